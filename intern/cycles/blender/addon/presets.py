@@ -74,6 +74,7 @@ class AddPresetSampling(AddPresetBase, Operator):
         "cycles.sample_clamp_indirect",
         "cycles.sample_all_lights_direct",
         "cycles.sample_all_lights_indirect",
+        "cycles.use_light_tree",
     ]
 
     preset_subdir = "cycles/sampling"
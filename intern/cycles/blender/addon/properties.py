@@ -55,6 +55,7 @@ enum_displacement_methods = (
 
 enum_bvh_layouts = (
     ('BVH2', "BVH2", "", 1),
+    ('BVH8', "BVH8", "", 2),
     ('EMBREE', "Embree", "", 4),
 )
 
@@ -384,6 +385,12 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         description="Sample all lights (for indirect samples), rather than randomly picking one",
         default=True,
     )
+    use_light_tree: BoolProperty(
+        name="Light Tree",
+        description="Pick lights by their importance for the shading point, which reduces noise in scenes with many lights. "
+        "Not used where all lights are sampled with branched path tracing",
+        default=False,
+    )
     light_sampling_threshold: FloatProperty(
         name="Light Sampling Threshold",
         description="Probabilistically terminate light samples when the light contribution is below this threshold (more noise but faster rendering). "
@@ -794,6 +801,20 @@ class CyclesRenderSettings(bpy.types.PropertyGroup):
         items=enum_texture_limit
     )
 
+    use_texture_cache: BoolProperty(
+        name="Texture Cache",
+        description="Load tiles of tiled and mipmapped image files (like .tx files) on demand, keeping the memory usage of "
+        "these textures within the cache size. Other images are loaded fully. Only used by CPU rendering with SVM shading",
+        default=False,
+    )
+    texture_cache_size: IntProperty(
+        name="Cache Size",
+        description="Maximum memory used by the texture cache, in megabytes",
+        default=4096,
+        min=1, soft_max=65536,
+        subtype='UNSIGNED',
+    )
+
     ao_bounces: IntProperty(
         name="AO Bounces",
         default=0,
@@ -147,24 +147,25 @@ template<typename K, typename T> class id_map {
 
   void post_sync(Scene *scene, bool do_delete = true)
   {
-    map<K, T *> new_map;
-    typedef pair<const K, T *> TMapPair;
+    /* Erase unused data in place and delete it all at once, scenes can have millions of
+     * instanced objects. */
+    unordered_set<T *> unused;
     typename map<K, T *>::iterator jt;
 
-    for (jt = b_map.begin(); jt != b_map.end(); jt++) {
-      TMapPair &pair = *jt;
-
-      if (do_delete && used_set.find(pair.second) == used_set.end()) {
-        scene->delete_node(pair.second);
+    for (jt = b_map.begin(); jt != b_map.end();) {
+      if (do_delete && used_set.find(jt->second) == used_set.end()) {
+        unused.insert(jt->second);
+        jt = b_map.erase(jt);
       }
       else {
-        new_map[pair.first] = pair.second;
+        jt++;
       }
     }
 
+    scene->delete_nodes(unused);
+
     used_set.clear();
     b_recalc.clear();
-    b_map = new_map;
   }
 
   const map<K, T *> &key_to_scene_data()
@@ -174,7 +175,7 @@ template<typename K, typename T> class id_map {
 
  protected:
   map<K, T *> b_map;
-  set<T *> used_set;
+  unordered_set<T *> used_set;
   set<void *> b_recalc;
 };
 
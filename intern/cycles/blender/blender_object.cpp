@@ -32,6 +32,7 @@
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
 #include "util/util_logging.h"
+#include "util/util_tbb.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -325,6 +326,206 @@ Object *BlenderSync::sync_object(BL::Depsgraph &b_depsgraph,
   return object;
 }
 
+/* Instances */
+
+void BlenderSync::InstanceArrays::clear()
+{
+  prototype_map.clear();
+  prototypes.clear();
+  prototype_parent.clear();
+  prototype_ob.clear();
+
+  prototype.clear();
+  persistent_id.clear();
+  tfm.clear();
+  random_id.clear();
+  dupli_generated.clear();
+  dupli_uv.clear();
+  from_particle_system.clear();
+}
+
+void BlenderSync::add_instance_prototype(BL::DepsgraphObjectInstance &b_instance, Object *object)
+{
+  if (!b_instance.is_instance() || !object->geometry) {
+    return;
+  }
+
+  /* Particle data is looked up for each instance in sync_dupli_particle(). */
+  if (b_instance.particle_system() &&
+      object->geometry->need_attribute(scene, ATTR_STD_PARTICLE)) {
+    return;
+  }
+
+  /* Motion steps are looked up for each instance, and their transforms filled in by the motion
+   * sync of every instance. */
+  if (!object->motion.empty()) {
+    return;
+  }
+
+  BL::Object b_parent = b_instance.parent();
+  BL::Object b_ob_instance = b_instance.instance_object();
+  const pair<void *, void *> key(b_parent.ptr.data, b_ob_instance.ptr.data);
+
+  instances.prototype_map[key] = instances.prototypes.size();
+  instances.prototypes.push_back(object);
+  instances.prototype_parent.push_back(b_parent.ptr.data);
+  instances.prototype_ob.push_back(b_ob_instance.ptr.data);
+}
+
+bool BlenderSync::sync_instance(BL::DepsgraphObjectInstance &b_instance,
+                                BlenderObjectCulling &culling)
+{
+  if (!b_instance.is_instance()) {
+    return false;
+  }
+
+  BL::Object b_parent = b_instance.parent();
+  BL::Object b_ob_instance = b_instance.instance_object();
+  const pair<void *, void *> key(b_parent.ptr.data, b_ob_instance.ptr.data);
+
+  map<pair<void *, void *>, int>::const_iterator it = instances.prototype_map.find(key);
+  if (it == instances.prototype_map.end()) {
+    return false;
+  }
+
+  BL::Object b_ob = b_instance.object();
+  Transform tfm = get_transform(b_ob.matrix_world());
+
+  /* Culled instances are not exported, same as in sync_object(). */
+  if (culling.test(scene, b_ob, tfm)) {
+    return true;
+  }
+
+  BL::Array<int, OBJECT_PERSISTENT_ID_SIZE> persistent_id = b_instance.persistent_id();
+
+  instances.prototype.push_back(it->second);
+  instances.persistent_id.insert(instances.persistent_id.end(),
+                                 persistent_id.data,
+                                 persistent_id.data + OBJECT_PERSISTENT_ID_SIZE);
+  instances.tfm.push_back(tfm);
+  instances.random_id.push_back(b_instance.random_id());
+  instances.dupli_generated.push_back(0.5f * get_float3(b_instance.orco()) -
+                                      make_float3(0.5f, 0.5f, 0.5f));
+  instances.dupli_uv.push_back(get_float2(b_instance.uv()));
+  instances.from_particle_system.push_back((bool)b_instance.particle_system());
+
+  return true;
+}
+
+void BlenderSync::sync_instances()
+{
+  const size_t num_instances = instances.prototype.size();
+  static const int INSTANCES_PER_TASK = 256;
+
+  /* Find existing objects, the object map is not modified meanwhile. */
+  vector<Object *> objects(num_instances, NULL);
+  const map<ObjectKey, Object *> &key_to_object = object_map.key_to_scene_data();
+
+  parallel_for(blocked_range<size_t>(0, num_instances, INSTANCES_PER_TASK),
+               [&](const blocked_range<size_t> &r) {
+                 for (size_t i = r.begin(); i != r.end(); i++) {
+                   const int prototype = instances.prototype[i];
+                   ObjectKey key(instances.prototype_parent[prototype],
+                                 &instances.persistent_id[i * OBJECT_PERSISTENT_ID_SIZE],
+                                 instances.prototype_ob[prototype],
+                                 false);
+                   map<ObjectKey, Object *>::const_iterator it = key_to_object.find(key);
+                   if (it != key_to_object.end()) {
+                     objects[i] = it->second;
+                   }
+                 }
+               });
+
+  /* Create objects for new instances, and tag all of them as used. */
+  for (size_t i = 0; i < num_instances; i++) {
+    if (objects[i]) {
+      object_map.used(objects[i]);
+      continue;
+    }
+
+    const int prototype = instances.prototype[i];
+    ObjectKey key(instances.prototype_parent[prototype],
+                  &instances.persistent_id[i * OBJECT_PERSISTENT_ID_SIZE],
+                  instances.prototype_ob[prototype],
+                  false);
+    objects[i] = object_map.find(key);
+    if (objects[i]) {
+      object_map.used(objects[i]);
+    }
+    else {
+      objects[i] = scene->create_node<Object>();
+      object_map.add(key, objects[i]);
+    }
+  }
+
+  /* Copy settings from the prototypes. */
+  vector<uchar> updated(num_instances, 0);
+
+  parallel_for(
+      blocked_range<size_t>(0, num_instances, INSTANCES_PER_TASK),
+      [&](const blocked_range<size_t> &r) {
+        for (size_t i = r.begin(); i != r.end(); i++) {
+          Object *object = objects[i];
+          const Object *prototype = instances.prototypes[instances.prototype[i]];
+          const Transform &tfm = instances.tfm[i];
+
+          if (object->geometry == prototype->geometry && !prototype->geometry->need_update &&
+              object->tfm == tfm && object->motion.empty() &&
+              object->visibility == prototype->visibility &&
+              object->use_holdout == prototype->use_holdout &&
+              object->is_shadow_catcher == prototype->is_shadow_catcher &&
+              object->shadow_terminator_offset == prototype->shadow_terminator_offset &&
+              object->asset_name == prototype->asset_name &&
+              object->pass_id == prototype->pass_id && object->color == prototype->color &&
+              object->random_id == instances.random_id[i] &&
+              object->dupli_generated == instances.dupli_generated[i] &&
+              object->dupli_uv == instances.dupli_uv[i]) {
+            continue;
+          }
+
+          object->name = prototype->name;
+          object->geometry = prototype->geometry;
+          object->tfm = tfm;
+          object->visibility = prototype->visibility;
+          object->use_holdout = prototype->use_holdout;
+          object->is_shadow_catcher = prototype->is_shadow_catcher;
+          object->shadow_terminator_offset = prototype->shadow_terminator_offset;
+          object->asset_name = prototype->asset_name;
+          object->pass_id = prototype->pass_id;
+          object->color = prototype->color;
+          object->random_id = instances.random_id[i];
+          object->dupli_generated = instances.dupli_generated[i];
+          object->dupli_uv = instances.dupli_uv[i];
+          object->hide_on_missing_motion = instances.from_particle_system[i];
+
+          /* Prototypes with motion steps are not batched. */
+          object->motion.clear();
+
+          updated[i] = 1;
+        }
+      });
+
+  /* Instances of a prototype share geometry and shaders, so tagging one of them updates the
+   * scene the same way as tagging all of them. */
+  vector<Object *> updated_objects(instances.prototypes.size(), NULL);
+  for (size_t i = 0; i < num_instances; i++) {
+    if (updated[i] && !updated_objects[instances.prototype[i]]) {
+      updated_objects[instances.prototype[i]] = objects[i];
+    }
+  }
+
+  foreach (Object *object, updated_objects) {
+    if (object) {
+      object->tag_update(scene);
+    }
+  }
+
+  VLOG(1) << "Synced " << num_instances << " instances of " << instances.prototypes.size()
+          << " objects.";
+
+  instances.clear();
+}
+
 /* Object Loop */
 
 void BlenderSync::sync_objects(BL::Depsgraph &b_depsgraph,
@@ -341,6 +542,7 @@ void BlenderSync::sync_objects(BL::Depsgraph &b_depsgraph,
     object_map.pre_sync();
     particle_system_map.pre_sync();
     motion_times.clear();
+    instances.clear();
   }
   else {
     geometry_motion_synced.clear();
@@ -372,16 +574,20 @@ void BlenderSync::sync_objects(BL::Depsgraph &b_depsgraph,
     /* Load per-object culling data. */
     culling.init_object(scene, b_ob);
 
-    /* Object itself. */
-    if (b_instance.show_self()) {
-      sync_object(b_depsgraph,
-                  b_view_layer,
-                  b_instance,
-                  motion_time,
-                  false,
-                  show_lights,
-                  culling,
-                  &use_portal);
+    /* Object itself. Duplis of an already synced object are batched. */
+    if (b_instance.show_self() && (motion || !sync_instance(b_instance, culling))) {
+      Object *object = sync_object(b_depsgraph,
+                                   b_view_layer,
+                                   b_instance,
+                                   motion_time,
+                                   false,
+                                   show_lights,
+                                   culling,
+                                   &use_portal);
+
+      if (object && !motion) {
+        add_instance_prototype(b_instance, object);
+      }
     }
 
     /* Particle hair as separate object. */
@@ -402,6 +608,7 @@ void BlenderSync::sync_objects(BL::Depsgraph &b_depsgraph,
   progress.set_sync_status("");
 
   if (!cancel && !motion) {
+    sync_instances();
     sync_background_light(b_v3d, use_portal);
 
     /* handle removed data and modified pointers */
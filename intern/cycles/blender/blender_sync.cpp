@@ -308,6 +308,12 @@ void BlenderSync::sync_integrator()
   integrator->sample_all_lights_indirect = get_boolean(cscene, "sample_all_lights_indirect");
   integrator->light_sampling_threshold = get_float(cscene, "light_sampling_threshold");
 
+  const bool use_light_tree = get_boolean(cscene, "use_light_tree");
+  if (integrator->use_light_tree != use_light_tree) {
+    scene->light_manager->tag_update(scene);
+  }
+  integrator->use_light_tree = use_light_tree;
+
   if (RNA_boolean_get(&cscene, "use_adaptive_sampling")) {
     integrator->sampling_pattern = SAMPLING_PATTERN_PMJ;
     integrator->adaptive_min_samples = get_int(cscene, "adaptive_min_samples");
@@ -783,6 +789,13 @@ SceneParams BlenderSync::get_scene_params(BL::Scene &b_scene, bool background)
     params.texture_limit = 0;
   }
 
+  if (get_boolean(cscene, "use_texture_cache")) {
+    params.texture_cache_size = get_int(cscene, "texture_cache_size");
+  }
+  else {
+    params.texture_cache_size = 0;
+  }
+
   params.bvh_layout = DebugFlags().cpu.bvh_layout;
 
   params.background = background;
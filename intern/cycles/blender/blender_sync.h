@@ -147,6 +147,11 @@ class BlenderSync {
                       BlenderObjectCulling &culling,
                       bool *use_portal);
 
+  /* Instances */
+  void add_instance_prototype(BL::DepsgraphObjectInstance &b_instance, Object *object);
+  bool sync_instance(BL::DepsgraphObjectInstance &b_instance, BlenderObjectCulling &culling);
+  void sync_instances();
+
   /* Volume */
   void sync_volume(BL::Object &b_ob, Volume *volume, const vector<Shader *> &used_shaders);
 
@@ -225,6 +230,29 @@ class BlenderSync {
   set<Geometry *> geometry_motion_synced;
   set<float> motion_times;
   void *world_map;
+
+  /* Duplis of an object that was already synced for the same parent share all its settings.
+   * They are gathered in flat arrays with only what differs per instance, and turned into
+   * scene objects in parallel after the object loop. */
+  struct InstanceArrays {
+    /* Synced objects the instances copy their settings from. */
+    map<pair<void *, void *>, int> prototype_map;
+    vector<Object *> prototypes;
+    vector<void *> prototype_parent;
+    vector<void *> prototype_ob;
+
+    /* Per instance data. */
+    vector<int> prototype;
+    vector<int> persistent_id;
+    vector<Transform> tfm;
+    vector<uint> random_id;
+    vector<float3> dupli_generated;
+    vector<float2> dupli_uv;
+    vector<bool> from_particle_system;
+
+    void clear();
+  } instances;
+
   bool world_recalc;
   BlenderViewportParameters viewport_parameters;
 
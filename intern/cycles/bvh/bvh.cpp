@@ -22,6 +22,7 @@
 #include "render/object.h"
 
 #include "bvh/bvh2.h"
+#include "bvh/bvh8.h"
 #include "bvh/bvh_build.h"
 #include "bvh/bvh_embree.h"
 #include "bvh/bvh_node.h"
@@ -40,6 +41,8 @@ const char *bvh_layout_name(BVHLayout layout)
   switch (layout) {
     case BVH_LAYOUT_BVH2:
       return "BVH2";
+    case BVH_LAYOUT_BVH8:
+      return "BVH8";
     case BVH_LAYOUT_NONE:
       return "NONE";
     case BVH_LAYOUT_EMBREE:
@@ -104,6 +107,8 @@ BVH *BVH::create(const BVHParams &params,
   switch (params.bvh_layout) {
     case BVH_LAYOUT_BVH2:
       return new BVH2(params, geometry, objects);
+    case BVH_LAYOUT_BVH8:
+      return new BVH8(params, geometry, objects);
     case BVH_LAYOUT_EMBREE:
 #ifdef WITH_EMBREE
       return new BVHEmbree(params, geometry, objects, device);
@@ -478,7 +483,24 @@ void BVH::pack_instances(size_t nodes_size, size_t leaf_nodes_size)
       }
     }
 
-    if (bvh->pack.nodes.size()) {
+    if (bvh->pack.nodes.size() && params.bvh_layout == BVH_LAYOUT_BVH8) {
+      int4 *bvh_nodes = &bvh->pack.nodes[0];
+      size_t bvh_nodes_size = bvh->pack.nodes.size();
+
+      /* All nodes have the same size, with the indices of the children in two int4. */
+      for (size_t i = 0; i < bvh_nodes_size; i += BVH8_NODE_SIZE) {
+        memcpy(pack_nodes + pack_nodes_offset, bvh_nodes + i, sizeof(int4) * BVH8_NODE_SIZE);
+
+        /* Modify offsets into arrays */
+        for (int j = 0; j < BVH8_NUM_CHILDREN; j++) {
+          int &c = pack_nodes[pack_nodes_offset + 5 + j / 4][j % 4];
+          c += (c < 0) ? -noffset_leaf : noffset;
+        }
+
+        pack_nodes_offset += BVH8_NODE_SIZE;
+      }
+    }
+    else if (bvh->pack.nodes.size()) {
       int4 *bvh_nodes = &bvh->pack.nodes[0];
       size_t bvh_nodes_size = bvh->pack.nodes.size();
 
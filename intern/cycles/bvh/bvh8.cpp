@@ -0,0 +1,304 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "bvh/bvh8.h"
+
+#include "render/mesh.h"
+#include "render/object.h"
+
+#include "bvh/bvh_node.h"
+
+CCL_NAMESPACE_BEGIN
+
+BVH8::BVH8(const BVHParams &params_,
+           const vector<Geometry *> &geometry_,
+           const vector<Object *> &objects_)
+    : BVH(params_, geometry_, objects_)
+{
+  /* Quantized nodes are axis aligned. */
+  params.use_unaligned_nodes = false;
+}
+
+namespace {
+
+/* Collapse the binary tree into nodes of up to eight children, by repeatedly opening the child
+ * with the largest surface area, which is the one most likely to be traversed. */
+BVHNode *bvh_node_merge_children_recursively(const BVHNode *node)
+{
+  if (node->is_leaf()) {
+    return new LeafNode(*reinterpret_cast<const LeafNode *>(node));
+  }
+
+  const BVHNode *children[BVH8_NUM_CHILDREN];
+  int num_children = 0;
+  for (int i = 0; i < node->num_children(); i++) {
+    children[num_children++] = node->get_child(i);
+  }
+
+  while (num_children < BVH8_NUM_CHILDREN) {
+    int best_child = -1;
+    float best_area = -FLT_MAX;
+    for (int i = 0; i < num_children; i++) {
+      if (!children[i]->is_leaf() && children[i]->bounds.safe_area() > best_area) {
+        best_child = i;
+        best_area = children[i]->bounds.safe_area();
+      }
+    }
+    if (best_child == -1) {
+      break;
+    }
+
+    const BVHNode *child = children[best_child];
+    children[best_child] = child->get_child(0);
+    children[num_children++] = child->get_child(1);
+  }
+
+  BVHNode *children8[BVH8_NUM_CHILDREN];
+  for (int i = 0; i < num_children; i++) {
+    children8[i] = bvh_node_merge_children_recursively(children[i]);
+  }
+
+  return new InnerNode(node->bounds, children8, num_children);
+}
+
+}  // namespace
+
+BVHNode *BVH8::widen_children_nodes(const BVHNode *root)
+{
+  if (root == NULL) {
+    return NULL;
+  }
+  if (root->is_leaf()) {
+    return const_cast<BVHNode *>(root);
+  }
+  return bvh_node_merge_children_recursively(root);
+}
+
+void BVH8::pack_leaf(const BVHStackEntry &e, const LeafNode *leaf)
+{
+  float4 data[BVH8_NODE_LEAF_SIZE];
+  memset(data, 0, sizeof(data));
+  if (leaf->num_triangles() == 1 && pack.prim_index[leaf->lo] == -1) {
+    /* object */
+    data[0].x = __int_as_float(~(leaf->lo));
+    data[0].y = __int_as_float(0);
+  }
+  else {
+    /* triangle */
+    data[0].x = __int_as_float(leaf->lo);
+    data[0].y = __int_as_float(leaf->hi);
+  }
+  data[0].z = __uint_as_float(leaf->visibility);
+  if (leaf->num_triangles() != 0) {
+    data[0].w = __uint_as_float(pack.prim_type[leaf->lo]);
+  }
+
+  memcpy(&pack.leaf_nodes[e.idx], data, sizeof(float4) * BVH8_NODE_LEAF_SIZE);
+}
+
+void BVH8::pack_inner(const BVHStackEntry &e, const BVHStackEntry *en, int num)
+{
+  BoundBox bounds[BVH8_NUM_CHILDREN];
+  int child[BVH8_NUM_CHILDREN];
+  uint visibility[BVH8_NUM_CHILDREN];
+
+  for (int i = 0; i < num; i++) {
+    bounds[i] = en[i].node->bounds;
+    child[i] = en[i].encodeIdx();
+    visibility[i] = en[i].node->visibility;
+  }
+
+  pack_node(e.idx, bounds, child, visibility, num);
+}
+
+void BVH8::pack_node(int idx,
+                     const BoundBox *bounds,
+                     const int *child,
+                     const uint *visibility,
+                     const int num_children)
+{
+  assert(idx + BVH8_NODE_SIZE <= pack.nodes.size());
+  assert(num_children <= BVH8_NUM_CHILDREN);
+
+  BoundBox node_bounds = BoundBox::empty;
+  for (int i = 0; i < num_children; i++) {
+    node_bounds.grow(bounds[i]);
+  }
+
+  /* The grid spans the node with one cell of margin on both sides, so the bounds of the children
+   * can be widened by one cell below. The padding keeps cells from being empty for flat nodes. */
+  const float3 pad = (fabs(node_bounds.min) + fabs(node_bounds.max)) * 1e-6f;
+  const float3 scale = (node_bounds.max - node_bounds.min + 2.0f * pad) * (1.0f / 253.0f);
+  const float3 origin = node_bounds.min - pad - scale;
+
+  int4 data[BVH8_NODE_SIZE];
+  memset(data, 0, sizeof(data));
+
+  data[0] = make_int4(
+      __float_as_int(origin.x), __float_as_int(origin.y), __float_as_int(origin.z), 0);
+  data[1] = make_int4(
+      __float_as_int(scale.x), __float_as_int(scale.y), __float_as_int(scale.z), 0);
+
+  for (int axis = 0; axis < 3; axis++) {
+    uchar *quantized = (uchar *)&data[2 + axis];
+    const float inv_scale = (scale[axis] > 0.0f) ? 1.0f / scale[axis] : 0.0f;
+
+    for (int i = 0; i < BVH8_NUM_CHILDREN; i++) {
+      if (i >= num_children) {
+        /* Unused children are never traversed because of their visibility. */
+        quantized[i] = 0;
+        quantized[i + BVH8_NUM_CHILDREN] = 0;
+        continue;
+      }
+
+      /* Widen the bounds by one cell, so neither the rounding of the grid coordinates here nor of
+       * the reconstructed coordinates in the kernel can shrink the bounds of the children. */
+      const int lo = (int)floorf((bounds[i].min[axis] - origin[axis]) * inv_scale) - 1;
+      const int hi = (int)ceilf((bounds[i].max[axis] - origin[axis]) * inv_scale) + 1;
+
+      quantized[i] = (uchar)clamp(lo, 0, 255);
+      quantized[i + BVH8_NUM_CHILDREN] = (uchar)clamp(hi, 0, 255);
+    }
+  }
+
+  for (int i = 0; i < num_children; i++) {
+    assert(child[i] < 0 || child[i] < pack.nodes.size());
+    data[5 + i / 4][i % 4] = child[i];
+    data[7 + i / 4][i % 4] = visibility[i];
+  }
+
+  memcpy(&pack.nodes[idx], data, sizeof(int4) * BVH8_NODE_SIZE);
+}
+
+void BVH8::pack_nodes(const BVHNode *root)
+{
+  const size_t num_nodes = root->getSubtreeSize(BVH_STAT_NODE_COUNT);
+  const size_t num_leaf_nodes = root->getSubtreeSize(BVH_STAT_LEAF_COUNT);
+  assert(num_leaf_nodes <= num_nodes);
+  const size_t num_inner_nodes = num_nodes - num_leaf_nodes;
+  const size_t node_size = num_inner_nodes * BVH8_NODE_SIZE;
+
+  /* Resize arrays */
+  pack.nodes.clear();
+  pack.leaf_nodes.clear();
+  /* For top level BVH, first merge existing BVH's so we know the offsets. */
+  if (params.top_level) {
+    pack_instances(node_size, num_leaf_nodes * BVH8_NODE_LEAF_SIZE);
+  }
+  else {
+    pack.nodes.resize(node_size);
+    pack.leaf_nodes.resize(num_leaf_nodes * BVH8_NODE_LEAF_SIZE);
+  }
+
+  int nextNodeIdx = 0, nextLeafNodeIdx = 0;
+
+  vector<BVHStackEntry> stack;
+  stack.reserve(BVHParams::MAX_DEPTH * 2);
+  if (root->is_leaf()) {
+    stack.push_back(BVHStackEntry(root, nextLeafNodeIdx++));
+  }
+  else {
+    stack.push_back(BVHStackEntry(root, nextNodeIdx));
+    nextNodeIdx += BVH8_NODE_SIZE;
+  }
+
+  while (stack.size()) {
+    BVHStackEntry e = stack.back();
+    stack.pop_back();
+
+    if (e.node->is_leaf()) {
+      /* leaf node */
+      const LeafNode *leaf = reinterpret_cast<const LeafNode *>(e.node);
+      pack_leaf(e, leaf);
+    }
+    else {
+      /* inner node */
+      const int num_children = e.node->num_children();
+      BVHStackEntry children[BVH8_NUM_CHILDREN];
+      for (int i = 0; i < num_children; ++i) {
+        const BVHNode *child = e.node->get_child(i);
+        if (child->is_leaf()) {
+          children[i] = BVHStackEntry(child, nextLeafNodeIdx++);
+        }
+        else {
+          children[i] = BVHStackEntry(child, nextNodeIdx);
+          nextNodeIdx += BVH8_NODE_SIZE;
+        }
+        stack.push_back(children[i]);
+      }
+
+      pack_inner(e, children, num_children);
+    }
+  }
+  assert(node_size == nextNodeIdx);
+  /* root index to start traversal at, to handle case of single leaf node */
+  pack.root_index = (root->is_leaf()) ? -1 : 0;
+}
+
+void BVH8::refit_nodes()
+{
+  assert(!params.top_level);
+
+  BoundBox bbox = BoundBox::empty;
+  uint visibility = 0;
+  refit_node(0, (pack.root_index == -1) ? true : false, bbox, visibility);
+}
+
+void BVH8::refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility)
+{
+  if (leaf) {
+    /* refit leaf node */
+    assert(idx + BVH8_NODE_LEAF_SIZE <= pack.leaf_nodes.size());
+    int4 *data = &pack.leaf_nodes[idx];
+    const int c0 = data[0].x;
+    const int c1 = data[0].y;
+
+    BVH::refit_primitives(c0, c1, bbox, visibility);
+
+    data[0].z = visibility;
+  }
+  else {
+    assert(idx + BVH8_NODE_SIZE <= pack.nodes.size());
+
+    const int4 *data = &pack.nodes[idx];
+    BoundBox child_bbox[BVH8_NUM_CHILDREN];
+    int child[BVH8_NUM_CHILDREN];
+    uint child_visibility[BVH8_NUM_CHILDREN];
+    int num_children = 0;
+
+    /* Used children are stored first. Unused ones have index zero, which is the root and never
+     * a child. */
+    for (int i = 0; i < BVH8_NUM_CHILDREN; i++) {
+      const int c = data[5 + i / 4][i % 4];
+      if (c == 0) {
+        break;
+      }
+
+      child_bbox[i] = BoundBox::empty;
+      child_visibility[i] = 0;
+      child[i] = c;
+      refit_node((c < 0) ? -c - 1 : c, (c < 0), child_bbox[i], child_visibility[i]);
+      num_children++;
+
+      bbox.grow(child_bbox[i]);
+      visibility |= child_visibility[i];
+    }
+
+    pack_node(idx, child_bbox, child, child_visibility, num_children);
+  }
+}
+
+CCL_NAMESPACE_END
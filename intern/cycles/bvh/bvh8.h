@@ -0,0 +1,81 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __BVH8_H__
+#define __BVH8_H__
+
+#include "bvh/bvh.h"
+#include "bvh/bvh_params.h"
+
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+class BVHNode;
+struct BVHStackEntry;
+class BVHParams;
+class BoundBox;
+class LeafNode;
+class Object;
+class Progress;
+
+#define BVH8_NODE_SIZE 9
+#define BVH8_NODE_LEAF_SIZE 1
+#define BVH8_NUM_CHILDREN 8
+
+/* BVH8
+ *
+ * BVH with up to eight children per node, for traversal with AVX2 on the CPU. The bounds of the
+ * children are quantized to 8 bits on a grid spanning the node, which makes nodes about a third
+ * of the size of the BVH2 nodes they replace. Leaf nodes are the same as BVH2.
+ *
+ * Node layout, in int4:
+ * 0: origin of the quantization grid
+ * 1: size of a grid cell
+ * 2-4: minimum and maximum grid coordinates of the children along X, Y and Z, one byte each
+ * 5-6: indices of the children
+ * 7-8: visibility of the children, zero for unused children */
+class BVH8 : public BVH {
+ protected:
+  /* constructor */
+  friend class BVH;
+  BVH8(const BVHParams &params,
+       const vector<Geometry *> &geometry,
+       const vector<Object *> &objects);
+
+  /* Building process. */
+  virtual BVHNode *widen_children_nodes(const BVHNode *root) override;
+
+  /* pack */
+  void pack_nodes(const BVHNode *root) override;
+
+  void pack_leaf(const BVHStackEntry &e, const LeafNode *leaf);
+  void pack_inner(const BVHStackEntry &e, const BVHStackEntry *en, int num);
+  void pack_node(int idx,
+                 const BoundBox *bounds,
+                 const int *child,
+                 const uint *visibility,
+                 const int num_children);
+
+  /* refit */
+  void refit_nodes() override;
+  void refit_node(int idx, bool leaf, BoundBox &bbox, uint &visibility);
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __BVH8_H__ */
@@ -1253,6 +1253,22 @@ void CUDADevice::tex_alloc(device_texture &mem)
     cuda_assert(cuMemcpyHtoD(mem.device_pointer, mem.host_pointer, size));
   }
 
+  /* Resize once */
+  const uint slot = mem.slot;
+  if (slot >= texture_info.size()) {
+    /* Allocate some slots in advance, to reduce amount
+     * of re-allocations. */
+    texture_info.resize(slot + 128);
+  }
+
+  if (IMAGE_DATA_TYPE_IS_SPARSE(mem.info.data_type)) {
+    /* Sparse grids are read directly from linear memory by the kernel. */
+    texture_info[slot] = mem.info;
+    texture_info[slot].data = (uint64_t)mem.device_pointer;
+    need_texture_info = true;
+    return;
+  }
+
   /* Kepler+, bindless textures. */
   CUDA_RESOURCE_DESC resDesc;
   memset(&resDesc, 0, sizeof(resDesc));
@@ -1289,14 +1305,6 @@ void CUDADevice::tex_alloc(device_texture &mem)
 
   cuda_assert(cuTexObjectCreate(&cmem->texobject, &resDesc, &texDesc, NULL));
 
-  /* Resize once */
-  const uint slot = mem.slot;
-  if (slot >= texture_info.size()) {
-    /* Allocate some slots in advance, to reduce amount
-     * of re-allocations. */
-    texture_info.resize(slot + 128);
-  }
-
   /* Set Mapping and tag that we need to (re-)upload to device */
   texture_info[slot] = mem.info;
   texture_info[slot].data = (uint64_t)cmem->texobject;
@@ -185,6 +185,12 @@ device_texture::device_texture(Device *device,
       data_type = TYPE_UINT16;
       data_elements = 1;
       break;
+    case IMAGE_DATA_TYPE_SPARSE_FLOAT:
+    case IMAGE_DATA_TYPE_SPARSE_FLOAT3:
+      /* Tile offsets and voxels, stored in one linear buffer. */
+      data_type = TYPE_FLOAT;
+      data_elements = 1;
+      break;
     case IMAGE_DATA_NUM_TYPES:
       assert(0);
       return;
@@ -38,6 +38,9 @@ CCL_NAMESPACE_BEGIN
 /* Regular BVH traversal */
 
 #  include "kernel/bvh/bvh_nodes.h"
+#  ifdef __BVH8__
+#    include "kernel/bvh/bvh8_nodes.h"
+#  endif
 
 #  define BVH_FUNCTION_NAME bvh_intersect
 #  define BVH_FUNCTION_FEATURES 0
@@ -0,0 +1,135 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+/* BVH8
+ *
+ * Interior nodes with eight children whose bounds are quantized to 8 bits, intersected all at
+ * once with AVX2. Leaf nodes, the traversal stack and instancing are the same as BVH2, so the
+ * traversal functions only replace their loop over interior nodes with bvh8_node_traverse(). */
+
+/* Distances along the ray to the slabs of the children along one axis. The bounds are
+ * origin + scale * q for grid coordinates q, so the distances are q * scale * idir +
+ * (origin - P) * idir. The grid coordinates are widened by one cell when packing the nodes, which
+ * covers the rounding of the reconstructed slabs. */
+ccl_device_forceinline void bvh8_node_intersect_axis(KernelGlobals *kg,
+                                                     const int addr,
+                                                     const float origin,
+                                                     const float scale,
+                                                     const float P,
+                                                     const float idir,
+                                                     avxf *tnear,
+                                                     avxf *tfar)
+{
+  const __m128i quantized = kernel_tex_fetch_ssei(__bvh_nodes, addr);
+  const avxf lo = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(quantized));
+  const avxf hi = _mm256_cvtepi32_ps(_mm256_cvtepu8_epi32(_mm_srli_si128(quantized, 8)));
+
+  const avxf scale_idir(scale * idir);
+  const avxf origin_idir((origin - P) * idir);
+  const avxf t_lo = madd(lo, scale_idir, origin_idir);
+  const avxf t_hi = madd(hi, scale_idir, origin_idir);
+
+  *tnear = max(*tnear, min(t_lo, t_hi));
+  *tfar = min(*tfar, max(t_lo, t_hi));
+}
+
+/* Returns a bit mask of the children intersected by the ray and visible to it. */
+ccl_device_forceinline int bvh8_node_intersect(KernelGlobals *kg,
+                                               const float3 P,
+                                               const float3 idir,
+                                               const float t,
+                                               const int node_addr,
+                                               const uint visibility,
+                                               avxf *dist)
+{
+  const float4 origin = kernel_tex_fetch(__bvh_nodes, node_addr + 0);
+  const float4 scale = kernel_tex_fetch(__bvh_nodes, node_addr + 1);
+
+  avxf tnear(0.0f), tfar(t);
+  bvh8_node_intersect_axis(kg, node_addr + 2, origin.x, scale.x, P.x, idir.x, &tnear, &tfar);
+  bvh8_node_intersect_axis(kg, node_addr + 3, origin.y, scale.y, P.y, idir.y, &tnear, &tfar);
+  bvh8_node_intersect_axis(kg, node_addr + 4, origin.z, scale.z, P.z, idir.z, &tnear, &tfar);
+
+  /* The distances are rounded relative to their magnitude, which far from the ray origin can
+   * exceed one cell, so the far distances are also pushed out by a few ulps. */
+  tfar = tfar * avxf(1.0f + 4.0f * FLT_EPSILON);
+
+  /* Unused children have no visibility, so this also masks them out. */
+  const __m256i child_visibility = _mm256_castps_si256(
+      kernel_tex_fetch_avxf(__bvh_nodes, node_addr + 7));
+  const __m256i invisible = _mm256_cmpeq_epi32(
+      _mm256_and_si256(child_visibility, _mm256_set1_epi32(visibility)), _mm256_setzero_si256());
+
+  *dist = tnear;
+  return (int)movemask(tnear <= tfar) & ~_mm256_movemask_ps(_mm256_castsi256_ps(invisible));
+}
+
+/* Traverse interior nodes until a leaf is reached, pushing the other intersected children on
+ * the stack. Returns the address of the leaf, or the sentinel when the stack is exhausted. */
+ccl_device_inline int bvh8_node_traverse(KernelGlobals *kg,
+                                         const float3 P,
+                                         const float3 idir,
+                                         const float t,
+                                         const uint visibility,
+                                         int node_addr,
+                                         int *traversal_stack,
+                                         int *stack_ptr)
+{
+  while (node_addr >= 0 && node_addr != ENTRYPOINT_SENTINEL) {
+    avxf dist;
+    int mask = bvh8_node_intersect(kg, P, idir, t, node_addr, visibility, &dist);
+
+    if (mask == 0) {
+      /* No children were intersected. */
+      node_addr = traversal_stack[*stack_ptr];
+      --*stack_ptr;
+      continue;
+    }
+
+    const avxf child_addr = kernel_tex_fetch_avxf(__bvh_nodes, node_addr + 5);
+
+    if ((mask & (mask - 1)) == 0) {
+      /* One child was intersected. */
+      node_addr = child_addr.i[__bsf(mask)];
+      continue;
+    }
+
+    /* Sort the intersected children from far to near, push all but the nearest one so they are
+     * popped in near to far order. */
+    int sorted_addr[8];
+    float sorted_dist[8];
+    int num_sorted = 0;
+    while (mask != 0) {
+      const int i = __bscf(mask);
+      int j = num_sorted++;
+      for (; j > 0 && sorted_dist[j - 1] < dist[i]; j--) {
+        sorted_dist[j] = sorted_dist[j - 1];
+        sorted_addr[j] = sorted_addr[j - 1];
+      }
+      sorted_dist[j] = dist[i];
+      sorted_addr[j] = child_addr.i[i];
+    }
+
+    for (int j = 0; j < num_sorted - 1; j++) {
+      ++*stack_ptr;
+      kernel_assert(*stack_ptr < BVH_STACK_SIZE);
+      traversal_stack[*stack_ptr] = sorted_addr[j];
+    }
+    node_addr = sorted_addr[num_sorted - 1];
+  }
+
+  return node_addr;
+}
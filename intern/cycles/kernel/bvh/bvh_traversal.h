@@ -72,6 +72,13 @@ ccl_device_noinline bool BVH_FUNCTION_FULL_NAME(BVH)(KernelGlobals *kg,
   /* traversal loop */
   do {
     do {
+#ifdef __BVH8__
+      if (kernel_data.bvh.bvh_layout == BVH_LAYOUT_BVH8) {
+        node_addr = bvh8_node_traverse(
+            kg, P, idir, isect->t, visibility, node_addr, traversal_stack, &stack_ptr);
+      }
+#endif
+
       /* traverse internal nodes */
       while (node_addr >= 0 && node_addr != ENTRYPOINT_SENTINEL) {
         int node_addr_child1, traverse_mask;
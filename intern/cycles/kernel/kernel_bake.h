@@ -64,7 +64,7 @@ ccl_device_noinline void compute_light_pass(
 
     /* sample emission */
     if ((pass_filter & BAKE_FILTER_EMISSION) && (sd->flag & SD_EMISSION)) {
-      float3 emission = indirect_primitive_emission(kg, sd, 0.0f, state.flag, state.ray_pdf);
+      float3 emission = indirect_primitive_emission(kg, sd, 0.0f, &state);
       path_radiance_accum_emission(kg, L, &state, throughput, emission);
     }
 
@@ -116,7 +116,7 @@ ccl_device_noinline void compute_light_pass(
 
     /* sample emission */
     if ((pass_filter & BAKE_FILTER_EMISSION) && (sd->flag & SD_EMISSION)) {
-      float3 emission = indirect_primitive_emission(kg, sd, 0.0f, state.flag, state.ray_pdf);
+      float3 emission = indirect_primitive_emission(kg, sd, 0.0f, &state);
       path_radiance_accum_emission(kg, L, &state, throughput, emission);
     }
 
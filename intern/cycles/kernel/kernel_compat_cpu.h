@@ -39,6 +39,7 @@
 #include "util/util_math.h"
 #include "util/util_simd.h"
 #include "util/util_texture.h"
+#include "util/util_texture_cache.h"
 #include "util/util_types.h"
 
 #define ccl_addr_space
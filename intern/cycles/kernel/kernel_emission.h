@@ -206,23 +206,33 @@ ccl_device_noinline_cpu bool direct_emission(KernelGlobals *kg,
 
 /* Indirect Primitive Emission */
 
-ccl_device_noinline_cpu float3 indirect_primitive_emission(
-    KernelGlobals *kg, ShaderData *sd, float t, int path_flag, float bsdf_pdf)
+ccl_device_noinline_cpu float3 indirect_primitive_emission(KernelGlobals *kg,
+                                                          ShaderData *sd,
+                                                          float t,
+                                                          const ccl_addr_space PathState *state)
 {
   /* evaluate emissive closure */
   float3 L = shader_emissive_eval(sd);
 
 #ifdef __HAIR__
-  if (!(path_flag & PATH_RAY_MIS_SKIP) && (sd->flag & SD_USE_MIS) &&
+  if (!(state->flag & PATH_RAY_MIS_SKIP) && (sd->flag & SD_USE_MIS) &&
       (sd->type & PRIMITIVE_ALL_TRIANGLE))
 #else
-  if (!(path_flag & PATH_RAY_MIS_SKIP) && (sd->flag & SD_USE_MIS))
+  if (!(state->flag & PATH_RAY_MIS_SKIP) && (sd->flag & SD_USE_MIS))
 #endif
   {
     /* multiple importance sampling, get triangle light pdf,
      * and compute weight with respect to BSDF pdf */
-    float pdf = triangle_light_pdf(kg, sd, t);
-    float mis_weight = power_heuristic(bsdf_pdf, pdf);
+    const bool use_light_tree = (state->flag & PATH_RAY_LIGHT_TREE);
+    float tree_pdf = 1.0f;
+    if (use_light_tree) {
+      /* Picked at the shading point of the last bounce, which is not the ray origin after
+       * transparent surfaces. */
+      const int emitter_index = light_tree_triangle_emitter(kg, sd->object, sd->prim);
+      tree_pdf = light_tree_emitter_pdf(kg, state->ray_P, state->ray_N, emitter_index);
+    }
+    float pdf = triangle_light_pdf(kg, sd, t, use_light_tree, tree_pdf);
+    float mis_weight = power_heuristic(state->ray_pdf, pdf);
 
     return L * mis_weight;
   }
@@ -245,6 +255,8 @@ ccl_device_noinline_cpu void indirect_lamp_emission(KernelGlobals *kg,
     if (!lamp_light_eval(kg, lamp, ray->P, ray->D, ray->t, &ls))
       continue;
 
+    ls.pdf *= lamp_light_select_pdf(kg, lamp, state);
+
 #ifdef __PASSES__
     /* use visibility flag to skip lights */
     if (ls.shader & SHADER_EXCLUDE_ANY) {
@@ -329,7 +341,8 @@ ccl_device_noinline_cpu float3 indirect_background(KernelGlobals *kg,
   if (!(state->flag & PATH_RAY_MIS_SKIP) && kernel_data.background.use_mis) {
     /* multiple importance sampling, get background light pdf for ray
      * direction, and compute weight with respect to BSDF pdf */
-    float pdf = background_light_pdf(kg, ray->P, ray->D);
+    float pdf = background_light_pdf(kg, ray->P, ray->D) *
+                lamp_light_select_pdf(kg, kernel_data.integrator.background_light_index, state);
     float mis_weight = power_heuristic(state->ray_pdf, pdf);
 
     return L * mis_weight;
@@ -15,6 +15,7 @@
  */
 
 #include "kernel_light_background.h"
+#include "kernel_light_tree.h"
 
 CCL_NAMESPACE_BEGIN
 
@@ -35,8 +36,21 @@ typedef struct LightSample {
   LightType type; /* type of light */
 } LightSample;
 
+/* Probability of selecting the lamp when sampling a light at the last bounce of the path. */
+ccl_device_inline float lamp_light_select_pdf(KernelGlobals *kg,
+                                              int lamp,
+                                              const ccl_addr_space PathState *state)
+{
+  if (state->flag & PATH_RAY_LIGHT_TREE) {
+    return light_tree_emitter_pdf(
+        kg, state->ray_P, state->ray_N, light_tree_lamp_emitter(kg, lamp));
+  }
+  return kernel_data.integrator.pdf_lights;
+}
+
 /* Regular Light */
 
+/* The returned pdf does not include the probability of selecting the lamp. */
 ccl_device_inline bool lamp_light_sample(
     KernelGlobals *kg, int lamp, float randu, float randv, float3 P, LightSample *ls)
 {
@@ -153,11 +167,10 @@ ccl_device_inline bool lamp_light_sample(
     }
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
-
   return (ls->pdf > 0.0f);
 }
 
+/* The returned pdf does not include the probability of selecting the lamp. */
 ccl_device bool lamp_light_eval(
     KernelGlobals *kg, int lamp, float3 P, float3 D, float t, LightSample *ls)
 {
@@ -291,8 +304,6 @@ ccl_device bool lamp_light_eval(
     return false;
   }
 
-  ls->pdf *= kernel_data.integrator.pdf_lights;
-
   return true;
 }
 
@@ -328,12 +339,11 @@ ccl_device_inline bool triangle_world_space_vertices(
   return has_motion;
 }
 
-ccl_device_inline float triangle_light_pdf_area(KernelGlobals *kg,
-                                                const float3 Ng,
+ccl_device_inline float triangle_light_pdf_area(const float3 Ng,
                                                 const float3 I,
-                                                float t)
+                                                float t,
+                                                float pdf)
 {
-  float pdf = kernel_data.integrator.pdf_triangles;
   float cos_pi = fabsf(dot(Ng, I));
 
   if (cos_pi == 0.0f)
@@ -342,7 +352,13 @@ ccl_device_inline float triangle_light_pdf_area(KernelGlobals *kg,
   return t * t * pdf / cos_pi;
 }
 
-ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *sd, float t)
+/* tree_pdf is the probability of picking the triangle in the light tree, it is unused when
+ * sampling the light distribution. */
+ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg,
+                                                ShaderData *sd,
+                                                float t,
+                                                bool use_light_tree,
+                                                float tree_pdf)
 {
   /* A naive heuristic to decide between costly solid angle sampling
    * and simple area sampling, comparing the distance to the triangle plane
@@ -379,6 +395,9 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
     if (UNLIKELY(solid_angle == 0.0f)) {
       return 0.0f;
     }
+    else if (use_light_tree) {
+      return tree_pdf / solid_angle;
+    }
     else {
       float area = 1.0f;
       if (has_motion) {
@@ -393,8 +412,16 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
       return pdf / solid_angle;
     }
   }
+  else if (use_light_tree) {
+    /* The probability of picking the triangle is spread over the area it is sampled from. */
+    const float area = 0.5f * len(N);
+    if (UNLIKELY(area == 0.0f)) {
+      return 0.0f;
+    }
+    return triangle_light_pdf_area(sd->Ng, sd->I, t, tree_pdf / area);
+  }
   else {
-    float pdf = triangle_light_pdf_area(kg, sd->Ng, sd->I, t);
+    float pdf = triangle_light_pdf_area(sd->Ng, sd->I, t, kernel_data.integrator.pdf_triangles);
     if (has_motion) {
       const float area = 0.5f * len(N);
       if (UNLIKELY(area == 0.0f)) {
@@ -411,6 +438,8 @@ ccl_device_forceinline float triangle_light_pdf(KernelGlobals *kg, ShaderData *s
   }
 }
 
+/* tree_pdf is the probability of picking the triangle in the light tree, it is unused when
+ * sampling the light distribution. */
 ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
                                                   int prim,
                                                   int object,
@@ -418,7 +447,9 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
                                                   float randv,
                                                   float time,
                                                   LightSample *ls,
-                                                  const float3 P)
+                                                  const float3 P,
+                                                  bool use_light_tree,
+                                                  float tree_pdf)
 {
   /* A naive heuristic to decide between costly solid angle sampling
    * and simple area sampling, comparing the distance to the triangle plane
@@ -536,6 +567,9 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
       ls->pdf = 0.0f;
       return;
     }
+    else if (use_light_tree) {
+      ls->pdf = tree_pdf / solid_angle;
+    }
     else {
       if (has_motion) {
         /* get the center frame vertices, this is what the PDF was calculated from */
@@ -564,14 +598,22 @@ ccl_device_forceinline void triangle_light_sample(KernelGlobals *kg,
     ls->P = u * V[0] + v * V[1] + t * V[2];
     /* compute incoming direction, distance and pdf */
     ls->D = normalize_len(ls->P - P, &ls->t);
-    ls->pdf = triangle_light_pdf_area(kg, ls->Ng, -ls->D, ls->t);
-    if (has_motion && area != 0.0f) {
-      /* scale the PDF.
-       * area = the area the sample was taken from
-       * area_pre = the are from which pdf_triangles was calculated from */
-      triangle_world_space_vertices(kg, object, prim, -1.0f, V);
-      const float area_pre = triangle_area(V[0], V[1], V[2]);
-      ls->pdf = ls->pdf * area_pre / area;
+    if (use_light_tree) {
+      /* The probability of picking the triangle is spread over the area it is sampled from. */
+      ls->pdf = (area != 0.0f) ? triangle_light_pdf_area(ls->Ng, -ls->D, ls->t, tree_pdf / area) :
+                                 0.0f;
+    }
+    else {
+      ls->pdf = triangle_light_pdf_area(
+          ls->Ng, -ls->D, ls->t, kernel_data.integrator.pdf_triangles);
+      if (has_motion && area != 0.0f) {
+        /* scale the PDF.
+         * area = the area the sample was taken from
+         * area_pre = the are from which pdf_triangles was calculated from */
+        triangle_world_space_vertices(kg, object, prim, -1.0f, V);
+        const float area_pre = triangle_area(V[0], V[1], V[2]);
+        ls->pdf = ls->pdf * area_pre / area;
+      }
     }
     ls->u = u;
     ls->v = v;
@@ -629,12 +671,25 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
                                       float randv,
                                       float time,
                                       float3 P,
+                                      float3 N,
+                                      bool use_light_tree,
                                       int bounce,
                                       LightSample *ls)
 {
+  float tree_pdf = 1.0f;
+
   if (lamp < 0) {
     /* sample index */
-    int index = light_distribution_sample(kg, &randu);
+    int index;
+    if (use_light_tree) {
+      index = light_tree_sample(kg, P, N, &randu, &tree_pdf);
+      if (index < 0) {
+        return false;
+      }
+    }
+    else {
+      index = light_distribution_sample(kg, &randu);
+    }
 
     /* fetch light data */
     const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(
@@ -645,19 +700,28 @@ ccl_device_noinline bool light_sample(KernelGlobals *kg,
       int object = kdistribution->mesh_light.object_id;
       int shader_flag = kdistribution->mesh_light.shader_flag;
 
-      triangle_light_sample(kg, prim, object, randu, randv, time, ls, P);
+      triangle_light_sample(
+          kg, prim, object, randu, randv, time, ls, P, use_light_tree, tree_pdf);
       ls->shader |= shader_flag;
       return (ls->pdf > 0.0f);
     }
 
     lamp = -prim - 1;
   }
+  else if (use_light_tree) {
+    tree_pdf = light_tree_emitter_pdf(kg, P, N, light_tree_lamp_emitter(kg, lamp));
+  }
 
   if (UNLIKELY(light_select_reached_max_bounces(kg, lamp, bounce))) {
     return false;
   }
 
-  return lamp_light_sample(kg, lamp, randu, randv, P, ls);
+  if (!lamp_light_sample(kg, lamp, randu, randv, P, ls)) {
+    return false;
+  }
+
+  ls->pdf *= (use_light_tree) ? tree_pdf : kernel_data.integrator.pdf_lights;
+  return (ls->pdf > 0.0f);
 }
 
 ccl_device_inline int light_select_num_samples(KernelGlobals *kg, int index)
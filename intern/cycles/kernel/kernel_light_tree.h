@@ -0,0 +1,248 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+CCL_NAMESPACE_BEGIN
+
+/* Light Tree
+ *
+ * Emitters are picked by walking down a tree of their bounds, choosing a child proportional to
+ * its importance for the shading point. The importance is an estimate of the light received from
+ * the node, based on its energy, distance and orientation, as described in "Importance Sampling
+ * of Many Lights with Adaptive Tree Splitting" by Conty and Kulla.
+ *
+ * The probability of picking an emitter is found by walking up from its leaf to the root, with
+ * the same importance computations, which keeps the multiple importance sampling weights of
+ * lights hit by BSDF samples consistent with the light samples. */
+
+/* Normal used for the importance of lights at a surface shading point. Surfaces that transmit
+ * light receive it from both sides, no normal is used for them then. Neither is it when the
+ * closures have different normals, for example from separate normal maps, since light behind the
+ * shading normal can still reach them. */
+ccl_device_inline float3 light_tree_shading_normal(KernelGlobals *kg, const ShaderData *sd)
+{
+  if (!kernel_data.integrator.use_light_tree || (sd->type & PRIMITIVE_ALL_CURVE)) {
+    return make_float3(0.0f, 0.0f, 0.0f);
+  }
+
+  for (int i = 0; i < sd->num_closure; i++) {
+    const ShaderClosure *sc = &sd->closure[i];
+    if (!CLOSURE_IS_BSDF(sc->type)) {
+      continue;
+    }
+    if (CLOSURE_IS_BSDF_TRANSMISSION(sc->type) || sc->type == CLOSURE_BSDF_TRANSLUCENT_ID) {
+      return make_float3(0.0f, 0.0f, 0.0f);
+    }
+    if (dot(sc->N, sd->N) < 0.9999f) {
+      return make_float3(0.0f, 0.0f, 0.0f);
+    }
+  }
+
+  return sd->N;
+}
+
+/* Whether lights are picked with the light tree at the current vertex of the path, which is
+ * tagged in the path state for the multiple importance sampling of emitters hit by the next
+ * bounce. Sampling all lights uses the light distribution. */
+ccl_device_inline bool light_tree_path_state_update(KernelGlobals *kg,
+                                                    ccl_addr_space PathState *state,
+                                                    const bool sample_all_lights)
+{
+  if (kernel_data.integrator.use_light_tree && !sample_all_lights) {
+    state->flag |= PATH_RAY_LIGHT_TREE;
+    return true;
+  }
+  state->flag &= ~PATH_RAY_LIGHT_TREE;
+  return false;
+}
+
+ccl_device float light_tree_node_importance(KernelGlobals *kg,
+                                            const float3 P,
+                                            const float3 N,
+                                            const int node_index)
+{
+  const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes, node_index);
+
+  if (knode->is_distant) {
+    /* Distant lights are equally far away from every shading point. */
+    return knode->energy;
+  }
+  if (knode->energy == 0.0f) {
+    return 0.0f;
+  }
+
+  const float3 bbox_min = make_float3(
+      knode->bounding_box_min[0], knode->bounding_box_min[1], knode->bounding_box_min[2]);
+  const float3 bbox_max = make_float3(
+      knode->bounding_box_max[0], knode->bounding_box_max[1], knode->bounding_box_max[2]);
+  const float3 centroid = 0.5f * (bbox_min + bbox_max);
+  const float radius = 0.5f * len(bbox_max - bbox_min);
+
+  float distance;
+  const float3 point_to_centroid = safe_normalize_len(centroid - P, &distance);
+
+  /* Angle subtended by the bounding sphere of the node, all directions when inside of it. */
+  const float theta_u = (distance > radius) ? fast_asinf(radius / distance) : M_PI_F;
+
+  /* Angle between the emission and the direction towards the shading point, reduced by the
+   * spread of the normals and the extent of the node. */
+  const float3 axis = make_float3(knode->axis[0], knode->axis[1], knode->axis[2]);
+  const float theta = fast_acosf(dot(axis, -point_to_centroid));
+  const float theta_prime = fmaxf(theta - knode->theta_o - theta_u, 0.0f);
+  if (theta_prime >= knode->theta_e) {
+    return 0.0f;
+  }
+  const float cos_theta_prime = fast_cosf(theta_prime);
+
+  /* Same for the incoming light at the shading point, nodes behind the surface can't
+   * contribute. */
+  float cos_theta_i_prime = 1.0f;
+  if (!is_zero(N)) {
+    const float theta_i = fast_acosf(dot(N, point_to_centroid));
+    const float theta_i_prime = fmaxf(theta_i - theta_u, 0.0f);
+    if (theta_i_prime >= M_PI_2_F) {
+      return 0.0f;
+    }
+    cos_theta_i_prime = fast_cosf(theta_i_prime);
+  }
+
+  /* Clamp the distance to the size of the node, so nearby nodes don't get an unbounded
+   * importance. */
+  const float distance_squared = fmaxf(distance * distance, fmaxf(radius * radius, 1e-8f));
+
+  return knode->energy * cos_theta_prime * cos_theta_i_prime / distance_squared;
+}
+
+/* Pick an emitter from the light distribution, returns its index and the probability of picking
+ * it. randu is rescaled, so it can be reused for sampling a position on the emitter. */
+ccl_device int light_tree_sample(
+    KernelGlobals *kg, const float3 P, const float3 N, float *randu, float *pdf)
+{
+  int node_index = 0;
+  float r = *randu;
+  *pdf = 1.0f;
+
+  while (true) {
+    const ccl_global KernelLightTreeNode *knode = &kernel_tex_fetch(__light_tree_nodes,
+                                                                    node_index);
+    if (knode->emitter_index >= 0) {
+      *randu = r;
+      return knode->emitter_index;
+    }
+
+    const int left_index = node_index + 1;
+    const int right_index = knode->child_index;
+    const float left_importance = light_tree_node_importance(kg, P, N, left_index);
+    const float right_importance = light_tree_node_importance(kg, P, N, right_index);
+    const float total_importance = left_importance + right_importance;
+
+    if (!(total_importance > 0.0f)) {
+      *pdf = 0.0f;
+      return -1;
+    }
+
+    const float left_probability = left_importance / total_importance;
+    if (r < left_probability) {
+      node_index = left_index;
+      r = r / left_probability;
+      *pdf *= left_probability;
+    }
+    else {
+      node_index = right_index;
+      r = (r - left_probability) / (1.0f - left_probability);
+      *pdf *= 1.0f - left_probability;
+    }
+
+    /* Float rounding could push the random number out of the [0, 1) range. */
+    r = fminf(r, 0.99999994f);
+  }
+}
+
+/* Probability of picking the emitter with light_tree_sample. */
+ccl_device float light_tree_emitter_pdf(KernelGlobals *kg,
+                                        const float3 P,
+                                        const float3 N,
+                                        const int emitter_index)
+{
+  if (emitter_index < 0) {
+    return 0.0f;
+  }
+
+  int node_index = kernel_tex_fetch(__light_tree_emitter_nodes, emitter_index);
+  float pdf = 1.0f;
+
+  while (node_index != 0) {
+    const int parent_index = kernel_tex_fetch(__light_tree_nodes, node_index).parent_index;
+    const int left_index = parent_index + 1;
+    const int right_index = kernel_tex_fetch(__light_tree_nodes, parent_index).child_index;
+    const float left_importance = light_tree_node_importance(kg, P, N, left_index);
+    const float right_importance = light_tree_node_importance(kg, P, N, right_index);
+    const float total_importance = left_importance + right_importance;
+
+    if (!(total_importance > 0.0f)) {
+      return 0.0f;
+    }
+
+    const float left_probability = left_importance / total_importance;
+    pdf *= (node_index == left_index) ? left_probability : 1.0f - left_probability;
+    node_index = parent_index;
+  }
+
+  return pdf;
+}
+
+/* Index of a triangle in the light distribution, -1 when it is not part of it. Triangles are
+ * stored ordered by object and primitive, before the lamps. */
+ccl_device int light_tree_triangle_emitter(KernelGlobals *kg, const int object, const int prim)
+{
+  const int num_triangles = kernel_data.integrator.num_distribution -
+                            kernel_data.integrator.num_all_lights;
+  int first = 0;
+  int len = num_triangles;
+
+  while (len > 0) {
+    const int half_len = len >> 1;
+    const int middle = first + half_len;
+    const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(
+        __light_distribution, middle);
+    const int middle_object = kdistribution->mesh_light.object_id;
+
+    if (middle_object < object || (middle_object == object && kdistribution->prim < prim)) {
+      first = middle + 1;
+      len = len - half_len - 1;
+    }
+    else {
+      len = half_len;
+    }
+  }
+
+  if (first < num_triangles) {
+    const ccl_global KernelLightDistribution *kdistribution = &kernel_tex_fetch(
+        __light_distribution, first);
+    if (kdistribution->mesh_light.object_id == object && kdistribution->prim == prim) {
+      return first;
+    }
+  }
+
+  return -1;
+}
+
+/* Index of a lamp in the light distribution, lamps are stored after the triangles. */
+ccl_device_inline int light_tree_lamp_emitter(KernelGlobals *kg, const int lamp)
+{
+  return kernel_data.integrator.num_distribution - kernel_data.integrator.num_all_lights + lamp;
+}
+
+CCL_NAMESPACE_END
@@ -51,6 +51,8 @@ ccl_device_inline void path_state_init(KernelGlobals *kg,
 
   state->min_ray_pdf = FLT_MAX;
   state->ray_pdf = 0.0f;
+  state->ray_P = make_float3(0.0f, 0.0f, 0.0f);
+  state->ray_N = make_float3(0.0f, 0.0f, 0.0f);
 #ifdef __LAMP_MIS__
   state->ray_t = 0.0f;
 #endif
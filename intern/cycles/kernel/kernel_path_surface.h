@@ -34,6 +34,8 @@ ccl_device_noinline_cpu void kernel_branched_path_surface_connect_light(
   /* sample illumination from lights to find path contribution */
   BsdfEval L_light ccl_optional_struct_init;
 
+  const bool use_light_tree = light_tree_path_state_update(kg, state, sample_all_lights);
+
   int num_lights = 0;
   if (kernel_data.integrator.use_direct_light) {
     if (sample_all_lights) {
@@ -100,7 +102,17 @@ ccl_device_noinline_cpu void kernel_branched_path_surface_connect_light(
 
         LightSample ls ccl_optional_struct_init;
         const int lamp = is_lamp ? i : -1;
-        if (light_sample(kg, lamp, light_u, light_v, sd->time, sd->P, state->bounce, &ls)) {
+        const float3 N = light_tree_shading_normal(kg, sd);
+        if (light_sample(kg,
+                         lamp,
+                         light_u,
+                         light_v,
+                         sd->time,
+                         sd->P,
+                         N,
+                         use_light_tree,
+                         state->bounce,
+                         &ls)) {
           /* The sampling probability returned by lamp_light_sample assumes that all lights were
            * sampled. However, this code only samples lamps, so if the scene also had mesh lights,
            * the real probability is twice as high. */
@@ -201,6 +213,8 @@ ccl_device bool kernel_branched_path_surface_bounce(KernelGlobals *kg,
   /* set MIS state */
   state->min_ray_pdf = fminf(bsdf_pdf, FLT_MAX);
   state->ray_pdf = bsdf_pdf;
+  state->ray_P = sd->P;
+  state->ray_N = light_tree_shading_normal(kg, sd);
 #  ifdef __LAMP_MIS__
   state->ray_t = 0.0f;
 #  endif
@@ -236,12 +250,16 @@ ccl_device_inline void kernel_path_surface_connect_light(KernelGlobals *kg,
   light_ray.time = sd->time;
 #    endif
 
+  const bool use_light_tree = light_tree_path_state_update(kg, state, false);
+
   if (kernel_data.integrator.use_direct_light && (sd->flag & SD_BSDF_HAS_EVAL)) {
     float light_u, light_v;
     path_state_rng_2D(kg, state, PRNG_LIGHT_U, &light_u, &light_v);
 
     LightSample ls ccl_optional_struct_init;
-    if (light_sample(kg, -1, light_u, light_v, sd->time, sd->P, state->bounce, &ls)) {
+    const float3 N = light_tree_shading_normal(kg, sd);
+    if (light_sample(
+            kg, -1, light_u, light_v, sd->time, sd->P, N, use_light_tree, state->bounce, &ls)) {
       float terminate = path_state_rng_light_termination(kg, state);
       has_emission = direct_emission(
           kg, sd, emission_sd, &ls, state, &light_ray, &L_light, &is_lamp, terminate);
@@ -299,6 +317,8 @@ ccl_device bool kernel_path_surface_bounce(KernelGlobals *kg,
     /* set labels */
     if (!(label & LABEL_TRANSPARENT)) {
       state->ray_pdf = bsdf_pdf;
+      state->ray_P = sd->P;
+      state->ray_N = light_tree_shading_normal(kg, sd);
 #ifdef __LAMP_MIS__
       state->ray_t = 0.0f;
 #endif
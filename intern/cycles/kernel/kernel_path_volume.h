@@ -38,12 +38,16 @@ ccl_device_inline void kernel_path_volume_connect_light(KernelGlobals *kg,
   light_ray.time = sd->time;
 #    endif
 
+  const bool use_light_tree = light_tree_path_state_update(kg, state, false);
+
   if (kernel_data.integrator.use_direct_light) {
     float light_u, light_v;
     path_state_rng_2D(kg, state, PRNG_LIGHT_U, &light_u, &light_v);
 
     LightSample ls ccl_optional_struct_init;
-    if (light_sample(kg, -1, light_u, light_v, sd->time, sd->P, state->bounce, &ls)) {
+    const float3 N = make_float3(0.0f, 0.0f, 0.0f);
+    if (light_sample(
+            kg, -1, light_u, light_v, sd->time, sd->P, N, use_light_tree, state->bounce, &ls)) {
       float terminate = path_state_rng_light_termination(kg, state);
       has_emission = direct_emission(
           kg, sd, emission_sd, &ls, state, &light_ray, &L_light, &is_lamp, terminate);
@@ -89,6 +93,8 @@ ccl_device_noinline_cpu bool kernel_path_volume_bounce(KernelGlobals *kg,
 
   /* set labels */
   state->ray_pdf = phase_pdf;
+  state->ray_P = sd->P;
+  state->ray_N = make_float3(0.0f, 0.0f, 0.0f);
 #  ifdef __LAMP_MIS__
   state->ray_t = 0.0f;
 #  endif
@@ -141,6 +147,8 @@ ccl_device void kernel_branched_path_volume_connect_light(KernelGlobals *kg,
 #    ifdef __EMISSION__
   BsdfEval L_light ccl_optional_struct_init;
 
+  const bool use_light_tree = light_tree_path_state_update(kg, state, sample_all_lights);
+
   int num_lights = 1;
   if (sample_all_lights) {
     num_lights = kernel_data.integrator.num_all_lights;
@@ -203,7 +211,9 @@ ccl_device void kernel_branched_path_volume_connect_light(KernelGlobals *kg,
 
         LightSample ls ccl_optional_struct_init;
         const int lamp = is_lamp ? i : -1;
-        light_sample(kg, lamp, light_u, light_v, sd->time, ray->P, state->bounce, &ls);
+        const float3 N = make_float3(0.0f, 0.0f, 0.0f);
+        light_sample(
+            kg, lamp, light_u, light_v, sd->time, ray->P, N, use_light_tree, state->bounce, &ls);
 
         /* sample position on volume segment */
         float rphase = path_branched_rng_1D(
@@ -225,7 +235,16 @@ ccl_device void kernel_branched_path_volume_connect_light(KernelGlobals *kg,
 
         if (result == VOLUME_PATH_SCATTERED) {
           /* todo: split up light_sample so we don't have to call it again with new position */
-          if (light_sample(kg, lamp, light_u, light_v, sd->time, sd->P, state->bounce, &ls)) {
+          if (light_sample(kg,
+                           lamp,
+                           light_u,
+                           light_v,
+                           sd->time,
+                           sd->P,
+                           N,
+                           use_light_tree,
+                           state->bounce,
+                           &ls)) {
             if (double_pdf) {
               ls.pdf *= 2.0f;
             }
@@ -128,6 +128,9 @@ CCL_NAMESPACE_BEGIN
 #  endif
 #  define __VOLUME_DECOUPLED__
 #  define __VOLUME_RECORD_ALL__
+#  ifdef __KERNEL_AVX2__
+#    define __BVH8__
+#  endif
 #endif /* __KERNEL_CPU__ */
 
 #ifdef __KERNEL_CUDA__
@@ -324,7 +327,10 @@ enum PathRayFlag {
   /* Ray is to be terminated. */
   PATH_RAY_TERMINATE = (PATH_RAY_TERMINATE_IMMEDIATE | PATH_RAY_TERMINATE_AFTER_TRANSPARENT),
   /* Path and shader is being evaluated for direct lighting emission. */
-  PATH_RAY_EMISSION = (1 << 22)
+  PATH_RAY_EMISSION = (1 << 22),
+  /* Lights were picked with the light tree at the last bounce, rather than all being sampled.
+   * Their probabilities are then used for multiple importance sampling of emitters hit next. */
+  PATH_RAY_LIGHT_TREE = (1 << 23)
 };
 
 /* Closure Label */
@@ -1064,6 +1070,8 @@ typedef struct PathState {
   /* multiple importance sampling */
   float min_ray_pdf; /* smallest bounce pdf over entire path up to now */
   float ray_pdf;     /* last bounce pdf */
+  float3 ray_P;      /* last bounce position, for the light tree */
+  float3 ray_N;      /* last bounce normal for the light tree, zero when not used */
 #ifdef __LAMP_MIS__
   float ray_t; /* accumulated distance through transparent surfaces */
 #endif
@@ -1389,7 +1397,9 @@ typedef struct KernelIntegrator {
 
   int max_closures;
 
-  int pad1, pad2;
+  /* light tree */
+  int use_light_tree;
+  int background_light_index;
 } KernelIntegrator;
 static_assert_align(KernelIntegrator, 16);
 
@@ -1397,8 +1407,9 @@ typedef enum KernelBVHLayout {
   BVH_LAYOUT_NONE = 0,
 
   BVH_LAYOUT_BVH2 = (1 << 0),
-  BVH_LAYOUT_EMBREE = (1 << 1),
-  BVH_LAYOUT_OPTIX = (1 << 2),
+  BVH_LAYOUT_BVH8 = (1 << 1),
+  BVH_LAYOUT_EMBREE = (1 << 2),
+  BVH_LAYOUT_OPTIX = (1 << 3),
 
   /* Default BVH layout to use for CPU. */
   BVH_LAYOUT_AUTO = BVH_LAYOUT_EMBREE,
@@ -1548,6 +1559,27 @@ typedef struct KernelLightDistribution {
 } KernelLightDistribution;
 static_assert_align(KernelLightDistribution, 16);
 
+typedef struct KernelLightTreeNode {
+  /* Bounding box of the emitters, unused for distant nodes. */
+  float bounding_box_min[3];
+  float energy;
+  float bounding_box_max[3];
+  /* Bounding cone of the emission, normals are within theta_o of the axis and emit light up to
+   * theta_e away from the normal. */
+  float theta_o;
+  float axis[3];
+  float theta_e;
+
+  /* Interior nodes: index of the second child, the first child directly follows the node. */
+  int child_index;
+  /* Leaf nodes: index of the emitter in the light distribution, -1 for interior nodes. */
+  int emitter_index;
+  int parent_index;
+  /* Distant lights and the background, their importance doesn't depend on the position. */
+  int is_distant;
+} KernelLightTreeNode;
+static_assert_align(KernelLightTreeNode, 16);
+
 typedef struct KernelParticle {
   int index;
   float age;
@@ -467,13 +467,127 @@ template<typename T> struct TextureInterpolator {
         return interp_3d_tricubic(info, x, y, z);
     }
   }
-#undef SET_CUBIC_SPLINE_WEIGHTS
 };
 
+/* Sparse grids only store the tiles with active voxels, so voxels are read one by one through
+ * the tile offsets instead of from a dense array. */
+template<int channels> struct SparseGridInterpolator {
+  static ccl_always_inline float4 read(const TextureInfo &info, int x, int y, int z)
+  {
+    if (info.extension == EXTENSION_REPEAT) {
+      x = TextureInterpolator<float>::wrap_periodic(x, info.width);
+      y = TextureInterpolator<float>::wrap_periodic(y, info.height);
+      z = TextureInterpolator<float>::wrap_periodic(z, info.depth);
+    }
+    else {
+      x = TextureInterpolator<float>::wrap_clamp(x, info.width);
+      y = TextureInterpolator<float>::wrap_clamp(y, info.height);
+      z = TextureInterpolator<float>::wrap_clamp(z, info.depth);
+    }
+
+    const uint offset = sparse_grid_voxel_offset(
+        (const uint *)info.data, info.width, info.height, info.depth, channels, x, y, z);
+    const float *data = (const float *)info.data + offset;
+    if (channels == 1) {
+      return make_float4(data[0], data[0], data[0], 1.0f);
+    }
+    return make_float4(data[0], data[1], data[2], 1.0f);
+  }
+
+  static ccl_always_inline float4
+  interp_3d(const TextureInfo &info, float x, float y, float z, InterpolationType interp)
+  {
+    if (UNLIKELY(!info.data))
+      return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+
+    if (info.extension == EXTENSION_CLIP) {
+      if (x < 0.0f || y < 0.0f || z < 0.0f || x > 1.0f || y > 1.0f || z > 1.0f) {
+        return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+      }
+    }
+
+    int ix, iy, iz;
+
+    switch ((interp == INTERPOLATION_NONE) ? info.interpolation : interp) {
+      case INTERPOLATION_CLOSEST: {
+        TextureInterpolator<float>::frac(x * (float)info.width, &ix);
+        TextureInterpolator<float>::frac(y * (float)info.height, &iy);
+        TextureInterpolator<float>::frac(z * (float)info.depth, &iz);
+        return read(info, ix, iy, iz);
+      }
+      case INTERPOLATION_LINEAR: {
+        const float tx = TextureInterpolator<float>::frac(x * (float)info.width - 0.5f, &ix);
+        const float ty = TextureInterpolator<float>::frac(y * (float)info.height - 0.5f, &iy);
+        const float tz = TextureInterpolator<float>::frac(z * (float)info.depth - 0.5f, &iz);
+
+        float4 r;
+        r = (1.0f - tz) * (1.0f - ty) * (1.0f - tx) * read(info, ix, iy, iz);
+        r += (1.0f - tz) * (1.0f - ty) * tx * read(info, ix + 1, iy, iz);
+        r += (1.0f - tz) * ty * (1.0f - tx) * read(info, ix, iy + 1, iz);
+        r += (1.0f - tz) * ty * tx * read(info, ix + 1, iy + 1, iz);
+
+        r += tz * (1.0f - ty) * (1.0f - tx) * read(info, ix, iy, iz + 1);
+        r += tz * (1.0f - ty) * tx * read(info, ix + 1, iy, iz + 1);
+        r += tz * ty * (1.0f - tx) * read(info, ix, iy + 1, iz + 1);
+        r += tz * ty * tx * read(info, ix + 1, iy + 1, iz + 1);
+        return r;
+      }
+      default: {
+        const float tx = TextureInterpolator<float>::frac(x * (float)info.width - 0.5f, &ix);
+        const float ty = TextureInterpolator<float>::frac(y * (float)info.height - 0.5f, &iy);
+        const float tz = TextureInterpolator<float>::frac(z * (float)info.depth - 0.5f, &iz);
+
+        float u[4], v[4], w[4];
+        SET_CUBIC_SPLINE_WEIGHTS(u, tx);
+        SET_CUBIC_SPLINE_WEIGHTS(v, ty);
+        SET_CUBIC_SPLINE_WEIGHTS(w, tz);
+
+        float4 r = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+        for (int k = 0; k < 4; k++) {
+          for (int j = 0; j < 4; j++) {
+            for (int i = 0; i < 4; i++) {
+              r += u[i] * v[j] * w[k] * read(info, ix + i - 1, iy + j - 1, iz + k - 1);
+            }
+          }
+        }
+        return r;
+      }
+    }
+  }
+};
+
+#undef SET_CUBIC_SPLINE_WEIGHTS
+
+ccl_device float4 kernel_tex_image_interp_texture_cache(
+    const TextureInfo &info, float x, float y, float2 dx, float2 dy)
+{
+  float4 r;
+  if (!texture_cache_lookup(info.data,
+                            info.interpolation,
+                            info.extension,
+                            x,
+                            y,
+                            dx.x,
+                            dx.y,
+                            dy.x,
+                            dy.y,
+                            (float *)&r)) {
+    return make_float4(
+        TEX_IMAGE_MISSING_R, TEX_IMAGE_MISSING_G, TEX_IMAGE_MISSING_B, TEX_IMAGE_MISSING_A);
+  }
+  return r;
+}
+
 ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, float y)
 {
   const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
 
+  if (info.use_texture_cache) {
+    /* Without differentials, the full resolution level is used. */
+    const float2 zero = make_float2(0.0f, 0.0f);
+    return kernel_tex_image_interp_texture_cache(info, x, y, zero, zero);
+  }
+
   switch (info.data_type) {
     case IMAGE_DATA_TYPE_HALF:
       return TextureInterpolator<half>::interp(info, x, y);
@@ -498,6 +612,20 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
   }
 }
 
+/* Lookup with the differentials of the coordinates, for choosing the mip level of images in the
+ * texture cache. Images loaded in memory have no mip levels and ignore them. */
+ccl_device float4 kernel_tex_image_interp_differential(
+    KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy)
+{
+  const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
+
+  if (info.use_texture_cache) {
+    return kernel_tex_image_interp_texture_cache(info, x, y, dx, dy);
+  }
+
+  return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg,
                                              int id,
                                              float3 P,
@@ -526,6 +654,10 @@ ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg,
       return TextureInterpolator<ushort4>::interp_3d(info, P.x, P.y, P.z, interp);
     case IMAGE_DATA_TYPE_FLOAT4:
       return TextureInterpolator<float4>::interp_3d(info, P.x, P.y, P.z, interp);
+    case IMAGE_DATA_TYPE_SPARSE_FLOAT:
+      return SparseGridInterpolator<1>::interp_3d(info, P.x, P.y, P.z, interp);
+    case IMAGE_DATA_TYPE_SPARSE_FLOAT3:
+      return SparseGridInterpolator<3>::interp_3d(info, P.x, P.y, P.z, interp);
     default:
       assert(0);
       return make_float4(
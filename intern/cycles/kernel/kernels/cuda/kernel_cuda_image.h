@@ -118,6 +118,97 @@ ccl_device T kernel_tex_image_interp_bicubic_3d(
                 g1y * (g0x * tex3D<T>(tex, x0, y1, z1) + g1x * tex3D<T>(tex, x1, y1, z1)));
 }
 
+/* Sparse grids are stored in linear memory without a texture object, voxels are read through
+ * the tile offsets and interpolated manually. */
+ccl_device_inline int kernel_tex_image_wrap_sparse(const TextureInfo &info, int x, int size)
+{
+  if (info.extension == EXTENSION_REPEAT) {
+    x %= size;
+    return (x < 0) ? x + size : x;
+  }
+  return clamp(x, 0, size - 1);
+}
+
+template<int channels>
+ccl_device float4 kernel_tex_image_read_sparse(const TextureInfo &info, int x, int y, int z)
+{
+  x = kernel_tex_image_wrap_sparse(info, x, info.width);
+  y = kernel_tex_image_wrap_sparse(info, y, info.height);
+  z = kernel_tex_image_wrap_sparse(info, z, info.depth);
+
+  const uint offset = sparse_grid_voxel_offset(
+      (const uint *)info.data, info.width, info.height, info.depth, channels, x, y, z);
+  const float *data = (const float *)info.data + offset;
+  if (channels == 1) {
+    return make_float4(data[0], data[0], data[0], 1.0f);
+  }
+  return make_float4(data[0], data[1], data[2], 1.0f);
+}
+
+template<int channels>
+ccl_device float4
+kernel_tex_image_interp_sparse_3d(const TextureInfo &info, float x, float y, float z, uint interp)
+{
+  if (info.extension == EXTENSION_CLIP) {
+    if (x < 0.0f || y < 0.0f || z < 0.0f || x > 1.0f || y > 1.0f || z > 1.0f) {
+      return make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+    }
+  }
+
+  if (interp == INTERPOLATION_CLOSEST) {
+    const int ix = (int)floorf(x * info.width);
+    const int iy = (int)floorf(y * info.height);
+    const int iz = (int)floorf(z * info.depth);
+    return kernel_tex_image_read_sparse<channels>(info, ix, iy, iz);
+  }
+
+  x = (x * info.width) - 0.5f;
+  y = (y * info.height) - 0.5f;
+  z = (z * info.depth) - 0.5f;
+
+  const float px = floorf(x);
+  const float py = floorf(y);
+  const float pz = floorf(z);
+  const float tx = x - px;
+  const float ty = y - py;
+  const float tz = z - pz;
+  const int ix = (int)px;
+  const int iy = (int)py;
+  const int iz = (int)pz;
+
+  if (interp == INTERPOLATION_CUBIC) {
+    const float u[4] = {cubic_w0(tx), cubic_w1(tx), cubic_w2(tx), cubic_w3(tx)};
+    const float v[4] = {cubic_w0(ty), cubic_w1(ty), cubic_w2(ty), cubic_w3(ty)};
+    const float w[4] = {cubic_w0(tz), cubic_w1(tz), cubic_w2(tz), cubic_w3(tz)};
+
+    float4 r = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+    for (int k = 0; k < 4; k++) {
+      for (int j = 0; j < 4; j++) {
+        for (int i = 0; i < 4; i++) {
+          r += u[i] * v[j] * w[k] *
+               kernel_tex_image_read_sparse<channels>(info, ix + i - 1, iy + j - 1, iz + k - 1);
+        }
+      }
+    }
+    return r;
+  }
+
+  const float u[2] = {1.0f - tx, tx};
+  const float v[2] = {1.0f - ty, ty};
+  const float w[2] = {1.0f - tz, tz};
+
+  float4 r = make_float4(0.0f, 0.0f, 0.0f, 0.0f);
+  for (int k = 0; k < 2; k++) {
+    for (int j = 0; j < 2; j++) {
+      for (int i = 0; i < 2; i++) {
+        r += u[i] * v[j] * w[k] *
+             kernel_tex_image_read_sparse<channels>(info, ix + i, iy + j, iz + k);
+      }
+    }
+  }
+  return r;
+}
+
 ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, float y)
 {
   const TextureInfo &info = kernel_tex_fetch(__texture_info, id);
@@ -149,6 +240,13 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
   }
 }
 
+/* Images have no mip levels on the GPU, the differentials are ignored. */
+ccl_device float4 kernel_tex_image_interp_differential(
+    KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy)
+{
+  return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg,
                                              int id,
                                              float3 P,
@@ -168,7 +266,13 @@ ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg,
   uint interpolation = (interp == INTERPOLATION_NONE) ? info.interpolation : interp;
 
   const int texture_type = info.data_type;
-  if (texture_type == IMAGE_DATA_TYPE_FLOAT4 || texture_type == IMAGE_DATA_TYPE_BYTE4 ||
+  if (texture_type == IMAGE_DATA_TYPE_SPARSE_FLOAT) {
+    return kernel_tex_image_interp_sparse_3d<1>(info, x, y, z, interpolation);
+  }
+  else if (texture_type == IMAGE_DATA_TYPE_SPARSE_FLOAT3) {
+    return kernel_tex_image_interp_sparse_3d<3>(info, x, y, z, interpolation);
+  }
+  else if (texture_type == IMAGE_DATA_TYPE_FLOAT4 || texture_type == IMAGE_DATA_TYPE_BYTE4 ||
       texture_type == IMAGE_DATA_TYPE_HALF4 || texture_type == IMAGE_DATA_TYPE_USHORT4) {
     if (interpolation == INTERPOLATION_CUBIC) {
       return kernel_tex_image_interp_bicubic_3d<float4>(info, tex, x, y, z);
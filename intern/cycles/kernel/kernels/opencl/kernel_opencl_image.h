@@ -95,6 +95,25 @@ ccl_device_inline float4 svm_image_texture_read(KernelGlobals *kg,
   }
 }
 
+ccl_device_inline float4 svm_image_texture_read_sparse(
+    KernelGlobals *kg, const ccl_global TextureInfo *info, int x, int y, int z)
+{
+  const int channels = (info->data_type == IMAGE_DATA_TYPE_SPARSE_FLOAT3) ? 3 : 1;
+  const uint offset = sparse_grid_voxel_offset(
+      &tex_fetch(uint, info, 0), info->width, info->height, info->depth, channels, x, y, z);
+
+  if (channels == 1) {
+    float f = tex_fetch(float, info, offset);
+    return make_float4(f, f, f, 1.0f);
+  }
+  else {
+    return make_float4(tex_fetch(float, info, offset),
+                       tex_fetch(float, info, offset + 1),
+                       tex_fetch(float, info, offset + 2),
+                       1.0f);
+  }
+}
+
 ccl_device_inline float4 svm_image_texture_read_2d(KernelGlobals *kg, int id, int x, int y)
 {
   const ccl_global TextureInfo *info = kernel_tex_info(kg, id);
@@ -129,6 +148,10 @@ ccl_device_inline float4 svm_image_texture_read_3d(KernelGlobals *kg, int id, in
     z = svm_image_texture_wrap_clamp(z, info->depth);
   }
 
+  if (IMAGE_DATA_TYPE_IS_SPARSE(info->data_type)) {
+    return svm_image_texture_read_sparse(kg, info, x, y, z);
+  }
+
   int offset = x + info->width * y + info->width * info->height * z;
   return svm_image_texture_read(kg, info, id, offset);
 }
@@ -202,6 +225,13 @@ ccl_device float4 kernel_tex_image_interp(KernelGlobals *kg, int id, float x, fl
   }
 }
 
+/* Images have no mip levels on the GPU, the differentials are ignored. */
+ccl_device float4 kernel_tex_image_interp_differential(
+    KernelGlobals *kg, int id, float x, float y, float2 dx, float2 dy)
+{
+  return kernel_tex_image_interp(kg, id, x, y);
+}
+
 ccl_device float4 kernel_tex_image_interp_3d(KernelGlobals *kg, int id, float3 P, int interp)
 {
   const ccl_global TextureInfo *info = kernel_tex_info(kg, id);
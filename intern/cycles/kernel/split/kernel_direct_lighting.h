@@ -86,7 +86,10 @@ ccl_device void kernel_direct_lighting(KernelGlobals *kg,
       float terminate = path_state_rng_light_termination(kg, state);
 
       LightSample ls;
-      if (light_sample(kg, -1, light_u, light_v, sd->time, sd->P, state->bounce, &ls)) {
+      const bool use_light_tree = light_tree_path_state_update(kg, state, false);
+      const float3 N = light_tree_shading_normal(kg, sd);
+      if (light_sample(
+              kg, -1, light_u, light_v, sd->time, sd->P, N, use_light_tree, state->bounce, &ls)) {
         Ray light_ray;
         light_ray.time = sd->time;
 
@@ -142,6 +142,17 @@ int Geometry::motion_step(float time) const
   return -1;
 }
 
+/* BVH layout to build for the device. OSL traces rays from its shading system, which is not
+ * compiled with AVX2 and so can't traverse BVH8. */
+static BVHLayout geometry_bvh_layout(const Device *device, const SceneParams &params)
+{
+  BVHLayoutMask layout_mask = device->get_bvh_layout_mask();
+  if (params.shadingsystem == SHADINGSYSTEM_OSL) {
+    layout_mask &= ~BVH_LAYOUT_BVH8;
+  }
+  return BVHParams::best_bvh_layout(params.bvh_layout, layout_mask);
+}
+
 bool Geometry::need_build_bvh(BVHLayout layout) const
 {
   return !transform_applied || has_surface_bssrdf || layout == BVH_LAYOUT_OPTIX;
@@ -176,8 +187,7 @@ void Geometry::compute_bvh(
 
   compute_bounds();
 
-  const BVHLayout bvh_layout = BVHParams::best_bvh_layout(params->bvh_layout,
-                                                          device->get_bvh_layout_mask());
+  const BVHLayout bvh_layout = geometry_bvh_layout(device, *params);
   if (need_build_bvh(bvh_layout)) {
     string msg = "Updating Geometry BVH ";
     if (name.empty())
@@ -1018,8 +1028,7 @@ void GeometryManager::device_update_bvh(Device *device,
 
   BVHParams bparams;
   bparams.top_level = true;
-  bparams.bvh_layout = BVHParams::best_bvh_layout(scene->params.bvh_layout,
-                                                  device->get_bvh_layout_mask());
+  bparams.bvh_layout = geometry_bvh_layout(device, scene->params);
   bparams.use_spatial_split = scene->params.use_bvh_spatial_split;
   bparams.use_unaligned_nodes = dscene->data.bvh.have_curves &&
                                 scene->params.use_bvh_unaligned_nodes;
@@ -1325,8 +1334,7 @@ void GeometryManager::device_update(Device *device,
   /* Update displacement. */
   bool displacement_done = false;
   size_t num_bvh = 0;
-  BVHLayout bvh_layout = BVHParams::best_bvh_layout(scene->params.bvh_layout,
-                                                    device->get_bvh_layout_mask());
+  BVHLayout bvh_layout = geometry_bvh_layout(device, scene->params);
 
   foreach (Geometry *geom, scene->geometry) {
     if (geom->need_update) {
@@ -30,6 +30,7 @@
 #include "util/util_progress.h"
 #include "util/util_task.h"
 #include "util/util_texture.h"
+#include "util/util_texture_cache.h"
 #include "util/util_unique_ptr.h"
 
 #ifdef WITH_OSL
@@ -73,6 +74,10 @@ const char *name_from_type(ImageDataType type)
       return "ushort4";
     case IMAGE_DATA_TYPE_USHORT:
       return "ushort";
+    case IMAGE_DATA_TYPE_SPARSE_FLOAT:
+      return "sparse_float";
+    case IMAGE_DATA_TYPE_SPARSE_FLOAT3:
+      return "sparse_float3";
     case IMAGE_DATA_NUM_TYPES:
       assert(!"System enumerator type, should never be used");
       return "";
@@ -211,6 +216,7 @@ ImageMetaData::ImageMetaData()
       height(0),
       depth(0),
       type(IMAGE_DATA_NUM_TYPES),
+      byte_size(0),
       colorspace(u_colorspace_raw),
       colorspace_file_format(""),
       use_transform_3d(false),
@@ -223,13 +229,15 @@ bool ImageMetaData::operator==(const ImageMetaData &other) const
   return channels == other.channels && width == other.width && height == other.height &&
          depth == other.depth && use_transform_3d == other.use_transform_3d &&
          (!use_transform_3d || transform_3d == other.transform_3d) && type == other.type &&
-         colorspace == other.colorspace && compress_as_srgb == other.compress_as_srgb;
+         byte_size == other.byte_size && colorspace == other.colorspace &&
+         compress_as_srgb == other.compress_as_srgb;
 }
 
 bool ImageMetaData::is_float() const
 {
   return (type == IMAGE_DATA_TYPE_FLOAT || type == IMAGE_DATA_TYPE_FLOAT4 ||
-          type == IMAGE_DATA_TYPE_HALF || type == IMAGE_DATA_TYPE_HALF4);
+          type == IMAGE_DATA_TYPE_HALF || type == IMAGE_DATA_TYPE_HALF4 ||
+          IMAGE_DATA_TYPE_IS_SPARSE(type));
 }
 
 void ImageMetaData::detect_colorspace()
@@ -295,16 +303,22 @@ ImageManager::ImageManager(const DeviceInfo &info)
 {
   need_update = true;
   osl_texture_system = NULL;
+  texture_cache = NULL;
   animation_frame = 0;
 
   /* Set image limits */
   has_half_images = info.has_half_images;
+
+  /* Texture cache lookups happen in the kernel, so the device must run on the host. */
+  supports_texture_cache = (info.type == DEVICE_CPU);
 }
 
 ImageManager::~ImageManager()
 {
   for (size_t slot = 0; slot < images.size(); slot++)
     assert(!images[slot]);
+
+  delete texture_cache;
 }
 
 void ImageManager::set_osl_texture_system(void *texture_system)
@@ -312,6 +326,23 @@ void ImageManager::set_osl_texture_system(void *texture_system)
   osl_texture_system = texture_system;
 }
 
+void ImageManager::set_texture_cache_size(const int size_mb)
+{
+  delete texture_cache;
+  texture_cache = NULL;
+
+  if (supports_texture_cache && size_mb > 0) {
+    texture_cache = new TextureCache(size_mb);
+  }
+
+  need_update = true;
+}
+
+bool ImageManager::use_texture_cache() const
+{
+  return texture_cache != NULL;
+}
+
 bool ImageManager::set_animation_frame_update(int frame)
 {
   if (frame != animation_frame) {
@@ -485,6 +516,22 @@ static bool image_associate_alpha(ImageManager::Image *img)
            img->params.alpha_type == IMAGE_ALPHA_CHANNEL_PACKED);
 }
 
+bool ImageManager::image_use_texture_cache(Image *img)
+{
+  /* The texture cache reads image files directly, so only images it reads the same as they are
+   * loaded into memory can use it: tiled and mipmapped 2D image files that need no color space
+   * conversion, and with alpha associated like OpenImageIO does by default. */
+  if (texture_cache == NULL || img->loader->osl_filepath().empty()) {
+    return false;
+  }
+
+  return img->metadata.depth <= 1 && !IMAGE_DATA_TYPE_IS_SPARSE(img->metadata.type) &&
+         (img->metadata.colorspace == u_colorspace_raw ||
+          img->metadata.colorspace == u_colorspace_srgb) &&
+         image_associate_alpha(img) &&
+         TextureCache::image_file_supported(img->loader->osl_filepath().string());
+}
+
 template<TypeDesc::BASETYPE FileFormat, typename StorageType>
 bool ImageManager::file_load_image(Image *img, int texture_limit)
 {
@@ -499,6 +546,25 @@ bool ImageManager::file_load_image(Image *img, int texture_limit)
   int depth = img->metadata.depth;
   int components = img->metadata.channels;
 
+  if (img->metadata.byte_size) {
+    /* Sparse grids are loaded as is, their memory usage is already proportional to the active
+     * voxels so they are not scaled down to the texture limit. */
+    const size_t num_values = img->metadata.byte_size / sizeof(StorageType);
+    StorageType *values;
+    {
+      thread_scoped_lock device_lock(device_mutex);
+      values = (StorageType *)img->mem->alloc(num_values, 0);
+      if (values == NULL) {
+        return false;
+      }
+      img->mem->info.width = width;
+      img->mem->info.height = height;
+      img->mem->info.depth = depth;
+    }
+
+    return img->loader->load_pixels(img->metadata, values, num_values, false);
+  }
+
   /* Read pixels. */
   vector<StorageType> pixels_storage;
   StorageType *pixels;
@@ -671,8 +737,19 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
   img->mem->info.use_transform_3d = img->metadata.use_transform_3d;
   img->mem->info.transform_3d = img->metadata.transform_3d;
 
+  if (image_use_texture_cache(img)) {
+    /* Pixels are read by the kernel through the texture cache, only a placeholder pixel is
+     * allocated for the device memory. */
+    thread_scoped_lock device_lock(device_mutex);
+    void *pixels = img->mem->alloc(1, 1);
+    memset(pixels, 0, img->mem->memory_size());
+    img->mem->info.width = img->metadata.width;
+    img->mem->info.height = img->metadata.height;
+    img->mem->info.use_texture_cache = 1;
+    img->mem->info.data = texture_cache->image_handle(img->loader->osl_filepath().string());
+  }
   /* Create new texture. */
-  if (type == IMAGE_DATA_TYPE_FLOAT4) {
+  else if (type == IMAGE_DATA_TYPE_FLOAT4) {
     if (!file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
       /* on failure to load, we set a 1x1 pixels pink image */
       thread_scoped_lock device_lock(device_mutex);
@@ -756,6 +833,25 @@ void ImageManager::device_load_image(Device *device, Scene *scene, int slot, Pro
       pixels[0] = TEX_IMAGE_MISSING_R;
     }
   }
+  else if (IMAGE_DATA_TYPE_IS_SPARSE(type)) {
+    if (!file_load_image<TypeDesc::FLOAT, float>(img, texture_limit)) {
+      /* on failure to load, we set a single voxel pink grid */
+      thread_scoped_lock device_lock(device_mutex);
+      const int channels = (type == IMAGE_DATA_TYPE_SPARSE_FLOAT3) ? 3 : 1;
+      float *values = (float *)img->mem->alloc(1 + channels, 0);
+      img->mem->info.width = 1;
+      img->mem->info.height = 1;
+      img->mem->info.depth = 1;
+
+      /* The only tile is not stored, so all voxels read the background value after it. */
+      ((uint *)values)[0] = 0;
+      values[1] = TEX_IMAGE_MISSING_R;
+      if (channels == 3) {
+        values[2] = TEX_IMAGE_MISSING_G;
+        values[3] = TEX_IMAGE_MISSING_B;
+      }
+    }
+  }
 
   {
     thread_scoped_lock device_lock(device_mutex);
@@ -783,6 +879,10 @@ void ImageManager::device_free_image(Device *, int slot)
 #endif
   }
 
+  if (img->mem && img->mem->info.use_texture_cache) {
+    texture_cache->invalidate(img->loader->osl_filepath().string());
+  }
+
   if (img->mem) {
     thread_scoped_lock device_lock(device_mutex);
     delete img->mem;
@@ -39,6 +39,7 @@ class Progress;
 class RenderStats;
 class Scene;
 class ColorSpaceProcessor;
+class TextureCache;
 class VDBImageLoader;
 
 /* Image Parameters */
@@ -79,6 +80,9 @@ class ImageMetaData {
   size_t width, height, depth;
   ImageDataType type;
 
+  /* Size of sparse grids in bytes, zero for dense images. */
+  size_t byte_size;
+
   /* Optional color space, defaults to raw. */
   ustring colorspace;
   const char *colorspace_file_format;
@@ -186,6 +190,11 @@ class ImageManager {
   void set_osl_texture_system(void *texture_system);
   bool set_animation_frame_update(int frame);
 
+  /* Look up image files through a texture cache of the given size in megabytes, instead of
+   * loading them fully into memory. Only supported by the CPU device, zero disables it. */
+  void set_texture_cache_size(const int size_mb);
+  bool use_texture_cache() const;
+
   void collect_statistics(RenderStats *stats);
 
   bool need_update;
@@ -209,6 +218,7 @@ class ImageManager {
 
  private:
   bool has_half_images;
+  bool supports_texture_cache;
 
   thread_mutex device_mutex;
   thread_mutex images_mutex;
@@ -216,12 +226,14 @@ class ImageManager {
 
   vector<Image *> images;
   void *osl_texture_system;
+  TextureCache *texture_cache;
 
   int add_image_slot(ImageLoader *loader, const ImageParams &params, const bool builtin);
   void add_image_user(int slot);
   void remove_image_user(int slot);
 
   void load_image_metadata(Image *img);
+  bool image_use_texture_cache(Image *img);
 
   template<TypeDesc::BASETYPE FileFormat, typename StorageType>
   bool file_load_image(Image *img, int texture_limit);
@@ -16,6 +16,10 @@
 
 #include "render/image_vdb.h"
 
+#include "util/util_logging.h"
+#include "util/util_tbb.h"
+#include "util/util_texture.h"
+
 #ifdef WITH_OPENVDB
 #  include <openvdb/openvdb.h>
 #  include <openvdb/tools/Dense.h>
@@ -23,6 +27,189 @@
 
 CCL_NAMESPACE_BEGIN
 
+#ifdef WITH_OPENVDB
+/* Sparse grids use more memory than dense ones per stored voxel for the tile offsets and for
+ * voxels of the tiles outside of the active bounding box, and are slower to look up. So they are
+ * only used when storing less than this fraction of the dense grid. */
+static const float sparse_grid_max_relative_size = 0.75f;
+
+/* Grow the box to whole tiles, aligned to multiples of the tile size in index space like OpenVDB
+ * leaf nodes, so every leaf node is stored in a single tile. */
+static openvdb::CoordBBox sparse_grid_tiles_bbox(const openvdb::CoordBBox &bbox)
+{
+  const openvdb::Coord min(bbox.min().x() & ~SPARSE_GRID_TILE_MASK,
+                           bbox.min().y() & ~SPARSE_GRID_TILE_MASK,
+                           bbox.min().z() & ~SPARSE_GRID_TILE_MASK);
+  const openvdb::Coord max(bbox.max().x() | SPARSE_GRID_TILE_MASK,
+                           bbox.max().y() | SPARSE_GRID_TILE_MASK,
+                           bbox.max().z() | SPARSE_GRID_TILE_MASK);
+  return openvdb::CoordBBox(min, max);
+}
+
+/* Mark the tiles of the sparse grid overlapping a box of voxels. */
+static void sparse_grid_mark_box(vector<uint> &tile_offsets,
+                                 const openvdb::CoordBBox &bbox,
+                                 openvdb::CoordBBox box)
+{
+  box.intersect(bbox);
+  if (box.empty()) {
+    return;
+  }
+
+  const openvdb::Coord dim = bbox.dim();
+  const int num_tiles_x = sparse_grid_num_tiles(dim.x());
+  const int num_tiles_y = sparse_grid_num_tiles(dim.y());
+  const int min_x = (box.min().x() - bbox.min().x()) >> SPARSE_GRID_TILE_SIZE_SHIFT;
+  const int min_y = (box.min().y() - bbox.min().y()) >> SPARSE_GRID_TILE_SIZE_SHIFT;
+  const int min_z = (box.min().z() - bbox.min().z()) >> SPARSE_GRID_TILE_SIZE_SHIFT;
+  const int max_x = (box.max().x() - bbox.min().x()) >> SPARSE_GRID_TILE_SIZE_SHIFT;
+  const int max_y = (box.max().y() - bbox.min().y()) >> SPARSE_GRID_TILE_SIZE_SHIFT;
+  const int max_z = (box.max().z() - bbox.min().z()) >> SPARSE_GRID_TILE_SIZE_SHIFT;
+
+  for (int z = min_z; z <= max_z; z++) {
+    for (int y = min_y; y <= max_y; y++) {
+      for (int x = min_x; x <= max_x; x++) {
+        tile_offsets[x + num_tiles_x * (y + num_tiles_y * z)] = 1;
+      }
+    }
+  }
+}
+
+/* Mark the tiles with leaf nodes or active tiles of the OpenVDB grid. Leaf nodes are marked as a
+ * whole, so the values of their inactive voxels are kept the same as when copying to a dense
+ * grid. Other voxels have the background value of the grid. */
+template<typename GridType>
+static void sparse_grid_mark_tiles(vector<uint> &tile_offsets,
+                                   const openvdb::CoordBBox &bbox,
+                                   const openvdb::GridBase::ConstPtr &grid_base)
+{
+  typename GridType::ConstPtr grid = openvdb::gridConstPtrCast<GridType>(grid_base);
+
+  for (typename GridType::TreeType::LeafCIter iter = grid->tree().cbeginLeaf(); iter; ++iter) {
+    sparse_grid_mark_box(tile_offsets, bbox, iter->getNodeBoundingBox());
+  }
+
+  typename GridType::ValueOnCIter iter = grid->cbeginValueOn();
+  iter.setMaxDepth(GridType::ValueOnCIter::LEAF_DEPTH - 1);
+  for (; iter; ++iter) {
+    openvdb::CoordBBox box;
+    if (iter.getBoundingBox(box)) {
+      sparse_grid_mark_box(tile_offsets, bbox, box);
+    }
+  }
+}
+
+/* Copy the background value and the voxels of the stored tiles, in parallel since every tile is
+ * a separate copy. */
+template<typename GridType, typename ValueType>
+static void sparse_grid_copy_tiles(const vector<uint> &tile_offsets,
+                                   const openvdb::CoordBBox &bbox,
+                                   const openvdb::GridBase::ConstPtr &grid_base,
+                                   float *values)
+{
+  typename GridType::ConstPtr grid = openvdb::gridConstPtrCast<GridType>(grid_base);
+  *(ValueType *)(values + tile_offsets.size()) = ValueType(grid->background());
+
+  const openvdb::Coord dim = bbox.dim();
+  const int num_tiles_x = sparse_grid_num_tiles(dim.x());
+  const int num_tiles_y = sparse_grid_num_tiles(dim.y());
+
+  parallel_for((size_t)0, tile_offsets.size(), [&](size_t tile_index) {
+    const uint tile_offset = tile_offsets[tile_index];
+    if (tile_offset == 0) {
+      return;
+    }
+
+    const int x = tile_index % num_tiles_x;
+    const int y = (tile_index / num_tiles_x) % num_tiles_y;
+    const int z = tile_index / (num_tiles_x * num_tiles_y);
+    const openvdb::Coord tile_min = bbox.min() + openvdb::Coord(x * SPARSE_GRID_TILE_SIZE,
+                                                                y * SPARSE_GRID_TILE_SIZE,
+                                                                z * SPARSE_GRID_TILE_SIZE);
+    const openvdb::CoordBBox tile_bbox(tile_min,
+                                       tile_min.offsetBy(SPARSE_GRID_TILE_SIZE - 1));
+
+    openvdb::tools::Dense<ValueType, openvdb::tools::LayoutXYZ> dense(
+        tile_bbox, (ValueType *)(values + tile_offset));
+    openvdb::tools::copyToDense(*grid, dense, true);
+  });
+}
+
+bool VDBImageLoader::sparse_grid_build_offsets(const int channels, size_t *byte_size)
+{
+  const openvdb::CoordBBox tiles_bbox = sparse_grid_tiles_bbox(bbox);
+  const openvdb::Coord dim = tiles_bbox.dim();
+  const size_t num_tiles = (size_t)sparse_grid_num_tiles(dim.x()) *
+                           sparse_grid_num_tiles(dim.y()) * sparse_grid_num_tiles(dim.z());
+
+  sparse_tile_offsets.clear();
+  sparse_tile_offsets.resize(num_tiles, 0);
+
+  if (grid->isType<openvdb::FloatGrid>()) {
+    sparse_grid_mark_tiles<openvdb::FloatGrid>(sparse_tile_offsets, tiles_bbox, grid);
+  }
+  else if (grid->isType<openvdb::Vec3fGrid>()) {
+    sparse_grid_mark_tiles<openvdb::Vec3fGrid>(sparse_tile_offsets, tiles_bbox, grid);
+  }
+  else if (grid->isType<openvdb::BoolGrid>()) {
+    sparse_grid_mark_tiles<openvdb::BoolGrid>(sparse_tile_offsets, tiles_bbox, grid);
+  }
+  else if (grid->isType<openvdb::DoubleGrid>()) {
+    sparse_grid_mark_tiles<openvdb::DoubleGrid>(sparse_tile_offsets, tiles_bbox, grid);
+  }
+  else if (grid->isType<openvdb::Int32Grid>()) {
+    sparse_grid_mark_tiles<openvdb::Int32Grid>(sparse_tile_offsets, tiles_bbox, grid);
+  }
+  else if (grid->isType<openvdb::Int64Grid>()) {
+    sparse_grid_mark_tiles<openvdb::Int64Grid>(sparse_tile_offsets, tiles_bbox, grid);
+  }
+  else if (grid->isType<openvdb::Vec3IGrid>()) {
+    sparse_grid_mark_tiles<openvdb::Vec3IGrid>(sparse_tile_offsets, tiles_bbox, grid);
+  }
+  else if (grid->isType<openvdb::Vec3dGrid>()) {
+    sparse_grid_mark_tiles<openvdb::Vec3dGrid>(sparse_tile_offsets, tiles_bbox, grid);
+  }
+  else if (grid->isType<openvdb::MaskGrid>()) {
+    sparse_grid_mark_tiles<openvdb::MaskGrid>(sparse_tile_offsets, tiles_bbox, grid);
+  }
+
+  size_t num_stored_tiles = 0;
+  for (size_t i = 0; i < num_tiles; i++) {
+    if (sparse_tile_offsets[i]) {
+      num_stored_tiles++;
+    }
+  }
+
+  /* The background value and the voxels of the stored tiles follow the tile offsets. */
+  const size_t tile_size = (size_t)SPARSE_GRID_TILE_NUM_VOXELS * channels;
+  const size_t size = num_tiles + channels + num_stored_tiles * tile_size;
+
+  /* Dense grids with three channels are stored as float4. */
+  const size_t dense_size = (size_t)bbox.volume() * ((channels == 1) ? 1 : 4);
+
+  VLOG(1) << "Sparse grid " << grid_name << " has " << num_stored_tiles << " of " << num_tiles
+          << " tiles, " << size << " of " << dense_size << " values of the dense grid.";
+
+  if (size > dense_size * sparse_grid_max_relative_size || size > UINT_MAX) {
+    /* Mostly occupied, or offsets don't fit, the grid is stored dense instead. */
+    sparse_tile_offsets.clear();
+    return false;
+  }
+
+  size_t offset = num_tiles + channels;
+  for (size_t i = 0; i < num_tiles; i++) {
+    if (sparse_tile_offsets[i]) {
+      sparse_tile_offsets[i] = (uint)offset;
+      offset += tile_size;
+    }
+  }
+
+  bbox = tiles_bbox;
+  *byte_size = size * sizeof(float);
+  return true;
+}
+#endif
+
 VDBImageLoader::VDBImageLoader(const string &grid_name) : grid_name(grid_name)
 {
 }
@@ -43,13 +230,6 @@ bool VDBImageLoader::load_metadata(ImageMetaData &metadata)
     return false;
   }
 
-  /* Set dimensions. */
-  openvdb::Coord dim = bbox.dim();
-  openvdb::Coord min = bbox.min();
-  metadata.width = dim.x();
-  metadata.height = dim.y();
-  metadata.depth = dim.z();
-
   /* Set data type. */
   if (grid->isType<openvdb::FloatGrid>()) {
     metadata.channels = 1;
@@ -82,13 +262,26 @@ bool VDBImageLoader::load_metadata(ImageMetaData &metadata)
     return false;
   }
 
-  if (metadata.channels == 1) {
+  /* Store grids sparse, so only tiles with active voxels use memory. This grows the bounding box
+   * to whole tiles. */
+  if (sparse_grid_build_offsets(metadata.channels, &metadata.byte_size)) {
+    metadata.type = (metadata.channels == 1) ? IMAGE_DATA_TYPE_SPARSE_FLOAT :
+                                               IMAGE_DATA_TYPE_SPARSE_FLOAT3;
+  }
+  else if (metadata.channels == 1) {
     metadata.type = IMAGE_DATA_TYPE_FLOAT;
   }
   else {
     metadata.type = IMAGE_DATA_TYPE_FLOAT4;
   }
 
+  /* Set dimensions. */
+  openvdb::Coord dim = bbox.dim();
+  openvdb::Coord min = bbox.min();
+  metadata.width = dim.x();
+  metadata.height = dim.y();
+  metadata.depth = dim.z();
+
   /* Set transform from object space to voxel index. */
   openvdb::math::Mat4f grid_matrix = grid->transform().baseMap()->getAffineMap()->getMat4();
   Transform index_to_object;
@@ -111,9 +304,16 @@ bool VDBImageLoader::load_metadata(ImageMetaData &metadata)
 #endif
 }
 
-bool VDBImageLoader::load_pixels(const ImageMetaData &, void *pixels, const size_t, const bool)
+bool VDBImageLoader::load_pixels(const ImageMetaData &metadata,
+                                 void *pixels,
+                                 const size_t,
+                                 const bool)
 {
 #ifdef WITH_OPENVDB
+  if (metadata.byte_size) {
+    return load_sparse_grid((float *)pixels);
+  }
+
   if (grid->isType<openvdb::FloatGrid>()) {
     openvdb::tools::Dense<float, openvdb::tools::LayoutXYZ> dense(bbox, (float *)pixels);
     openvdb::tools::copyToDense(*openvdb::gridConstPtrCast<openvdb::FloatGrid>(grid), dense);
@@ -156,11 +356,56 @@ bool VDBImageLoader::load_pixels(const ImageMetaData &, void *pixels, const size
 
   return true;
 #else
+  (void)metadata;
   (void)pixels;
   return false;
 #endif
 }
 
+#ifdef WITH_OPENVDB
+bool VDBImageLoader::load_sparse_grid(float *values)
+{
+  if (sparse_tile_offsets.empty()) {
+    return false;
+  }
+
+  memcpy(values, sparse_tile_offsets.data(), sparse_tile_offsets.size() * sizeof(uint));
+
+  if (grid->isType<openvdb::FloatGrid>()) {
+    sparse_grid_copy_tiles<openvdb::FloatGrid, float>(sparse_tile_offsets, bbox, grid, values);
+  }
+  else if (grid->isType<openvdb::Vec3fGrid>()) {
+    sparse_grid_copy_tiles<openvdb::Vec3fGrid, openvdb::Vec3f>(
+        sparse_tile_offsets, bbox, grid, values);
+  }
+  else if (grid->isType<openvdb::BoolGrid>()) {
+    sparse_grid_copy_tiles<openvdb::BoolGrid, float>(sparse_tile_offsets, bbox, grid, values);
+  }
+  else if (grid->isType<openvdb::DoubleGrid>()) {
+    sparse_grid_copy_tiles<openvdb::DoubleGrid, float>(sparse_tile_offsets, bbox, grid, values);
+  }
+  else if (grid->isType<openvdb::Int32Grid>()) {
+    sparse_grid_copy_tiles<openvdb::Int32Grid, float>(sparse_tile_offsets, bbox, grid, values);
+  }
+  else if (grid->isType<openvdb::Int64Grid>()) {
+    sparse_grid_copy_tiles<openvdb::Int64Grid, float>(sparse_tile_offsets, bbox, grid, values);
+  }
+  else if (grid->isType<openvdb::Vec3IGrid>()) {
+    sparse_grid_copy_tiles<openvdb::Vec3IGrid, openvdb::Vec3f>(
+        sparse_tile_offsets, bbox, grid, values);
+  }
+  else if (grid->isType<openvdb::Vec3dGrid>()) {
+    sparse_grid_copy_tiles<openvdb::Vec3dGrid, openvdb::Vec3f>(
+        sparse_tile_offsets, bbox, grid, values);
+  }
+  else if (grid->isType<openvdb::MaskGrid>()) {
+    sparse_grid_copy_tiles<openvdb::MaskGrid, float>(sparse_tile_offsets, bbox, grid, values);
+  }
+
+  return true;
+}
+#endif
+
 string VDBImageLoader::name() const
 {
   return grid_name;
@@ -182,6 +427,8 @@ void VDBImageLoader::cleanup()
 #ifdef WITH_OPENVDB
   /* Free OpenVDB grid memory as soon as we can. */
   grid.reset();
+  sparse_tile_offsets.clear();
+  sparse_tile_offsets.shrink_to_fit();
 #endif
 }
 
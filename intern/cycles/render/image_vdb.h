@@ -54,6 +54,11 @@ class VDBImageLoader : public ImageLoader {
 #ifdef WITH_OPENVDB
   openvdb::GridBase::ConstPtr grid;
   openvdb::CoordBBox bbox;
+  /* Offsets of the tiles of the sparse grid, see util_texture.h. */
+  vector<uint> sparse_tile_offsets;
+
+  bool sparse_grid_build_offsets(const int channels, size_t *byte_size);
+  bool load_sparse_grid(float *values);
 #endif
 };
 
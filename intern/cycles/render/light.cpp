@@ -20,6 +20,7 @@
 #include "render/film.h"
 #include "render/graph.h"
 #include "render/integrator.h"
+#include "render/light_tree.h"
 #include "render/mesh.h"
 #include "render/nodes.h"
 #include "render/object.h"
@@ -29,6 +30,7 @@
 #include "util/util_foreach.h"
 #include "util/util_hash.h"
 #include "util/util_logging.h"
+#include "util/util_map.h"
 #include "util/util_path.h"
 #include "util/util_progress.h"
 #include "util/util_task.h"
@@ -274,6 +276,54 @@ bool LightManager::object_usable_as_light(Object *object)
   return false;
 }
 
+/* Estimate of the power emitted per area by a shader, for picking emitters with the light tree.
+ * Only constant emission is known in advance, other shaders are assumed to emit one. */
+static float light_tree_shader_emission(Shader *shader, unordered_map<Shader *, float> &cache)
+{
+  unordered_map<Shader *, float>::iterator it = cache.find(shader);
+  if (it != cache.end()) {
+    return it->second;
+  }
+
+  float3 emission;
+  const float estimate = (shader->is_constant_emission(&emission)) ? fabsf(average(emission)) :
+                                                                     1.0f;
+  cache[shader] = estimate;
+  return estimate;
+}
+
+static LightTreePrimitive light_tree_lamp_primitive(const Light *light)
+{
+  LightTreePrimitive prim;
+  prim.energy = fabsf(average(light->strength));
+
+  if (light->type == LIGHT_DISTANT || light->type == LIGHT_BACKGROUND) {
+    prim.is_distant = true;
+  }
+  else if (light->type == LIGHT_AREA) {
+    const float3 axisu = light->axisu * (light->sizeu * light->size * 0.5f);
+    const float3 axisv = light->axisv * (light->sizev * light->size * 0.5f);
+    prim.bounds.grow(light->co - axisu - axisv);
+    prim.bounds.grow(light->co - axisu + axisv);
+    prim.bounds.grow(light->co + axisu - axisv);
+    prim.bounds.grow(light->co + axisu + axisv);
+    /* Area lights emit from one side only. */
+    prim.bcone = LightTreeBoundingCone(safe_normalize(light->dir), 0.0f, M_PI_2_F);
+  }
+  else {
+    prim.bounds.grow(light->co, light->size);
+    if (light->type == LIGHT_SPOT) {
+      prim.bcone = LightTreeBoundingCone(
+          safe_normalize(light->dir), light->spot_angle * 0.5f, M_PI_2_F);
+    }
+    else {
+      prim.bcone = LightTreeBoundingCone(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F);
+    }
+  }
+
+  return prim;
+}
+
 void LightManager::device_update_distribution(Device *,
                                               DeviceScene *dscene,
                                               Scene *scene,
@@ -328,6 +378,14 @@ void LightManager::device_update_distribution(Device *,
   KernelLightDistribution *distribution = dscene->light_distribution.alloc(num_distribution + 1);
   float totarea = 0.0f;
 
+  /* light tree primitives, in the same order as the distribution */
+  const bool use_light_tree = scene->integrator->use_light_tree;
+  vector<LightTreePrimitive> light_tree_prims;
+  unordered_map<Shader *, float> light_tree_shader_cache;
+  if (use_light_tree) {
+    light_tree_prims.resize(num_distribution);
+  }
+
   /* triangles */
   size_t offset = 0;
   int j = 0;
@@ -380,6 +438,11 @@ void LightManager::device_update_distribution(Device *,
 
         Mesh::Triangle t = mesh->get_triangle(i);
         if (!t.valid(&mesh->verts[0])) {
+          if (use_light_tree) {
+            /* Without bounds and energy, the triangle is never picked by the light tree. */
+            light_tree_prims[offset - 1].emitter_index = offset - 1;
+            light_tree_prims[offset - 1].is_distant = true;
+          }
           continue;
         }
         float3 p1 = mesh->verts[t.v[0]];
@@ -392,7 +455,20 @@ void LightManager::device_update_distribution(Device *,
           p3 = transform_point(&tfm, p3);
         }
 
-        totarea += triangle_area(p1, p2, p3);
+        const float area = triangle_area(p1, p2, p3);
+        totarea += area;
+
+        if (use_light_tree) {
+          /* Mesh lights emit from both sides. */
+          LightTreePrimitive &prim = light_tree_prims[offset - 1];
+          prim.emitter_index = offset - 1;
+          prim.energy = area * light_tree_shader_emission(shader, light_tree_shader_cache);
+          prim.bounds.grow(p1);
+          prim.bounds.grow(p2);
+          prim.bounds.grow(p3);
+          prim.bcone = LightTreeBoundingCone(
+              safe_normalize(cross(p2 - p1, p3 - p1)), M_PI_F, M_PI_2_F);
+        }
       }
     }
 
@@ -406,10 +482,16 @@ void LightManager::device_update_distribution(Device *,
   bool use_lamp_mis = false;
 
   int light_index = 0;
+  int background_light_index = 0;
   foreach (Light *light, scene->lights) {
     if (!light->is_enabled)
       continue;
 
+    if (use_light_tree) {
+      light_tree_prims[offset] = light_tree_lamp_primitive(light);
+      light_tree_prims[offset].emitter_index = offset;
+    }
+
     distribution[offset].totarea = totarea;
     distribution[offset].prim = ~light_index;
     distribution[offset].lamp.pad = 1.0f;
@@ -428,6 +510,7 @@ void LightManager::device_update_distribution(Device *,
     else if (light->type == LIGHT_BACKGROUND) {
       num_background_lights++;
       background_mis |= light->use_mis;
+      background_light_index = light_index;
     }
 
     light_index++;
@@ -493,6 +576,27 @@ void LightManager::device_update_distribution(Device *,
     /* CDF */
     dscene->light_distribution.copy_to_device();
 
+    /* Light tree */
+    kintegrator->use_light_tree = use_light_tree;
+    kintegrator->background_light_index = background_light_index;
+
+    if (use_light_tree) {
+      progress.set_status("Updating Lights", "Building light tree");
+
+      LightTree light_tree(light_tree_prims, num_distribution);
+
+      const size_t num_nodes = light_tree.nodes.size();
+      KernelLightTreeNode *nodes = dscene->light_tree_nodes.alloc(num_nodes);
+      memcpy(nodes, light_tree.nodes.data(), sizeof(*nodes) * num_nodes);
+      uint *emitter_nodes = dscene->light_tree_emitter_nodes.alloc(num_distribution);
+      memcpy(emitter_nodes,
+             light_tree.emitter_nodes.data(),
+             sizeof(*emitter_nodes) * num_distribution);
+
+      dscene->light_tree_nodes.copy_to_device();
+      dscene->light_tree_emitter_nodes.copy_to_device();
+    }
+
     /* Portals */
     if (num_portals > 0) {
       kbackground->portal_offset = light_index;
@@ -510,12 +614,16 @@ void LightManager::device_update_distribution(Device *,
   }
   else {
     dscene->light_distribution.free();
+    dscene->light_tree_nodes.free();
+    dscene->light_tree_emitter_nodes.free();
 
     kintegrator->num_distribution = 0;
     kintegrator->num_all_lights = 0;
     kintegrator->pdf_triangles = 0.0f;
     kintegrator->pdf_lights = 0.0f;
     kintegrator->use_lamp_mis = false;
+    kintegrator->use_light_tree = false;
+    kintegrator->background_light_index = 0;
 
     kbackground->num_portals = 0;
     kbackground->portal_offset = 0;
@@ -1000,6 +1108,8 @@ void LightManager::device_update(Device *device,
 void LightManager::device_free(Device *, DeviceScene *dscene, const bool free_background)
 {
   dscene->light_distribution.free();
+  dscene->light_tree_nodes.free();
+  dscene->light_tree_emitter_nodes.free();
   dscene->lights.free();
   if (free_background) {
     dscene->light_background_marginal_cdf.free();
@@ -0,0 +1,350 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "render/light_tree.h"
+
+#include "util/util_algorithm.h"
+#include "util/util_logging.h"
+#include "util/util_math.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Bounding Cone */
+
+void LightTreeBoundingCone::grow(const LightTreeBoundingCone &other)
+{
+  if (other.is_empty) {
+    return;
+  }
+  if (is_empty) {
+    *this = other;
+    return;
+  }
+
+  /* From "Importance Sampling of Many Lights with Adaptive Tree Splitting", the cone a has the
+   * largest spread of normals. */
+  LightTreeBoundingCone a = *this;
+  LightTreeBoundingCone b = other;
+  if (a.theta_o < b.theta_o) {
+    swap(a, b);
+  }
+
+  const float theta_d = safe_acosf(dot(a.axis, b.axis));
+  theta_e = max(a.theta_e, b.theta_e);
+
+  if (min(theta_d + b.theta_o, M_PI_F) <= a.theta_o) {
+    axis = a.axis;
+    theta_o = a.theta_o;
+    return;
+  }
+
+  const float new_theta_o = (a.theta_o + theta_d + b.theta_o) * 0.5f;
+  if (new_theta_o >= M_PI_F) {
+    axis = a.axis;
+    theta_o = M_PI_F;
+    return;
+  }
+
+  /* Rotate the axis towards the other cone, any rotation works for opposite axes. */
+  float3 rotation_axis = cross(a.axis, b.axis);
+  if (len_squared(rotation_axis) < 1e-12f) {
+    float3 unused;
+    make_orthonormals(a.axis, &rotation_axis, &unused);
+  }
+
+  axis = rotate_around_axis(a.axis, normalize(rotation_axis), new_theta_o - a.theta_o);
+  theta_o = new_theta_o;
+}
+
+float LightTreeBoundingCone::measure() const
+{
+  if (is_empty) {
+    return 0.0f;
+  }
+
+  const float theta_w = min(theta_o + theta_e, M_PI_F);
+  const float cos_theta_o = cosf(theta_o);
+  const float sin_theta_o = sinf(theta_o);
+
+  return M_2PI_F * (1.0f - cos_theta_o) +
+         M_PI_2_F * (2.0f * theta_w * sin_theta_o - cosf(theta_o - 2.0f * theta_w) +
+                     2.0f * theta_o * sin_theta_o + cos_theta_o);
+}
+
+/* Light Tree */
+
+namespace {
+
+/* Number of buckets the centroids are binned in, to find the split with the lowest cost. */
+const int LIGHT_TREE_NUM_BUCKETS = 12;
+
+/* Area of the bounds, falling back to their length for emitters along a line. */
+float light_tree_bounds_measure(const BoundBox &bounds)
+{
+  if (!bounds.valid()) {
+    return 0.0f;
+  }
+  const float area = bounds.area();
+  return (area > 0.0f) ? area : len(bounds.size());
+}
+
+struct LightTreeBucket {
+  BoundBox bounds;
+  LightTreeBoundingCone bcone;
+  float energy;
+  int count;
+
+  LightTreeBucket() : bounds(BoundBox::empty), energy(0.0f), count(0)
+  {
+  }
+
+  void add(const LightTreePrimitive &prim)
+  {
+    bounds.grow(prim.bounds);
+    bcone.grow(prim.bcone);
+    energy += prim.energy;
+    count++;
+  }
+
+  void add(const LightTreeBucket &other)
+  {
+    bounds.grow(other.bounds);
+    bcone.grow(other.bcone);
+    energy += other.energy;
+    count += other.count;
+  }
+
+  float cost() const
+  {
+    return energy * bcone.measure() * light_tree_bounds_measure(bounds);
+  }
+};
+
+struct LightTreeBuildTask {
+  int start;
+  int end;
+  int parent_index;
+  bool is_second_child;
+};
+
+}  // namespace
+
+LightTree::LightTree(const vector<LightTreePrimitive> &prims_, int num_emitters) : prims(prims_)
+{
+  emitter_nodes.resize(num_emitters, 0);
+  if (!prims.empty()) {
+    build();
+  }
+}
+
+void LightTree::build()
+{
+  /* Distant emitters have no bounds, they are kept in their own subtree. */
+  const int num_local = (int)(std::partition(prims.begin(),
+                                             prims.end(),
+                                             [](const LightTreePrimitive &prim) {
+                                               return !prim.is_distant;
+                                             }) -
+                              prims.begin());
+
+  nodes.reserve(prims.size() * 2 - 1);
+
+  /* Build iteratively, unbalanced trees of many emitters would overflow the stack otherwise. The
+   * second child is pushed first, so the first child directly follows its parent. */
+  vector<LightTreeBuildTask> stack;
+  stack.push_back({0, (int)prims.size(), -1, false});
+
+  while (!stack.empty()) {
+    const LightTreeBuildTask task = stack.back();
+    stack.pop_back();
+
+    const int node_index = (int)nodes.size();
+    KernelLightTreeNode knode = make_node(task.start, task.end);
+    knode.parent_index = task.parent_index;
+    if (task.is_second_child) {
+      nodes[task.parent_index].child_index = node_index;
+    }
+
+    if (task.end - task.start == 1) {
+      knode.emitter_index = prims[task.start].emitter_index;
+      knode.child_index = -1;
+      emitter_nodes[knode.emitter_index] = node_index;
+      nodes.push_back(knode);
+      continue;
+    }
+
+    knode.emitter_index = -1;
+    nodes.push_back(knode);
+
+    const int middle = split(task.start, task.end, num_local);
+    stack.push_back({middle, task.end, node_index, true});
+    stack.push_back({task.start, middle, node_index, false});
+  }
+
+  VLOG(1) << "Light tree built with " << nodes.size() << " nodes for " << prims.size()
+          << " emitters.";
+}
+
+int LightTree::split(int start, int end, int num_local)
+{
+  if (start < num_local && end > num_local) {
+    /* Separate the local and distant emitters. */
+    return num_local;
+  }
+  if (start >= num_local) {
+    /* The importance of distant emitters is independent of the position, their order doesn't
+     * matter. */
+    return (start + end) / 2;
+  }
+  return split_saoh(start, end);
+}
+
+int LightTree::split_saoh(int start, int end)
+{
+  const int middle = (start + end) / 2;
+
+  BoundBox centroid_bounds = BoundBox::empty;
+  for (int i = start; i < end; i++) {
+    centroid_bounds.grow(prims[i].bounds.center());
+  }
+
+  const float3 extent = centroid_bounds.size();
+  const float max_extent = max3(extent);
+  if (!(max_extent > 0.0f)) {
+    /* All centroids are at the same position. */
+    return middle;
+  }
+
+  float min_cost = FLT_MAX;
+  int min_axis = -1;
+  int min_bucket = 0;
+
+  for (int axis = 0; axis < 3; axis++) {
+    if (!(extent[axis] > 0.0f)) {
+      continue;
+    }
+
+    const float inv_extent = 1.0f / extent[axis];
+    LightTreeBucket buckets[LIGHT_TREE_NUM_BUCKETS];
+    for (int i = start; i < end; i++) {
+      const float offset = (prims[i].bounds.center()[axis] - centroid_bounds.min[axis]) *
+                           inv_extent;
+      const int bucket = min((int)(offset * LIGHT_TREE_NUM_BUCKETS), LIGHT_TREE_NUM_BUCKETS - 1);
+      buckets[bucket].add(prims[i]);
+    }
+
+    /* Cost of splitting after each bucket, accumulated from both sides. */
+    float cost[LIGHT_TREE_NUM_BUCKETS - 1];
+    int count[LIGHT_TREE_NUM_BUCKETS - 1];
+
+    LightTreeBucket left;
+    for (int i = 0; i < LIGHT_TREE_NUM_BUCKETS - 1; i++) {
+      left.add(buckets[i]);
+      cost[i] = left.cost();
+      count[i] = left.count;
+    }
+
+    LightTreeBucket right;
+    for (int i = LIGHT_TREE_NUM_BUCKETS - 1; i > 0; i--) {
+      right.add(buckets[i]);
+      cost[i - 1] += right.cost();
+    }
+
+    /* Favor splitting along the longest axis, which gives more compact nodes. */
+    const float regularization = max_extent * inv_extent;
+
+    for (int i = 0; i < LIGHT_TREE_NUM_BUCKETS - 1; i++) {
+      if (count[i] == 0 || count[i] == end - start) {
+        continue;
+      }
+      const float axis_cost = regularization * cost[i];
+      if (axis_cost < min_cost) {
+        min_cost = axis_cost;
+        min_axis = axis;
+        min_bucket = i;
+      }
+    }
+  }
+
+  if (min_axis == -1) {
+    return middle;
+  }
+
+  const float inv_extent = 1.0f / extent[min_axis];
+  const float3 centroid_min = centroid_bounds.min;
+  const int split_index = (int)(std::partition(prims.begin() + start,
+                                               prims.begin() + end,
+                                               [&](const LightTreePrimitive &prim) {
+                                                 const float offset =
+                                                     (prim.bounds.center()[min_axis] -
+                                                      centroid_min[min_axis]) *
+                                                     inv_extent;
+                                                 const int bucket = min(
+                                                     (int)(offset * LIGHT_TREE_NUM_BUCKETS),
+                                                     LIGHT_TREE_NUM_BUCKETS - 1);
+                                                 return bucket <= min_bucket;
+                                               }) -
+                                prims.begin());
+
+  if (split_index == start || split_index == end) {
+    return middle;
+  }
+  return split_index;
+}
+
+KernelLightTreeNode LightTree::make_node(int start, int end) const
+{
+  BoundBox bounds = BoundBox::empty;
+  LightTreeBoundingCone bcone;
+  float energy = 0.0f;
+  bool is_distant = true;
+
+  for (int i = start; i < end; i++) {
+    const LightTreePrimitive &prim = prims[i];
+    if (!prim.is_distant) {
+      bounds.grow(prim.bounds);
+      bcone.grow(prim.bcone);
+      is_distant = false;
+    }
+    energy += prim.energy;
+  }
+
+  if (!bounds.valid()) {
+    bounds = BoundBox(make_float3(0.0f, 0.0f, 0.0f));
+  }
+
+  KernelLightTreeNode knode;
+  knode.bounding_box_min[0] = bounds.min.x;
+  knode.bounding_box_min[1] = bounds.min.y;
+  knode.bounding_box_min[2] = bounds.min.z;
+  knode.bounding_box_max[0] = bounds.max.x;
+  knode.bounding_box_max[1] = bounds.max.y;
+  knode.bounding_box_max[2] = bounds.max.z;
+  knode.energy = energy;
+  knode.axis[0] = bcone.axis.x;
+  knode.axis[1] = bcone.axis.y;
+  knode.axis[2] = bcone.axis.z;
+  knode.theta_o = bcone.theta_o;
+  knode.theta_e = bcone.theta_e;
+  knode.child_index = -1;
+  knode.emitter_index = -1;
+  knode.parent_index = -1;
+  knode.is_distant = is_distant;
+
+  return knode;
+}
+
+CCL_NAMESPACE_END
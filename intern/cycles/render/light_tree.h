@@ -0,0 +1,94 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __LIGHT_TREE_H__
+#define __LIGHT_TREE_H__
+
+#include "kernel/kernel_types.h"
+
+#include "util/util_boundbox.h"
+#include "util/util_types.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Cone bounding the emission of a set of emitters: their normals are within theta_o of the
+ * axis, and they emit light up to theta_e away from their normals. */
+class LightTreeBoundingCone {
+ public:
+  float3 axis;
+  float theta_o;
+  float theta_e;
+  bool is_empty;
+
+  LightTreeBoundingCone()
+      : axis(make_float3(0.0f, 0.0f, 1.0f)), theta_o(0.0f), theta_e(0.0f), is_empty(true)
+  {
+  }
+
+  LightTreeBoundingCone(const float3 &axis_, float theta_o_, float theta_e_)
+      : axis(axis_), theta_o(theta_o_), theta_e(theta_e_), is_empty(false)
+  {
+  }
+
+  /* Grow to the smallest cone containing both cones. */
+  void grow(const LightTreeBoundingCone &other);
+
+  /* Measure of the directions the emission reaches, for comparing splits. */
+  float measure() const;
+};
+
+/* Emitter of the light distribution, with the bounds the tree is built from. */
+struct LightTreePrimitive {
+  BoundBox bounds;
+  LightTreeBoundingCone bcone;
+  float energy;
+  /* Index of the emitter in the light distribution. */
+  int emitter_index;
+  /* Distant lights and the background, they have no bounds. */
+  bool is_distant;
+
+  LightTreePrimitive() : bounds(BoundBox::empty), energy(0.0f), emitter_index(0), is_distant(false)
+  {
+  }
+};
+
+/* Light Tree
+ *
+ * Hierarchy of the bounds of the emitters, for picking them in the kernel by their importance
+ * for the shading point. Nodes are split by the surface area orientation heuristic, which takes
+ * the energy and emission directions into account besides the bounding boxes. */
+class LightTree {
+ public:
+  LightTree(const vector<LightTreePrimitive> &prims, int num_emitters);
+
+  /* Nodes in depth first order, the first child of an interior node directly follows it. */
+  vector<KernelLightTreeNode> nodes;
+  /* Leaf node of each emitter in the light distribution. */
+  vector<uint> emitter_nodes;
+
+ protected:
+  void build();
+  int split(int start, int end, int num_local);
+  int split_saoh(int start, int end);
+  KernelLightTreeNode make_node(int start, int end) const;
+
+  vector<LightTreePrimitive> prims;
+};
+
+CCL_NAMESPACE_END
+
+#endif /* __LIGHT_TREE_H__ */
@@ -388,6 +388,14 @@ void ImageTextureNode::compile(SVMCompiler &compiler)
       flags |= NODE_IMAGE_ALPHA_UNASSOCIATE;
     }
   }
+  if (compiler.scene->image_manager->use_texture_cache() && projection == NODE_IMAGE_PROJ_FLAT &&
+      tex_mapping.skip() && vector_in->link &&
+      vector_in->link->parent->type == TextureCoordinateNode::node_type &&
+      vector_in->link == vector_in->link->parent->output("UV")) {
+    /* The texture cache picks the mip level from the differentials of the coordinates, which are
+     * only known for the default UV map. */
+    flags |= NODE_IMAGE_UV_DIFFERENTIALS;
+  }
 
   if (projection != NODE_IMAGE_PROJ_BOX) {
     /* If there only is one image (a very common case), we encode it as a negative value. */
@@ -74,6 +74,8 @@ DeviceScene::DeviceScene(Device *device)
       attributes_uchar4(device, "__attributes_uchar4", MEM_GLOBAL),
       light_distribution(device, "__light_distribution", MEM_GLOBAL),
       lights(device, "__lights", MEM_GLOBAL),
+      light_tree_nodes(device, "__light_tree_nodes", MEM_GLOBAL),
+      light_tree_emitter_nodes(device, "__light_tree_emitter_nodes", MEM_GLOBAL),
       light_background_marginal_cdf(device, "__light_background_marginal_cdf", MEM_GLOBAL),
       light_background_conditional_cdf(device, "__light_background_conditional_cdf", MEM_GLOBAL),
       particles(device, "__particles", MEM_GLOBAL),
@@ -109,6 +111,7 @@ Scene::Scene(const SceneParams &params_, Device *device)
   object_manager = new ObjectManager();
   integrator = create_node<Integrator>();
   image_manager = new ImageManager(device->info);
+  image_manager->set_texture_cache_size(params.texture_cache_size);
   particle_system_manager = new ParticleSystemManager();
   bake_manager = new BakeManager();
   kernels_loaded = false;
@@ -637,12 +640,43 @@ template<typename T> void delete_node_from_array(vector<T> &nodes, T node)
   delete node;
 }
 
+/* Remove all nodes of the set in a single pass over the array, instanced scenes may delete
+ * millions of them at once. Nodes are deleted in the order of the array. */
+template<typename T>
+static void delete_nodes_from_array(vector<T *> &nodes,
+                                    const unordered_set<T *> &delete_nodes,
+                                    const NodeOwner *owner)
+{
+  size_t new_size = 0;
+
+  for (size_t i = 0; i < nodes.size(); i++) {
+    T *node = nodes[i];
+
+    if (delete_nodes.find(node) != delete_nodes.end()) {
+      assert(node->get_owner() == owner);
+      delete node;
+    }
+    else {
+      nodes[new_size++] = node;
+    }
+  }
+
+  nodes.resize(new_size);
+  (void)owner;
+}
+
 template<> void Scene::delete_node_impl(Light *node)
 {
   delete_node_from_array(lights, node);
   light_manager->tag_update(this);
 }
 
+template<> void Scene::delete_nodes_impl(const unordered_set<Light *> &nodes)
+{
+  delete_nodes_from_array(lights, nodes, this);
+  light_manager->tag_update(this);
+}
+
 template<> void Scene::delete_node_impl(Mesh *node)
 {
   delete_node_from_array(geometry, static_cast<Geometry *>(node));
@@ -667,21 +701,44 @@ template<> void Scene::delete_node_impl(Geometry *node)
   geometry_manager->tag_update(this);
 }
 
+template<> void Scene::delete_nodes_impl(const unordered_set<Geometry *> &nodes)
+{
+  delete_nodes_from_array(geometry, nodes, this);
+  geometry_manager->tag_update(this);
+}
+
 template<> void Scene::delete_node_impl(Object *node)
 {
   delete_node_from_array(objects, node);
   object_manager->tag_update(this);
 }
 
+template<> void Scene::delete_nodes_impl(const unordered_set<Object *> &nodes)
+{
+  delete_nodes_from_array(objects, nodes, this);
+  object_manager->tag_update(this);
+}
+
 template<> void Scene::delete_node_impl(ParticleSystem *node)
 {
   delete_node_from_array(particle_systems, node);
   particle_system_manager->tag_update(this);
 }
 
+template<> void Scene::delete_nodes_impl(const unordered_set<ParticleSystem *> &nodes)
+{
+  delete_nodes_from_array(particle_systems, nodes, this);
+  particle_system_manager->tag_update(this);
+}
+
 template<> void Scene::delete_node_impl(Shader * /*node*/)
 {
   /* don't delete unused shaders, not supported */
 }
 
+template<> void Scene::delete_nodes_impl(const unordered_set<Shader *> & /*nodes*/)
+{
+  /* don't delete unused shaders, not supported */
+}
+
 CCL_NAMESPACE_END
@@ -27,6 +27,7 @@
 #include "device/device_memory.h"
 
 #include "util/util_param.h"
+#include "util/util_set.h"
 #include "util/util_string.h"
 #include "util/util_system.h"
 #include "util/util_texture.h"
@@ -109,6 +110,8 @@ class DeviceScene {
   /* lights */
   device_vector<KernelLightDistribution> light_distribution;
   device_vector<KernelLight> lights;
+  device_vector<KernelLightTreeNode> light_tree_nodes;
+  device_vector<uint> light_tree_emitter_nodes;
   device_vector<float2> light_background_marginal_cdf;
   device_vector<float2> light_background_conditional_cdf;
 
@@ -175,6 +178,8 @@ class SceneParams {
   CurveShapeType hair_shape;
   bool persistent_data;
   int texture_limit;
+  /* Size of the texture cache in megabytes, zero to load images fully into memory. */
+  int texture_cache_size;
 
   bool background;
 
@@ -190,6 +195,7 @@ class SceneParams {
     hair_shape = CURVE_RIBBON;
     persistent_data = false;
     texture_limit = 0;
+    texture_cache_size = 0;
     background = true;
   }
 
@@ -201,7 +207,8 @@ class SceneParams {
              use_bvh_unaligned_nodes == params.use_bvh_unaligned_nodes &&
              num_bvh_time_steps == params.num_bvh_time_steps &&
              hair_subdivisions == params.hair_subdivisions && hair_shape == params.hair_shape &&
-             persistent_data == params.persistent_data && texture_limit == params.texture_limit);
+             persistent_data == params.persistent_data && texture_limit == params.texture_limit &&
+             texture_cache_size == params.texture_cache_size);
   }
 
   int curve_subdivisions()
@@ -316,6 +323,14 @@ class Scene : public NodeOwner {
     (void)owner;
   }
 
+  /* Same as delete_node(), for a set of nodes at once. */
+  template<typename T> void delete_nodes(const unordered_set<T *> &nodes)
+  {
+    if (!nodes.empty()) {
+      delete_nodes_impl(nodes);
+    }
+  }
+
  protected:
   /* Check if some heavy data worth logging was updated.
    * Mainly used to suppress extra annoying logging.
@@ -343,6 +358,10 @@ class Scene : public NodeOwner {
   {
     delete node;
   }
+
+  /* Only implemented for the node types that are deleted in sets, removing the nodes in the
+   * order of the scene arrays so it doesn't depend on the order of the set. */
+  template<typename T> void delete_nodes_impl(const unordered_set<T *> &nodes);
 };
 
 template<> Light *Scene::create_node<Light>();
@@ -375,6 +394,16 @@ template<> void Scene::delete_node_impl(ParticleSystem *node);
 
 template<> void Scene::delete_node_impl(Shader *node);
 
+template<> void Scene::delete_nodes_impl(const unordered_set<Light *> &nodes);
+
+template<> void Scene::delete_nodes_impl(const unordered_set<Geometry *> &nodes);
+
+template<> void Scene::delete_nodes_impl(const unordered_set<Object *> &nodes);
+
+template<> void Scene::delete_nodes_impl(const unordered_set<ParticleSystem *> &nodes);
+
+template<> void Scene::delete_nodes_impl(const unordered_set<Shader *> &nodes);
+
 CCL_NAMESPACE_END
 
 #endif /*  __SCENE_H__ */
@@ -0,0 +1,180 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#define __KERNEL_SSE__
+#define __KERNEL_SSE2__
+#define __KERNEL_SSE3__
+#define __KERNEL_SSSE3__
+#define __KERNEL_SSE41__
+#define __KERNEL_AVX__
+#define __KERNEL_AVX2__
+
+#include "testing/testing.h"
+
+#include "bvh/bvh.h"
+#include "bvh/bvh_params.h"
+
+#include "render/mesh.h"
+#include "render/object.h"
+
+#include "kernel/kernel_compat_cpu.h"
+#include "kernel/kernel_math.h"
+#include "kernel/kernel_types.h"
+#include "kernel/split/kernel_split_data.h"
+#include "kernel/kernel_globals.h"
+#include "kernel/kernel_color.h"
+#include "kernel/kernels/cpu/kernel_cpu_image.h"
+#include "kernel/kernel_random.h"
+#include "kernel/kernel_projection.h"
+#include "kernel/kernel_montecarlo.h"
+#include "kernel/kernel_differential.h"
+#include "kernel/geom/geom.h"
+#include "kernel/bvh/bvh.h"
+
+#include "util/util_hash.h"
+#include "util/util_progress.h"
+#include "util/util_system.h"
+
+CCL_NAMESPACE_BEGIN
+
+#if defined(i386) || defined(_M_IX86) || defined(__x86_64__) || defined(_M_X64)
+namespace {
+
+float3 random_float3(const uint seed, const uint index)
+{
+  return make_float3(hash_uint3_to_float(seed, index, 0),
+                     hash_uint3_to_float(seed, index, 1),
+                     hash_uint3_to_float(seed, index, 2));
+}
+
+/* Small triangles scattered in a unit cube, with a few large ones spanning it so that nodes with
+ * children of very different sizes are quantized. */
+Mesh *bvh_test_mesh_create()
+{
+  const int num_triangles = 2000;
+  Mesh *mesh = new Mesh();
+  mesh->reserve_mesh(num_triangles * 3, num_triangles);
+
+  for (int i = 0; i < num_triangles; i++) {
+    const float size = (i % 100 == 0) ? 1.0f : 0.02f;
+    const float3 center = random_float3(1, i);
+    for (int j = 0; j < 3; j++) {
+      mesh->add_vertex(center + (random_float3(2, i * 3 + j) - make_float3(0.5f)) * size);
+    }
+    mesh->add_triangle(i * 3, i * 3 + 1, i * 3 + 2, 0, false);
+  }
+
+  return mesh;
+}
+
+/* Kernel globals pointing to the packed data of a BVH. */
+class BVHKernelGlobals {
+ public:
+  KernelGlobals kg;
+
+  BVHKernelGlobals(const BVHParams &params, BVH *bvh)
+  {
+    PackedBVH &pack = bvh->pack;
+    set_texture(kg.__bvh_nodes, pack.nodes);
+    set_texture(kg.__bvh_leaf_nodes, pack.leaf_nodes);
+    set_texture(kg.__object_node, pack.object_node);
+    set_texture(kg.__prim_tri_index, pack.prim_tri_index);
+    set_texture(kg.__prim_tri_verts, pack.prim_tri_verts);
+    set_texture(kg.__prim_type, pack.prim_type);
+    set_texture(kg.__prim_visibility, pack.prim_visibility);
+    set_texture(kg.__prim_index, pack.prim_index);
+    set_texture(kg.__prim_object, pack.prim_object);
+
+    kg.__data.bvh.root = pack.root_index;
+    kg.__data.bvh.bvh_layout = params.bvh_layout;
+  }
+
+ private:
+  template<typename T, typename V> static void set_texture(texture<T> &tex, V &data)
+  {
+    tex.data = (T *)data.data();
+    tex.width = data.size();
+  }
+};
+
+}  // namespace
+
+/* Closest hits found with the BVH8 layout are the same as with BVH2, for rays starting inside
+ * and outside of the bounds and along the axes, where the slab distances are infinite. */
+TEST(bvh_bvh8, same_hits_as_bvh2)
+{
+  if (!system_cpu_support_avx2()) {
+    return;
+  }
+
+  Mesh *mesh = bvh_test_mesh_create();
+  Object *object = new Object();
+  object->geometry = mesh;
+  const vector<Geometry *> geometry = {mesh};
+  const vector<Object *> objects = {object};
+
+  BVHParams params;
+  params.top_level = false;
+  Progress progress;
+
+  params.bvh_layout = BVH_LAYOUT_BVH2;
+  BVH *bvh2 = BVH::create(params, geometry, objects, NULL);
+  bvh2->build(progress);
+  BVHKernelGlobals bvh2_globals(params, bvh2);
+
+  params.bvh_layout = BVH_LAYOUT_BVH8;
+  BVH *bvh8 = BVH::create(params, geometry, objects, NULL);
+  bvh8->build(progress);
+  BVHKernelGlobals bvh8_globals(params, bvh8);
+
+  int num_hits = 0;
+  for (int i = 0; i < 4000; i++) {
+    Ray ray;
+    ray.P = random_float3(3, i) * 3.0f - make_float3(1.0f);
+    if (i % 4 == 0) {
+      const int axis = (i / 4) % 3;
+      ray.D = make_float3(0.0f);
+      ray.D[axis] = (i % 8 == 0) ? 1.0f : -1.0f;
+    }
+    else {
+      ray.D = normalize(random_float3(4, i) - make_float3(0.5f));
+    }
+    ray.t = FLT_MAX;
+    ray.time = 0.5f;
+
+    Intersection bvh2_isect, bvh8_isect;
+    const bool bvh2_hit = scene_intersect(
+        &bvh2_globals.kg, &ray, PATH_RAY_ALL_VISIBILITY, &bvh2_isect);
+    const bool bvh8_hit = scene_intersect(
+        &bvh8_globals.kg, &ray, PATH_RAY_ALL_VISIBILITY, &bvh8_isect);
+
+    ASSERT_EQ(bvh2_hit, bvh8_hit) << "ray " << i;
+    if (bvh2_hit) {
+      EXPECT_EQ(bvh2_isect.prim, bvh8_isect.prim) << "ray " << i;
+      EXPECT_EQ(bvh2_isect.t, bvh8_isect.t) << "ray " << i;
+      num_hits++;
+    }
+  }
+  EXPECT_GT(num_hits, 0);
+
+  delete bvh2;
+  delete bvh8;
+  delete object;
+  delete mesh;
+}
+#endif
+
+CCL_NAMESPACE_END
@@ -0,0 +1,131 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/image_vdb.h"
+
+#include "util/util_texture.h"
+#include "util/util_vector.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* A grid of two tiles where only the second one is stored. */
+TEST(render_image_vdb, sparse_grid_voxel_offset)
+{
+  const int width = 2 * SPARSE_GRID_TILE_SIZE;
+  const int height = SPARSE_GRID_TILE_SIZE;
+  const int depth = SPARSE_GRID_TILE_SIZE - 3;
+  const uint background_offset = sparse_grid_background_offset(width, height, depth);
+  EXPECT_EQ(background_offset, 2);
+
+  for (int channels = 1; channels <= 3; channels += 2) {
+    const uint grid[2] = {0, background_offset + channels};
+
+    /* Voxels of the missing tile read the background value. */
+    EXPECT_EQ(sparse_grid_voxel_offset(grid, width, height, depth, channels, 0, 0, 0),
+              background_offset);
+    EXPECT_EQ(sparse_grid_voxel_offset(grid, width, height, depth, channels, 7, 5, 4),
+              background_offset);
+
+    EXPECT_EQ(sparse_grid_voxel_offset(grid, width, height, depth, channels, 8, 0, 0), grid[1]);
+    EXPECT_EQ(sparse_grid_voxel_offset(grid, width, height, depth, channels, 9, 2, 3),
+              grid[1] + (1 + 2 * 8 + 3 * 64) * channels);
+    EXPECT_EQ(sparse_grid_voxel_offset(grid, width, height, depth, channels, 15, 7, 4),
+              grid[1] + (7 + 7 * 8 + 4 * 64) * channels);
+  }
+}
+
+#ifdef WITH_OPENVDB
+namespace {
+
+class GridImageLoader : public VDBImageLoader {
+ public:
+  explicit GridImageLoader(openvdb::GridBase::ConstPtr grid) : VDBImageLoader("test")
+  {
+    this->grid = grid;
+  }
+};
+
+float sparse_grid_read(const vector<float> &values,
+                       const ImageMetaData &metadata,
+                       const openvdb::Coord &tiles_min,
+                       const openvdb::Coord &ijk)
+{
+  const openvdb::Coord xyz = ijk - tiles_min;
+  const uint offset = sparse_grid_voxel_offset((const uint *)values.data(),
+                                               metadata.width,
+                                               metadata.height,
+                                               metadata.depth,
+                                               1,
+                                               xyz.x(),
+                                               xyz.y(),
+                                               xyz.z());
+  return values[offset];
+}
+
+}  // namespace
+
+TEST(render_image_vdb, sparse_grid)
+{
+  /* Two far apart voxels, one at a negative coordinate that is not a multiple of the tile size. */
+  openvdb::FloatGrid::Ptr grid = openvdb::FloatGrid::create(0.5f);
+  openvdb::FloatGrid::Accessor accessor = grid->getAccessor();
+  accessor.setValueOn(openvdb::Coord(-5, 3, 3), 1.0f);
+  accessor.setValueOn(openvdb::Coord(203, 203, 203), 2.0f);
+
+  GridImageLoader loader(grid);
+  ImageMetaData metadata;
+  ASSERT_TRUE(loader.load_metadata(metadata));
+  EXPECT_EQ(metadata.type, IMAGE_DATA_TYPE_SPARSE_FLOAT);
+
+  /* The grid is grown to whole tiles aligned like leaf nodes, so each leaf is a single tile. */
+  const openvdb::Coord tiles_min(-8, 0, 0);
+  EXPECT_EQ(metadata.width, 216);
+  EXPECT_EQ(metadata.height, 208);
+  EXPECT_EQ(metadata.depth, 208);
+  const size_t num_tiles = 27 * 26 * 26;
+  EXPECT_EQ(metadata.byte_size, (num_tiles + 1 + 2 * SPARSE_GRID_TILE_NUM_VOXELS) * sizeof(float));
+
+  vector<float> values(metadata.byte_size / sizeof(float));
+  ASSERT_TRUE(loader.load_pixels(metadata, values.data(), values.size(), false));
+
+  EXPECT_EQ(sparse_grid_read(values, metadata, tiles_min, openvdb::Coord(-5, 3, 3)), 1.0f);
+  EXPECT_EQ(sparse_grid_read(values, metadata, tiles_min, openvdb::Coord(203, 203, 203)), 2.0f);
+
+  /* Inactive voxels in stored tiles and voxels of missing tiles have the background value. */
+  EXPECT_EQ(sparse_grid_read(values, metadata, tiles_min, openvdb::Coord(-4, 3, 3)), 0.5f);
+  EXPECT_EQ(sparse_grid_read(values, metadata, tiles_min, openvdb::Coord(100, 100, 100)), 0.5f);
+}
+
+TEST(render_image_vdb, dense_fallback)
+{
+  /* A fully occupied grid uses less memory when stored dense. */
+  openvdb::FloatGrid::Ptr grid = openvdb::FloatGrid::create(0.0f);
+  grid->fill(openvdb::CoordBBox(openvdb::Coord(0, 0, 0), openvdb::Coord(15, 15, 15)), 1.0f);
+
+  GridImageLoader loader(grid);
+  ImageMetaData metadata;
+  ASSERT_TRUE(loader.load_metadata(metadata));
+  EXPECT_EQ(metadata.type, IMAGE_DATA_TYPE_FLOAT);
+  EXPECT_EQ(metadata.byte_size, 0);
+  EXPECT_EQ(metadata.width, 16);
+  EXPECT_EQ(metadata.height, 16);
+  EXPECT_EQ(metadata.depth, 16);
+}
+#endif
+
+CCL_NAMESPACE_END
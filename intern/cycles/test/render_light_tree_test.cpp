@@ -0,0 +1,220 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "render/light_tree.h"
+
+#include "kernel/kernel_compat_cpu.h"
+#include "kernel/kernel_math.h"
+#include "kernel/kernel_types.h"
+#include "kernel/split/kernel_split_data.h"
+#include "kernel/kernel_globals.h"
+#include "kernel/kernel_light_tree.h"
+
+#include "util/util_hash.h"
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+/* Point lights on a grid in the XY plane with varying energy, and a distant light. */
+vector<LightTreePrimitive> light_tree_test_primitives(const int grid_size)
+{
+  vector<LightTreePrimitive> prims;
+  for (int y = 0; y < grid_size; y++) {
+    for (int x = 0; x < grid_size; x++) {
+      LightTreePrimitive prim;
+      prim.emitter_index = (int)prims.size();
+      prim.energy = 1.0f + (float)((x * 7 + y * 3) % 5);
+      prim.bounds.grow(make_float3((float)x, (float)y, 0.0f), 0.1f);
+      prim.bcone = LightTreeBoundingCone(make_float3(0.0f, 0.0f, 1.0f), M_PI_F, M_PI_2_F);
+      prims.push_back(prim);
+    }
+  }
+
+  /* A spot light pointing down, only lighting below the grid. */
+  LightTreePrimitive spot;
+  spot.emitter_index = (int)prims.size();
+  spot.energy = 4.0f;
+  spot.bounds.grow(make_float3(0.5f, 0.5f, 1.0f), 0.1f);
+  spot.bcone = LightTreeBoundingCone(make_float3(0.0f, 0.0f, -1.0f), M_PI_4_F, M_PI_2_F);
+  prims.push_back(spot);
+
+  LightTreePrimitive distant;
+  distant.emitter_index = (int)prims.size();
+  distant.energy = 2.0f;
+  distant.is_distant = true;
+  prims.push_back(distant);
+
+  return prims;
+}
+
+class LightTreeKernelGlobals {
+ public:
+  KernelGlobals kg;
+
+  explicit LightTreeKernelGlobals(LightTree &tree)
+  {
+    kg.__light_tree_nodes.data = tree.nodes.data();
+    kg.__light_tree_nodes.width = tree.nodes.size();
+    kg.__light_tree_emitter_nodes.data = tree.emitter_nodes.data();
+    kg.__light_tree_emitter_nodes.width = tree.emitter_nodes.size();
+  }
+};
+
+}  // namespace
+
+TEST(render_light_tree, build)
+{
+  const vector<LightTreePrimitive> prims = light_tree_test_primitives(8);
+  const int num_emitters = prims.size();
+  LightTree tree(prims, num_emitters);
+
+  ASSERT_EQ(tree.nodes.size(), num_emitters * 2 - 1);
+  ASSERT_EQ(tree.emitter_nodes.size(), num_emitters);
+  EXPECT_EQ(tree.nodes[0].parent_index, -1);
+
+  /* Every emitter has its own leaf. */
+  for (int i = 0; i < num_emitters; i++) {
+    const KernelLightTreeNode &leaf = tree.nodes[tree.emitter_nodes[i]];
+    EXPECT_EQ(leaf.emitter_index, i);
+    EXPECT_EQ(leaf.child_index, -1);
+    EXPECT_FLOAT_EQ(leaf.energy, prims[i].energy);
+  }
+
+  /* Interior nodes contain their children. */
+  for (int i = 0; i < tree.nodes.size(); i++) {
+    const KernelLightTreeNode &node = tree.nodes[i];
+    if (node.emitter_index >= 0) {
+      continue;
+    }
+    const KernelLightTreeNode &left = tree.nodes[i + 1];
+    const KernelLightTreeNode &right = tree.nodes[node.child_index];
+    EXPECT_EQ(left.parent_index, i);
+    EXPECT_EQ(right.parent_index, i);
+    EXPECT_FLOAT_EQ(node.energy, left.energy + right.energy);
+    EXPECT_EQ(node.is_distant, left.is_distant && right.is_distant);
+
+    for (const KernelLightTreeNode *child : {&left, &right}) {
+      if (child->is_distant) {
+        continue;
+      }
+      for (int axis = 0; axis < 3; axis++) {
+        EXPECT_LE(node.bounding_box_min[axis], child->bounding_box_min[axis]);
+        EXPECT_GE(node.bounding_box_max[axis], child->bounding_box_max[axis]);
+      }
+    }
+  }
+}
+
+TEST(render_light_tree, bounding_cone)
+{
+  const float sqrt1_2 = 0.5f * M_SQRT2_F;
+  LightTreeBoundingCone bcone(make_float3(0.0f, 0.0f, 1.0f), 0.0f, M_PI_2_F);
+  bcone.grow(LightTreeBoundingCone(make_float3(1.0f, 0.0f, 0.0f), 0.0f, M_PI_2_F));
+  EXPECT_NEAR(bcone.theta_o, M_PI_4_F, 1e-5f);
+  EXPECT_NEAR(bcone.axis.x, sqrt1_2, 1e-5f);
+  EXPECT_NEAR(bcone.axis.z, sqrt1_2, 1e-5f);
+
+  /* The opposite direction widens the cone past a hemisphere. */
+  bcone.grow(LightTreeBoundingCone(make_float3(-sqrt1_2, 0.0f, -sqrt1_2), 0.0f, 0.0f));
+  EXPECT_NEAR(bcone.theta_o, 0.625f * M_PI_F, 1e-3f);
+
+  /* Until it covers all directions. */
+  bcone.grow(LightTreeBoundingCone(make_float3(0.0f, 0.0f, -1.0f), M_PI_2_F, 0.0f));
+  bcone.grow(LightTreeBoundingCone(make_float3(0.0f, 0.0f, 1.0f), M_PI_2_F, 0.0f));
+  EXPECT_FLOAT_EQ(bcone.theta_o, M_PI_F);
+}
+
+/* The probability of an emitter found by walking up from its leaf matches the one of picking it
+ * by walking down, which multiple importance sampling of lights hit by BSDF samples relies on.
+ * Sampling fails in subtrees where all emitters are culled, so the probabilities only add up to
+ * one without culling. */
+TEST(render_light_tree, pdf_consistency)
+{
+  const vector<LightTreePrimitive> prims = light_tree_test_primitives(8);
+  const int num_emitters = prims.size();
+  LightTree tree(prims, num_emitters);
+  LightTreeKernelGlobals globals(tree);
+  KernelGlobals *kg = &globals.kg;
+
+  const float3 shading_points[][2] = {
+      {make_float3(3.5f, 3.5f, 2.0f), make_float3(0.0f, 0.0f, -1.0f)},
+      {make_float3(-4.0f, 2.0f, 0.5f), make_float3(0.0f, 0.0f, 0.0f)},
+      {make_float3(10.0f, 10.0f, -3.0f), make_float3(0.0f, 0.0f, 1.0f)},
+      {make_float3(0.2f, 0.1f, 0.0f), make_float3(1.0f, 0.0f, 0.0f)},
+  };
+
+  for (int i = 0; i < sizeof(shading_points) / sizeof(*shading_points); i++) {
+    const float3 P = shading_points[i][0];
+    const float3 N = shading_points[i][1];
+
+    float total_pdf = 0.0f;
+    for (int emitter = 0; emitter < num_emitters; emitter++) {
+      total_pdf += light_tree_emitter_pdf(kg, P, N, emitter);
+    }
+    if (is_zero(N)) {
+      EXPECT_NEAR(total_pdf, 1.0f, 1e-4f) << "shading point " << i;
+    }
+    else {
+      EXPECT_GT(total_pdf, 0.0f) << "shading point " << i;
+      EXPECT_LE(total_pdf, 1.0f + 1e-4f) << "shading point " << i;
+    }
+
+    for (int j = 0; j < 256; j++) {
+      float randu = hash_uint2_to_float(i, j);
+      float pdf;
+      const int emitter = light_tree_sample(kg, P, N, &randu, &pdf);
+      if (emitter < 0) {
+        EXPECT_EQ(pdf, 0.0f);
+        continue;
+      }
+      ASSERT_LT(emitter, num_emitters);
+      EXPECT_GT(pdf, 0.0f);
+      EXPECT_NEAR(pdf, light_tree_emitter_pdf(kg, P, N, emitter), pdf * 1e-4f);
+      EXPECT_GE(randu, 0.0f);
+      EXPECT_LT(randu, 1.0f);
+    }
+  }
+}
+
+TEST(render_light_tree, orientation)
+{
+  const vector<LightTreePrimitive> prims = light_tree_test_primitives(8);
+  const int num_emitters = prims.size();
+  LightTree tree(prims, num_emitters);
+  LightTreeKernelGlobals globals(tree);
+  KernelGlobals *kg = &globals.kg;
+
+  const int spot = num_emitters - 2;
+  const int distant = num_emitters - 1;
+
+  /* The spot light only lights below it. */
+  const float3 N = make_float3(0.0f, 0.0f, 0.0f);
+  EXPECT_GT(light_tree_emitter_pdf(kg, make_float3(0.5f, 0.5f, 0.5f), N, spot), 0.0f);
+  EXPECT_EQ(light_tree_emitter_pdf(kg, make_float3(0.5f, 0.5f, 2.0f), N, spot), 0.0f);
+
+  /* Lights behind the surface can't contribute, except for distant lights without bounds. */
+  const float3 P = make_float3(3.5f, 3.5f, 2.0f);
+  const float3 N_up = make_float3(0.0f, 0.0f, 1.0f);
+  for (int emitter = 0; emitter < distant; emitter++) {
+    EXPECT_EQ(light_tree_emitter_pdf(kg, P, N_up, emitter), 0.0f);
+  }
+  EXPECT_GT(light_tree_emitter_pdf(kg, P, N_up, distant), 0.0f);
+}
+
+CCL_NAMESPACE_END
@@ -0,0 +1,106 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "testing/testing.h"
+
+#include "util/util_image.h"
+#include "util/util_path.h"
+#include "util/util_texture.h"
+#include "util/util_texture_cache.h"
+#include "util/util_unique_ptr.h"
+
+#include <OpenImageIO/filesystem.h>
+
+CCL_NAMESPACE_BEGIN
+
+namespace {
+
+const float test_color[4] = {0.25f, 0.5f, 0.75f, 1.0f};
+
+/* Write an image of a constant color, tiled and with all its mip levels when requested. */
+bool write_test_image(const string &filepath, const bool tiled_mipmap)
+{
+  unique_ptr<ImageOutput> out(ImageOutput::create(filepath));
+  if (!out) {
+    return false;
+  }
+
+  ImageSpec spec(64, 64, 4, TypeDesc::FLOAT);
+  if (tiled_mipmap) {
+    spec.tile_width = 16;
+    spec.tile_height = 16;
+    spec.tile_depth = 1;
+  }
+  if (!out->open(filepath, spec)) {
+    return false;
+  }
+
+  while (true) {
+    vector<float> pixels(spec.width * spec.height * 4);
+    for (size_t i = 0; i < pixels.size(); i++) {
+      pixels[i] = test_color[i % 4];
+    }
+    if (!out->write_image(TypeDesc::FLOAT, pixels.data())) {
+      return false;
+    }
+
+    if (!tiled_mipmap || spec.width == 1) {
+      break;
+    }
+
+    spec.width /= 2;
+    spec.height /= 2;
+    if (!out->open(filepath, spec, ImageOutput::AppendMIPLevel)) {
+      return false;
+    }
+  }
+
+  return out->close();
+}
+
+}  // namespace
+
+TEST(util_texture_cache, tiled_mipmap_files_only)
+{
+  const string dir = OIIO::Filesystem::temp_directory_path();
+  const string tiled = path_join(dir, "cycles_texture_cache_test_tiled.tif");
+  const string untiled = path_join(dir, "cycles_texture_cache_test_untiled.tif");
+  ASSERT_TRUE(write_test_image(tiled, true));
+  ASSERT_TRUE(write_test_image(untiled, false));
+
+  /* Untiled files would be read fully into memory by the texture system. */
+  EXPECT_TRUE(TextureCache::image_file_supported(tiled));
+  EXPECT_FALSE(TextureCache::image_file_supported(untiled));
+  EXPECT_FALSE(
+      TextureCache::image_file_supported(path_join(dir, "cycles_texture_cache_test_none.tif")));
+
+  /* Lookups at full resolution and at a coarse mip level. */
+  TextureCache cache(16);
+  const uint64_t handle = cache.image_handle(tiled);
+  for (const float d : {0.0f, 0.25f}) {
+    float result[4];
+    ASSERT_TRUE(texture_cache_lookup(
+        handle, INTERPOLATION_LINEAR, EXTENSION_REPEAT, 0.3f, 0.6f, d, 0.0f, 0.0f, d, result));
+    for (int i = 0; i < 4; i++) {
+      EXPECT_NEAR(result[i], test_color[i], 1e-5f);
+    }
+  }
+
+  path_remove(tiled);
+  path_remove(untiled);
+}
+
+CCL_NAMESPACE_END
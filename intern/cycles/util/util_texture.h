@@ -57,6 +57,8 @@ typedef enum ImageDataType {
   IMAGE_DATA_TYPE_HALF = 5,
   IMAGE_DATA_TYPE_USHORT4 = 6,
   IMAGE_DATA_TYPE_USHORT = 7,
+  IMAGE_DATA_TYPE_SPARSE_FLOAT = 8,
+  IMAGE_DATA_TYPE_SPARSE_FLOAT3 = 9,
 
   IMAGE_DATA_NUM_TYPES
 } ImageDataType;
@@ -73,8 +75,11 @@ typedef enum ImageAlphaType {
   IMAGE_ALPHA_NUM_TYPES,
 } ImageAlphaType;
 
-#define IMAGE_DATA_TYPE_SHIFT 3
-#define IMAGE_DATA_TYPE_MASK 0x7
+#define IMAGE_DATA_TYPE_SHIFT 4
+#define IMAGE_DATA_TYPE_MASK 0xF
+
+#define IMAGE_DATA_TYPE_IS_SPARSE(type) \
+  ((type) == IMAGE_DATA_TYPE_SPARSE_FLOAT || (type) == IMAGE_DATA_TYPE_SPARSE_FLOAT3)
 
 /* Extension types for textures.
  *
@@ -101,11 +106,71 @@ typedef struct TextureInfo {
   uint interpolation, extension;
   /* Dimensions. */
   uint width, height, depth;
+  /* Data is a handle of the texture cache instead of the pixels, CPU only. */
+  uint use_texture_cache;
   /* Transform for 3D textures. */
   uint use_transform_3d;
   Transform transform_3d;
 } TextureInfo;
 
+/* Sparse Grids
+ *
+ * Volume grids are stored in tiles of SPARSE_GRID_TILE_SIZE^3 voxels, the size of OpenVDB leaf
+ * nodes, and only tiles with active voxels are stored. The buffer starts with the offset of the
+ * voxels of every tile of the grid, in floats, followed by the background value and the voxels of
+ * the stored tiles. Tiles that are not stored have offset zero and read the background value.
+ *
+ * The width, height and depth of the texture info are the size of the grid in voxels. */
+
+#define SPARSE_GRID_TILE_SIZE_SHIFT 3
+#define SPARSE_GRID_TILE_SIZE (1 << SPARSE_GRID_TILE_SIZE_SHIFT)
+#define SPARSE_GRID_TILE_MASK (SPARSE_GRID_TILE_SIZE - 1)
+#define SPARSE_GRID_TILE_NUM_VOXELS \
+  (SPARSE_GRID_TILE_SIZE * SPARSE_GRID_TILE_SIZE * SPARSE_GRID_TILE_SIZE)
+
+ccl_device_inline int sparse_grid_num_tiles(const int size)
+{
+  return (size + SPARSE_GRID_TILE_MASK) >> SPARSE_GRID_TILE_SIZE_SHIFT;
+}
+
+/* Offset of the background value, which directly follows the tile offsets. */
+ccl_device_inline uint sparse_grid_background_offset(const int width,
+                                                     const int height,
+                                                     const int depth)
+{
+  return (uint)(sparse_grid_num_tiles(width) * sparse_grid_num_tiles(height) *
+                sparse_grid_num_tiles(depth));
+}
+
+/* Offset of the first channel of a voxel inside of the grid, the offset of the background value
+ * when its tile is not stored. */
+ccl_device_inline uint sparse_grid_voxel_offset(const ccl_global uint *grid,
+                                                const int width,
+                                                const int height,
+                                                const int depth,
+                                                const int channels,
+                                                const int x,
+                                                const int y,
+                                                const int z)
+{
+  const int tile_x = x >> SPARSE_GRID_TILE_SIZE_SHIFT;
+  const int tile_y = y >> SPARSE_GRID_TILE_SIZE_SHIFT;
+  const int tile_z = z >> SPARSE_GRID_TILE_SIZE_SHIFT;
+  const int tile_index = tile_x + sparse_grid_num_tiles(width) *
+                                      (tile_y + sparse_grid_num_tiles(height) * tile_z);
+
+  const uint tile_offset = grid[tile_index];
+  if (tile_offset == 0) {
+    return sparse_grid_background_offset(width, height, depth);
+  }
+
+  const int voxel_index = (x & SPARSE_GRID_TILE_MASK) +
+                          SPARSE_GRID_TILE_SIZE * ((y & SPARSE_GRID_TILE_MASK) +
+                                                   SPARSE_GRID_TILE_SIZE *
+                                                       (z & SPARSE_GRID_TILE_MASK));
+  return tile_offset + voxel_index * channels;
+}
+
 CCL_NAMESPACE_END
 
 #endif /* __UTIL_TEXTURE_H__ */
@@ -0,0 +1,161 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#include "util/util_texture_cache.h"
+
+#include "util/util_foreach.h"
+#include "util/util_image.h"
+#include "util/util_logging.h"
+#include "util/util_texture.h"
+#include "util/util_unique_ptr.h"
+
+#include <OpenImageIO/texture.h>
+
+CCL_NAMESPACE_BEGIN
+
+OIIO_NAMESPACE_USING
+
+struct TextureCache::Image {
+  TextureSystem *texture_system;
+  TextureSystem::TextureHandle *handle;
+};
+
+TextureCache::TextureCache(const size_t max_memory_mb)
+{
+  /* Not shared with OSL, so the memory limit only applies to the images looked up here. */
+  TextureSystem *ts = TextureSystem::create(false);
+
+  /* No automatic tiling or mip mapping, which would read untiled files fully into memory. */
+  ts->attribute("automip", 0);
+  ts->attribute("autotile", 0);
+  ts->attribute("gray_to_rgb", 1);
+  ts->attribute("max_memory_MB", (float)max_memory_mb);
+
+  texture_system = ts;
+
+  VLOG(1) << "Texture cache created with " << max_memory_mb << " MB.";
+}
+
+TextureCache::~TextureCache()
+{
+  foreach (auto &it, images) {
+    delete it.second;
+  }
+
+  TextureSystem *ts = (TextureSystem *)texture_system;
+  VLOG(2) << ts->getstats();
+  TextureSystem::destroy(ts);
+}
+
+bool TextureCache::image_file_supported(const string &filepath)
+{
+  unique_ptr<ImageInput> in(ImageInput::create(filepath));
+  ImageSpec spec;
+  if (!in || !in->open(filepath, spec)) {
+    return false;
+  }
+
+  /* Tiles are read on demand, and a second mip level means the file has a full pyramid. */
+  const bool is_tiled = spec.tile_width > 0;
+  const bool is_mipmapped = in->seek_subimage(0, 1, spec);
+  in->close();
+
+  if (!(is_tiled && is_mipmapped)) {
+    VLOG(1) << "Image " << filepath << " is not tiled and mipmapped, not using the texture cache.";
+    return false;
+  }
+  return true;
+}
+
+uint64_t TextureCache::image_handle(const string &filepath)
+{
+  thread_scoped_lock lock(images_mutex);
+
+  Image *&image = images[filepath];
+  if (image == NULL) {
+    TextureSystem *ts = (TextureSystem *)texture_system;
+    image = new Image();
+    image->texture_system = ts;
+    image->handle = ts->get_texture_handle(ustring(filepath));
+  }
+
+  return (uint64_t)image;
+}
+
+void TextureCache::invalidate(const string &filepath)
+{
+  ((TextureSystem *)texture_system)->invalidate(ustring(filepath));
+}
+
+bool texture_cache_lookup(const uint64_t image_handle,
+                          const int interpolation,
+                          const int extension,
+                          const float x,
+                          const float y,
+                          const float dxdx,
+                          const float dydx,
+                          const float dxdy,
+                          const float dydy,
+                          float result[4])
+{
+  const TextureCache::Image *image = (const TextureCache::Image *)image_handle;
+  if (image->handle == NULL) {
+    return false;
+  }
+
+  TextureOpt options;
+  switch (interpolation) {
+    case INTERPOLATION_CLOSEST:
+      options.interpmode = TextureOpt::InterpClosest;
+      break;
+    case INTERPOLATION_LINEAR:
+      options.interpmode = TextureOpt::InterpBilinear;
+      break;
+    default:
+      options.interpmode = TextureOpt::InterpBicubic;
+      break;
+  }
+
+  switch (extension) {
+    case EXTENSION_REPEAT:
+      options.swrap = options.twrap = TextureOpt::WrapPeriodic;
+      break;
+    case EXTENSION_CLIP:
+      options.swrap = options.twrap = TextureOpt::WrapBlack;
+      break;
+    default:
+      options.swrap = options.twrap = TextureOpt::WrapClamp;
+      break;
+  }
+
+  /* Alpha of images without it. */
+  options.fill = 1.0f;
+
+  /* OpenImageIO has the origin at the top left. */
+  return image->texture_system->texture(image->handle,
+                                        NULL,
+                                        options,
+                                        x,
+                                        1.0f - y,
+                                        dxdx,
+                                        -dydx,
+                                        dxdy,
+                                        -dydy,
+                                        4,
+                                        result);
+}
+
+CCL_NAMESPACE_END
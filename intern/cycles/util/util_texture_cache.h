@@ -0,0 +1,77 @@
+/*
+ * Copyright 2011-2020 Blender Foundation
+ *
+ * Licensed under the Apache License, Version 2.0 (the "License");
+ * you may not use this file except in compliance with the License.
+ * You may obtain a copy of the License at
+ *
+ * http://www.apache.org/licenses/LICENSE-2.0
+ *
+ * Unless required by applicable law or agreed to in writing, software
+ * distributed under the License is distributed on an "AS IS" BASIS,
+ * WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ * See the License for the specific language governing permissions and
+ * limitations under the License.
+ */
+
+#ifndef __UTIL_TEXTURE_CACHE_H__
+#define __UTIL_TEXTURE_CACHE_H__
+
+#include "util/util_map.h"
+#include "util/util_string.h"
+#include "util/util_thread.h"
+#include "util/util_types.h"
+
+CCL_NAMESPACE_BEGIN
+
+/* Texture Cache
+ *
+ * Image files are looked up through an OpenImageIO texture system instead of being loaded into
+ * memory before rendering. Only tiled and mipmapped files are supported, like .tx files created
+ * with maketx, so only the tiles needed by lookups are read. Other files would have to be read
+ * fully to generate their mip levels, so they are loaded into memory as usual. Tiles are kept up
+ * to a fixed memory size, after which the least recently used tiles are freed.
+ *
+ * Lookups happen directly from the kernel, so this is only used by the CPU device. */
+
+class TextureCache {
+ public:
+  explicit TextureCache(const size_t max_memory_mb);
+  ~TextureCache();
+
+  /* Image file opened by the texture system, pointed to by its handle. */
+  struct Image;
+
+  /* Test if the image file is tiled and mipmapped, and so can be looked up through the cache. */
+  static bool image_file_supported(const string &filepath);
+
+  /* Handle of an image file, stored as the data of its texture info. */
+  uint64_t image_handle(const string &filepath);
+
+  /* Reload the image file on the next lookup. */
+  void invalidate(const string &filepath);
+
+ protected:
+  /* OpenImageIO::TextureSystem, not exposed to avoid including OpenImageIO in the kernel. */
+  void *texture_system;
+  map<string, Image *> images;
+  thread_mutex images_mutex;
+};
+
+/* Lookup an image of the texture cache with the derivatives of the coordinates, which select the
+ * mip level. Coordinates are in 0..1 with the origin at the bottom left, as for images loaded in
+ * memory. Returns false when the image can't be read. */
+bool texture_cache_lookup(const uint64_t image_handle,
+                          const int interpolation,
+                          const int extension,
+                          const float x,
+                          const float y,
+                          const float dxdx,
+                          const float dydx,
+                          const float dxdy,
+                          const float dydy,
+                          float result[4]);
+
+CCL_NAMESPACE_END
+
+#endif /* __UTIL_TEXTURE_CACHE_H__ */
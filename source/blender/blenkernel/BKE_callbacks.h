@@ -67,6 +67,8 @@ typedef struct bCallbackFuncStore {
   void (*func)(struct Main *, struct PointerRNA **, const int num_pointers, void *arg);
   void *arg;
   short alloc;
+  /* Optional, returns false when calling func would have no effect. */
+  bool (*poll)(void *arg);
 } bCallbackFuncStore;
 
 void BKE_callback_exec(struct Main *bmain,
@@ -80,6 +82,7 @@ void BKE_callback_exec_id_depsgraph(struct Main *bmain,
                                     struct Depsgraph *depsgraph,
                                     eCbEvent evt);
 void BKE_callback_add(bCallbackFuncStore *funcstore, eCbEvent evt);
+bool BKE_callback_has_handlers(eCbEvent evt);
 
 void BKE_callback_global_init(void);
 void BKE_callback_global_finalize(void);
@@ -70,7 +70,12 @@ typedef enum eCDAllocType {
   CD_CALLOC = 1,
   /** Allocate and set to default. */
   CD_DEFAULT = 2,
-  /** Use data pointers, set layer flag NOFREE. */
+  /**
+   * Use data pointers, set layer flag NOFREE.
+   * When copying from layers which own their data, the data is shared instead: it stays valid as
+   * long as one of the layers uses it, and is copied when a layer is made mutable with
+   * #CustomData_duplicate_referenced_layer.
+   */
   CD_REFERENCE = 3,
   /** Do a full copy of all layers, only allowed if source has same number of elements. */
   CD_DUPLICATE = 4,
@@ -374,7 +379,9 @@ void CustomData_bmesh_set_n(
 void CustomData_bmesh_set_layer_n(struct CustomData *data, void *block, int n, const void *source);
 
 /* set the pointer of to the first layer of type. the old data is not freed.
- * returns the value of ptr if the layer is found, NULL otherwise
+ * returns the value of ptr if the layer is found, NULL otherwise.
+ * Shared layers (see #CD_REFERENCE) drop their reference to the old data instead, which is freed
+ * when no other layer uses it, and reference ptr like referenced layers.
  */
 void *CustomData_set_layer(const struct CustomData *data, int type, void *ptr);
 void *CustomData_set_layer_n(const struct CustomData *data, int type, int n, void *ptr);
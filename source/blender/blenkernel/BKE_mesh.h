@@ -296,6 +296,9 @@ void BKE_mesh_calc_normals_poly(struct MVert *mverts,
 void BKE_mesh_calc_normals(struct Mesh *me);
 void BKE_mesh_ensure_normals(struct Mesh *me);
 void BKE_mesh_ensure_normals_for_display(struct Mesh *mesh);
+void BKE_mesh_normals_tag_dirty(struct Mesh *mesh);
+const float (*BKE_mesh_vertex_normals_ensure(struct Mesh *mesh))[3];
+const float (*BKE_mesh_poly_normals_ensure(struct Mesh *mesh))[3];
 void BKE_mesh_calc_normals_looptri(struct MVert *mverts,
                                    int numVerts,
                                    const struct MLoop *mloop,
@@ -683,6 +686,8 @@ enum {
   BKE_MESH_BATCH_DIRTY_SHADING,
   BKE_MESH_BATCH_DIRTY_UVEDIT_ALL,
   BKE_MESH_BATCH_DIRTY_UVEDIT_SELECT,
+  /** Only vertex positions changed, topology and attributes are the same. */
+  BKE_MESH_BATCH_DIRTY_DEFORM,
 };
 void BKE_mesh_batch_cache_dirty_tag(struct Mesh *me, int mode);
 void BKE_mesh_batch_cache_free(struct Mesh *me);
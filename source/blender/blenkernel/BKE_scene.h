@@ -149,6 +149,16 @@ void BKE_scene_graph_evaluated_ensure(struct Depsgraph *depsgraph, struct Main *
 
 void BKE_scene_graph_update_for_newframe(struct Depsgraph *depsgraph);
 
+typedef void (*SceneGraphBuildFn)(struct Depsgraph *depsgraph, void *user_data);
+typedef bool (*SceneGraphFrameFn)(struct Depsgraph *depsgraph, double frame, void *user_data);
+void BKE_scene_graph_evaluate_frames(struct Depsgraph *depsgraph,
+                                     const double *frames,
+                                     const int frames_num,
+                                     int graphs_num,
+                                     SceneGraphBuildFn build_fn,
+                                     SceneGraphFrameFn frame_fn,
+                                     void *user_data);
+
 void BKE_scene_view_layer_graph_evaluated_ensure(struct Main *bmain,
                                                  struct Scene *scene,
                                                  struct ViewLayer *view_layer);
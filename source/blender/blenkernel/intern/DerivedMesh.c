@@ -797,17 +797,13 @@ static void mesh_calc_modifier_final_normals(const Mesh *mesh_input,
    * (BKE_mesh_calc_normals_split() assumes that if that data exists, it is always valid). */
   if (do_poly_normals) {
     if (!CustomData_has_layer(&mesh_final->pdata, CD_NORMAL)) {
-      float(*polynors)[3] = CustomData_add_layer(
-          &mesh_final->pdata, CD_NORMAL, CD_CALLOC, NULL, mesh_final->totpoly);
-      BKE_mesh_calc_normals_poly(mesh_final->mvert,
-                                 NULL,
-                                 mesh_final->totvert,
-                                 mesh_final->mloop,
-                                 mesh_final->mpoly,
-                                 mesh_final->totloop,
-                                 mesh_final->totpoly,
-                                 polynors,
-                                 false);
+      /* Also calculates the vertex normals, the normals are cached for drawing. */
+      BKE_mesh_vertex_normals_ensure(mesh_final);
+      CustomData_add_layer(&mesh_final->pdata,
+                           CD_NORMAL,
+                           CD_DUPLICATE,
+                           (void *)BKE_mesh_poly_normals_ensure(mesh_final),
+                           mesh_final->totpoly);
     }
   }
 
@@ -1415,17 +1411,13 @@ static void editbmesh_calc_modifier_final_normals(Mesh *mesh_final,
    * (BKE_mesh_calc_normals_split() assumes that if that data exists, it is always valid). */
   if (do_poly_normals) {
     if (!CustomData_has_layer(&mesh_final->pdata, CD_NORMAL)) {
-      float(*polynors)[3] = CustomData_add_layer(
-          &mesh_final->pdata, CD_NORMAL, CD_CALLOC, NULL, mesh_final->totpoly);
-      BKE_mesh_calc_normals_poly(mesh_final->mvert,
-                                 NULL,
-                                 mesh_final->totvert,
-                                 mesh_final->mloop,
-                                 mesh_final->mpoly,
-                                 mesh_final->totloop,
-                                 mesh_final->totpoly,
-                                 polynors,
-                                 false);
+      /* Also calculates the vertex normals, the normals are cached for drawing. */
+      BKE_mesh_vertex_normals_ensure(mesh_final);
+      CustomData_add_layer(&mesh_final->pdata,
+                           CD_NORMAL,
+                           CD_DUPLICATE,
+                           (void *)BKE_mesh_poly_normals_ensure(mesh_final),
+                           mesh_final->totpoly);
     }
   }
 
@@ -1754,6 +1746,59 @@ static void mesh_runtime_check_normals_valid(const Mesh *mesh)
   BLI_assert(!(mesh->runtime.cd_dirty_poly & CD_MASK_NORMAL));
 }
 
+/**
+ * Detach the previous evaluated mesh from the object when its draw cache can possibly be reused
+ * by the new evaluated mesh. This is the case when neither the object nor its original mesh have
+ * been changed, and the modifier stack only deforms the mesh (typically meshes animated with
+ * an armature or shape keys). The caller frees the returned mesh.
+ *
+ * Geometry updates flushed from other data-blocks are tagged with #ID_RECALC_GEOMETRY as well,
+ * changes to the original object or mesh are told apart by their copy-on-write update.
+ */
+static Mesh *mesh_eval_detach_for_batch_cache_reuse(Object *ob)
+{
+  ID *data_eval = ob->runtime.data_eval;
+  if (data_eval == NULL || !ob->runtime.is_data_eval_owned || GS(data_eval->name) != ID_ME) {
+    return NULL;
+  }
+  Mesh *mesh_eval = (Mesh *)data_eval;
+  if (mesh_eval->runtime.batch_cache == NULL || !mesh_eval->runtime.deformed_only) {
+    return NULL;
+  }
+  const Mesh *mesh = (const Mesh *)ob->runtime.data_orig;
+  if (mesh == NULL || ((ob->id.recalc | mesh->id.recalc) & ID_RECALC_COPY_ON_WRITE) ||
+      mesh->adt != NULL) {
+    return NULL;
+  }
+  ob->runtime.is_data_eval_owned = false;
+  return mesh_eval;
+}
+
+/**
+ * Move the draw cache of the previous evaluated mesh to the new one, if they only differ in
+ * vertex positions. The cache is then tagged for a partial update when the evaluation of the
+ * object is finished, see #BKE_object_batch_cache_dirty_tag.
+ */
+static void mesh_eval_batch_cache_reuse(Mesh *mesh_eval_prev,
+                                        Mesh *mesh_eval,
+                                        const bool is_mesh_eval_owned)
+{
+  if (!is_mesh_eval_owned || !mesh_eval->runtime.deformed_only ||
+      mesh_eval->runtime.batch_cache != NULL) {
+    return;
+  }
+  if (mesh_eval_prev->totvert != mesh_eval->totvert ||
+      mesh_eval_prev->totedge != mesh_eval->totedge ||
+      mesh_eval_prev->totloop != mesh_eval->totloop ||
+      mesh_eval_prev->totpoly != mesh_eval->totpoly ||
+      mesh_eval_prev->totcol != mesh_eval->totcol) {
+    return;
+  }
+  mesh_eval->runtime.batch_cache = mesh_eval_prev->runtime.batch_cache;
+  mesh_eval->runtime.is_batch_cache_deformed = true;
+  mesh_eval_prev->runtime.batch_cache = NULL;
+}
+
 static void mesh_build_data(struct Depsgraph *depsgraph,
                             Scene *scene,
                             Object *ob,
@@ -1766,6 +1811,8 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
    * they aren't cleaned up properly on mode switch, causing crashes, e.g T58150. */
   BLI_assert(ob->id.tag & LIB_TAG_COPIED_ON_WRITE);
 
+  Mesh *mesh_eval_prev = mesh_eval_detach_for_batch_cache_reuse(ob);
+
   BKE_object_free_derived_caches(ob);
   if (DEG_is_active(depsgraph)) {
     BKE_sculpt_update_object_before_eval(ob);
@@ -1803,6 +1850,11 @@ static void mesh_build_data(struct Depsgraph *depsgraph,
   const bool is_mesh_eval_owned = (mesh_eval != mesh->runtime.mesh_eval);
   BKE_object_eval_assign_data(ob, &mesh_eval->id, is_mesh_eval_owned);
 
+  if (mesh_eval_prev != NULL) {
+    mesh_eval_batch_cache_reuse(mesh_eval_prev, mesh_eval, is_mesh_eval_owned);
+    BKE_mesh_eval_delete(mesh_eval_prev);
+  }
+
   ob->runtime.mesh_deform_eval = mesh_deform_eval;
   ob->runtime.last_data_mask = *dataMask;
   ob->runtime.last_need_mapping = need_mapping;
@@ -80,6 +80,21 @@ void BKE_callback_add(bCallbackFuncStore *funcstore, eCbEvent evt)
   BLI_addtail(lb, funcstore);
 }
 
+/* Check whether executing the event would call anything, for callers which can skip work when
+ * there are no handlers to run it for. */
+bool BKE_callback_has_handlers(eCbEvent evt)
+{
+  ListBase *lb = &callback_slots[evt];
+  bCallbackFuncStore *funcstore;
+
+  for (funcstore = lb->first; funcstore; funcstore = funcstore->next) {
+    if (funcstore->poll == NULL || funcstore->poll(funcstore->arg)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 void BKE_callback_global_init(void)
 {
   /* do nothing */
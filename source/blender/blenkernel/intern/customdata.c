@@ -58,6 +58,8 @@
 
 #include "BLO_read_write.h"
 
+#include "atomic_ops.h"
+
 #include "bmesh.h"
 
 #include "CLG_log.h"
@@ -2158,6 +2160,134 @@ void CustomData_update_typemap(CustomData *data)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Shared Layer Data
+ *
+ * Copies made with #CD_REFERENCE share the data of layers which own their data, instead of only
+ * pointing to it. The data is freed with the last layer using it, so copies stay valid when the
+ * source is freed, and copying a layer does not depend on the number of elements.
+ *
+ * Layers the data is shared to are treated like referenced layers: the data is copied before the
+ * layer is modified, unless no other layer uses it anymore. The layer the data is shared from
+ * still owns it and is not referenced, it can be modified in place, which is visible to the other
+ * layers like for #CD_REFERENCE. The data is only copied when it is reallocated or explicitly made
+ * mutable while it is shared.
+ * \{ */
+
+typedef struct CustomDataSharing {
+  int users;
+} CustomDataSharing;
+
+/* Share the data of a layer, the returned sharing is to be assigned to the new layer.
+ * The source layer may be shared from multiple threads at the same time. */
+static CustomDataSharing *customData_layer_share(CustomDataLayer *layer)
+{
+  if (layer->sharing == NULL) {
+    CustomDataSharing *sharing = MEM_mallocN(sizeof(*sharing), __func__);
+    sharing->users = 1;
+    if (atomic_cas_ptr((void **)&layer->sharing, NULL, sharing) != NULL) {
+      MEM_freeN(sharing);
+    }
+  }
+  atomic_add_and_fetch_int32(&layer->sharing->users, 1);
+  return layer->sharing;
+}
+
+/* Stop sharing the data of the layer, returns true when the layer was its last user. */
+static bool customData_layer_unshare(CustomDataLayer *layer)
+{
+  CustomDataSharing *sharing = layer->sharing;
+  layer->sharing = NULL;
+  layer->flag &= ~CD_FLAG_SHARED;
+  if (atomic_sub_and_fetch_int32(&sharing->users, 1) == 0) {
+    MEM_freeN(sharing);
+    return true;
+  }
+  return false;
+}
+
+/* Whether the data is referenced or used by other layers, so it can not be reallocated or freed
+ * by this layer alone. */
+static bool customData_layer_data_is_shared(const CustomDataLayer *layer)
+{
+  if (layer->flag & CD_FLAG_NOFREE) {
+    return true;
+  }
+  return (layer->sharing != NULL) && (layer->sharing->users > 1);
+}
+
+/* Whether the layer uses data of another layer, so it must be copied before modifying it. */
+static bool customData_layer_is_referenced(const CustomDataLayer *layer)
+{
+  if (layer->flag & CD_FLAG_NOFREE) {
+    return true;
+  }
+  return (layer->flag & CD_FLAG_SHARED) && (layer->sharing->users > 1);
+}
+
+static void *customData_layer_data_duplicate(const CustomDataLayer *layer, int totelem)
+{
+  /* MEM_dupallocN won't work in case of complex layers, like e.g.
+   * CD_MDEFORMVERT, which has pointers to allocated data...
+   * So in case a custom copy function is defined, use it!
+   */
+  const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
+
+  if (typeInfo->copy) {
+    void *dst_data = MEM_malloc_arrayN((size_t)totelem, typeInfo->size, "CD duplicate ref layer");
+    typeInfo->copy(layer->data, dst_data, totelem);
+    return dst_data;
+  }
+  return MEM_dupallocN(layer->data);
+}
+
+static void customData_layer_data_free(int type, void *data, int totelem)
+{
+  const LayerTypeInfo *typeInfo = layerType_getInfo(type);
+
+  if (typeInfo->free) {
+    typeInfo->free(data, totelem, typeInfo->size);
+  }
+  MEM_freeN(data);
+}
+
+/* Stop sharing the data of the layer before its data pointer is replaced. The layer references
+ * the new data, as the caller used to own the old data when it was referenced instead. */
+static void customData_layer_release_shared(CustomDataLayer *layer)
+{
+  if (layer->sharing == NULL) {
+    return;
+  }
+  void *data = layer->data;
+  if (customData_layer_unshare(layer) && data != NULL) {
+    const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
+    customData_layer_data_free(
+        layer->type, data, (int)(MEM_allocN_len(data) / (size_t)typeInfo->size));
+  }
+  layer->flag |= CD_FLAG_NOFREE;
+}
+
+/* Make sure the layer owns its data, copying it when it is referenced or used by other layers. */
+static void customData_layer_ensure_mutable(CustomDataLayer *layer, int totelem)
+{
+  if (layer->sharing != NULL) {
+    void *data = layer->data;
+    if (customData_layer_data_is_shared(layer)) {
+      layer->data = customData_layer_data_duplicate(layer, totelem);
+    }
+    /* Other users may have been freed in the meantime. */
+    if (customData_layer_unshare(layer) && layer->data != data) {
+      customData_layer_data_free(layer->type, data, totelem);
+    }
+  }
+  else if (layer->flag & CD_FLAG_NOFREE) {
+    layer->data = customData_layer_data_duplicate(layer, totelem);
+    layer->flag &= ~CD_FLAG_NOFREE;
+  }
+}
+
+/** \} */
+
 /* currently only used in BLI_assert */
 #ifndef NDEBUG
 static bool customdata_typemap_is_valid(const CustomData *data)
@@ -2234,6 +2364,19 @@ bool CustomData_merge(const struct CustomData *source,
       newlayer = customData_add_layer__internal(dest, type, alloctype, data, totelem, layer->name);
     }
 
+    if (newlayer && data) {
+      if ((alloctype == CD_REFERENCE) && !(flag & CD_FLAG_NOFREE)) {
+        /* Share the data owned by the source, see #CustomDataSharing. */
+        newlayer->flag &= ~CD_FLAG_NOFREE;
+        newlayer->flag |= CD_FLAG_SHARED;
+        newlayer->sharing = customData_layer_share((CustomDataLayer *)layer);
+      }
+      else if (alloctype == CD_ASSIGN) {
+        newlayer->flag |= flag & CD_FLAG_SHARED;
+        newlayer->sharing = layer->sharing;
+      }
+    }
+
     if (newlayer) {
       newlayer->uid = layer->uid;
 
@@ -2261,6 +2404,9 @@ void CustomData_realloc(CustomData *data, int totelem)
       continue;
     }
     typeInfo = layerType_getInfo(layer->type);
+    if (layer->sharing) {
+      customData_layer_ensure_mutable(layer, (int)(MEM_allocN_len(layer->data) / typeInfo->size));
+    }
     layer->data = MEM_reallocN(layer->data, (size_t)totelem * typeInfo->size);
   }
 }
@@ -2282,18 +2428,12 @@ void CustomData_copy(const struct CustomData *source,
 
 static void customData_free_layer__internal(CustomDataLayer *layer, int totelem)
 {
-  const LayerTypeInfo *typeInfo;
-
+  if (layer->sharing && !customData_layer_unshare(layer)) {
+    /* Data is still used by other layers. */
+    return;
+  }
   if (!(layer->flag & CD_FLAG_NOFREE) && layer->data) {
-    typeInfo = layerType_getInfo(layer->type);
-
-    if (typeInfo->free) {
-      typeInfo->free(layer->data, totelem, typeInfo->size);
-    }
-
-    if (layer->data) {
-      MEM_freeN(layer->data);
-    }
+    customData_layer_data_free(layer->type, layer->data, totelem);
   }
 }
 
@@ -2684,6 +2824,7 @@ static CustomDataLayer *customData_add_layer__internal(CustomData *data,
   data->layers[index].type = type;
   data->layers[index].flag = flag;
   data->layers[index].data = newlayerdata;
+  data->layers[index].sharing = NULL;
 
   /* Set default name if none exists. Note we only call DATA_()  once
    * we know there is a default name, to avoid overhead of locale lookups
@@ -2868,26 +3009,7 @@ static void *customData_duplicate_referenced_layer_index(CustomData *data,
   }
 
   layer = &data->layers[layer_index];
-
-  if (layer->flag & CD_FLAG_NOFREE) {
-    /* MEM_dupallocN won't work in case of complex layers, like e.g.
-     * CD_MDEFORMVERT, which has pointers to allocated data...
-     * So in case a custom copy function is defined, use it!
-     */
-    const LayerTypeInfo *typeInfo = layerType_getInfo(layer->type);
-
-    if (typeInfo->copy) {
-      void *dst_data = MEM_malloc_arrayN(
-          (size_t)totelem, typeInfo->size, "CD duplicate ref layer");
-      typeInfo->copy(layer->data, dst_data, totelem);
-      layer->data = dst_data;
-    }
-    else {
-      layer->data = MEM_dupallocN(layer->data);
-    }
-
-    layer->flag &= ~CD_FLAG_NOFREE;
-  }
+  customData_layer_ensure_mutable(layer, totelem);
 
   return layer->data;
 }
@@ -2941,7 +3063,7 @@ bool CustomData_is_referenced_layer(struct CustomData *data, int type)
 
   layer = &data->layers[layer_index];
 
-  return (layer->flag & CD_FLAG_NOFREE) != 0;
+  return customData_layer_is_referenced(layer);
 }
 
 void CustomData_free_temporary(CustomData *data, int totelem)
@@ -3123,7 +3245,7 @@ void CustomData_free_elem(CustomData *data, int index, int count)
   const LayerTypeInfo *typeInfo;
 
   for (i = 0; i < data->totlayer; i++) {
-    if (!(data->layers[i].flag & CD_FLAG_NOFREE)) {
+    if (!customData_layer_data_is_shared(&data->layers[i])) {
       typeInfo = layerType_getInfo(data->layers[i].type);
 
       if (typeInfo->free) {
@@ -3375,6 +3497,7 @@ void *CustomData_set_layer(const CustomData *data, int type, void *ptr)
     return NULL;
   }
 
+  customData_layer_release_shared(&data->layers[layer_index]);
   data->layers[layer_index].data = ptr;
 
   return ptr;
@@ -3388,6 +3511,7 @@ void *CustomData_set_layer_n(const struct CustomData *data, int type, int n, voi
     return NULL;
   }
 
+  customData_layer_release_shared(&data->layers[layer_index]);
   data->layers[layer_index].data = ptr;
 
   return ptr;
@@ -4004,7 +4128,7 @@ bool CustomData_has_referenced(const struct CustomData *data)
 {
   int i;
   for (i = 0; i < data->totlayer; i++) {
-    if (data->layers[i].flag & CD_FLAG_NOFREE) {
+    if (customData_layer_is_referenced(&data->layers[i])) {
       return true;
     }
   }
@@ -4374,7 +4498,9 @@ void CustomData_file_write_prepare(CustomData *data,
         }
         write_layers_size += chunk_size;
       }
-      write_layers[j++] = *layer;
+      write_layers[j] = *layer;
+      write_layers[j].flag &= ~CD_FLAG_SHARED;
+      write_layers[j++].sharing = NULL;
     }
   }
   BLI_assert(j == data->totlayer);
@@ -5321,7 +5447,8 @@ void CustomData_blend_read(BlendDataReader *reader, CustomData *data, int count)
       layer->flag &= ~CD_FLAG_IN_MEMORY;
     }
 
-    layer->flag &= ~CD_FLAG_NOFREE;
+    layer->flag &= ~(CD_FLAG_NOFREE | CD_FLAG_SHARED);
+    layer->sharing = NULL;
 
     if (CustomData_verify_versions(data, i)) {
       BLO_read_data_address(reader, &layer->data);
@@ -0,0 +1,137 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_customdata.h"
+
+#include "DNA_customdata_types.h"
+
+namespace blender::bke::tests {
+
+static float *customdata_float_layer_add(CustomData *data, const int totelem)
+{
+  CustomData_reset(data);
+  float *values = (float *)CustomData_add_layer(data, CD_PROP_FLOAT, CD_CALLOC, NULL, totelem);
+  for (int i = 0; i < totelem; i++) {
+    values[i] = (float)i;
+  }
+  return values;
+}
+
+TEST(customdata, ReferenceSharesData)
+{
+  CustomData data_a, data_b;
+  float *values_a = customdata_float_layer_add(&data_a, 4);
+  CustomData_copy(&data_a, &data_b, CD_MASK_PROP_FLOAT, CD_REFERENCE, 4);
+
+  float *values_b = (float *)CustomData_get_layer(&data_b, CD_PROP_FLOAT);
+  EXPECT_EQ(values_b, values_a);
+  /* The source still owns the data, only the copy references it. */
+  EXPECT_FALSE(CustomData_is_referenced_layer(&data_a, CD_PROP_FLOAT));
+  EXPECT_FALSE(CustomData_has_referenced(&data_a));
+  EXPECT_TRUE(CustomData_is_referenced_layer(&data_b, CD_PROP_FLOAT));
+  EXPECT_TRUE(CustomData_has_referenced(&data_b));
+
+  /* The copy keeps the data alive. */
+  CustomData_free(&data_a, 4);
+  EXPECT_FALSE(CustomData_is_referenced_layer(&data_b, CD_PROP_FLOAT));
+  EXPECT_EQ(CustomData_duplicate_referenced_layer(&data_b, CD_PROP_FLOAT, 4), values_b);
+  EXPECT_EQ(values_b[3], 3.0f);
+
+  CustomData_free(&data_b, 4);
+}
+
+TEST(customdata, DuplicateSharedLayer)
+{
+  CustomData data_a, data_b;
+  float *values_a = customdata_float_layer_add(&data_a, 4);
+  CustomData_copy(&data_a, &data_b, CD_MASK_PROP_FLOAT, CD_REFERENCE, 4);
+
+  /* Modifying the copy does not change the source. */
+  float *values_b = (float *)CustomData_duplicate_referenced_layer(&data_b, CD_PROP_FLOAT, 4);
+  EXPECT_NE(values_b, values_a);
+  values_b[0] = 10.0f;
+  EXPECT_EQ(values_a[0], 0.0f);
+  EXPECT_FALSE(CustomData_is_referenced_layer(&data_a, CD_PROP_FLOAT));
+  EXPECT_FALSE(CustomData_is_referenced_layer(&data_b, CD_PROP_FLOAT));
+
+  CustomData_free(&data_a, 4);
+  CustomData_free(&data_b, 4);
+}
+
+TEST(customdata, ReallocSharedLayer)
+{
+  CustomData data_a, data_b;
+  float *values_a = customdata_float_layer_add(&data_a, 4);
+  CustomData_copy(&data_a, &data_b, CD_MASK_PROP_FLOAT, CD_REFERENCE, 4);
+
+  /* The source gets its own data when resized, the copy keeps the shared data. */
+  CustomData_realloc(&data_a, 8);
+  EXPECT_NE(CustomData_get_layer(&data_a, CD_PROP_FLOAT), values_a);
+  EXPECT_EQ(CustomData_get_layer(&data_b, CD_PROP_FLOAT), values_a);
+  EXPECT_EQ(values_a[3], 3.0f);
+  EXPECT_FALSE(CustomData_is_referenced_layer(&data_b, CD_PROP_FLOAT));
+
+  CustomData_free(&data_a, 8);
+  CustomData_free(&data_b, 4);
+}
+
+TEST(customdata, SetSharedLayer)
+{
+  CustomData data_a, data_b;
+  float *values_a = customdata_float_layer_add(&data_a, 4);
+  CustomData_copy(&data_a, &data_b, CD_MASK_PROP_FLOAT, CD_REFERENCE, 4);
+
+  /* Replacing the data of one layer keeps the other one valid. */
+  float *values_new = (float *)MEM_callocN(sizeof(float) * 4, __func__);
+  EXPECT_EQ(CustomData_set_layer(&data_a, CD_PROP_FLOAT, values_new), values_new);
+  EXPECT_FALSE(CustomData_is_referenced_layer(&data_b, CD_PROP_FLOAT));
+  EXPECT_EQ(CustomData_get_layer(&data_b, CD_PROP_FLOAT), values_a);
+  EXPECT_EQ(values_a[3], 3.0f);
+
+  /* The replaced data is still owned by the caller. */
+  CustomData_free(&data_a, 4);
+  MEM_freeN(values_new);
+
+  /* Replacing the last user frees the old data. */
+  values_new = (float *)MEM_callocN(sizeof(float) * 4, __func__);
+  CustomData_set_layer(&data_b, CD_PROP_FLOAT, values_new);
+  CustomData_free(&data_b, 4);
+  MEM_freeN(values_new);
+}
+
+TEST(customdata, ReferenceExternalData)
+{
+  float values[4] = {0.0f, 1.0f, 2.0f, 3.0f};
+  CustomData data_a, data_b;
+  CustomData_reset(&data_a);
+  CustomData_add_layer(&data_a, CD_PROP_FLOAT, CD_REFERENCE, values, 4);
+  CustomData_copy(&data_a, &data_b, CD_MASK_PROP_FLOAT, CD_REFERENCE, 4);
+
+  EXPECT_EQ(CustomData_get_layer(&data_b, CD_PROP_FLOAT), values);
+  float *values_b = (float *)CustomData_duplicate_referenced_layer(&data_b, CD_PROP_FLOAT, 4);
+  EXPECT_NE(values_b, values);
+  EXPECT_EQ(values_b[2], 2.0f);
+
+  CustomData_free(&data_a, 4);
+  CustomData_free(&data_b, 4);
+}
+
+}  // namespace blender::bke::tests
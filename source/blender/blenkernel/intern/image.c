@@ -5563,6 +5563,7 @@ bool BKE_image_is_dirty(Image *image)
 void BKE_image_mark_dirty(Image *UNUSED(image), ImBuf *ibuf)
 {
   ibuf->userflags |= IB_BITMAPDIRTY;
+  IMB_mark_changed(ibuf);
 }
 
 bool BKE_image_buffer_format_writable(ImBuf *ibuf)
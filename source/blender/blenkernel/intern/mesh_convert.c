@@ -549,7 +549,7 @@ Mesh *BKE_mesh_new_nomain_from_curve_displist(Object *ob, ListBase *dispbase)
   }
 
   mesh = BKE_mesh_new_nomain(totvert, totedge, 0, totloop, totpoly);
-  mesh->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+  BKE_mesh_normals_tag_dirty(mesh);
 
   memcpy(mesh->mvert, allvert, totvert * sizeof(MVert));
   memcpy(mesh->medge, alledge, totedge * sizeof(MEdge));
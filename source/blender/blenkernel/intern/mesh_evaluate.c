@@ -49,6 +49,7 @@
 #include "BKE_editmesh_cache.h"
 #include "BKE_global.h"
 #include "BKE_mesh.h"
+#include "BKE_mesh_mapping.h"
 #include "BKE_multires.h"
 #include "BKE_report.h"
 
@@ -216,6 +217,7 @@ typedef struct MeshCalcNormalsData {
   MVert *mverts;
   float (*pnors)[3];
   float (*lnors_weighted)[3];
+  const MeshElemMap *vert_loop_map;
   float (*vnors)[3];
 } MeshCalcNormalsData;
 
@@ -273,20 +275,18 @@ static void mesh_calc_normals_poly_prepare_cb(void *__restrict userdata,
 
   /* accumulate angle weighted face normal */
   /* inline version of #accumulate_vertex_normals_poly_v3,
-   * split between this threaded callback and #mesh_calc_normals_poly_accum_cb. */
+   * split between this threaded callback and #mesh_calc_normals_poly_finalize_cb. */
   {
     const float *prev_edge = edgevecbuf[nverts - 1];
 
     for (i = 0; i < nverts; i++) {
-      const int lidx = mp->loopstart + i;
       const float *cur_edge = edgevecbuf[i];
 
       /* calculate angle between the two poly edges incident on
        * this vertex */
       const float fac = saacos(-dot_v3v3(cur_edge, prev_edge));
 
-      /* Store for later accumulation */
-      mul_v3_v3fl(lnors_weighted[lidx], pnor, fac);
+      mul_v3_v3fl(lnors_weighted[mp->loopstart + i], pnor, fac);
 
       prev_edge = cur_edge;
     }
@@ -302,6 +302,16 @@ static void mesh_calc_normals_poly_finalize_cb(void *__restrict userdata,
   MVert *mv = &data->mverts[vidx];
   float *no = data->vnors[vidx];
 
+  /* Sum the loops of the vertex in the same order as #mesh_calc_normals_poly_accumulate,
+   * so the result does not depend on the map being available. */
+  if (data->vert_loop_map) {
+    const MeshElemMap *vert_loops = &data->vert_loop_map[vidx];
+    zero_v3(no);
+    for (int i = 0; i < vert_loops->count; i++) {
+      add_v3_v3(no, data->lnors_weighted[vert_loops->indices[i]]);
+    }
+  }
+
   if (UNLIKELY(normalize_v3(no) == 0.0f)) {
     /* following Mesh convention; we use vertex coordinate itself for normal in this case */
     normalize_v3_v3(no, mv->co);
@@ -310,15 +320,35 @@ static void mesh_calc_normals_poly_finalize_cb(void *__restrict userdata,
   normal_float_to_short_v3(mv->no, no);
 }
 
-void BKE_mesh_calc_normals_poly(MVert *mverts,
-                                float (*r_vertnors)[3],
-                                int numVerts,
-                                const MLoop *mloop,
-                                const MPoly *mpolys,
-                                int numLoops,
-                                int numPolys,
-                                float (*r_polynors)[3],
-                                const bool only_face_normals)
+/* Accumulate the weighted loop normals into the vertex normals, in the order of the polygons.
+ * Not threaded, several loops use the same vertex. */
+static void mesh_calc_normals_poly_accumulate(const MeshCalcNormalsData *data,
+                                              const int numVerts,
+                                              const int numPolys)
+{
+  memset(data->vnors, 0, sizeof(*data->vnors) * (size_t)numVerts);
+  for (int pidx = 0; pidx < numPolys; pidx++) {
+    const MPoly *mp = &data->mpolys[pidx];
+    for (int lidx = mp->loopstart; lidx < mp->loopstart + mp->totloop; lidx++) {
+      add_v3_v3(data->vnors[data->mloop[lidx].v], data->lnors_weighted[lidx]);
+    }
+  }
+}
+
+/**
+ * \param vert_loop_map: Optional map of the loops of each vertex (see
+ * #BKE_mesh_vert_loop_map_create), the vertex normals are summed in parallel when given.
+ */
+static void mesh_calc_normals_poly_ex(MVert *mverts,
+                                      float (*r_vertnors)[3],
+                                      int numVerts,
+                                      const MLoop *mloop,
+                                      const MPoly *mpolys,
+                                      int numLoops,
+                                      int numPolys,
+                                      float (*r_polynors)[3],
+                                      const bool only_face_normals,
+                                      const MeshElemMap *vert_loop_map)
 {
   float(*pnors)[3] = r_polynors;
 
@@ -348,12 +378,9 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
 
   /* first go through and calculate normals for all the polys */
   if (vnors == NULL) {
-    vnors = MEM_calloc_arrayN((size_t)numVerts, sizeof(*vnors), __func__);
+    vnors = MEM_malloc_arrayN((size_t)numVerts, sizeof(*vnors), __func__);
     free_vnors = true;
   }
-  else {
-    memset(vnors, 0, sizeof(*vnors) * (size_t)numVerts);
-  }
 
   MeshCalcNormalsData data = {
       .mpolys = mpolys,
@@ -361,27 +388,265 @@ void BKE_mesh_calc_normals_poly(MVert *mverts,
       .mverts = mverts,
       .pnors = pnors,
       .lnors_weighted = lnors_weighted,
+      .vert_loop_map = vert_loop_map,
       .vnors = vnors,
   };
 
   /* Compute poly normals, and prepare weighted loop normals. */
   BLI_task_parallel_range(0, numPolys, &data, mesh_calc_normals_poly_prepare_cb, &settings);
 
-  /* Actually accumulate weighted loop normals into vertex ones. */
-  /* Unfortunately, not possible to thread that
-   * (not in a reasonable, totally lock- and barrier-free fashion),
-   * since several loops will point to the same vertex... */
-  for (int lidx = 0; lidx < numLoops; lidx++) {
-    add_v3_v3(vnors[mloop[lidx].v], data.lnors_weighted[lidx]);
+  if (vert_loop_map == NULL) {
+    mesh_calc_normals_poly_accumulate(&data, numVerts, numPolys);
   }
 
-  /* Normalize and validate computed vertex normals. */
+  /* Normalize and validate computed vertex normals, summing them first when there is a map. */
   BLI_task_parallel_range(0, numVerts, &data, mesh_calc_normals_poly_finalize_cb, &settings);
 
+  MEM_freeN(lnors_weighted);
   if (free_vnors) {
     MEM_freeN(vnors);
   }
-  MEM_freeN(lnors_weighted);
+}
+
+void BKE_mesh_calc_normals_poly(MVert *mverts,
+                                float (*r_vertnors)[3],
+                                int numVerts,
+                                const MLoop *mloop,
+                                const MPoly *mpolys,
+                                int numLoops,
+                                int numPolys,
+                                float (*r_polynors)[3],
+                                const bool only_face_normals)
+{
+  mesh_calc_normals_poly_ex(mverts,
+                            r_vertnors,
+                            numVerts,
+                            mloop,
+                            mpolys,
+                            numLoops,
+                            numPolys,
+                            r_polynors,
+                            only_face_normals,
+                            NULL);
+}
+
+/**
+ * Mark the normals of the mesh as out of date, after changing vertex coordinates.
+ */
+void BKE_mesh_normals_tag_dirty(Mesh *mesh)
+{
+  mesh->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+  mesh->runtime.vert_normals_dirty = true;
+  mesh->runtime.poly_normals_dirty = true;
+}
+
+/* Hashes of the data the cached normals depend on. Each element is hashed separately and the
+ * hashes are summed, so the result doesn't depend on the order of the threaded reduction. */
+typedef struct MeshNormalsHash {
+  uint64_t topology;
+  /** The topology and the vertex coordinates. */
+  uint64_t geometry;
+} MeshNormalsHash;
+
+BLI_INLINE uint64_t mesh_normals_hash_mix(uint64_t h)
+{
+  /* Finalizer of MurmurHash3. */
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdull;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ull;
+  h ^= h >> 33;
+  return h;
+}
+
+BLI_INLINE uint64_t mesh_normals_hash_pair(const uint32_t a, const uint32_t b)
+{
+  return ((uint64_t)a << 32) | b;
+}
+
+static void mesh_normals_hash_topology_cb(void *__restrict userdata,
+                                          const int pidx,
+                                          const TaskParallelTLS *__restrict tls)
+{
+  const Mesh *mesh = userdata;
+  const MPoly *mp = &mesh->mpoly[pidx];
+  uint64_t hash = mesh_normals_hash_mix(
+      mesh_normals_hash_pair((uint32_t)mp->loopstart, (uint32_t)mp->totloop) ^
+      mesh_normals_hash_mix((uint64_t)pidx));
+  for (int lidx = mp->loopstart; lidx < mp->loopstart + mp->totloop; lidx++) {
+    hash += mesh_normals_hash_mix(mesh_normals_hash_pair(mesh->mloop[lidx].v, (uint32_t)lidx));
+  }
+  *(uint64_t *)tls->userdata_chunk += hash;
+}
+
+static void mesh_normals_hash_coords_cb(void *__restrict userdata,
+                                        const int vidx,
+                                        const TaskParallelTLS *__restrict tls)
+{
+  const Mesh *mesh = userdata;
+  uint32_t co[3];
+  memcpy(co, mesh->mvert[vidx].co, sizeof(co));
+  *(uint64_t *)tls->userdata_chunk += mesh_normals_hash_mix(
+      mesh_normals_hash_pair(co[0], co[1]) ^
+      mesh_normals_hash_mix(mesh_normals_hash_pair(co[2], (uint32_t)vidx)));
+}
+
+static void mesh_normals_hash_reduce(const void *__restrict UNUSED(userdata),
+                                     void *__restrict chunk_join,
+                                     void *__restrict chunk)
+{
+  *(uint64_t *)chunk_join += *(const uint64_t *)chunk;
+}
+
+static MeshNormalsHash mesh_normals_hash(const Mesh *mesh)
+{
+  uint64_t hash = 0;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 4096;
+  settings.userdata_chunk = &hash;
+  settings.userdata_chunk_size = sizeof(hash);
+  settings.func_reduce = mesh_normals_hash_reduce;
+
+  MeshNormalsHash result;
+  BLI_task_parallel_range(
+      0, mesh->totpoly, (void *)mesh, mesh_normals_hash_topology_cb, &settings);
+  result.topology = hash + mesh_normals_hash_mix((uint64_t)mesh->totvert);
+
+  hash = 0;
+  BLI_task_parallel_range(0, mesh->totvert, (void *)mesh, mesh_normals_hash_coords_cb, &settings);
+  result.geometry = result.topology + hash;
+  return result;
+}
+
+/* Reuse the cached array when the size still matches the mesh. */
+static float (*mesh_normals_cache_ensure_len(float (*normals)[3], const int len))[3]
+{
+  const size_t size = sizeof(*normals) * (size_t)len;
+  if (normals != NULL && MEM_allocN_len(normals) == size) {
+    return normals;
+  }
+  MEM_SAFE_FREE(normals);
+  return MEM_malloc_arrayN((size_t)len, sizeof(*normals), __func__);
+}
+
+static bool mesh_normals_cache_is_valid(const float (*normals)[3],
+                                        const bool dirty,
+                                        const uint64_t normals_hash,
+                                        const MeshNormalsHash *hash)
+{
+  return (normals != NULL) && !dirty && (normals_hash == hash->geometry);
+}
+
+/* Calculate all normals, the vertex normals are also copied to the #CD_MVERT layer. */
+static void mesh_calc_normals_cached(Mesh *mesh, const MeshNormalsHash *hash)
+{
+  Mesh_Runtime *runtime = &mesh->runtime;
+  /* Don't write the normals to vertices used by other meshes. */
+  if (CustomData_is_referenced_layer(&mesh->vdata, CD_MVERT)) {
+    mesh->mvert = CustomData_duplicate_referenced_layer(&mesh->vdata, CD_MVERT, mesh->totvert);
+  }
+
+  /* The loops of each vertex are only mapped when the normals are calculated again for the same
+   * topology, e.g. while the mesh is deformed. Building the map costs about as much as summing
+   * the normals without it. */
+  const bool same_topology = (runtime->vert_normals != NULL) &&
+                             (runtime->normals_topology_hash == hash->topology);
+  if (!same_topology) {
+    MEM_SAFE_FREE(runtime->vert_loop_map);
+    MEM_SAFE_FREE(runtime->vert_loop_map_mem);
+  }
+  else if (runtime->vert_loop_map == NULL) {
+    BKE_mesh_vert_loop_map_create(&runtime->vert_loop_map,
+                                  &runtime->vert_loop_map_mem,
+                                  mesh->mpoly,
+                                  mesh->mloop,
+                                  mesh->totvert,
+                                  mesh->totpoly,
+                                  mesh->totloop);
+  }
+
+  runtime->vert_normals = mesh_normals_cache_ensure_len(runtime->vert_normals, mesh->totvert);
+  runtime->poly_normals = mesh_normals_cache_ensure_len(runtime->poly_normals, mesh->totpoly);
+
+  mesh_calc_normals_poly_ex(mesh->mvert,
+                            runtime->vert_normals,
+                            mesh->totvert,
+                            mesh->mloop,
+                            mesh->mpoly,
+                            mesh->totloop,
+                            mesh->totpoly,
+                            runtime->poly_normals,
+                            false,
+                            runtime->vert_loop_map);
+
+  runtime->cd_dirty_vert &= ~CD_MASK_NORMAL;
+  runtime->vert_normals_dirty = false;
+  runtime->poly_normals_dirty = false;
+  runtime->normals_topology_hash = hash->topology;
+  runtime->vert_normals_hash = hash->geometry;
+  runtime->poly_normals_hash = hash->geometry;
+}
+
+/**
+ * Return the vertex normals, only calculated when the mesh changed since the last call.
+ * Also updates the normals in the #CD_MVERT layer.
+ */
+const float (*BKE_mesh_vertex_normals_ensure(Mesh *mesh))[3]
+{
+  Mesh_Runtime *runtime = &mesh->runtime;
+
+  ThreadMutex *mesh_eval_mutex = (ThreadMutex *)runtime->eval_mutex;
+  BLI_mutex_lock(mesh_eval_mutex);
+
+  const MeshNormalsHash hash = mesh_normals_hash(mesh);
+  if (!mesh_normals_cache_is_valid(
+          runtime->vert_normals, runtime->vert_normals_dirty, runtime->vert_normals_hash, &hash)) {
+    mesh_calc_normals_cached(mesh, &hash);
+  }
+
+  BLI_mutex_unlock(mesh_eval_mutex);
+
+  return (const float(*)[3])runtime->vert_normals;
+}
+
+/* Non-locking version of #BKE_mesh_poly_normals_ensure,
+ * for code that is already the only user of the mesh. */
+static const float (*mesh_poly_normals_ensure_nolock(Mesh *mesh))[3]
+{
+  Mesh_Runtime *runtime = &mesh->runtime;
+  const MeshNormalsHash hash = mesh_normals_hash(mesh);
+  if (!mesh_normals_cache_is_valid(
+          runtime->poly_normals, runtime->poly_normals_dirty, runtime->poly_normals_hash, &hash)) {
+    runtime->poly_normals = mesh_normals_cache_ensure_len(runtime->poly_normals, mesh->totpoly);
+    BKE_mesh_calc_normals_poly(mesh->mvert,
+                               NULL,
+                               mesh->totvert,
+                               mesh->mloop,
+                               mesh->mpoly,
+                               mesh->totloop,
+                               mesh->totpoly,
+                               runtime->poly_normals,
+                               true);
+    runtime->poly_normals_dirty = false;
+    runtime->poly_normals_hash = hash.geometry;
+  }
+  return (const float(*)[3])runtime->poly_normals;
+}
+
+/**
+ * Return the polygon normals, only calculated when the mesh changed since the last call.
+ */
+const float (*BKE_mesh_poly_normals_ensure(Mesh *mesh))[3]
+{
+  ThreadMutex *mesh_eval_mutex = (ThreadMutex *)mesh->runtime.eval_mutex;
+  BLI_mutex_lock(mesh_eval_mutex);
+
+  const float(*poly_normals)[3] = mesh_poly_normals_ensure_nolock(mesh);
+
+  BLI_mutex_unlock(mesh_eval_mutex);
+
+  return poly_normals;
 }
 
 void BKE_mesh_ensure_normals(Mesh *mesh)
@@ -421,17 +686,17 @@ void BKE_mesh_ensure_normals_for_display(Mesh *mesh)
     if (do_add_poly_nors_cddata) {
       poly_nors = MEM_malloc_arrayN((size_t)mesh->totpoly, sizeof(*poly_nors), __func__);
     }
+    else {
+      poly_nors = CustomData_duplicate_referenced_layer(&mesh->pdata, CD_NORMAL, mesh->totpoly);
+    }
 
     /* calculate poly/vert normals */
-    BKE_mesh_calc_normals_poly(mesh->mvert,
-                               NULL,
-                               mesh->totvert,
-                               mesh->mloop,
-                               mesh->mpoly,
-                               mesh->totloop,
-                               mesh->totpoly,
-                               poly_nors,
-                               !do_vert_normals);
+    if (do_vert_normals) {
+      BKE_mesh_calc_normals(mesh);
+    }
+    memcpy(poly_nors,
+           mesh_poly_normals_ensure_nolock(mesh),
+           sizeof(*poly_nors) * (size_t)mesh->totpoly);
 
     if (do_add_poly_nors_cddata) {
       CustomData_add_layer(&mesh->pdata, CD_NORMAL, CD_ASSIGN, poly_nors, mesh->totpoly);
@@ -443,25 +708,17 @@ void BKE_mesh_ensure_normals_for_display(Mesh *mesh)
 }
 
 /* Note that this does not update the CD_NORMAL layer,
- * but does update the normals in the CD_MVERT layer. */
+ * but does update the normals in the CD_MVERT layer and the cached normals. */
 void BKE_mesh_calc_normals(Mesh *mesh)
 {
 #ifdef DEBUG_TIME
   TIMEIT_START_AVERAGED(BKE_mesh_calc_normals);
 #endif
-  BKE_mesh_calc_normals_poly(mesh->mvert,
-                             NULL,
-                             mesh->totvert,
-                             mesh->mloop,
-                             mesh->mpoly,
-                             mesh->totloop,
-                             mesh->totpoly,
-                             NULL,
-                             false);
+  const MeshNormalsHash hash = mesh_normals_hash(mesh);
+  mesh_calc_normals_cached(mesh, &hash);
 #ifdef DEBUG_TIME
   TIMEIT_END_AVERAGED(BKE_mesh_calc_normals);
 #endif
-  mesh->runtime.cd_dirty_vert &= ~CD_MASK_NORMAL;
 }
 
 void BKE_mesh_calc_normals_looptri(MVert *mverts,
@@ -813,6 +1070,10 @@ typedef struct LoopSplitTaskDataCommon {
   int (*edge_to_loops)[2];
   int *loop_to_poly;
   const float (*polynors)[3];
+  /** Per loop, whether a fan of loops starts there, see #loop_split_entry_tag_cb. */
+  char *loop_entry;
+  /** Loops known not to be the first of their cyclic smooth fan, set atomically. */
+  BLI_bitmap *skip_loops;
 
   int numEdges;
   int numLoops;
@@ -1316,54 +1577,29 @@ static void loop_split_worker_do(LoopSplitTaskDataCommon *common_data,
   }
 }
 
-static void loop_split_worker(TaskPool *__restrict pool, void *taskdata)
-{
-  LoopSplitTaskDataCommon *common_data = BLI_task_pool_user_data(pool);
-  LoopSplitTaskData *data = taskdata;
-
-  /* Temp edge vectors stack, only used when computing lnor spacearr. */
-  BLI_Stack *edge_vectors = common_data->lnors_spacearr ?
-                                BLI_stack_new(sizeof(float[3]), __func__) :
-                                NULL;
-
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_worker);
-#endif
-
-  for (int i = 0; i < LOOP_SPLIT_TASK_BLOCK_SIZE; i++, data++) {
-    /* A NULL ml_curr is used to tag ended data! */
-    if (data->ml_curr == NULL) {
-      break;
-    }
-
-    loop_split_worker_do(common_data, data, edge_vectors);
-  }
-
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
-  }
-
-#ifdef DEBUG_TIME
-  TIMEIT_END_AVERAGED(loop_split_worker);
-#endif
-}
-
 /**
- * Check whether given loop is part of an unknown-so-far cyclic smooth fan, or not.
+ * Check whether given loop is the first one of a cyclic smooth fan, or not.
  * Needed because cyclic smooth fans have no obvious 'entry point',
  * and yet we need to walk them once, and only once.
+ *
+ * The first loop is the one processed first when looping over polygons and their loops,
+ * it only depends on the fan itself so all loops can be checked in parallel.
+ *
+ * The loops walked over before finding an earlier one are tagged in \a skip_loops,
+ * so they don't walk the fan again: each fan is walked about once instead of once per loop.
  */
-static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
-                                                         const MPoly *mpolys,
-                                                         const int (*edge_to_loops)[2],
-                                                         const int *loop_to_poly,
-                                                         const int *e2l_prev,
-                                                         BLI_bitmap *skip_loops,
-                                                         const MLoop *ml_curr,
-                                                         const MLoop *ml_prev,
-                                                         const int ml_curr_index,
-                                                         const int ml_prev_index,
-                                                         const int mp_curr_index)
+static bool loop_split_cyclic_smooth_fan_is_first(const MLoop *mloops,
+                                                  const MPoly *mpolys,
+                                                  const int (*edge_to_loops)[2],
+                                                  const int *loop_to_poly,
+                                                  BLI_bitmap *skip_loops,
+                                                  const int *e2l_prev,
+                                                  const MLoop *ml_curr,
+                                                  const MLoop *ml_prev,
+                                                  const int ml_curr_index,
+                                                  const int ml_prev_index,
+                                                  const int mp_curr_index,
+                                                  const int numLoops)
 {
   const unsigned int mv_pivot_index = ml_curr->v; /* The vertex we are "fanning" around! */
   const int *e2lfan_curr;
@@ -1386,10 +1622,9 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
   BLI_assert(mlfan_vert_index >= 0);
   BLI_assert(mpfan_curr_index >= 0);
 
-  BLI_assert(!BLI_BITMAP_TEST(skip_loops, mlfan_vert_index));
-  BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
-
-  while (true) {
+  /* Without the tagging of visited loops, degenerate geometry could make us walk a cycle that
+   * doesn't contain the initial loop, stop after as many steps as there are loops. */
+  for (int step = 0; step < numLoops; step++) {
     /* Find next loop of the smooth fan. */
     BKE_mesh_loop_manifold_fan_around_vert_next(mloops,
                                                 mpolys,
@@ -1408,192 +1643,222 @@ static bool loop_split_generator_check_cyclic_smooth_fan(const MLoop *mloops,
       return false;
     }
     /* Smooth loop/edge... */
-    if (BLI_BITMAP_TEST(skip_loops, mlfan_vert_index)) {
-      if (mlfan_vert_index == ml_curr_index) {
-        /* We walked around a whole cyclic smooth fan without finding any already-processed loop,
-         * means we can use initial ml_curr/ml_prev edge as start for this smooth fan. */
-        return true;
-      }
-      /* ... already checked in some previous looping, we can abort. */
+    if (mlfan_vert_index == ml_curr_index) {
+      /* We walked around a whole cyclic smooth fan without finding any loop processed before
+       * the initial one, means we can use initial ml_curr/ml_prev edge as start for this
+       * smooth fan. */
+      return true;
+    }
+    if ((mpfan_curr_index < mp_curr_index) ||
+        (mpfan_curr_index == mp_curr_index && mlfan_vert_index < ml_curr_index)) {
+      /* ... the fan is processed from a previous loop, we can abort. */
       return false;
     }
-
-    /* ... we can skip it in future, and keep checking the smooth fan. */
-    BLI_BITMAP_ENABLE(skip_loops, mlfan_vert_index);
+    /* Comes after the initial loop, so it can't be the first one of the fan. */
+    BLI_BITMAP_TEST_AND_SET_ATOMIC(skip_loops, mlfan_vert_index);
   }
+  return false;
 }
 
-static void loop_split_generator(TaskPool *pool, LoopSplitTaskDataCommon *common_data)
-{
-  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
-  float(*loopnors)[3] = common_data->loopnors;
+/** Type of the fan starting at a loop, see #loop_split_entry_tag_cb. */
+enum {
+  LOOP_SPLIT_ENTRY_NONE = 0,
+  LOOP_SPLIT_ENTRY_SINGLE = 1,
+  LOOP_SPLIT_ENTRY_FAN = 2,
+};
 
+/**
+ * Find the loops where the fans of loops sharing the same normal start.
+ */
+static void loop_split_entry_tag_cb(void *__restrict userdata,
+                                    const int mp_index,
+                                    const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  LoopSplitTaskDataCommon *common_data = userdata;
   const MLoop *mloops = common_data->mloops;
   const MPoly *mpolys = common_data->mpolys;
   const int *loop_to_poly = common_data->loop_to_poly;
   const int(*edge_to_loops)[2] = common_data->edge_to_loops;
-  const int numLoops = common_data->numLoops;
-  const int numPolys = common_data->numPolys;
+  char *loop_entry = common_data->loop_entry;
+  BLI_bitmap *skip_loops = common_data->skip_loops;
+
+  const MPoly *mp = &mpolys[mp_index];
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  int ml_curr_index = mp->loopstart;
+  int ml_prev_index = ml_last_index;
+
+  for (; ml_curr_index <= ml_last_index; ml_curr_index++) {
+    const MLoop *ml_curr = &mloops[ml_curr_index];
+    const MLoop *ml_prev = &mloops[ml_prev_index];
+    const int *e2l_curr = edge_to_loops[ml_curr->e];
+    const int *e2l_prev = edge_to_loops[ml_prev->e];
+
+    /* A smooth edge, we have to check for cyclic smooth fan case.
+     * If this loop is the first one of a cyclic smooth fan, we can use it as 'entry point',
+     * otherwise we can skip it.
+     *
+     * We *do not need* to check/tag loops as already computed!
+     * Due to the fact a loop only links to one of its two edges,
+     * a same fan *will never be walked more than once!*
+     * Since we consider edges having neighbor polys with inverted
+     * (flipped) normals as sharp, we are sure that no fan will be skipped,
+     * even only considering the case (sharp curr_edge, smooth prev_edge),
+     * and not the alternative (smooth curr_edge, sharp prev_edge).
+     * All this due/thanks to link between normals and loop ordering (i.e. winding). */
+    if (IS_EDGE_SHARP(e2l_curr)) {
+      loop_entry[ml_curr_index] = IS_EDGE_SHARP(e2l_prev) ? LOOP_SPLIT_ENTRY_SINGLE :
+                                                            LOOP_SPLIT_ENTRY_FAN;
+    }
+    else if (!BLI_BITMAP_TEST(skip_loops, ml_curr_index) &&
+             loop_split_cyclic_smooth_fan_is_first(mloops,
+                                                   mpolys,
+                                                   edge_to_loops,
+                                                   loop_to_poly,
+                                                   skip_loops,
+                                                   e2l_prev,
+                                                   ml_curr,
+                                                   ml_prev,
+                                                   ml_curr_index,
+                                                   ml_prev_index,
+                                                   mp_index,
+                                                   common_data->numLoops)) {
+      loop_entry[ml_curr_index] = LOOP_SPLIT_ENTRY_FAN;
+    }
+    else {
+      loop_entry[ml_curr_index] = LOOP_SPLIT_ENTRY_NONE;
+    }
 
-  const MPoly *mp;
-  int mp_index;
+    ml_prev_index = ml_curr_index;
+  }
+}
 
-  const MLoop *ml_curr;
-  const MLoop *ml_prev;
-  int ml_curr_index;
-  int ml_prev_index;
+typedef struct LoopSplitTLSData {
+  /* Temp edge vectors stack, only used when computing lnor spacearr. */
+  BLI_Stack *edge_vectors;
+} LoopSplitTLSData;
 
-  BLI_bitmap *skip_loops = BLI_BITMAP_NEW(numLoops, __func__);
+static void loop_split_fan_cb(void *__restrict userdata,
+                              const int mp_index,
+                              const TaskParallelTLS *__restrict tls)
+{
+  LoopSplitTaskDataCommon *common_data = userdata;
+  LoopSplitTLSData *tls_data = tls->userdata_chunk;
+  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
+  float(*loopnors)[3] = common_data->loopnors;
+  const MLoop *mloops = common_data->mloops;
+  const int(*edge_to_loops)[2] = common_data->edge_to_loops;
+  const char *loop_entry = common_data->loop_entry;
 
-  LoopSplitTaskData *data_buff = NULL;
-  int data_idx = 0;
+  const MPoly *mp = &common_data->mpolys[mp_index];
+  const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
+  int ml_curr_index = mp->loopstart;
+  int ml_prev_index = ml_last_index;
 
-  /* Temp edge vectors stack, only used when computing lnor spacearr
-   * (and we are not multi-threading). */
-  BLI_Stack *edge_vectors = NULL;
+  for (; ml_curr_index <= ml_last_index; ml_prev_index = ml_curr_index++) {
+    if (loop_entry[ml_curr_index] == LOOP_SPLIT_ENTRY_NONE) {
+      continue;
+    }
 
-#ifdef DEBUG_TIME
-  TIMEIT_START_AVERAGED(loop_split_generator);
-#endif
+    LoopSplitTaskData data = {NULL};
+    data.ml_curr = &mloops[ml_curr_index];
+    data.ml_prev = &mloops[ml_prev_index];
+    data.ml_curr_index = ml_curr_index;
+    data.mp_index = mp_index;
+    if (loop_entry[ml_curr_index] == LOOP_SPLIT_ENTRY_SINGLE) {
+      data.lnor = &loopnors[ml_curr_index];
+    }
+    else {
+      data.ml_prev_index = ml_prev_index;
+      data.e2l_prev = edge_to_loops[data.ml_prev->e]; /* Also tag as 'fan' task. */
+    }
 
-  if (!pool) {
     if (lnors_spacearr) {
-      edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+      /* Allocated before, see #loop_split_spaces_create. */
+      data.lnor_space = lnors_spacearr->lspacearr[ml_curr_index];
+      if (data.e2l_prev && tls_data->edge_vectors == NULL) {
+        tls_data->edge_vectors = BLI_stack_new(sizeof(float[3]), __func__);
+      }
     }
+
+    loop_split_worker_do(common_data, &data, tls_data->edge_vectors);
   }
+}
 
-  /* We now know edges that can be smoothed (with their vector, and their two loops),
-   * and edges that will be hard! Now, time to generate the normals.
-   */
-  for (mp = mpolys, mp_index = 0; mp_index < numPolys; mp++, mp_index++) {
-    float(*lnors)[3];
-    const int ml_last_index = (mp->loopstart + mp->totloop) - 1;
-    ml_curr_index = mp->loopstart;
-    ml_prev_index = ml_last_index;
+static void loop_split_fan_free(const void *__restrict UNUSED(userdata), void *__restrict chunk)
+{
+  LoopSplitTLSData *tls_data = chunk;
+  if (tls_data->edge_vectors) {
+    BLI_stack_free(tls_data->edge_vectors);
+  }
+}
 
-    ml_curr = &mloops[ml_curr_index];
-    ml_prev = &mloops[ml_prev_index];
-    lnors = &loopnors[ml_curr_index];
+/**
+ * The memarena of the lnor spacearr is not threadsafe,
+ * so the spaces of all fans are allocated at once, and assigned to their first loop.
+ */
+static void loop_split_spaces_create(LoopSplitTaskDataCommon *common_data)
+{
+  MLoopNorSpaceArray *lnors_spacearr = common_data->lnors_spacearr;
+  const char *loop_entry = common_data->loop_entry;
+  const int numLoops = common_data->numLoops;
 
-    for (; ml_curr_index <= ml_last_index; ml_curr++, ml_curr_index++, lnors++) {
-      const int *e2l_curr = edge_to_loops[ml_curr->e];
-      const int *e2l_prev = edge_to_loops[ml_prev->e];
+  int spaces_len = 0;
+  for (int ml_index = 0; ml_index < numLoops; ml_index++) {
+    spaces_len += (loop_entry[ml_index] != LOOP_SPLIT_ENTRY_NONE);
+  }
+  if (spaces_len == 0) {
+    return;
+  }
 
-#if 0
-      printf("Checking loop %d / edge %u / vert %u (sharp edge: %d, skiploop: %d)...",
-             ml_curr_index,
-             ml_curr->e,
-             ml_curr->v,
-             IS_EDGE_SHARP(e2l_curr),
-             BLI_BITMAP_TEST_BOOL(skip_loops, ml_curr_index));
-#endif
+  MLoopNorSpace *lnor_space = BLI_memarena_calloc(lnors_spacearr->mem,
+                                                  sizeof(*lnor_space) * (size_t)spaces_len);
+  lnors_spacearr->num_spaces += spaces_len;
+  for (int ml_index = 0; ml_index < numLoops; ml_index++) {
+    if (loop_entry[ml_index] != LOOP_SPLIT_ENTRY_NONE) {
+      lnors_spacearr->lspacearr[ml_index] = lnor_space++;
+    }
+  }
+}
 
-      /* A smooth edge, we have to check for cyclic smooth fan case.
-       * If we find a new, never-processed cyclic smooth fan, we can do it now using that loop/edge
-       * as 'entry point', otherwise we can skip it. */
-
-      /* Note: In theory, we could make loop_split_generator_check_cyclic_smooth_fan() store
-       * mlfan_vert_index'es and edge indexes in two stacks, to avoid having to fan again around
-       * the vert during actual computation of clnor & clnorspace. However, this would complicate
-       * the code, add more memory usage, and despite its logical complexity,
-       * loop_manifold_fan_around_vert_next() is quite cheap in term of CPU cycles,
-       * so really think it's not worth it. */
-      if (!IS_EDGE_SHARP(e2l_curr) && (BLI_BITMAP_TEST(skip_loops, ml_curr_index) ||
-                                       !loop_split_generator_check_cyclic_smooth_fan(mloops,
-                                                                                     mpolys,
-                                                                                     edge_to_loops,
-                                                                                     loop_to_poly,
-                                                                                     e2l_prev,
-                                                                                     skip_loops,
-                                                                                     ml_curr,
-                                                                                     ml_prev,
-                                                                                     ml_curr_index,
-                                                                                     ml_prev_index,
-                                                                                     mp_index))) {
-        //              printf("SKIPPING!\n");
-      }
-      else {
-        LoopSplitTaskData *data, data_local;
+/**
+ * Compute the normals of all fans in parallel:
+ * first find the loops where the fans start, then walk each fan from its first loop.
+ */
+static void loop_split_generator(LoopSplitTaskDataCommon *common_data)
+{
+  const int numLoops = common_data->numLoops;
+  const int numPolys = common_data->numPolys;
 
-        //              printf("PROCESSING!\n");
+#ifdef DEBUG_TIME
+  TIMEIT_START_AVERAGED(loop_split_generator);
+#endif
 
-        if (pool) {
-          if (data_idx == 0) {
-            data_buff = MEM_calloc_arrayN(
-                LOOP_SPLIT_TASK_BLOCK_SIZE, sizeof(*data_buff), __func__);
-          }
-          data = &data_buff[data_idx];
-        }
-        else {
-          data = &data_local;
-          memset(data, 0, sizeof(*data));
-        }
+  common_data->loop_entry = MEM_malloc_arrayN((size_t)numLoops, sizeof(char), __func__);
+  common_data->skip_loops = BLI_BITMAP_NEW((size_t)numLoops, __func__);
 
-        if (IS_EDGE_SHARP(e2l_curr) && IS_EDGE_SHARP(e2l_prev)) {
-          data->lnor = lnors;
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-#if 0 /* Not needed for 'single' loop. */
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = NULL; /* Tag as 'single' task. */
-#endif
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
-        /* We *do not need* to check/tag loops as already computed!
-         * Due to the fact a loop only links to one of its two edges,
-         * a same fan *will never be walked more than once!*
-         * Since we consider edges having neighbor polys with inverted
-         * (flipped) normals as sharp, we are sure that no fan will be skipped,
-         * even only considering the case (sharp curr_edge, smooth prev_edge),
-         * and not the alternative (smooth curr_edge, sharp prev_edge).
-         * All this due/thanks to link between normals and loop ordering (i.e. winding).
-         */
-        else {
-#if 0 /* Not needed for 'fan' loops. */
-          data->lnor = lnors;
-#endif
-          data->ml_curr = ml_curr;
-          data->ml_prev = ml_prev;
-          data->ml_curr_index = ml_curr_index;
-          data->ml_prev_index = ml_prev_index;
-          data->e2l_prev = e2l_prev; /* Also tag as 'fan' task. */
-          data->mp_index = mp_index;
-          if (lnors_spacearr) {
-            data->lnor_space = BKE_lnor_space_create(lnors_spacearr);
-          }
-        }
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  /* Not enough loops to be worth the whole threading overhead... */
+  settings.use_threading = (numLoops >= LOOP_SPLIT_TASK_BLOCK_SIZE * 8);
+  settings.min_iter_per_thread = LOOP_SPLIT_TASK_BLOCK_SIZE;
 
-        if (pool) {
-          data_idx++;
-          if (data_idx == LOOP_SPLIT_TASK_BLOCK_SIZE) {
-            BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
-            data_idx = 0;
-          }
-        }
-        else {
-          loop_split_worker_do(common_data, data, edge_vectors);
-        }
-      }
+  BLI_task_parallel_range(0, numPolys, common_data, loop_split_entry_tag_cb, &settings);
 
-      ml_prev = ml_curr;
-      ml_prev_index = ml_curr_index;
-    }
-  }
+  MEM_freeN(common_data->skip_loops);
+  common_data->skip_loops = NULL;
 
-  /* Last block of data... Since it is calloc'ed and we use first NULL item as stopper,
-   * everything is fine. */
-  if (pool && data_idx) {
-    BLI_task_pool_push(pool, loop_split_worker, data_buff, true, NULL);
+  if (common_data->lnors_spacearr) {
+    loop_split_spaces_create(common_data);
   }
 
-  if (edge_vectors) {
-    BLI_stack_free(edge_vectors);
-  }
-  MEM_freeN(skip_loops);
+  LoopSplitTLSData tls_data = {NULL};
+  settings.userdata_chunk = &tls_data;
+  settings.userdata_chunk_size = sizeof(tls_data);
+  settings.func_free = loop_split_fan_free;
+  BLI_task_parallel_range(0, numPolys, common_data, loop_split_fan_cb, &settings);
+
+  MEM_freeN(common_data->loop_entry);
+  common_data->loop_entry = NULL;
 
 #ifdef DEBUG_TIME
   TIMEIT_END_AVERAGED(loop_split_generator);
@@ -1714,19 +1979,7 @@ void BKE_mesh_normals_loop_split(const MVert *mverts,
   /* This first loop check which edges are actually smooth, and compute edge vectors. */
   mesh_edges_sharp_tag(&common_data, check_angle, split_angle, false);
 
-  if (numLoops < LOOP_SPLIT_TASK_BLOCK_SIZE * 8) {
-    /* Not enough loops to be worth the whole threading overhead... */
-    loop_split_generator(NULL, &common_data);
-  }
-  else {
-    TaskPool *task_pool = BLI_task_pool_create(&common_data, TASK_PRIORITY_HIGH);
-
-    loop_split_generator(task_pool, &common_data);
-
-    BLI_task_pool_work_and_wait(task_pool);
-
-    BLI_task_pool_free(task_pool);
-  }
+  loop_split_generator(&common_data);
 
   MEM_freeN(edge_to_loops);
   if (!r_loop_to_poly) {
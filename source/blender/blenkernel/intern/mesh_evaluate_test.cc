@@ -0,0 +1,311 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <utility>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+#include "BLI_timeit.hh"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_mesh_runtime.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "tests/mesh_testing.hh"
+
+namespace blender::bke::tests {
+
+TEST(mesh_evaluate, NormalsCache)
+{
+  BKE_idtype_init();
+  Mesh *mesh = mesh_grid_create(64);
+  const float up[3] = {0.0f, 0.0f, 1.0f};
+
+  const float(*vert_normals)[3] = BKE_mesh_vertex_normals_ensure(mesh);
+  const float(*poly_normals)[3] = BKE_mesh_poly_normals_ensure(mesh);
+  for (int i = 0; i < mesh->totvert; i++) {
+    EXPECT_V3_NEAR(vert_normals[i], up, 1e-6f);
+    EXPECT_EQ(mesh->mvert[i].no[2], SHRT_MAX);
+  }
+  for (int i = 0; i < mesh->totpoly; i++) {
+    EXPECT_V3_NEAR(poly_normals[i], up, 1e-6f);
+  }
+
+  /* Not recalculated when the mesh didn't change, the vertex normal isn't written again. */
+  mesh->mvert[0].no[2] = 0;
+  BKE_mesh_vertex_normals_ensure(mesh);
+  EXPECT_EQ(mesh->mvert[0].no[2], 0);
+
+  /* Recalculated when a coordinate changed, also when the normals weren't tagged dirty. */
+  mesh->mvert[0].co[2] = 1.0f;
+  vert_normals = BKE_mesh_vertex_normals_ensure(mesh);
+  poly_normals = BKE_mesh_poly_normals_ensure(mesh);
+  EXPECT_LT(poly_normals[0][2], 1.0f);
+  EXPECT_LT(vert_normals[0][2], 1.0f);
+  EXPECT_LT(vert_normals[1][2], 1.0f);
+  EXPECT_GT(mesh->mvert[0].no[2], 0);
+  EXPECT_LT(mesh->mvert[0].no[2], SHRT_MAX);
+  EXPECT_V3_NEAR(vert_normals[mesh->totvert - 1], up, 1e-6f);
+  EXPECT_V3_NEAR(poly_normals[mesh->totpoly - 1], up, 1e-6f);
+
+  /* Polygon normals alone are also recalculated. */
+  mesh->mvert[0].co[2] = 0.0f;
+  EXPECT_V3_NEAR(BKE_mesh_poly_normals_ensure(mesh)[0], up, 1e-6f);
+
+  /* Tagging the normals dirty recalculates them. */
+  mesh->mvert[0].no[2] = 0;
+  BKE_mesh_normals_tag_dirty(mesh);
+  EXPECT_V3_NEAR(BKE_mesh_vertex_normals_ensure(mesh)[0], up, 1e-6f);
+  EXPECT_EQ(mesh->mvert[0].no[2], SHRT_MAX);
+
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST(mesh_evaluate, NormalsDeterministic)
+{
+  BKE_idtype_init();
+  const int size = 101;
+  Mesh *mesh = mesh_grid_create(size);
+  for (int i = 0; i < mesh->totvert; i++) {
+    mesh->mvert[i].co[2] = (float)((i * 7919) % 101) * 0.01f;
+  }
+
+  /* Vertex normals are summed in a fixed order, so threading doesn't change the result. The
+   * first calculation sums them without the map of the loops of each vertex, the following ones
+   * with the map. */
+  float(*vert_normals)[3] = (float(*)[3])MEM_malloc_arrayN(
+      mesh->totvert, sizeof(float[3]), __func__);
+  memcpy(vert_normals, BKE_mesh_vertex_normals_ensure(mesh), sizeof(float[3]) * mesh->totvert);
+  EXPECT_EQ(mesh->runtime.vert_loop_map, nullptr);
+  for (int iter = 0; iter < 4; iter++) {
+    BKE_mesh_normals_tag_dirty(mesh);
+    EXPECT_EQ(memcmp(BKE_mesh_vertex_normals_ensure(mesh),
+                     vert_normals,
+                     sizeof(float[3]) * mesh->totvert),
+              0);
+    EXPECT_NE(mesh->runtime.vert_loop_map, nullptr);
+  }
+
+  /* The map is freed when the topology changes. */
+  std::swap(mesh->mloop[0].v, mesh->mloop[1].v);
+  BKE_mesh_vertex_normals_ensure(mesh);
+  EXPECT_EQ(mesh->runtime.vert_loop_map, nullptr);
+
+  MEM_freeN(vert_normals);
+  BKE_id_free(nullptr, mesh);
+}
+
+/* Raise the grid into a roof, with a ridge along the middle row of vertices. */
+static void mesh_grid_roof(Mesh *mesh, const int size)
+{
+  for (int i = 0; i < mesh->totvert; i++) {
+    const int y = i / size;
+    mesh->mvert[i].co[2] = (float)min_ii(y, size - 1 - y);
+  }
+  BKE_mesh_calc_normals(mesh);
+}
+
+static void mesh_normals_loop_split(Mesh *mesh,
+                                    float (*r_loop_normals)[3],
+                                    const float split_angle,
+                                    MLoopNorSpaceArray *r_lnors_spacearr)
+{
+  BKE_mesh_normals_loop_split(mesh->mvert,
+                              mesh->totvert,
+                              mesh->medge,
+                              mesh->totedge,
+                              mesh->mloop,
+                              r_loop_normals,
+                              mesh->totloop,
+                              mesh->mpoly,
+                              BKE_mesh_poly_normals_ensure(mesh),
+                              mesh->totpoly,
+                              true,
+                              split_angle,
+                              r_lnors_spacearr,
+                              nullptr,
+                              nullptr);
+}
+
+/* Large enough to be threaded. */
+static const int loop_split_grid_size = 101;
+
+TEST(mesh_evaluate, NormalsLoopSplitSmooth)
+{
+  BKE_idtype_init();
+  const int size = loop_split_grid_size;
+  Mesh *mesh = mesh_grid_create(size);
+  for (int i = 0; i < mesh->totpoly; i++) {
+    mesh->mpoly[i].flag |= ME_SMOOTH;
+  }
+  mesh_grid_roof(mesh, size);
+
+  float(*loop_normals)[3] = (float(*)[3])MEM_malloc_arrayN(
+      mesh->totloop, sizeof(float[3]), __func__);
+  MLoopNorSpaceArray lnors_spacearr = {nullptr};
+  mesh_normals_loop_split(mesh, loop_normals, (float)M_PI, &lnors_spacearr);
+
+  /* Without sharp edges each vertex has a single fan of loops, using the vertex normal. */
+  const float(*vert_normals)[3] = BKE_mesh_vertex_normals_ensure(mesh);
+  MLoopNorSpace **vert_spaces = (MLoopNorSpace **)MEM_calloc_arrayN(
+      mesh->totvert, sizeof(MLoopNorSpace *), __func__);
+  EXPECT_EQ(lnors_spacearr.num_spaces, mesh->totvert);
+  for (int i = 0; i < mesh->totloop; i++) {
+    const int v = mesh->mloop[i].v;
+    EXPECT_V3_NEAR(loop_normals[i], vert_normals[v], 1e-5f);
+    MLoopNorSpace *space = lnors_spacearr.lspacearr[i];
+    ASSERT_NE(space, nullptr);
+    if (vert_spaces[v] == nullptr) {
+      vert_spaces[v] = space;
+    }
+    EXPECT_EQ(space, vert_spaces[v]);
+  }
+
+  MEM_freeN(vert_spaces);
+  BKE_lnor_spacearr_free(&lnors_spacearr);
+  MEM_freeN(loop_normals);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST(mesh_evaluate, NormalsLoopSplitAngle)
+{
+  BKE_idtype_init();
+  const int size = loop_split_grid_size;
+  Mesh *mesh = mesh_grid_create(size);
+  for (int i = 0; i < mesh->totpoly; i++) {
+    mesh->mpoly[i].flag |= ME_SMOOTH;
+  }
+  mesh_grid_roof(mesh, size);
+
+  float(*loop_normals)[3] = (float(*)[3])MEM_malloc_arrayN(
+      mesh->totloop, sizeof(float[3]), __func__);
+  MLoopNorSpaceArray lnors_spacearr = {nullptr};
+  mesh_normals_loop_split(mesh, loop_normals, DEG2RADF(30.0f), &lnors_spacearr);
+
+  /* The ridge is split, both sides of the roof are flat so all loops use the polygon normal. */
+  const float(*poly_normals)[3] = BKE_mesh_poly_normals_ensure(mesh);
+  for (int i = 0; i < mesh->totpoly; i++) {
+    const MPoly *mp = &mesh->mpoly[i];
+    for (int j = mp->loopstart; j < mp->loopstart + mp->totloop; j++) {
+      EXPECT_V3_NEAR(loop_normals[j], poly_normals[i], 1e-5f);
+    }
+  }
+  /* One more fan for each vertex of the ridge. */
+  EXPECT_EQ(lnors_spacearr.num_spaces, mesh->totvert + size);
+
+  BKE_lnor_spacearr_free(&lnors_spacearr);
+  MEM_freeN(loop_normals);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST(mesh_evaluate, NormalsLoopSplitFlat)
+{
+  BKE_idtype_init();
+  const int size = loop_split_grid_size;
+  Mesh *mesh = mesh_grid_create(size);
+  mesh_grid_roof(mesh, size);
+
+  float(*loop_normals)[3] = (float(*)[3])MEM_malloc_arrayN(
+      mesh->totloop, sizeof(float[3]), __func__);
+  MLoopNorSpaceArray lnors_spacearr = {nullptr};
+  mesh_normals_loop_split(mesh, loop_normals, (float)M_PI, &lnors_spacearr);
+
+  /* Each loop of flat polygons has its own space. */
+  EXPECT_EQ(lnors_spacearr.num_spaces, mesh->totloop);
+  const float(*poly_normals)[3] = BKE_mesh_poly_normals_ensure(mesh);
+  for (int i = 0; i < mesh->totpoly; i++) {
+    const MPoly *mp = &mesh->mpoly[i];
+    for (int j = mp->loopstart; j < mp->loopstart + mp->totloop; j++) {
+      EXPECT_V3_NEAR(loop_normals[j], poly_normals[i], 1e-5f);
+      EXPECT_TRUE(lnors_spacearr.lspacearr[j]->flags & MLNOR_SPACE_IS_SINGLE);
+    }
+  }
+
+  BKE_lnor_spacearr_free(&lnors_spacearr);
+  MEM_freeN(loop_normals);
+  BKE_id_free(nullptr, mesh);
+}
+
+/* Compares the first calculation of the vertex normals with the following ones, which sum the
+ * normals in parallel, and with getting the cached normals of an unchanged mesh. */
+TEST(mesh_evaluate, NormalsBenchmark)
+{
+  BKE_idtype_init();
+  const int size = 500;
+  Mesh *mesh = mesh_grid_create(size);
+  mesh_grid_roof(mesh, size);
+
+  for (int i = 0; i < 3; i++) {
+    BKE_mesh_runtime_clear_geometry(mesh);
+    SCOPED_TIMER("Vertex normals, first");
+    BKE_mesh_vertex_normals_ensure(mesh);
+  }
+  for (int i = 0; i < 3; i++) {
+    BKE_mesh_normals_tag_dirty(mesh);
+    SCOPED_TIMER("Vertex normals, again");
+    BKE_mesh_vertex_normals_ensure(mesh);
+  }
+  for (int i = 0; i < 3; i++) {
+    SCOPED_TIMER("Vertex normals, cached");
+    BKE_mesh_vertex_normals_ensure(mesh);
+  }
+
+  BKE_id_free(nullptr, mesh);
+}
+
+/**
+ * Set this to 1 to activate the benchmark. It is disabled by default, because it prints a lot.
+ */
+#if 0
+TEST(mesh_evaluate, NormalsLoopSplitBenchmark)
+{
+  BKE_idtype_init();
+  const int size = 2000;
+  Mesh *mesh = mesh_grid_create(size);
+  for (int i = 0; i < mesh->totpoly; i++) {
+    mesh->mpoly[i].flag |= ME_SMOOTH;
+  }
+  mesh_grid_roof(mesh, size);
+
+  float(*loop_normals)[3] = (float(*)[3])MEM_malloc_arrayN(
+      mesh->totloop, sizeof(float[3]), __func__);
+  for (int i = 0; i < 5; i++) {
+    SCOPED_TIMER("Loop normals");
+    mesh_normals_loop_split(mesh, loop_normals, DEG2RADF(30.0f), nullptr);
+  }
+  for (int i = 0; i < 5; i++) {
+    MLoopNorSpaceArray lnors_spacearr = {nullptr};
+    {
+      SCOPED_TIMER("Loop normals with spaces");
+      mesh_normals_loop_split(mesh, loop_normals, DEG2RADF(30.0f), &lnors_spacearr);
+    }
+    BKE_lnor_spacearr_free(&lnors_spacearr);
+  }
+
+  MEM_freeN(loop_normals);
+  BKE_id_free(nullptr, mesh);
+}
+#endif
+
+}  // namespace blender::bke::tests
@@ -51,6 +51,12 @@
 
 #define LEAF_LIMIT 10000
 
+/* Number of bins along the split axis used to find the split with the lowest SAH cost. */
+#define SAH_BINS 16
+
+/* Nodes with more primitives than this many leaves are split in their own task. */
+#define BUILD_TASK_LEAVES 4
+
 //#define PERFCNTRS
 
 #define STACK_FIXED_DEPTH 100
@@ -171,7 +177,9 @@ static bool grid_materials_match(const DMFlagMat *f1, const DMFlagMat *f2)
   return ((f1->flag & ME_SMOOTH) == (f2->flag & ME_SMOOTH) && (f1->mat_nr == f2->mat_nr));
 }
 
-/* Adapted from BLI_kdopbvh.c */
+/* Adapted from BLI_kdopbvh.c
+ * Both ends move after a swap, so centroids equal to mid are spread over the two sides
+ * instead of all but one going to the left. */
 /* Returns the index of the first element on the right of the partition */
 static int partition_indices(int *prim_indices, int lo, int hi, int axis, float mid, BBC *prim_bbc)
 {
@@ -190,7 +198,94 @@ static int partition_indices(int *prim_indices, int lo, int hi, int axis, float
 
     SWAP(int, prim_indices[i], prim_indices[j]);
     i++;
+    j--;
+  }
+}
+
+static float BB_half_area(const BB *bb)
+{
+  const float x = bb->bmax[0] - bb->bmin[0];
+  const float y = bb->bmax[1] - bb->bmin[1];
+  const float z = bb->bmax[2] - bb->bmin[2];
+  return x * y + y * z + z * x;
+}
+
+/* Partition primitives along the widest axis of their centroids, at the bin boundary with the
+ * lowest surface area heuristic cost. Falls back to the middle of the axis when all centroids
+ * end up in the same bin.
+ *
+ * The split position is rounded, so either side can still come out empty when centroids are
+ * very close together. Then the middle of the axis is tried, and if that doesn't split them
+ * either, the range is split in half. An empty side would recurse forever.
+ *
+ * Returns the index of the first element on the right of the partition */
+static int partition_indices_sah(int *prim_indices, int lo, int hi, const BB *cb, BBC *prim_bbc)
+{
+  const int axis = BB_widest_axis(cb);
+  const float extent = cb->bmax[axis] - cb->bmin[axis];
+  float mid = (cb->bmax[axis] + cb->bmin[axis]) * 0.5f;
+
+  if (extent > 0.0f) {
+    const float scale = SAH_BINS / extent;
+    BB bin_bb[SAH_BINS];
+    int bin_count[SAH_BINS] = {0};
+
+    for (int b = 0; b < SAH_BINS; b++) {
+      BB_reset(&bin_bb[b]);
+    }
+    for (int i = lo; i <= hi; i++) {
+      BBC *bbc = &prim_bbc[prim_indices[i]];
+      const int b = min_ii((int)((bbc->bcentroid[axis] - cb->bmin[axis]) * scale), SAH_BINS - 1);
+      BB_expand_with_bb(&bin_bb[b], (BB *)bbc);
+      bin_count[b]++;
+    }
+
+    /* Cost of the right side of the split before every bin. */
+    float right_cost[SAH_BINS];
+    int right_count[SAH_BINS];
+    BB bb;
+    int count = 0;
+    BB_reset(&bb);
+    for (int b = SAH_BINS - 1; b > 0; b--) {
+      BB_expand_with_bb(&bb, &bin_bb[b]);
+      count += bin_count[b];
+      right_cost[b] = (count) ? BB_half_area(&bb) * count : 0.0f;
+      right_count[b] = count;
+    }
+
+    float best_cost = FLT_MAX;
+    int best_split = 0;
+    count = 0;
+    BB_reset(&bb);
+    for (int b = 1; b < SAH_BINS; b++) {
+      BB_expand_with_bb(&bb, &bin_bb[b - 1]);
+      count += bin_count[b - 1];
+      if (count == 0 || right_count[b] == 0) {
+        continue;
+      }
+      const float cost = BB_half_area(&bb) * count + right_cost[b];
+      if (cost < best_cost) {
+        best_cost = cost;
+        best_split = b;
+      }
+    }
+
+    if (best_split != 0) {
+      const float split = cb->bmin[axis] + best_split / scale;
+      const int end = partition_indices(prim_indices, lo, hi, axis, split, prim_bbc);
+      if (end > lo && end <= hi) {
+        return end;
+      }
+    }
+  }
+
+  const int end = partition_indices(prim_indices, lo, hi, axis, mid, prim_bbc);
+  if (end > lo && end <= hi) {
+    return end;
   }
+
+  /* Centroids are the same along the axis, as far as the split goes. */
+  return lo + (hi - lo + 1) / 2;
 }
 
 /* Returns the index of the first element on the right of the partition */
@@ -252,16 +347,19 @@ void pbvh_grow_nodes(PBVH *pbvh, int totnode)
 
 /* Add a vertex to the map, with a positive value for unique vertices and
  * a negative value for additional vertices */
-static int map_insert_vert(
-    PBVH *pbvh, GHash *map, unsigned int *face_verts, unsigned int *uniq_verts, int vertex)
+static int map_insert_vert(PBVH *pbvh,
+                           GHash *map,
+                           unsigned int *face_verts,
+                           unsigned int *uniq_verts,
+                           int vertex,
+                           int leaf_index)
 {
   void *key, **value_p;
 
   key = POINTER_FROM_INT(vertex);
   if (!BLI_ghash_ensure_p(map, key, &value_p)) {
     int value_i;
-    if (BLI_BITMAP_TEST(pbvh->vert_bitmap, vertex) == 0) {
-      BLI_BITMAP_ENABLE(pbvh->vert_bitmap, vertex);
+    if (pbvh->vert_owner[vertex] == leaf_index) {
       value_i = *uniq_verts;
       (*uniq_verts)++;
     }
@@ -277,7 +375,7 @@ static int map_insert_vert(
 }
 
 /* Find vertices used by the faces in this node and update the draw buffers */
-static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
+static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node, int leaf_index)
 {
   bool has_visible = false;
 
@@ -298,8 +396,12 @@ static void build_mesh_leaf_node(PBVH *pbvh, PBVHNode *node)
   for (int i = 0; i < totface; i++) {
     const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
     for (int j = 0; j < 3; j++) {
-      face_vert_indices[i][j] = map_insert_vert(
-          pbvh, map, &node->face_verts, &node->uniq_verts, pbvh->mloop[lt->tri[j]].v);
+      face_vert_indices[i][j] = map_insert_vert(pbvh,
+                                                map,
+                                                &node->face_verts,
+                                                &node->uniq_verts,
+                                                pbvh->mloop[lt->tri[j]].v,
+                                                leaf_index);
     }
 
     if (has_visible == false) {
@@ -413,21 +515,16 @@ static void build_grid_leaf_node(PBVH *pbvh, PBVHNode *node)
   BKE_pbvh_node_mark_rebuild_draw(node);
 }
 
-static void build_leaf(PBVH *pbvh, int node_index, BBC *prim_bbc, int offset, int count)
+static void build_leaf(PBVH *pbvh, PBVHNode *node, int leaf_index, BBC *prim_bbc)
 {
-  pbvh->nodes[node_index].flag |= PBVH_Leaf;
-
-  pbvh->nodes[node_index].prim_indices = pbvh->prim_indices + offset;
-  pbvh->nodes[node_index].totprim = count;
-
   /* Still need vb for searches */
-  update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
+  update_vb(pbvh, node, prim_bbc, (int)(node->prim_indices - pbvh->prim_indices), node->totprim);
 
   if (pbvh->looptri) {
-    build_mesh_leaf_node(pbvh, pbvh->nodes + node_index);
+    build_mesh_leaf_node(pbvh, node, leaf_index);
   }
   else {
-    build_grid_leaf_node(pbvh, pbvh->nodes + node_index);
+    build_grid_leaf_node(pbvh, node);
   }
 }
 
@@ -465,19 +562,39 @@ static bool leaf_needs_material_split(PBVH *pbvh, int offset, int count)
   return false;
 }
 
-/* Recursively build a node in the tree
- *
- * vb is the voxel box around all of the primitives contained in
- * this node.
+/* Node of the tree of partitions, created before the PBVH nodes. Leaves have no children. */
+typedef struct PBVHBuildNode {
+  struct PBVHBuildNode *children[2];
+  int offset, count;
+  int node_index;
+} PBVHBuildNode;
+
+typedef struct PBVHBuildData {
+  PBVH *pbvh;
+  BBC *prim_bbc;
+
+  /* Indices of the leaf nodes, in the order of the tree. */
+  int *leaves;
+  uint32_t totleaf;
+} PBVHBuildData;
+
+static void build_sub_task_cb(TaskPool *__restrict pool, void *taskdata);
+
+/* Recursively partition the primitives of a node in the tree
  *
  * cb is the bounding box around all the centroids of the primitives
  * contained in this node
  *
- * offset and start indicate a range in the array of primitive indices
+ * Large children are partitioned in their own task, since they work
+ * on separate ranges of the primitive indices.
  */
-
-static void build_sub(PBVH *pbvh, int node_index, BB *cb, BBC *prim_bbc, int offset, int count)
+static void build_sub(TaskPool *__restrict pool, PBVHBuildNode *bnode, BB *cb)
 {
+  PBVHBuildData *data = BLI_task_pool_user_data(pool);
+  PBVH *pbvh = data->pbvh;
+  BBC *prim_bbc = data->prim_bbc;
+  const int offset = bnode->offset;
+  const int count = bnode->count;
   int end;
   BB cb_backing;
 
@@ -485,18 +602,11 @@ static void build_sub(PBVH *pbvh, int node_index, BB *cb, BBC *prim_bbc, int off
   const bool below_leaf_limit = count <= pbvh->leaf_limit;
   if (below_leaf_limit) {
     if (!leaf_needs_material_split(pbvh, offset, count)) {
-      build_leaf(pbvh, node_index, prim_bbc, offset, count);
+      atomic_add_and_fetch_uint32(&data->totleaf, 1);
       return;
     }
   }
 
-  /* Add two child nodes */
-  pbvh->nodes[node_index].children_offset = pbvh->totnode;
-  pbvh_grow_nodes(pbvh, pbvh->totnode + 2);
-
-  /* Update parent node bounding box */
-  update_vb(pbvh, &pbvh->nodes[node_index], prim_bbc, offset, count);
-
   if (!below_leaf_limit) {
     /* Find axis with widest range of primitive centroids */
     if (!cb) {
@@ -506,29 +616,111 @@ static void build_sub(PBVH *pbvh, int node_index, BB *cb, BBC *prim_bbc, int off
         BB_expand(cb, prim_bbc[pbvh->prim_indices[i]].bcentroid);
       }
     }
-    const int axis = BB_widest_axis(cb);
 
     /* Partition primitives along that axis */
-    end = partition_indices(pbvh->prim_indices,
-                            offset,
-                            offset + count - 1,
-                            axis,
-                            (cb->bmax[axis] + cb->bmin[axis]) * 0.5f,
-                            prim_bbc);
+    end = partition_indices_sah(pbvh->prim_indices, offset, offset + count - 1, cb, prim_bbc);
   }
   else {
     /* Partition primitives by material */
     end = partition_indices_material(pbvh, offset, offset + count - 1);
   }
 
+  /* Add two child nodes */
+  for (int i = 0; i < 2; i++) {
+    PBVHBuildNode *child = MEM_callocN(sizeof(PBVHBuildNode), __func__);
+    child->offset = (i == 0) ? offset : end;
+    child->count = (i == 0) ? end - offset : offset + count - end;
+    bnode->children[i] = child;
+  }
+
   /* Build children */
-  build_sub(pbvh, pbvh->nodes[node_index].children_offset, NULL, prim_bbc, offset, end - offset);
-  build_sub(pbvh,
-            pbvh->nodes[node_index].children_offset + 1,
-            NULL,
-            prim_bbc,
-            end,
-            offset + count - end);
+  if (bnode->children[0]->count > BUILD_TASK_LEAVES * pbvh->leaf_limit) {
+    BLI_task_pool_push(pool, build_sub_task_cb, bnode->children[0], false, NULL);
+  }
+  else {
+    build_sub(pool, bnode->children[0], NULL);
+  }
+  build_sub(pool, bnode->children[1], NULL);
+}
+
+static void build_sub_task_cb(TaskPool *__restrict pool, void *taskdata)
+{
+  build_sub(pool, taskdata, NULL);
+}
+
+/* Create the PBVH nodes in depth-first order of the partitions, children of a node are
+ * next to each other. */
+static void build_nodes(PBVHBuildData *data, PBVHBuildNode *bnode, int node_index)
+{
+  PBVH *pbvh = data->pbvh;
+
+  bnode->node_index = node_index;
+
+  if (bnode->children[0] == NULL) {
+    pbvh->nodes[node_index].flag |= PBVH_Leaf;
+    pbvh->nodes[node_index].prim_indices = pbvh->prim_indices + bnode->offset;
+    pbvh->nodes[node_index].totprim = bnode->count;
+    data->leaves[data->totleaf++] = node_index;
+    return;
+  }
+
+  const int children_offset = pbvh->totnode;
+  pbvh->nodes[node_index].children_offset = children_offset;
+  pbvh_grow_nodes(pbvh, pbvh->totnode + 2);
+
+  build_nodes(data, bnode->children[0], children_offset);
+  build_nodes(data, bnode->children[1], children_offset + 1);
+}
+
+/* Update the bounding boxes of the inner nodes from their children, after the leaves are built.
+ * Frees the partitions. */
+static void build_inner_nodes_vb(PBVH *pbvh, PBVHBuildNode *bnode)
+{
+  if (bnode->children[0] == NULL) {
+    return;
+  }
+
+  PBVHNode *node = &pbvh->nodes[bnode->node_index];
+  BB_reset(&node->vb);
+  for (int i = 0; i < 2; i++) {
+    build_inner_nodes_vb(pbvh, bnode->children[i]);
+    BB_expand_with_bb(&node->vb, &pbvh->nodes[bnode->children[i]->node_index].vb);
+    MEM_freeN(bnode->children[i]);
+  }
+  node->orig_vb = node->vb;
+}
+
+/* The first leaf (in the order of the tree) using a vertex owns it as unique vertex. */
+static void build_vert_owner_task_cb(void *__restrict userdata,
+                                     const int n,
+                                     const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildData *data = userdata;
+  PBVH *pbvh = data->pbvh;
+  PBVHNode *node = &pbvh->nodes[data->leaves[n]];
+
+  for (int i = 0; i < node->totprim; i++) {
+    const MLoopTri *lt = &pbvh->looptri[node->prim_indices[i]];
+    for (int j = 0; j < 3; j++) {
+      int32_t *owner = &pbvh->vert_owner[pbvh->mloop[lt->tri[j]].v];
+      int32_t old_owner = *owner;
+      while (n < old_owner) {
+        const int32_t prev_owner = atomic_cas_int32(owner, old_owner, n);
+        if (prev_owner == old_owner) {
+          break;
+        }
+        old_owner = prev_owner;
+      }
+    }
+  }
+}
+
+static void build_leaf_task_cb(void *__restrict userdata,
+                               const int n,
+                               const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  PBVHBuildData *data = userdata;
+  build_leaf(data->pbvh, &data->pbvh->nodes[data->leaves[n]], n, data->prim_bbc);
 }
 
 static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
@@ -552,8 +744,107 @@ static void pbvh_build(PBVH *pbvh, BB *cb, BBC *prim_bbc, int totprim)
     }
   }
 
+  PBVHBuildData data = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+  };
+
+  /* Partition the primitives, in parallel for separate subtrees. */
+  PBVHBuildNode root = {{NULL}};
+  root.count = totprim;
+  TaskPool *pool = BLI_task_pool_create(&data, TASK_PRIORITY_HIGH);
+  build_sub(pool, &root, cb);
+  BLI_task_pool_work_and_wait(pool);
+  BLI_task_pool_free(pool);
+
+  data.leaves = MEM_mallocN(sizeof(int) * data.totleaf, "bvh build leaves");
+  data.totleaf = 0;
   pbvh->totnode = 1;
-  build_sub(pbvh, 0, cb, prim_bbc, 0, totprim);
+  build_nodes(&data, &root, 0);
+
+  TaskParallelSettings settings;
+  BKE_pbvh_parallel_range_settings(&settings, true, (int)data.totleaf);
+
+  if (pbvh->looptri) {
+    pbvh->vert_owner = MEM_mallocN(sizeof(int) * pbvh->totvert, "bvh vert owner");
+    copy_vn_i(pbvh->vert_owner, pbvh->totvert, INT_MAX);
+    BLI_task_parallel_range(0, (int)data.totleaf, &data, build_vert_owner_task_cb, &settings);
+  }
+
+  BLI_task_parallel_range(0, (int)data.totleaf, &data, build_leaf_task_cb, &settings);
+  build_inner_nodes_vb(pbvh, &root);
+
+  MEM_SAFE_FREE(pbvh->vert_owner);
+  MEM_freeN(data.leaves);
+}
+
+typedef struct PBVHBuildBBCData {
+  PBVH *pbvh;
+  BBC *prim_bbc;
+} PBVHBuildBBCData;
+
+static void pbvh_build_mesh_bbc_task_cb(void *__restrict userdata,
+                                        const int i,
+                                        const TaskParallelTLS *__restrict tls)
+{
+  PBVHBuildBBCData *data = userdata;
+  PBVH *pbvh = data->pbvh;
+  const MLoopTri *lt = &pbvh->looptri[i];
+  BBC *bbc = data->prim_bbc + i;
+
+  BB_reset((BB *)bbc);
+
+  for (int j = 0; j < 3; j++) {
+    BB_expand((BB *)bbc, pbvh->verts[pbvh->mloop[lt->tri[j]].v].co);
+  }
+
+  BBC_update_centroid(bbc);
+
+  BB_expand(tls->userdata_chunk, bbc->bcentroid);
+}
+
+static void pbvh_build_grids_bbc_task_cb(void *__restrict userdata,
+                                         const int i,
+                                         const TaskParallelTLS *__restrict tls)
+{
+  PBVHBuildBBCData *data = userdata;
+  PBVH *pbvh = data->pbvh;
+  const CCGKey *key = &pbvh->gridkey;
+  CCGElem *grid = pbvh->grids[i];
+  BBC *bbc = data->prim_bbc + i;
+
+  BB_reset((BB *)bbc);
+
+  for (int j = 0; j < key->grid_area; j++) {
+    BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
+  }
+
+  BBC_update_centroid(bbc);
+
+  BB_expand(tls->userdata_chunk, bbc->bcentroid);
+}
+
+static void pbvh_build_bbc_reduce(const void *__restrict UNUSED(userdata),
+                                  void *__restrict chunk_join,
+                                  void *__restrict chunk)
+{
+  BB_expand_with_bb(chunk_join, chunk);
+}
+
+/* For each primitive, store the AABB and the AABB centroid in parallel,
+ * cb is expanded with all the centroids. */
+static void pbvh_build_bbc(PBVHBuildBBCData *data,
+                           BB *cb,
+                           int totprim,
+                           TaskParallelRangeFunc func)
+{
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1024;
+  settings.userdata_chunk = cb;
+  settings.userdata_chunk_size = sizeof(BB);
+  settings.func_reduce = pbvh_build_bbc_reduce;
+  BLI_task_parallel_range(0, totprim, data, func, &settings);
 }
 
 /**
@@ -583,7 +874,6 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
   pbvh->mloop = mloop;
   pbvh->looptri = looptri;
   pbvh->verts = verts;
-  pbvh->vert_bitmap = BLI_BITMAP_NEW(totvert, "bvh->vert_bitmap");
   pbvh->totvert = totvert;
   pbvh->leaf_limit = LEAF_LIMIT;
   pbvh->vdata = vdata;
@@ -595,31 +885,19 @@ void BKE_pbvh_build_mesh(PBVH *pbvh,
 
   BB_reset(&cb);
 
-  /* For each face, store the AABB and the AABB centroid */
   prim_bbc = MEM_mallocN(sizeof(BBC) * looptri_num, "prim_bbc");
 
-  for (int i = 0; i < looptri_num; i++) {
-    const MLoopTri *lt = &looptri[i];
-    const int sides = 3;
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < sides; j++) {
-      BB_expand((BB *)bbc, verts[pbvh->mloop[lt->tri[j]].v].co);
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  PBVHBuildBBCData data = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+  };
+  pbvh_build_bbc(&data, &cb, looptri_num, pbvh_build_mesh_bbc_task_cb);
 
   if (looptri_num) {
     pbvh_build(pbvh, &cb, prim_bbc, looptri_num);
   }
 
   MEM_freeN(prim_bbc);
-  MEM_freeN(pbvh->vert_bitmap);
 }
 
 /* Do a full rebuild with on Grids data structure */
@@ -645,23 +923,13 @@ void BKE_pbvh_build_grids(PBVH *pbvh,
   BB cb;
   BB_reset(&cb);
 
-  /* For each grid, store the AABB and the AABB centroid */
   BBC *prim_bbc = MEM_mallocN(sizeof(BBC) * totgrid, "prim_bbc");
 
-  for (int i = 0; i < totgrid; i++) {
-    CCGElem *grid = grids[i];
-    BBC *bbc = prim_bbc + i;
-
-    BB_reset((BB *)bbc);
-
-    for (int j = 0; j < gridsize * gridsize; j++) {
-      BB_expand((BB *)bbc, CCG_elem_offset_co(key, grid, j));
-    }
-
-    BBC_update_centroid(bbc);
-
-    BB_expand(&cb, bbc->bcentroid);
-  }
+  PBVHBuildBBCData data = {
+      .pbvh = pbvh,
+      .prim_bbc = prim_bbc,
+  };
+  pbvh_build_bbc(&data, &cb, totgrid, pbvh_build_grids_bbc_task_cb);
 
   if (totgrid) {
     pbvh_build(pbvh, &cb, prim_bbc, totgrid);
@@ -150,9 +150,9 @@ struct PBVH {
   int totgrid;
   BLI_bitmap **grid_hidden;
 
-  /* Only used during BVH build and update,
-   * don't need to remain valid after */
-  BLI_bitmap *vert_bitmap;
+  /* Only used during BVH build, don't need to remain valid after.
+   * Index of the first leaf using a vertex, which has it as unique vertex. */
+  int *vert_owner;
 
 #ifdef PERFCNTRS
   int perf_modified;
@@ -0,0 +1,157 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "testing/testing.h"
+
+#include <cmath>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_math.h"
+#include "BLI_vector.hh"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_pbvh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+namespace blender::bke::tests {
+
+/* Leaves of the mesh PBVH hold at most this many triangles. */
+static const int pbvh_leaf_limit = 10000;
+
+/* Separate triangles in the YZ plane, so that every vertex belongs to a single triangle. The
+ * bounds of triangle `i` are centered at `centroid(i)`. */
+template<typename CentroidFn>
+static Mesh *triangles_mesh_create(const int tris_len, const CentroidFn &centroid)
+{
+  const float corners[3][3] = {{0.0f, 1.0f, 0.0f}, {0.0f, 0.0f, 1.0f}, {0.0f, -1.0f, -1.0f}};
+  Mesh *mesh = BKE_mesh_new_nomain(tris_len * 3, 0, 0, tris_len * 3, tris_len);
+  for (int i = 0; i < tris_len; i++) {
+    float center[3];
+    centroid(i, center);
+    for (int j = 0; j < 3; j++) {
+      add_v3_v3v3(mesh->mvert[i * 3 + j].co, center, corners[j]);
+      mesh->mloop[i * 3 + j].v = i * 3 + j;
+    }
+    mesh->mpoly[i].loopstart = i * 3;
+    mesh->mpoly[i].totloop = 3;
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+  return mesh;
+}
+
+/* Build the PBVH of the mesh and check that every triangle is in exactly one leaf, within the
+ * leaf bounds and that leaves are not empty or larger than the limit. Returns the number of
+ * leaves. */
+static int pbvh_build_check(Mesh *mesh)
+{
+  /* The PBVH takes ownership of the triangles. */
+  const int looptris_num = poly_to_tri_count(mesh->totpoly, mesh->totloop);
+  MLoopTri *looptri = (MLoopTri *)MEM_malloc_arrayN(looptris_num, sizeof(*looptri), __func__);
+  BKE_mesh_recalc_looptri(
+      mesh->mloop, mesh->mpoly, mesh->mvert, mesh->totloop, mesh->totpoly, looptri);
+
+  PBVH *pbvh = BKE_pbvh_new();
+  BKE_pbvh_build_mesh(pbvh,
+                      mesh,
+                      mesh->mpoly,
+                      mesh->mloop,
+                      mesh->mvert,
+                      mesh->totvert,
+                      &mesh->vdata,
+                      &mesh->ldata,
+                      &mesh->pdata,
+                      looptri,
+                      looptris_num);
+
+  PBVHNode **nodes;
+  int totnode;
+  BKE_pbvh_search_gather(pbvh, nullptr, nullptr, &nodes, &totnode);
+  EXPECT_GE(totnode, 2);
+
+  Vector<int> vert_leaf_count(mesh->totvert, 0);
+  for (int n = 0; n < totnode; n++) {
+    int uniquevert, totvert;
+    const int *vert_indices;
+    MVert *mvert;
+    BKE_pbvh_node_num_verts(pbvh, nodes[n], &uniquevert, &totvert);
+    BKE_pbvh_node_get_verts(pbvh, nodes[n], &vert_indices, &mvert);
+
+    /* Triangles don't share vertices, so leaves have three unique vertices per triangle. */
+    EXPECT_EQ(uniquevert, totvert);
+    EXPECT_EQ(totvert % 3, 0);
+    EXPECT_GT(totvert, 0);
+    EXPECT_LE(totvert / 3, pbvh_leaf_limit);
+
+    float bb_min[3], bb_max[3];
+    BKE_pbvh_node_get_BB(nodes[n], bb_min, bb_max);
+    for (int i = 0; i < totvert; i++) {
+      const float *co = mvert[vert_indices[i]].co;
+      for (int axis = 0; axis < 3; axis++) {
+        EXPECT_GE(co[axis], bb_min[axis]);
+        EXPECT_LE(co[axis], bb_max[axis]);
+      }
+      vert_leaf_count[vert_indices[i]]++;
+    }
+  }
+  for (int i = 0; i < mesh->totvert; i++) {
+    EXPECT_EQ(vert_leaf_count[i], 1);
+  }
+
+  MEM_SAFE_FREE(nodes);
+  BKE_pbvh_free(pbvh);
+  return totnode;
+}
+
+TEST(pbvh, BuildScattered)
+{
+  BKE_idtype_init();
+  Mesh *mesh = triangles_mesh_create(50000, [](const int i, float r_center[3]) {
+    copy_v3_fl3(r_center, (float)(i % 97), (float)((i * 31) % 89), (float)((i * 7) % 13));
+  });
+  pbvh_build_check(mesh);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST(pbvh, BuildCoincidentCentroids)
+{
+  BKE_idtype_init();
+  Mesh *mesh = triangles_mesh_create(
+      30000, [](const int UNUSED(i), float r_center[3]) { zero_v3(r_center); });
+  /* Split in halves, not one triangle at a time. */
+  EXPECT_EQ(pbvh_build_check(mesh), 4);
+  BKE_id_free(nullptr, mesh);
+}
+
+TEST(pbvh, BuildAdjacentCentroids)
+{
+  /* One triangle a float step away from all others: the split position between them rounds to
+   * one of the two, and must not put all triangles on the same side. */
+  BKE_idtype_init();
+  Mesh *mesh = triangles_mesh_create(30000, [](const int i, float r_center[3]) {
+    const float x = 1024.0f;
+    copy_v3_fl3(r_center, (i == 0) ? x : nextafterf(x, 2048.0f), 0.0f, 0.0f);
+  });
+  EXPECT_LE(pbvh_build_check(mesh), 5);
+  BKE_id_free(nullptr, mesh);
+}
+
+}  // namespace blender::bke::tests
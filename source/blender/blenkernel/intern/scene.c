@@ -87,6 +87,7 @@
 #include "BKE_node.h"
 #include "BKE_object.h"
 #include "BKE_paint.h"
+#include "BKE_pointcache.h"
 #include "BKE_rigidbody.h"
 #include "BKE_scene.h"
 #include "BKE_screen.h"
@@ -1605,6 +1606,141 @@ void BKE_scene_graph_update_for_newframe(Depsgraph *depsgraph)
   }
 }
 
+/* -------------------------------------------------------------------- */
+/** \name Multi-Frame Evaluation
+ * \{ */
+
+/* Every depsgraph holds a copy-on-write copy of the scene, so the default number of graphs is
+ * kept low instead of using one per thread. */
+#define SCENE_FRAMES_GRAPHS_NUM_DEFAULT 4
+
+typedef struct SceneFramesEvalData {
+  Depsgraph **graphs;
+  const double *frames;
+  float framelen;
+} SceneFramesEvalData;
+
+static void scene_graph_evaluate_frame_cb(void *__restrict userdata,
+                                          const int index,
+                                          const TaskParallelTLS *__restrict UNUSED(tls))
+{
+  SceneFramesEvalData *data = userdata;
+  const float ctime = (float)data->frames[index] * data->framelen;
+  DEG_evaluate_on_framechange(data->graphs[index], ctime);
+}
+
+/* Frames of a simulation depend on the previous frame, and handlers expect to see the frames in
+ * order on the original scene, so these can only be evaluated one after the other. */
+static bool scene_graph_frames_need_sequential(Depsgraph *depsgraph)
+{
+  if (BKE_callback_has_handlers(BKE_CB_EVT_FRAME_CHANGE_PRE) ||
+      BKE_callback_has_handlers(BKE_CB_EVT_FRAME_CHANGE_POST)) {
+    return true;
+  }
+
+  Scene *scene = DEG_get_input_scene(depsgraph);
+  if (scene->rigidbody_world != NULL || DEG_id_type_any_exists(depsgraph, ID_SIM)) {
+    return true;
+  }
+
+  bool has_pointcache = false;
+  DEG_OBJECT_ITER_BEGIN (depsgraph,
+                         object,
+                         DEG_ITER_OBJECT_FLAG_LINKED_DIRECTLY |
+                             DEG_ITER_OBJECT_FLAG_LINKED_INDIRECTLY |
+                             DEG_ITER_OBJECT_FLAG_LINKED_VIA_SET) {
+    if (!has_pointcache) {
+      has_pointcache = BKE_ptcache_object_has(scene, DEG_get_original_object(object), 0);
+    }
+  }
+  DEG_OBJECT_ITER_END;
+
+  return has_pointcache;
+}
+
+/**
+ * Evaluate the scene of the depsgraph for every frame in \a frames, and call \a frame_fn in
+ * frame order with a depsgraph which is evaluated for that frame. The evaluated data is only
+ * valid for the duration of the call. Evaluation stops when \a frame_fn returns false.
+ *
+ * Consecutive frames are evaluated concurrently, by up to \a graphs_num depsgraphs over the same
+ * original data. 0 uses one per thread, up to #SCENE_FRAMES_GRAPHS_NUM_DEFAULT. The extra graphs
+ * are built from the input scene, view layer and mode of \a depsgraph by \a build_fn, which must
+ * build them the same way as \a depsgraph was built. Scenes with simulations, or with frame
+ * change handlers, are evaluated one frame after the other with
+ * #BKE_scene_graph_update_for_newframe() instead.
+ *
+ * Unlike the sequential evaluation, the concurrent evaluation leaves the current frame of the
+ * original scene unchanged.
+ */
+void BKE_scene_graph_evaluate_frames(Depsgraph *depsgraph,
+                                     const double *frames,
+                                     const int frames_num,
+                                     int graphs_num,
+                                     SceneGraphBuildFn build_fn,
+                                     SceneGraphFrameFn frame_fn,
+                                     void *user_data)
+{
+  if (graphs_num <= 0) {
+    graphs_num = min_ii(BLI_task_scheduler_num_threads(), SCENE_FRAMES_GRAPHS_NUM_DEFAULT);
+  }
+  graphs_num = min_ii(graphs_num, frames_num);
+
+  if (graphs_num < 2 || scene_graph_frames_need_sequential(depsgraph)) {
+    Scene *scene = DEG_get_input_scene(depsgraph);
+    for (int i = 0; i < frames_num; i++) {
+      BKE_scene_frame_set(scene, frames[i]);
+      BKE_scene_graph_update_for_newframe(depsgraph);
+      if (!frame_fn(depsgraph, frames[i], user_data)) {
+        break;
+      }
+    }
+    return;
+  }
+
+  Main *bmain = DEG_get_bmain(depsgraph);
+  Scene *scene = DEG_get_input_scene(depsgraph);
+  ViewLayer *view_layer = DEG_get_input_view_layer(depsgraph);
+
+  /* The given graph evaluates the first frame of every batch, the others are only used here. */
+  Depsgraph **graphs = MEM_malloc_arrayN(graphs_num, sizeof(*graphs), __func__);
+  graphs[0] = depsgraph;
+  for (int i = 1; i < graphs_num; i++) {
+    graphs[i] = DEG_graph_new(bmain, scene, view_layer, DEG_get_mode(depsgraph));
+    build_fn(graphs[i], user_data);
+  }
+
+  SceneFramesEvalData data = {
+      .graphs = graphs,
+      .framelen = scene->r.framelen,
+  };
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+
+  for (int batch_start = 0; batch_start < frames_num; batch_start += graphs_num) {
+    const int batch_size = min_ii(graphs_num, frames_num - batch_start);
+    data.frames = &frames[batch_start];
+    BLI_task_parallel_range(0, batch_size, &data, scene_graph_evaluate_frame_cb, &settings);
+
+    bool do_continue = true;
+    for (int i = 0; i < batch_size && do_continue; i++) {
+      do_continue = frame_fn(graphs[i], frames[batch_start + i], user_data);
+    }
+    if (!do_continue) {
+      break;
+    }
+  }
+
+  for (int i = 1; i < graphs_num; i++) {
+    DEG_graph_free(graphs[i]);
+  }
+  MEM_freeN(graphs);
+}
+
+/** \} */
+
 /**
  * Ensures given scene/view_layer pair has a valid, up-to-date depsgraph.
  *
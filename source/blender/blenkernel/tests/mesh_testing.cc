@@ -0,0 +1,55 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 by Blender Foundation.
+ */
+#include "mesh_testing.hh"
+
+#include "BLI_math.h"
+
+#include "BKE_mesh.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+namespace blender::bke::tests {
+
+Mesh *mesh_grid_create(const int size)
+{
+  const int polys_len = (size - 1) * (size - 1);
+  Mesh *mesh = BKE_mesh_new_nomain(size * size, 0, 0, polys_len * 4, polys_len);
+
+  for (int y = 0; y < size; y++) {
+    for (int x = 0; x < size; x++) {
+      copy_v3_fl3(mesh->mvert[y * size + x].co, (float)x, (float)y, 0.0f);
+    }
+  }
+  MPoly *mpoly = mesh->mpoly;
+  MLoop *mloop = mesh->mloop;
+  for (int y = 0; y < size - 1; y++) {
+    for (int x = 0; x < size - 1; x++, mpoly++) {
+      mpoly->loopstart = (int)(mloop - mesh->mloop);
+      mpoly->totloop = 4;
+      (mloop++)->v = y * size + x;
+      (mloop++)->v = y * size + x + 1;
+      (mloop++)->v = (y + 1) * size + x + 1;
+      (mloop++)->v = (y + 1) * size + x;
+    }
+  }
+  BKE_mesh_calc_edges(mesh, false, false);
+  return mesh;
+}
+
+}  // namespace blender::bke::tests
@@ -0,0 +1,238 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup bli
+ */
+
+#include <stdio.h>
+#include <string.h>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_fileops.h"
+#include "BLI_listbase.h"
+#include "BLI_mmap.h"
+#include "BLI_threads.h"
+#include "BLI_utildefines.h"
+
+#ifdef WIN32
+#  include "BLI_winstuff.h"
+#  include <io.h>
+#else
+#  include <signal.h>
+#  include <sys/mman.h>
+#endif
+
+struct BLI_mmap_file {
+  /* The address to which the file was mapped. */
+  char *memory;
+
+  /* The length of the file (and therefore the mapped region). */
+  size_t length;
+
+  /* Set by the SIGBUS handler when accessing the mapped memory failed. */
+  volatile bool io_error;
+
+#ifdef WIN32
+  /* Handle of the file mapping object, needed to release it. */
+  HANDLE handle;
+#endif
+};
+
+#ifndef WIN32
+/* An IO error while accessing mapped memory raises SIGBUS, which would crash. The handler
+ * checks whether the fault is in one of the mapped files, flags the error and replaces the
+ * mapped memory with zeros so that reading can continue and fail gracefully afterwards.
+ *
+ * The list of mapped files is only modified under the lock, which the handler takes as well so
+ * files closed by other threads meanwhile are not accessed. This can't deadlock, the lock is
+ * never held while accessing mapped memory or allocating. */
+
+static ListBase open_mmaps = {NULL, NULL};
+static SpinLock open_mmaps_lock;
+static struct sigaction next_handler;
+static bool handler_installed = false;
+
+static void sigbus_handler(int sig, siginfo_t *siginfo, void *ptr)
+{
+  BLI_assert(sig == SIGBUS);
+  char *error_addr = (char *)siginfo->si_addr;
+  bool handled = false;
+
+  BLI_spin_lock(&open_mmaps_lock);
+  LISTBASE_FOREACH (LinkData *, link, &open_mmaps) {
+    BLI_mmap_file *file = link->data;
+    if (error_addr >= file->memory && error_addr < file->memory + file->length) {
+      file->io_error = true;
+      /* Replace the mapped memory with zeros, the faulting access is then retried. */
+      void *memory = mmap(file->memory,
+                          file->length,
+                          PROT_READ,
+                          MAP_PRIVATE | MAP_ANONYMOUS | MAP_FIXED,
+                          -1,
+                          0);
+      if (memory == MAP_FAILED) {
+        fprintf(stderr, "SIGBUS handler: error replacing mapped file with zeros\n");
+      }
+      else {
+        handled = true;
+      }
+      break;
+    }
+  }
+  BLI_spin_unlock(&open_mmaps_lock);
+
+  if (handled) {
+    return;
+  }
+
+  /* Not one of our files, let the previous handler or the default action deal with it. */
+  if (next_handler.sa_flags & SA_SIGINFO) {
+    next_handler.sa_sigaction(sig, siginfo, ptr);
+  }
+  else if (next_handler.sa_handler != SIG_DFL && next_handler.sa_handler != SIG_IGN) {
+    next_handler.sa_handler(sig);
+  }
+  else {
+    signal(SIGBUS, SIG_DFL);
+    raise(SIGBUS);
+  }
+}
+
+static bool sigbus_handler_add(BLI_mmap_file *file)
+{
+  if (!handler_installed) {
+    /* The lock must be usable before the handler can run. */
+    BLI_spin_init(&open_mmaps_lock);
+    struct sigaction newact = {{NULL}};
+    newact.sa_sigaction = sigbus_handler;
+    newact.sa_flags = SA_SIGINFO;
+    sigemptyset(&newact.sa_mask);
+    if (sigaction(SIGBUS, &newact, &next_handler) != 0) {
+      BLI_spin_end(&open_mmaps_lock);
+      return false;
+    }
+    handler_installed = true;
+  }
+
+  LinkData *link = BLI_genericNodeN(file);
+  BLI_spin_lock(&open_mmaps_lock);
+  BLI_addtail(&open_mmaps, link);
+  BLI_spin_unlock(&open_mmaps_lock);
+  return true;
+}
+
+static void sigbus_handler_remove(BLI_mmap_file *file)
+{
+  BLI_spin_lock(&open_mmaps_lock);
+  LinkData *link = BLI_findptr(&open_mmaps, file, offsetof(LinkData, data));
+  BLI_remlink(&open_mmaps, link);
+  BLI_spin_unlock(&open_mmaps_lock);
+  MEM_freeN(link);
+}
+#endif
+
+BLI_mmap_file *BLI_mmap_open(int fd)
+{
+  const int64_t length = BLI_lseek(fd, 0, SEEK_END);
+  if (length <= 0) {
+    /* Mapping empty files isn't supported (nor useful). */
+    return NULL;
+  }
+
+  void *memory;
+#ifdef WIN32
+  HANDLE file_handle = (HANDLE)_get_osfhandle(fd);
+  if (file_handle == INVALID_HANDLE_VALUE) {
+    return NULL;
+  }
+  HANDLE handle = CreateFileMapping(file_handle, NULL, PAGE_READONLY, 0, 0, NULL);
+  if (handle == NULL) {
+    return NULL;
+  }
+  memory = MapViewOfFile(handle, FILE_MAP_READ, 0, 0, 0);
+  if (memory == NULL) {
+    CloseHandle(handle);
+    return NULL;
+  }
+#else
+  memory = mmap(NULL, (size_t)length, PROT_READ, MAP_PRIVATE, fd, 0);
+  if (memory == MAP_FAILED) {
+    return NULL;
+  }
+#endif
+
+  BLI_mmap_file *file = MEM_callocN(sizeof(BLI_mmap_file), __func__);
+  file->memory = memory;
+  file->length = (size_t)length;
+#ifdef WIN32
+  file->handle = handle;
+#else
+  if (!sigbus_handler_add(file)) {
+    /* Without the handler IO errors would crash, read the file regularly instead. */
+    munmap(file->memory, file->length);
+    MEM_freeN(file);
+    return NULL;
+  }
+#endif
+
+  return file;
+}
+
+bool BLI_mmap_read(BLI_mmap_file *file, void *dest, size_t offset, size_t length)
+{
+  if (file->io_error) {
+    return false;
+  }
+
+  if (offset > file->length || length > file->length - offset) {
+    return false;
+  }
+
+  memcpy(dest, file->memory + offset, length);
+
+  /* The SIGBUS handler sets the error when the copy hit an IO error. */
+  return !file->io_error;
+}
+
+const void *BLI_mmap_get_pointer(const BLI_mmap_file *file)
+{
+  return file->memory;
+}
+
+size_t BLI_mmap_get_length(const BLI_mmap_file *file)
+{
+  return file->length;
+}
+
+bool BLI_mmap_has_io_error(const BLI_mmap_file *file)
+{
+  return file->io_error;
+}
+
+void BLI_mmap_free(BLI_mmap_file *file)
+{
+#ifdef WIN32
+  UnmapViewOfFile(file->memory);
+  CloseHandle(file->handle);
+#else
+  sigbus_handler_remove(file);
+  munmap(file->memory, file->length);
+#endif
+
+  MEM_freeN(file);
+}
@@ -0,0 +1,90 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include <atomic>
+#include <fcntl.h>
+#include <string>
+#include <thread>
+
+#include "BLI_fileops.h"
+#include "BLI_mmap.h"
+
+#ifndef _WIN32
+#  include <unistd.h>
+
+static const size_t file_length = 1 << 16;
+
+static std::string mmap_test_file_write(const char *name)
+{
+  const std::string filepath = testing::TempDir() + name;
+  FILE *file = BLI_fopen(filepath.c_str(), "wb");
+  for (size_t i = 0; i < file_length; i++) {
+    fputc((int)(i & 0xff), file);
+  }
+  fclose(file);
+  return filepath;
+}
+
+TEST(mmap, read)
+{
+  const std::string filepath = mmap_test_file_write("BLI_mmap_test_read");
+  const int fd = BLI_open(filepath.c_str(), O_RDONLY, 0);
+  ASSERT_GE(fd, 0);
+  BLI_mmap_file *file = BLI_mmap_open(fd);
+  ASSERT_NE(file, nullptr);
+  EXPECT_EQ(BLI_mmap_get_length(file), file_length);
+
+  unsigned char data[4];
+  EXPECT_TRUE(BLI_mmap_read(file, data, 1000, sizeof(data)));
+  EXPECT_EQ(data[0], 1000 & 0xff);
+  EXPECT_EQ(data[3], 1003 & 0xff);
+  EXPECT_FALSE(BLI_mmap_read(file, data, file_length - 2, sizeof(data)));
+  EXPECT_FALSE(BLI_mmap_has_io_error(file));
+
+  BLI_mmap_free(file);
+  close(fd);
+  BLI_delete(filepath.c_str(), false, false);
+}
+
+/* Reading a file truncated after mapping it faults, which must fail the read instead of crashing,
+ * also while other threads open and close mapped files. */
+TEST(mmap, truncated_while_mapped)
+{
+  const std::string filepath = mmap_test_file_write("BLI_mmap_test_truncated");
+  const std::string other_filepath = mmap_test_file_write("BLI_mmap_test_other");
+
+  std::atomic<bool> stop(false);
+  std::thread other_thread([&]() {
+    while (!stop) {
+      const int fd = BLI_open(other_filepath.c_str(), O_RDONLY, 0);
+      BLI_mmap_file *file = BLI_mmap_open(fd);
+      if (file) {
+        BLI_mmap_free(file);
+      }
+      close(fd);
+    }
+  });
+
+  for (int i = 0; i < 20; i++) {
+    const int fd = BLI_open(filepath.c_str(), O_RDWR, 0);
+    ASSERT_GE(fd, 0);
+    BLI_mmap_file *file = BLI_mmap_open(fd);
+    ASSERT_NE(file, nullptr);
+    ASSERT_EQ(ftruncate(fd, 0), 0);
+
+    unsigned char data[16];
+    EXPECT_FALSE(BLI_mmap_read(file, data, file_length / 2, sizeof(data)));
+    EXPECT_TRUE(BLI_mmap_has_io_error(file));
+
+    BLI_mmap_free(file);
+    close(fd);
+    mmap_test_file_write("BLI_mmap_test_truncated");
+  }
+
+  stop = true;
+  other_thread.join();
+  BLI_delete(filepath.c_str(), false, false);
+  BLI_delete(other_filepath.c_str(), false, false);
+}
+#endif
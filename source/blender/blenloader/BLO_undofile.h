@@ -24,15 +24,45 @@
  * \ingroup blenloader
  */
 
-struct Scene;
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct GHash;
+struct MemFileBufferStore;
+struct MemFileCompressTask;
+struct Scene;
+
+/**
+ * Contents of #MemFileChunk, shared by all chunks with identical contents (see undofile.c).
+ */
+typedef struct MemFileBuffer {
+  /** NULL while compressed, see #BLO_memfile_decompress. */
+  const char *data;
+  void *data_compressed;
+  /** Size in bytes. */
+  unsigned int size;
+  unsigned int size_compressed;
+  unsigned int hash;
+  /** Number of chunks using this buffer, and the ones among them in uncompressed memfiles. */
+  unsigned int users;
+  unsigned int users_hot;
+  /** In the store, false on hash collisions. */
+  bool is_stored;
+  bool is_compress_queued;
+  /** The background compression of this buffer, NULL once its result is swapped in. */
+  struct MemFileCompressTask *compress_task;
+  /** The memfile the memory of this buffer is accounted to (in #MemFile.size), may be NULL. */
+  struct MemFile *owner;
+} MemFileBuffer;
 
 typedef struct {
   void *next, *prev;
-  const char *buf;
+  MemFileBuffer *buffer;
   /** Size in bytes. */
   unsigned int size;
-  /** When true, this chunk doesn't own the memory, it's shared with a previous #MemFileChunk */
+  /** When true, this chunk is identical to the matching one of the previous #MemFile
+   * (used by undo code to detect unchanged IDs). */
   bool is_identical;
   /** When true, this chunk is also identical to the one in the next step (used by undo code to
    * detect unchanged IDs).
@@ -45,7 +75,13 @@ typedef struct {
 
 typedef struct MemFile {
   ListBase chunks;
+  /** Memory used by the buffers accounted to this memfile (the ones it added). */
   size_t size;
+  /** See #BLO_memfile_compress. */
+  bool is_compressed;
+  /** Contains the buffers of the chunks, shared with the memfiles written with this one as
+   * reference (NULL until written to). */
+  struct MemFileBufferStore *store;
 } MemFile;
 
 typedef struct MemFileWriteData {
@@ -78,9 +114,17 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, unsigned
 extern void BLO_memfile_free(MemFile *memfile);
 extern void BLO_memfile_merge(MemFile *first, MemFile *second);
 extern void BLO_memfile_clear_future(MemFile *memfile);
+extern void BLO_memfile_compress(MemFile *memfile);
+extern void BLO_memfile_decompress(MemFile *memfile);
+extern void BLO_memfile_compress_wait(MemFile *memfile);
+extern void BLO_memfile_copy_shared(MemFile *memfile, MemFile *r_memfile);
 
 /* utilities */
 extern struct Main *BLO_memfile_main_get(struct MemFile *memfile,
                                          struct Main *bmain,
                                          struct Scene **r_scene);
 extern bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename);
+
+#ifdef __cplusplus
+}
+#endif
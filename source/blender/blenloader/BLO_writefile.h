@@ -24,6 +24,10 @@
  * \brief external writefile function prototypes.
  */
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct BlendThumbnail;
 struct Main;
 struct MemFile;
@@ -71,4 +75,13 @@ extern bool BLO_write_file_mem(struct Main *mainvar,
                                struct MemFile *current,
                                int write_flags);
 
+extern bool BLO_write_file_from_memfile(struct MemFile *memfile,
+                                        const char *filepath,
+                                        const int write_flags,
+                                        const short *stop);
+
 /** \} */
+
+#ifdef __cplusplus
+}
+#endif
@@ -107,6 +107,8 @@
 #include "BLI_math.h"
 #include "BLI_memarena.h"
 #include "BLI_mempool.h"
+#include "BLI_mmap.h"
+#include "BLI_task.h"
 #include "BLI_threads.h"
 
 #include "BLT_translation.h"
@@ -236,8 +238,9 @@
  * Delay reading blocks we might not use (especially applies to library linking).
  * which keeps large arrays in memory from data-blocks we may not even use.
  *
- * \note This is disabled when using compression,
+ * \note This is disabled when reading compressed files without a seek table,
  * while zlib supports seek it's unusably slow, see: T61880.
+ * Files written with independently compressed frames support it, see #BLO_ZLIB_FRAME_SIZE.
  */
 #define USE_BHEAD_READ_ON_DEMAND
 
@@ -321,144 +324,9 @@ static const char *library_parent_filepath(Library *lib)
 /** \name OldNewMap API
  * \{ */
 
-typedef struct OldNew {
-  const void *oldp;
-  void *newp;
-  /* `nr` is "user count" for data, and ID code for libdata. */
-  int nr;
-} OldNew;
-
-typedef struct OldNewMap {
-  /* Array that stores the actual entries. */
-  OldNew *entries;
-  int nentries;
-  /* Hashmap that stores indices into the `entries` array. */
-  int32_t *map;
-
-  int capacity_exp;
-} OldNewMap;
-
-#define ENTRIES_CAPACITY(onm) (1ll << (onm)->capacity_exp)
-#define MAP_CAPACITY(onm) (1ll << ((onm)->capacity_exp + 1))
-#define SLOT_MASK(onm) (MAP_CAPACITY(onm) - 1)
-#define DEFAULT_SIZE_EXP 6
-#define PERTURB_SHIFT 5
-
-/* based on the probing algorithm used in Python dicts. */
-#define ITER_SLOTS(onm, KEY, SLOT_NAME, INDEX_NAME) \
-  uint32_t hash = BLI_ghashutil_ptrhash(KEY); \
-  uint32_t mask = SLOT_MASK(onm); \
-  uint perturb = hash; \
-  int SLOT_NAME = mask & hash; \
-  int INDEX_NAME = onm->map[SLOT_NAME]; \
-  for (;; SLOT_NAME = mask & ((5 * SLOT_NAME) + 1 + perturb), \
-          perturb >>= PERTURB_SHIFT, \
-          INDEX_NAME = onm->map[SLOT_NAME])
-
-static void oldnewmap_insert_index_in_map(OldNewMap *onm, const void *ptr, int index)
-{
-  ITER_SLOTS (onm, ptr, slot, stored_index) {
-    if (stored_index == -1) {
-      onm->map[slot] = index;
-      break;
-    }
-  }
-}
-
-static void oldnewmap_insert_or_replace(OldNewMap *onm, OldNew entry)
-{
-  ITER_SLOTS (onm, entry.oldp, slot, index) {
-    if (index == -1) {
-      onm->entries[onm->nentries] = entry;
-      onm->map[slot] = onm->nentries;
-      onm->nentries++;
-      break;
-    }
-    if (onm->entries[index].oldp == entry.oldp) {
-      onm->entries[index] = entry;
-      break;
-    }
-  }
-}
-
-static OldNew *oldnewmap_lookup_entry(const OldNewMap *onm, const void *addr)
-{
-  ITER_SLOTS (onm, addr, slot, index) {
-    if (index >= 0) {
-      OldNew *entry = &onm->entries[index];
-      if (entry->oldp == addr) {
-        return entry;
-      }
-    }
-    else {
-      return NULL;
-    }
-  }
-}
-
-static void oldnewmap_clear_map(OldNewMap *onm)
-{
-  memset(onm->map, 0xFF, MAP_CAPACITY(onm) * sizeof(*onm->map));
-}
-
-static void oldnewmap_increase_size(OldNewMap *onm)
-{
-  onm->capacity_exp++;
-  onm->entries = MEM_reallocN(onm->entries, sizeof(*onm->entries) * ENTRIES_CAPACITY(onm));
-  onm->map = MEM_reallocN(onm->map, sizeof(*onm->map) * MAP_CAPACITY(onm));
-  oldnewmap_clear_map(onm);
-  for (int i = 0; i < onm->nentries; i++) {
-    oldnewmap_insert_index_in_map(onm, onm->entries[i].oldp, i);
-  }
-}
-
-/* Public OldNewMap API */
-
-static OldNewMap *oldnewmap_new(void)
-{
-  OldNewMap *onm = MEM_callocN(sizeof(*onm), "OldNewMap");
-
-  onm->capacity_exp = DEFAULT_SIZE_EXP;
-  onm->entries = MEM_malloc_arrayN(
-      ENTRIES_CAPACITY(onm), sizeof(*onm->entries), "OldNewMap.entries");
-  onm->map = MEM_malloc_arrayN(MAP_CAPACITY(onm), sizeof(*onm->map), "OldNewMap.map");
-  oldnewmap_clear_map(onm);
-
-  return onm;
-}
-
-static void oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr, int nr)
-{
-  if (oldaddr == NULL || newaddr == NULL) {
-    return;
-  }
-
-  if (UNLIKELY(onm->nentries == ENTRIES_CAPACITY(onm))) {
-    oldnewmap_increase_size(onm);
-  }
-
-  OldNew entry;
-  entry.oldp = oldaddr;
-  entry.newp = newaddr;
-  entry.nr = nr;
-  oldnewmap_insert_or_replace(onm, entry);
-}
-
 void blo_do_versions_oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr, int nr)
 {
-  oldnewmap_insert(onm, oldaddr, newaddr, nr);
-}
-
-static void *oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool increase_users)
-{
-  OldNew *entry = oldnewmap_lookup_entry(onm, addr);
-  if (entry == NULL) {
-    return NULL;
-  }
-  if (increase_users) {
-    entry->nr++;
-  }
-  return entry->newp;
+  blo_oldnewmap_insert(onm, oldaddr, newaddr, nr);
 }
 
 /* for libdata, OldNew.nr has ID code, no increment */
@@ -468,7 +336,7 @@ static void *oldnewmap_liblookup(OldNewMap *onm, const void *addr, const void *l
     return NULL;
   }
 
-  ID *id = oldnewmap_lookup_and_inc(onm, addr, false);
+  ID *id = blo_oldnewmap_lookup_and_inc(onm, addr, false);
   if (id == NULL) {
     return NULL;
   }
@@ -478,36 +346,6 @@ static void *oldnewmap_liblookup(OldNewMap *onm, const void *addr, const void *l
   return NULL;
 }
 
-static void oldnewmap_clear(OldNewMap *onm)
-{
-  /* Free unused data. */
-  for (int i = 0; i < onm->nentries; i++) {
-    OldNew *entry = &onm->entries[i];
-    if (entry->nr == 0) {
-      MEM_freeN(entry->newp);
-      entry->newp = NULL;
-    }
-  }
-
-  onm->capacity_exp = DEFAULT_SIZE_EXP;
-  oldnewmap_clear_map(onm);
-  onm->nentries = 0;
-}
-
-static void oldnewmap_free(OldNewMap *onm)
-{
-  MEM_freeN(onm->entries);
-  MEM_freeN(onm->map);
-  MEM_freeN(onm);
-}
-
-#undef ENTRIES_CAPACITY
-#undef MAP_CAPACITY
-#undef SLOT_MASK
-#undef DEFAULT_SIZE_EXP
-#undef PERTURB_SHIFT
-#undef ITER_SLOTS
-
 /** \} */
 
 /* -------------------------------------------------------------------- */
@@ -998,6 +836,11 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
   bool success = true;
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
   BLI_assert(new_bhead->has_data == false && new_bhead->file_offset != 0);
+  if (fd->mmap_file != NULL) {
+    /* Doesn't change the file position, so this is safe to use from multiple threads. */
+    return BLI_mmap_read(
+        fd->mmap_file, buf, (size_t)new_bhead->file_offset, (size_t)new_bhead->bhead.len);
+  }
   off64_t offset_backup = fd->file_offset;
   if (UNLIKELY(fd->seek(fd, new_bhead->file_offset, SEEK_SET) == -1)) {
     success = false;
@@ -1014,6 +857,26 @@ static bool blo_bhead_read_data(FileData *fd, BHead *thisblock, void *buf)
   return success;
 }
 
+/**
+ * Access the data of a delayed block in place when the file is memory mapped,
+ * avoiding a temporary copy when the data only needs to be read once.
+ *
+ * \return NULL when the data isn't mapped and must be read instead.
+ * Callers must check #BLI_mmap_has_io_error once they are done reading the data.
+ */
+static const void *blo_bhead_data_mapped(FileData *fd, BHead *thisblock)
+{
+  BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
+  if (fd->mmap_file == NULL || new_bhead->has_data) {
+    return NULL;
+  }
+  if ((size_t)new_bhead->file_offset + (size_t)new_bhead->bhead.len >
+      BLI_mmap_get_length(fd->mmap_file)) {
+    return NULL;
+  }
+  return POINTER_OFFSET(BLI_mmap_get_pointer(fd->mmap_file), new_bhead->file_offset);
+}
+
 static BHead *blo_bhead_read_full(FileData *fd, BHead *thisblock)
 {
   BHeadN *new_bhead = BHEADN_FROM_BHEAD(thisblock);
@@ -1084,7 +947,11 @@ static bool read_file_dna(FileData *fd, const char **r_error_message)
   BHead *bhead;
   int subversion = 0;
 
+  fd->id_bheads_num = 0;
   for (bhead = blo_bhead_first(fd); bhead; bhead = blo_bhead_next(fd, bhead)) {
+    if (bhead->code != DATA) {
+      fd->id_bheads_num++;
+    }
     if (bhead->code == GLOB) {
       /* Before this, the subversion didn't exist in 'FileGlobal' so the subversion
        * value isn't accessible for the purpose of DNA versioning in this case. */
@@ -1196,6 +1063,53 @@ static off64_t fd_seek_data_from_file(FileData *filedata, off64_t offset, int wh
   return filedata->file_offset;
 }
 
+/* Memory-mapped file reading. */
+
+static int fd_read_from_mmap(FileData *filedata,
+                             void *buffer,
+                             uint size,
+                             bool *UNUSED(r_is_memchunck_identical))
+{
+  /* Don't read more bytes than there are available in the file. */
+  const size_t length = BLI_mmap_get_length(filedata->mmap_file);
+  if ((size_t)filedata->file_offset >= length) {
+    return 0;
+  }
+  const uint readsize = (uint)MIN2(size, length - (size_t)filedata->file_offset);
+
+  /* Fails when an IO error was caught by the SIGBUS handler, during this or an earlier read. */
+  if (!BLI_mmap_read(filedata->mmap_file, buffer, (size_t)filedata->file_offset, readsize)) {
+    return EOF;
+  }
+  filedata->file_offset += readsize;
+
+  return (int)readsize;
+}
+
+static off64_t fd_seek_from_mmap(FileData *filedata, off64_t offset, int whence)
+{
+  off64_t new_pos;
+  switch (whence) {
+    case SEEK_SET:
+      new_pos = offset;
+      break;
+    case SEEK_CUR:
+      new_pos = filedata->file_offset + offset;
+      break;
+    case SEEK_END:
+      new_pos = (off64_t)BLI_mmap_get_length(filedata->mmap_file) + offset;
+      break;
+    default:
+      return -1;
+  }
+
+  if (new_pos < 0 || (size_t)new_pos > BLI_mmap_get_length(filedata->mmap_file)) {
+    return -1;
+  }
+  filedata->file_offset = new_pos;
+  return new_pos;
+}
+
 /* GZip file reading. */
 
 static int fd_read_gzip_from_file(FileData *filedata,
@@ -1215,6 +1129,259 @@ static int fd_read_gzip_from_file(FileData *filedata,
   return readsize;
 }
 
+/* Seekable GZip file reading (independently compressed frames). */
+
+/**
+ * Number of decompressed frames kept around, reading blocks on demand jumps back and forth
+ * between nearby frames.
+ */
+#define ZLIB_FRAMES_CACHE_NUM 4
+
+/** Deflate can't compress data to less than about 1/1032 of its size. */
+#define ZLIB_DEFLATE_RATIO_MAX 1032
+
+typedef struct ZlibFrameCacheItem {
+  /** Index of the decompressed frame, -1 when unused. */
+  int frame_index;
+  uint frame_len;
+  uchar *frame_buf;
+  /** For evicting the least recently used frame. */
+  uint64_t last_used;
+} ZlibFrameCacheItem;
+
+typedef struct ZlibFrameReader {
+  /** Offset of each frame in the compressed file, `frames_num + 1` items. */
+  int64_t *frame_offsets;
+  int frames_num;
+  uint frame_size;
+
+  ZlibFrameCacheItem cache[ZLIB_FRAMES_CACHE_NUM];
+  uint64_t cache_tick;
+
+  /** Compressed data of the frame being decompressed. */
+  uchar *frame_compressed_buf;
+  uint frame_compressed_buf_len;
+
+  z_stream strm;
+} ZlibFrameReader;
+
+static uint32_t zlib_frames_uint32_decode(const uchar *buf)
+{
+  return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) |
+         ((uint32_t)buf[3] << 24);
+}
+
+static bool zlib_frames_read_at(int file, int64_t offset, void *buffer, size_t size)
+{
+  return (BLI_lseek(file, offset, SEEK_SET) == offset) &&
+         ((size_t)read(file, buffer, size) == size);
+}
+
+/**
+ * Read the seek table from the end of the file, see #BLO_ZLIB_FRAME_SIZE.
+ *
+ * \return NULL when the file has no (valid) seek table, it's then read as a regular gzip stream.
+ */
+static ZlibFrameReader *zlib_frames_reader_create_from_seek_table(int file)
+{
+  const int64_t file_size = BLI_lseek(file, 0, SEEK_END);
+  uchar tail[BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE + BLO_ZLIB_SEEK_TABLE_TRAILER_SIZE];
+  ZlibFrameReader *zframes = NULL;
+
+  if (file_size < BLO_ZLIB_SEEK_TABLE_HEADER_SIZE + (int64_t)sizeof(tail) ||
+      !zlib_frames_read_at(file, file_size - (int64_t)sizeof(tail), tail, sizeof(tail))) {
+    return NULL;
+  }
+
+  const uchar trailer_expect[BLO_ZLIB_SEEK_TABLE_TRAILER_SIZE] = {0x03, 0x00};
+  const uchar *trailer = tail + BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE;
+  if (memcmp(tail + 8, BLO_ZLIB_FRAMES_MAGIC, 4) != 0 ||
+      memcmp(trailer, trailer_expect, sizeof(trailer_expect)) != 0) {
+    return NULL;
+  }
+
+  const uint frame_size = zlib_frames_uint32_decode(tail);
+  const uint32_t frames_num = zlib_frames_uint32_decode(tail + 4);
+  if (frame_size == 0 || frame_size > BLO_ZLIB_FRAME_SIZE_MAX || frames_num == 0 ||
+      frames_num > BLO_ZLIB_SEEK_TABLE_FRAMES_MAX) {
+    return NULL;
+  }
+
+  const uint subfield_len = frames_num * 4 + BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE;
+  const int64_t table_offset = file_size - BLO_ZLIB_SEEK_TABLE_TRAILER_SIZE - subfield_len -
+                               BLO_ZLIB_SEEK_TABLE_HEADER_SIZE;
+  if (table_offset <= 0) {
+    return NULL;
+  }
+  /* Don't trust a frame size that the compressed data can't possibly inflate to. */
+  if ((uint64_t)frame_size > (uint64_t)table_offset * ZLIB_DEFLATE_RATIO_MAX) {
+    return NULL;
+  }
+
+  uchar header[BLO_ZLIB_SEEK_TABLE_HEADER_SIZE];
+  if (!zlib_frames_read_at(file, table_offset, header, sizeof(header)) ||
+      !(header[0] == 0x1f && header[1] == 0x8b && header[3] == 4) ||
+      (uint)(header[10] | (header[11] << 8)) != subfield_len + 4 ||
+      !(header[12] == 'B' && header[13] == 'S') ||
+      (uint)(header[14] | (header[15] << 8)) != subfield_len) {
+    return NULL;
+  }
+
+  uchar *sizes = MEM_mallocN(frames_num * 4, __func__);
+  if (zlib_frames_read_at(file, table_offset + sizeof(header), sizes, frames_num * 4)) {
+    int64_t *frame_offsets = MEM_malloc_arrayN(
+        frames_num + 1, sizeof(*frame_offsets), __func__);
+    frame_offsets[0] = 0;
+    for (uint i = 0; i < frames_num; i++) {
+      frame_offsets[i + 1] = frame_offsets[i] + zlib_frames_uint32_decode(sizes + i * 4);
+    }
+
+    /* The frames must exactly fill the file up to the seek table. */
+    if (frame_offsets[frames_num] == table_offset) {
+      zframes = MEM_callocN(sizeof(*zframes), __func__);
+      zframes->frame_offsets = frame_offsets;
+      zframes->frames_num = (int)frames_num;
+      zframes->frame_size = frame_size;
+      for (int i = 0; i < ZLIB_FRAMES_CACHE_NUM; i++) {
+        zframes->cache[i].frame_index = -1;
+      }
+      if (inflateInit2(&zframes->strm, 16 + MAX_WBITS) != Z_OK) {
+        MEM_freeN(zframes);
+        zframes = NULL;
+      }
+    }
+    if (zframes == NULL) {
+      MEM_freeN(frame_offsets);
+    }
+  }
+  MEM_freeN(sizes);
+
+  return zframes;
+}
+
+static ZlibFrameReader *zlib_frames_reader_create(int file)
+{
+  ZlibFrameReader *zframes = zlib_frames_reader_create_from_seek_table(file);
+  BLI_lseek(file, 0, SEEK_SET);
+  return zframes;
+}
+
+static void zlib_frames_reader_free(ZlibFrameReader *zframes)
+{
+  inflateEnd(&zframes->strm);
+  MEM_freeN(zframes->frame_offsets);
+  for (int i = 0; i < ZLIB_FRAMES_CACHE_NUM; i++) {
+    MEM_SAFE_FREE(zframes->cache[i].frame_buf);
+  }
+  MEM_SAFE_FREE(zframes->frame_compressed_buf);
+  MEM_freeN(zframes);
+}
+
+/**
+ * Ensure \a frame_index is decompressed into one of the cached frames.
+ *
+ * \return The cached frame, NULL on failure.
+ */
+static ZlibFrameCacheItem *zlib_frames_reader_load(FileData *filedata, int frame_index)
+{
+  ZlibFrameReader *zframes = filedata->zframes;
+  ZlibFrameCacheItem *item = &zframes->cache[0];
+
+  for (int i = 0; i < ZLIB_FRAMES_CACHE_NUM; i++) {
+    ZlibFrameCacheItem *item_test = &zframes->cache[i];
+    if (item_test->frame_index == frame_index) {
+      item_test->last_used = ++zframes->cache_tick;
+      return item_test;
+    }
+    if (item_test->last_used < item->last_used) {
+      item = item_test;
+    }
+  }
+
+  /* Replace the least recently used frame. */
+  item->frame_index = -1;
+  if (item->frame_buf == NULL) {
+    item->frame_buf = MEM_mallocN(zframes->frame_size, __func__);
+  }
+
+  const int64_t offset = zframes->frame_offsets[frame_index];
+  const uint compressed_len = (uint)(zframes->frame_offsets[frame_index + 1] - offset);
+  if (compressed_len > zframes->frame_compressed_buf_len) {
+    MEM_SAFE_FREE(zframes->frame_compressed_buf);
+    zframes->frame_compressed_buf = MEM_mallocN(compressed_len, __func__);
+    zframes->frame_compressed_buf_len = compressed_len;
+  }
+  if (!zlib_frames_read_at(
+          filedata->filedes, offset, zframes->frame_compressed_buf, compressed_len)) {
+    return NULL;
+  }
+
+  z_stream *strm = &zframes->strm;
+  inflateReset(strm);
+  strm->next_in = zframes->frame_compressed_buf;
+  strm->avail_in = compressed_len;
+  strm->next_out = item->frame_buf;
+  strm->avail_out = zframes->frame_size;
+  if (inflate(strm, Z_FINISH) != Z_STREAM_END) {
+    printf("%s: zlib error\n", __func__);
+    return NULL;
+  }
+
+  item->frame_index = frame_index;
+  item->frame_len = zframes->frame_size - strm->avail_out;
+  item->last_used = ++zframes->cache_tick;
+  return item;
+}
+
+static int fd_read_zlib_frames_from_file(FileData *filedata,
+                                         void *buffer,
+                                         uint size,
+                                         bool *UNUSED(r_is_memchunck_identical))
+{
+  ZlibFrameReader *zframes = filedata->zframes;
+  uint readsize = 0;
+
+  while (readsize < size) {
+    const int frame_index = (int)(filedata->file_offset / zframes->frame_size);
+    if (frame_index >= zframes->frames_num) {
+      break;
+    }
+    const ZlibFrameCacheItem *item = zlib_frames_reader_load(filedata, frame_index);
+    if (item == NULL) {
+      return EOF;
+    }
+    const uint frame_offset = (uint)(filedata->file_offset % zframes->frame_size);
+    if (frame_offset >= item->frame_len) {
+      break;
+    }
+    const uint len = MIN2(size - readsize, item->frame_len - frame_offset);
+    memcpy(POINTER_OFFSET(buffer, readsize), item->frame_buf + frame_offset, len);
+    readsize += len;
+    filedata->file_offset += len;
+  }
+
+  return (int)readsize;
+}
+
+static off64_t fd_seek_zlib_frames_from_file(FileData *filedata, off64_t offset, int whence)
+{
+  switch (whence) {
+    case SEEK_SET:
+      break;
+    case SEEK_CUR:
+      offset += filedata->file_offset;
+      break;
+    default:
+      /* The uncompressed size isn't stored, not needed for reading. */
+      return -1;
+  }
+  if (offset < 0) {
+    return -1;
+  }
+  filedata->file_offset = offset;
+  return offset;
+}
+
 /* Memory reading. */
 
 static int fd_read_from_memory(FileData *filedata,
@@ -1292,7 +1459,7 @@ static int fd_read_from_memfile(FileData *filedata,
         readsize = chunk->size - chunkoffset;
       }
 
-      memcpy(POINTER_OFFSET(buffer, totread), chunk->buf + chunkoffset, readsize);
+      memcpy(POINTER_OFFSET(buffer, totread), chunk->buffer->data + chunkoffset, readsize);
       totread += readsize;
       filedata->file_offset += readsize;
       seek += readsize;
@@ -1322,9 +1489,9 @@ static FileData *filedata_new(void)
 
   fd->memsdna = DNA_sdna_current_get();
 
-  fd->datamap = oldnewmap_new();
-  fd->globmap = oldnewmap_new();
-  fd->libmap = oldnewmap_new();
+  fd->datamap = blo_oldnewmap_new();
+  fd->globmap = blo_oldnewmap_new();
+  fd->libmap = blo_oldnewmap_new();
 
   return fd;
 }
@@ -1360,6 +1527,8 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   FileDataSeekFn *seek_fn = NULL; /* Optional. */
 
   gzFile gzfile = (gzFile)Z_NULL;
+  ZlibFrameReader *zframes = NULL;
+  BLI_mmap_file *mmap_file = NULL;
 
   char header[7];
 
@@ -1378,8 +1547,18 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   /* Regular file. */
   if (memcmp(header, "BLENDER", sizeof(header)) == 0) {
-    read_fn = fd_read_data_from_file;
-    seek_fn = fd_seek_data_from_file;
+    /* Map the file when possible, reading blocks is then a copy from the page cache
+     * without a system call for each of them. */
+    mmap_file = BLI_mmap_open(file);
+    if (mmap_file != NULL) {
+      read_fn = fd_read_from_mmap;
+      seek_fn = fd_seek_from_mmap;
+    }
+    else {
+      read_fn = fd_read_data_from_file;
+      seek_fn = fd_seek_data_from_file;
+    }
+    BLI_lseek(file, 0, SEEK_SET);
   }
 
   /* Gzip file. */
@@ -1387,20 +1566,28 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
   if ((read_fn == NULL) &&
       /* Check header magic. */
       (header[0] == 0x1f && header[1] == 0x8b)) {
-    gzfile = BLI_gzopen(filepath, "rb");
-    if (gzfile == (gzFile)Z_NULL) {
-      BKE_reportf(reports,
-                  RPT_WARNING,
-                  "Unable to open '%s': %s",
-                  filepath,
-                  errno ? strerror(errno) : TIP_("unknown error reading file"));
-      return NULL;
+    zframes = zlib_frames_reader_create(file);
+    if (zframes != NULL) {
+      /* Frames can be decompressed individually, which makes seeking cheap. */
+      read_fn = fd_read_zlib_frames_from_file;
+      seek_fn = fd_seek_zlib_frames_from_file;
     }
+    else {
+      gzfile = BLI_gzopen(filepath, "rb");
+      if (gzfile == (gzFile)Z_NULL) {
+        BKE_reportf(reports,
+                    RPT_WARNING,
+                    "Unable to open '%s': %s",
+                    filepath,
+                    errno ? strerror(errno) : TIP_("unknown error reading file"));
+        return NULL;
+      }
 
-    /* 'seek_fn' is too slow for gzip, don't set it. */
-    read_fn = fd_read_gzip_from_file;
-    /* Caller must close. */
-    file = -1;
+      /* 'seek_fn' is too slow for gzip, don't set it. */
+      read_fn = fd_read_gzip_from_file;
+      /* Caller must close. */
+      file = -1;
+    }
   }
 
   if (read_fn == NULL) {
@@ -1412,6 +1599,8 @@ static FileData *blo_filedata_from_file_descriptor(const char *filepath,
 
   fd->filedes = file;
   fd->gzfiledes = gzfile;
+  fd->zframes = zframes;
+  fd->mmap_file = mmap_file;
 
   fd->read = read_fn;
   fd->seek = seek_fn;
@@ -1479,20 +1668,30 @@ static int fd_read_gzip_from_memory(FileData *filedata,
   filedata->strm.next_out = (Bytef *)buffer;
   filedata->strm.avail_out = size;
 
-  // Inflate another chunk.
-  err = inflate(&filedata->strm, Z_SYNC_FLUSH);
+  while (filedata->strm.avail_out != 0) {
+    // Inflate another chunk.
+    err = inflate(&filedata->strm, Z_SYNC_FLUSH);
 
-  if (err == Z_STREAM_END) {
-    return 0;
-  }
-  if (err != Z_OK) {
-    printf("fd_read_gzip_from_memory: zlib error\n");
-    return 0;
+    if (err == Z_STREAM_END) {
+      if (filedata->strm.avail_in == 0) {
+        break;
+      }
+      /* Compressed files are written as multiple gzip members, continue with the next one. */
+      if (inflateReset(&filedata->strm) != Z_OK) {
+        printf("fd_read_gzip_from_memory: zlib error\n");
+        return 0;
+      }
+    }
+    else if (err != Z_OK) {
+      printf("fd_read_gzip_from_memory: zlib error\n");
+      return 0;
+    }
   }
 
-  filedata->file_offset += size;
+  const int readsize = (int)(size - filedata->strm.avail_out);
+  filedata->file_offset += readsize;
 
-  return size;
+  return readsize;
 }
 
 static int fd_read_gzip_from_memory_init(FileData *fd)
@@ -1551,6 +1750,9 @@ FileData *blo_filedata_from_memfile(MemFile *memfile,
     return NULL;
   }
 
+  /* Old undo steps may have been compressed. */
+  BLO_memfile_decompress(memfile);
+
   FileData *fd = filedata_new();
   fd->memfile = memfile;
   fd->undo_direction = params->undo_direction;
@@ -1572,6 +1774,14 @@ void blo_filedata_free(FileData *fd)
       gzclose(fd->gzfiledes);
     }
 
+    if (fd->zframes != NULL) {
+      zlib_frames_reader_free(fd->zframes);
+    }
+
+    if (fd->mmap_file != NULL) {
+      BLI_mmap_free(fd->mmap_file);
+    }
+
     if (fd->strm.next_in) {
       if (inflateEnd(&fd->strm) != Z_OK) {
         printf("close gzip stream error\n");
@@ -1604,16 +1814,16 @@ void blo_filedata_free(FileData *fd)
     }
 
     if (fd->datamap) {
-      oldnewmap_free(fd->datamap);
+      blo_oldnewmap_free(fd->datamap);
     }
     if (fd->globmap) {
-      oldnewmap_free(fd->globmap);
+      blo_oldnewmap_free(fd->globmap);
     }
     if (fd->packedmap) {
-      oldnewmap_free(fd->packedmap);
+      blo_oldnewmap_free(fd->packedmap);
     }
     if (fd->libmap && !(fd->flags & FD_FLAGS_NOT_MY_LIBMAP)) {
-      oldnewmap_free(fd->libmap);
+      blo_oldnewmap_free(fd->libmap);
     }
     if (fd->old_idmap != NULL) {
       BKE_main_idmap_destroy(fd->old_idmap);
@@ -1770,29 +1980,29 @@ BlendThumbnail *BLO_thumbnail_from_file(const char *filepath)
 /* only direct databocks */
 static void *newdataadr(FileData *fd, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
+  return blo_oldnewmap_lookup_and_inc(fd->datamap, adr, true);
 }
 
 /* only direct databocks */
 static void *newdataadr_no_us(FileData *fd, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, false);
+  return blo_oldnewmap_lookup_and_inc(fd->datamap, adr, false);
 }
 
 /* direct datablocks with global linking */
 static void *newglobadr(FileData *fd, const void *adr)
 {
-  return oldnewmap_lookup_and_inc(fd->globmap, adr, true);
+  return blo_oldnewmap_lookup_and_inc(fd->globmap, adr, true);
 }
 
 /* used to restore packed data after undo */
 static void *newpackedadr(FileData *fd, const void *adr)
 {
   if (fd->packedmap && adr) {
-    return oldnewmap_lookup_and_inc(fd->packedmap, adr, true);
+    return blo_oldnewmap_lookup_and_inc(fd->packedmap, adr, true);
   }
 
-  return oldnewmap_lookup_and_inc(fd->datamap, adr, true);
+  return blo_oldnewmap_lookup_and_inc(fd->datamap, adr, true);
 }
 
 /* only lib data */
@@ -1808,20 +2018,31 @@ void *blo_do_versions_newlibadr(FileData *fd, const void *lib, const void *adr)
 }
 
 /* increases user number */
-static void change_link_placeholder_to_real_ID_pointer_fd(FileData *fd, const void *old, void *new)
-{
-  for (int i = 0; i < fd->libmap->nentries; i++) {
-    OldNew *entry = &fd->libmap->entries[i];
+typedef struct ChangeLinkPlaceholderData {
+  const void *old;
+  void *new;
+} ChangeLinkPlaceholderData;
 
-    if (old == entry->newp && entry->nr == ID_LINK_PLACEHOLDER) {
-      entry->newp = new;
-      if (new) {
-        entry->nr = GS(((ID *)new)->name);
-      }
+static void change_link_placeholder_to_real_ID_pointer_fd_cb(void *user_data,
+                                                              const void *UNUSED(oldp),
+                                                              void **r_newp,
+                                                              int *r_nr)
+{
+  ChangeLinkPlaceholderData *data = user_data;
+  if (data->old == *r_newp && *r_nr == ID_LINK_PLACEHOLDER) {
+    *r_newp = data->new;
+    if (data->new) {
+      *r_nr = GS(((ID *)data->new)->name);
     }
   }
 }
 
+static void change_link_placeholder_to_real_ID_pointer_fd(FileData *fd, const void *old, void *new)
+{
+  ChangeLinkPlaceholderData data = {old, new};
+  blo_oldnewmap_foreach(fd->libmap, change_link_placeholder_to_real_ID_pointer_fd_cb, &data);
+}
+
 static void change_link_placeholder_to_real_ID_pointer(ListBase *mainlist,
                                                        FileData *basefd,
                                                        void *old,
@@ -1863,13 +2084,13 @@ void blo_clear_proxy_pointers_from_lib(Main *oldmain)
 
 static void insert_packedmap(FileData *fd, PackedFile *pf)
 {
-  oldnewmap_insert(fd->packedmap, pf, pf, 0);
-  oldnewmap_insert(fd->packedmap, pf->data, pf->data, 0);
+  blo_oldnewmap_insert(fd->packedmap, pf, pf, 0);
+  blo_oldnewmap_insert(fd->packedmap, pf->data, pf->data, 0);
 }
 
 void blo_make_packed_pointer_map(FileData *fd, Main *oldmain)
 {
-  fd->packedmap = oldnewmap_new();
+  fd->packedmap = blo_oldnewmap_new();
 
   LISTBASE_FOREACH (Image *, ima, &oldmain->images) {
     if (ima->packedfile) {
@@ -1910,16 +2131,20 @@ void blo_make_packed_pointer_map(FileData *fd, Main *oldmain)
 
 /* set old main packed data to zero if it has been restored */
 /* this works because freeing old main only happens after this call */
-void blo_end_packed_pointer_map(FileData *fd, Main *oldmain)
+static void end_packed_pointer_map_cb(void *UNUSED(user_data),
+                                      const void *UNUSED(oldp),
+                                      void **r_newp,
+                                      int *r_nr)
 {
-  OldNew *entry = fd->packedmap->entries;
+  if (*r_nr > 0) {
+    *r_newp = NULL;
+  }
+}
 
+void blo_end_packed_pointer_map(FileData *fd, Main *oldmain)
+{
   /* used entries were restored, so we put them to zero */
-  for (int i = 0; i < fd->packedmap->nentries; i++, entry++) {
-    if (entry->nr > 0) {
-      entry->newp = NULL;
-    }
-  }
+  blo_oldnewmap_foreach(fd->packedmap, end_packed_pointer_map_cb, NULL);
 
   LISTBASE_FOREACH (Image *, ima, &oldmain->images) {
     ima->packedfile = newpackedadr(fd, ima->packedfile);
@@ -1955,7 +2180,7 @@ void blo_add_library_pointer_map(ListBase *old_mainlist, FileData *fd)
     int i = set_listbasepointers(ptr, lbarray);
     while (i--) {
       LISTBASE_FOREACH (ID *, id, lbarray[i]) {
-        oldnewmap_insert(fd->libmap, id, id, GS(id->name));
+        blo_oldnewmap_insert(fd->libmap, id, id, GS(id->name));
       }
     }
   }
@@ -2135,7 +2360,13 @@ static void switch_endian_structs(const struct SDNA *filesdna, BHead *bhead)
   }
 }
 
-static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+/**
+ * Read and reconstruct the data of a block.
+ *
+ * Doesn't modify \a fd so it can be used from multiple threads (see #read_data_into_datamap),
+ * read errors are reported in \a r_failed instead.
+ */
+static void *read_struct_ex(FileData *fd, BHead *bh, const char *blockname, bool *r_failed)
 {
   void *temp = NULL;
 
@@ -2150,7 +2381,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
       if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
         bh = blo_bhead_read_full(fd, bh);
         if (UNLIKELY(bh == NULL)) {
-          fd->flags &= ~FD_FLAGS_FILE_OK;
+          *r_failed = true;
           return NULL;
         }
       }
@@ -2160,17 +2391,31 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
 
     if (fd->compflags[bh->SDNAnr] != SDNA_CMP_REMOVED) {
       if (fd->compflags[bh->SDNAnr] == SDNA_CMP_NOT_EQUAL) {
+        const void *data = (bh + 1);
 #ifdef USE_BHEAD_READ_ON_DEMAND
         if (BHEADN_FROM_BHEAD(bh)->has_data == false) {
-          bh = blo_bhead_read_full(fd, bh);
-          if (UNLIKELY(bh == NULL)) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
-            return NULL;
+          /* Reconstruct directly from the mapped file when possible. */
+          data = blo_bhead_data_mapped(fd, bh);
+          if (data == NULL) {
+            bh = blo_bhead_read_full(fd, bh);
+            if (UNLIKELY(bh == NULL)) {
+              *r_failed = true;
+              return NULL;
+            }
+            data = (bh + 1);
           }
         }
 #endif
         temp = DNA_struct_reconstruct(
-            fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, (bh + 1));
+            fd->memsdna, fd->filesdna, fd->compflags, bh->SDNAnr, bh->nr, data);
+#ifdef USE_BHEAD_READ_ON_DEMAND
+        if (UNLIKELY(fd->mmap_file != NULL && BLI_mmap_has_io_error(fd->mmap_file))) {
+          /* The mapped data read as zeros after an IO error. */
+          *r_failed = true;
+          MEM_freeN(temp);
+          temp = NULL;
+        }
+#endif
       }
       else {
         /* SDNA_CMP_EQUAL */
@@ -2183,7 +2428,7 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
           /* Instead of allocating the bhead, then copying it,
            * read the data from the file directly into the memory. */
           if (UNLIKELY(!blo_bhead_read_data(fd, bh, temp))) {
-            fd->flags &= ~FD_FLAGS_FILE_OK;
+            *r_failed = true;
             MEM_freeN(temp);
             temp = NULL;
           }
@@ -2204,6 +2449,16 @@ static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
   return temp;
 }
 
+static void *read_struct(FileData *fd, BHead *bh, const char *blockname)
+{
+  bool failed = false;
+  void *temp = read_struct_ex(fd, bh, blockname, &failed);
+  if (UNLIKELY(failed)) {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+  }
+  return temp;
+}
+
 /* Like read_struct, but gets a pointer without allocating. Only works for
  * undo since DNA must match. */
 static const void *peek_struct_undo(FileData *fd, BHead *bhead)
@@ -2223,7 +2478,7 @@ static void link_glob_list(FileData *fd, ListBase *lb) /* for glob data */
   }
   poin = newdataadr(fd, lb->first);
   if (lb->first) {
-    oldnewmap_insert(fd->globmap, lb->first, poin, 0);
+    blo_oldnewmap_insert(fd->globmap, lb->first, poin, 0);
   }
   lb->first = poin;
 
@@ -2232,7 +2487,7 @@ static void link_glob_list(FileData *fd, ListBase *lb) /* for glob data */
   while (ln) {
     poin = newdataadr(fd, ln->next);
     if (ln->next) {
-      oldnewmap_insert(fd->globmap, ln->next, poin, 0);
+      blo_oldnewmap_insert(fd->globmap, ln->next, poin, 0);
     }
     ln->next = poin;
     ln->prev = prev;
@@ -6537,7 +6792,7 @@ static void direct_link_windowmanager(BlendDataReader *reader, wmWindowManager *
 
     /* we need to restore a pointer to this later when reading workspaces,
      * so store in global oldnew-map. */
-    oldnewmap_insert(reader->fd->globmap, hook, win->workspace_hook, 0);
+    blo_oldnewmap_insert(reader->fd->globmap, hook, win->workspace_hook, 0);
 
     direct_link_area_map(reader, &win->global_areas);
 
@@ -8141,37 +8396,134 @@ static bool direct_link_id(FileData *fd, Main *main, const int tag, ID *id, ID *
   return success;
 }
 
+/**
+ * Minimum total size of the data blocks of a single data-block to reconstruct them using
+ * multiple threads, below this the overhead of scheduling outweighs the gain.
+ * Many small blocks are cheap to read, while a few large ones (mesh layers) are not.
+ */
+#define READ_DATA_PARALLEL_MIN_BYTES (256 * 1024)
+
+typedef struct ReadDataParallelData {
+  FileData *fd;
+  BHead **bheads;
+  void **data;
+  const char *allocname;
+} ReadDataParallelData;
+
+static void read_data_into_datamap_parallel_cb(void *__restrict userdata,
+                                               const int i,
+                                               const TaskParallelTLS *__restrict tls)
+{
+  ReadDataParallelData *data = userdata;
+  bool *failed = tls->userdata_chunk;
+  data->data[i] = read_struct_ex(data->fd, data->bheads[i], data->allocname, failed);
+}
+
+static void read_data_into_datamap_parallel_reduce(const void *__restrict UNUSED(userdata),
+                                                   void *__restrict chunk_join,
+                                                   void *__restrict chunk)
+{
+  bool *failed_join = chunk_join;
+  const bool *failed = chunk;
+  *failed_join |= *failed;
+}
+
+/**
+ * Data blocks can only be read from multiple threads when this doesn't involve reading
+ * (and seeking) the file, either because all data is already in memory or because it's mapped.
+ */
+static bool read_data_supports_threading(const FileData *fd)
+{
+#ifdef USE_BHEAD_READ_ON_DEMAND
+  return (fd->seek == NULL) || (fd->mmap_file != NULL);
+#else
+  UNUSED_VARS(fd);
+  return true;
+#endif
+}
+
 /* Read all data associated with a datablock into datamap. */
 static BHead *read_data_into_datamap(FileData *fd, BHead *bhead, const char *allocname)
 {
-  bhead = blo_bhead_next(fd, bhead);
-
-  while (bhead && bhead->code == DATA) {
-    /* The code below is useful for debugging leaks in data read from the blend file.
-     * Without this the messages only tell us what ID-type the memory came from,
-     * eg: `Data from OB len 64`, see #dataname.
-     * With the code below we get the struct-name to help tracking down the leak.
-     * This is kept disabled as the #malloc for the text always leaks memory. */
+  /* First gather the data blocks: reading the block headers is serial by nature. */
+  BHead *bhead_id = bhead;
+  int bheads_num = 0;
+  size_t bheads_size = 0;
+  for (bhead = blo_bhead_next(fd, bhead); bhead && bhead->code == DATA;
+       bhead = blo_bhead_next(fd, bhead)) {
+    bheads_num++;
+    bheads_size += (size_t)bhead->len;
+  }
+  BHead *bhead_end = bhead;
+
+  blo_oldnewmap_reserve(fd->datamap, bheads_num);
+
+  if (bheads_num < 2 || bheads_size < READ_DATA_PARALLEL_MIN_BYTES ||
+      !read_data_supports_threading(fd)) {
+    for (bhead = blo_bhead_next(fd, bhead_id); bhead != bhead_end;
+         bhead = blo_bhead_next(fd, bhead)) {
+      /* The code below is useful for debugging leaks in data read from the blend file.
+       * Without this the messages only tell us what ID-type the memory came from,
+       * eg: `Data from OB len 64`, see #dataname.
+       * With the code below we get the struct-name to help tracking down the leak.
+       * This is kept disabled as the #malloc for the text always leaks memory. */
 #if 0
-    {
-      const short *sp = fd->filesdna->structs[bhead->SDNAnr];
-      allocname = fd->filesdna->types[sp[0]];
-      size_t allocname_size = strlen(allocname) + 1;
-      char *allocname_buf = malloc(allocname_size);
-      memcpy(allocname_buf, allocname, allocname_size);
-      allocname = allocname_buf;
-    }
+      {
+        const short *sp = fd->filesdna->structs[bhead->SDNAnr];
+        allocname = fd->filesdna->types[sp[0]];
+        size_t allocname_size = strlen(allocname) + 1;
+        char *allocname_buf = malloc(allocname_size);
+        memcpy(allocname_buf, allocname, allocname_size);
+        allocname = allocname_buf;
+      }
 #endif
 
-    void *data = read_struct(fd, bhead, allocname);
-    if (data) {
-      oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+      void *data = read_struct(fd, bhead, allocname);
+      if (data) {
+        blo_oldnewmap_insert(fd->datamap, bhead->old, data, 0);
+      }
     }
+    return bhead_end;
+  }
 
-    bhead = blo_bhead_next(fd, bhead);
+  /* Reading and reconstructing (#DNA_struct_reconstruct, endian switching) the blocks
+   * is independent for each of them, only the map insertion needs to remain serial. */
+  ReadDataParallelData data = {
+      .fd = fd,
+      .bheads = MEM_malloc_arrayN(bheads_num, sizeof(BHead *), __func__),
+      .data = MEM_malloc_arrayN(bheads_num, sizeof(void *), __func__),
+      .allocname = allocname,
+  };
+  int i = 0;
+  for (bhead = blo_bhead_next(fd, bhead_id); bhead != bhead_end;
+       bhead = blo_bhead_next(fd, bhead)) {
+    data.bheads[i++] = bhead;
   }
 
-  return bhead;
+  /* Failures are gathered per thread and merged after the join, the file flags can't be
+   * modified from the worker threads. */
+  bool failed = false;
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.userdata_chunk = &failed;
+  settings.userdata_chunk_size = sizeof(failed);
+  settings.func_reduce = read_data_into_datamap_parallel_reduce;
+  BLI_task_parallel_range(0, bheads_num, &data, read_data_into_datamap_parallel_cb, &settings);
+
+  if (UNLIKELY(failed)) {
+    fd->flags &= ~FD_FLAGS_FILE_OK;
+  }
+
+  for (i = 0; i < bheads_num; i++) {
+    if (data.data[i]) {
+      blo_oldnewmap_insert(fd->datamap, data.bheads[i]->old, data.data[i], 0);
+    }
+  }
+
+  MEM_freeN(data.bheads);
+  MEM_freeN(data.data);
+
+  return bhead_end;
 }
 
 /* Verify if the datablock and all associated data is identical. */
@@ -8247,7 +8599,7 @@ static bool read_libblock_undo_restore_linked(FileData *fd, Main *main, const ID
     /* Even though we found our linked ID, there is no guarantee its address
      * is still the same. */
     if (id_old != bhead->old) {
-      oldnewmap_insert(fd->libmap, bhead->old, id_old, GS(id_old->name));
+      blo_oldnewmap_insert(fd->libmap, bhead->old, id_old, GS(id_old->name));
     }
 
     /* No need to do anything else for ID_LINK_PLACEHOLDER, it's assumed
@@ -8394,7 +8746,7 @@ static bool read_libblock_undo_restore(
     /* Insert into library map for lookup by newly read datablocks (with pointer value bhead->old).
      * Note that existing datablocks in memory (which pointer value would be id_old) are not
      * remapped anymore, so no need to store this info here. */
-    oldnewmap_insert(fd->libmap, bhead->old, id_old, bhead->code);
+    blo_oldnewmap_insert(fd->libmap, bhead->old, id_old, bhead->code);
 
     *r_id_old = id_old;
     return true;
@@ -8468,7 +8820,7 @@ static BHead *read_libblock(FileData *fd,
    * Note that existing datablocks in memory (which pointer value would be id_old) are not remapped
    * remapped anymore, so no need to store this info here. */
   ID *id_target = id_old ? id_old : id;
-  oldnewmap_insert(fd->libmap, bhead->old, id_target, bhead->code);
+  blo_oldnewmap_insert(fd->libmap, bhead->old, id_target, bhead->code);
 
   if (r_id) {
     *r_id = id_target;
@@ -8500,7 +8852,7 @@ static BHead *read_libblock(FileData *fd,
   const char *allocname = dataname(idcode);
   bhead = read_data_into_datamap(fd, bhead, allocname);
   const bool success = direct_link_id(fd, main, id_tag, id, id_old);
-  oldnewmap_clear(fd->datamap);
+  blo_oldnewmap_clear(fd->datamap);
 
   if (!success) {
     /* XXX This is probably working OK currently given the very limited scope of that flag.
@@ -8978,7 +9330,7 @@ static BHead *read_userdef(BlendFileData *bfd, FileData *fd, BHead *bhead)
   user->edit_studio_light = 0;
 
   /* free fd->datamap again */
-  oldnewmap_clear(fd->datamap);
+  blo_oldnewmap_clear(fd->datamap);
 
   return bhead;
 }
@@ -9010,6 +9362,9 @@ BlendFileData *blo_read_file_internal(FileData *fd, const char *filepath)
     BLI_addtail(&mainlist, bfd->main);
     fd->mainlist = &mainlist;
     BLI_strncpy(bfd->main->name, filepath, sizeof(bfd->main->name));
+
+    /* All blocks up to the DNA are known at this point, avoid growing the map while reading. */
+    blo_oldnewmap_reserve(fd->libmap, fd->id_bheads_num);
   }
 
   if (G.background) {
@@ -9367,7 +9722,7 @@ static void expand_doit_library(void *fdhandle, Main *mainvar, void *old)
        * (B) forest.blend: contains Forest collection linking in Tree from tree.blend.
        * (C) shot.blend: links in both Tree from tree.blend and Forest from forest.blend.
        */
-      oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
+      blo_oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
 
       /* If "id" is a real data-lock and not a placeholder, we need to
        * update fd->libmap to replace ID_LINK_PLACEHOLDER with the real
@@ -9409,7 +9764,7 @@ static void expand_doit_library(void *fdhandle, Main *mainvar, void *old)
       /* this is actually only needed on UI call? when ID was already read before,
        * and another append happens which invokes same ID...
        * in that case the lookup table needs this entry */
-      oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
+      blo_oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
       // commented because this can print way too much
       // if (G.debug & G_DEBUG) printf("expand: already read %s\n", id->name);
     }
@@ -10449,7 +10804,7 @@ static ID *link_named_part(
       if (G.debug) {
         printf("append: already linked\n");
       }
-      oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
+      blo_oldnewmap_insert(fd->libmap, bhead->old, id, bhead->code);
       if (!force_indirect && (id->tag & LIB_TAG_INDIRECT)) {
         id->tag &= ~LIB_TAG_INDIRECT;
         id->flag &= ~LIB_INDIRECT_WEAK_LINK;
@@ -10964,10 +11319,10 @@ static FileData *read_library_file_data(FileData *basefd,
     fd->reports = basefd->reports;
 
     if (fd->libmap) {
-      oldnewmap_free(fd->libmap);
+      blo_oldnewmap_free(fd->libmap);
     }
 
-    fd->libmap = oldnewmap_new();
+    fd->libmap = blo_oldnewmap_new();
 
     mainptr->curlib->filedata = fd;
     mainptr->versionfile = fd->fileversion;
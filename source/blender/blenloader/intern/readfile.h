@@ -29,6 +29,10 @@
 #include "DNA_windowmanager_types.h" /* for ReportType */
 #include "zlib.h"
 
+#ifdef __cplusplus
+extern "C" {
+#endif
+
 struct BLOCacheStorage;
 struct GSet;
 struct IDNameLib_Map;
@@ -80,6 +84,8 @@ typedef struct FileData {
 
   /** Regular file reading. */
   int filedes;
+  /** Memory-mapped reading of uncompressed files, when supported by the file-system. */
+  struct BLI_mmap_file *mmap_file;
 
   /** Variables needed for reading from memory / stream. */
   const char *buffer;
@@ -93,6 +99,8 @@ typedef struct FileData {
   gzFile gzfiledes;
   /** Gzip stream for memory decompression. */
   z_stream strm;
+  /** Seekable reading of compressed files written as frames, see #BLO_ZLIB_FRAME_SIZE. */
+  struct ZlibFrameReader *zframes;
 
   /** Now only in use for library appending. */
   char relabase[FILE_MAX];
@@ -106,6 +114,8 @@ typedef struct FileData {
   int fileversion;
   /** Used to retrieve ID names from (bhead+1). */
   int id_name_offs;
+  /** Number of blocks that aren't #DATA (read along with the DNA), used to size lookup maps. */
+  int id_bheads_num;
   /** For do_versions patching. */
   int globalf, fileflags;
 
@@ -134,6 +144,37 @@ typedef struct FileData {
 
 #define SIZEOFBLENDERHEADER 12
 
+/**
+ * Compressed files are written as a sequence of independently compressed gzip members
+ * ("frames"), each holding #BLO_ZLIB_FRAME_SIZE bytes of the uncompressed file (the last one
+ * may be smaller). This allows compressing frames in parallel and decompressing only the
+ * frames that are needed when seeking.
+ *
+ * The file ends with an empty gzip member storing the seek table in its extra field,
+ * so the result remains a regular (multi-member) gzip file that any gzip reader can inflate.
+ *
+ * Seek table extra sub-field (`SI1 = 'B'`, `SI2 = 'S'`), all values little endian `uint32`:
+ * <pre>
+ * `compressed_size[frames_num]`  Size of each frame in the file.
+ * `frame_size`                   Uncompressed size of each frame (#BLO_ZLIB_FRAME_SIZE).
+ * `frames_num`                   Number of frames.
+ * `magic`                        #BLO_ZLIB_FRAMES_MAGIC.
+ * </pre>
+ * Followed by an empty final deflate block and a zero CRC32/size gzip trailer.
+ */
+#define BLO_ZLIB_FRAME_SIZE (1 << 20)
+/** Seek tables with larger frames are ignored when reading, to bound memory use. */
+#define BLO_ZLIB_FRAME_SIZE_MAX (8 << 20)
+#define BLO_ZLIB_FRAMES_MAGIC "BLZF"
+/** Gzip header (10) + XLEN (2) + sub-field header (4). */
+#define BLO_ZLIB_SEEK_TABLE_HEADER_SIZE 16
+/** `frame_size`, `frames_num` and `magic`. */
+#define BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE 12
+/** Empty deflate block (2) + CRC32 (4) + uncompressed size (4). */
+#define BLO_ZLIB_SEEK_TABLE_TRAILER_SIZE 10
+/** The extra field length is stored as 16 bits, larger files are written without a table. */
+#define BLO_ZLIB_SEEK_TABLE_FRAMES_MAX ((0xffff - 4 - BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE) / 4)
+
 /***/
 struct Main;
 void blo_join_main(ListBase *mainlist);
@@ -172,6 +213,19 @@ void blo_reportf_wrap(struct ReportList *reports, ReportType type, const char *f
 
 void blo_do_versions_dna(struct SDNA *sdna, const int versionfile, const int subversionfile);
 
+/* readfile_oldnewmap.cc */
+
+typedef struct OldNewMap OldNewMap;
+typedef void (*OldNewMapForeachFn)(void *user_data, const void *oldp, void **r_newp, int *r_nr);
+
+OldNewMap *blo_oldnewmap_new(void);
+void blo_oldnewmap_free(OldNewMap *onm);
+void blo_oldnewmap_reserve(OldNewMap *onm, int items_num);
+void blo_oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr, int nr);
+void *blo_oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool increase_users);
+void blo_oldnewmap_foreach(OldNewMap *onm, OldNewMapForeachFn fn, void *user_data);
+void blo_oldnewmap_clear(OldNewMap *onm);
+
 void blo_do_versions_oldnewmap_insert(struct OldNewMap *onm,
                                       const void *oldaddr,
                                       void *newaddr,
@@ -198,3 +252,7 @@ void do_versions_after_linking_270(struct Main *bmain);
 void do_versions_after_linking_280(struct Main *bmain, struct ReportList *reports);
 void do_versions_after_linking_290(struct Main *bmain, struct ReportList *reports);
 void do_versions_after_linking_cycles(struct Main *bmain);
+
+#ifdef __cplusplus
+}
+#endif
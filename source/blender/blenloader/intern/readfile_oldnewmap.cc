@@ -0,0 +1,120 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+/** \file
+ * \ingroup blenloader
+ *
+ * Mapping of pointers stored in the file (old addresses) to the newly read data.
+ * This is consulted for every pointer that is read, so it's kept small and fast.
+ */
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_map.hh"
+#include "BLI_utildefines.h"
+
+#include "BLO_readfile.h"
+
+#include "readfile.h"
+
+using blender::Map;
+
+struct OldNew {
+  void *newp;
+  /* `nr` is "user count" for data, and ID code for libdata. */
+  int nr;
+};
+
+/**
+ * Old addresses are allocations from the Blender session that wrote the file.
+ * The low bits are always zero because of alignment and nearby allocations only differ in a few
+ * bits, so mix all of them into the hash (Fibonacci hashing) to get an even slot distribution.
+ */
+struct OldAddressHash {
+  uint64_t operator()(const void *ptr) const
+  {
+    const uint64_t value = static_cast<uint64_t>(reinterpret_cast<uintptr_t>(ptr)) >> 3;
+    return (value * 0x9E3779B97F4A7C15ull) >> 16;
+  }
+};
+
+struct OldNewMap {
+  Map<const void *,
+      OldNew,
+      0,
+      blender::DefaultProbingStrategy,
+      OldAddressHash,
+      blender::DefaultEquality>
+      map;
+};
+
+OldNewMap *blo_oldnewmap_new(void)
+{
+  return OBJECT_GUARDED_NEW(OldNewMap);
+}
+
+void blo_oldnewmap_free(OldNewMap *onm)
+{
+  OBJECT_GUARDED_DELETE(onm, OldNewMap);
+}
+
+/**
+ * Avoid growing the map multiple times when the number of items to insert is known.
+ */
+void blo_oldnewmap_reserve(OldNewMap *onm, int items_num)
+{
+  onm->map.reserve(items_num);
+}
+
+void blo_oldnewmap_insert(OldNewMap *onm, const void *oldaddr, void *newaddr, int nr)
+{
+  if (oldaddr == nullptr || newaddr == nullptr) {
+    return;
+  }
+  onm->map.add_overwrite(oldaddr, {newaddr, nr});
+}
+
+void *blo_oldnewmap_lookup_and_inc(OldNewMap *onm, const void *addr, bool increase_users)
+{
+  OldNew *entry = onm->map.lookup_ptr(addr);
+  if (entry == nullptr) {
+    return nullptr;
+  }
+  if (increase_users) {
+    entry->nr++;
+  }
+  return entry->newp;
+}
+
+void blo_oldnewmap_foreach(OldNewMap *onm, OldNewMapForeachFn fn, void *user_data)
+{
+  for (auto item : onm->map.items()) {
+    fn(user_data, item.key, &item.value.newp, &item.value.nr);
+  }
+}
+
+/**
+ * Remove all items, freeing the new data that wasn't used (data with a zero user count).
+ */
+void blo_oldnewmap_clear(OldNewMap *onm)
+{
+  for (OldNew &entry : onm->map.values()) {
+    if (entry.nr == 0) {
+      MEM_freeN(entry.newp);
+    }
+  }
+  onm->map.clear();
+}
@@ -36,12 +36,16 @@
 #  include <io.h>
 #endif
 
+#include "zlib.h"
+
 #include "MEM_guardedalloc.h"
 
 #include "DNA_listBase.h"
 
 #include "BLI_blenlib.h"
 #include "BLI_ghash.h"
+#include "BLI_hash_mm2a.h"
+#include "BLI_task.h"
 
 #include "BLO_readfile.h"
 #include "BLO_undofile.h"
@@ -49,59 +53,368 @@
 #include "BKE_lib_id.h"
 #include "BKE_main.h"
 
+#include "atomic_ops.h"
+
 /* keep last */
 #include "BLI_strict_flags.h"
 
 /* **************** support for memory-write, for undo buffers *************** */
 
+/* -------------------------------------------------------------------- */
+/** \name Chunk Buffer Store
+ *
+ * The contents of all #MemFileChunk are stored in reference counted #MemFileBuffer,
+ * de-duplicated by a hash of their contents, so identical data is shared by all memfiles using
+ * the same #MemFileBufferStore (not only the chunks identical to the previous step).
+ * A memfile written with a reference memfile uses the store of the reference, so all steps of an
+ * undo stack share one store.
+ *
+ * Buffers only used by compressed memfiles (see #BLO_memfile_compress) are compressed
+ * in background tasks, started once the memfile operation queuing them is done. The compressed
+ * data is swapped in from the main thread once the task is done, unless the buffer was needed
+ * uncompressed again in the meantime. Only freeing a buffer has to wait for its task.
+ * All other accesses to the store are done from the main thread.
+ * \{ */
+
+/** Buffers compressed by the same task pool. */
+typedef struct MemFileCompressTask {
+  struct MemFileCompressTask *next, *prev;
+  TaskPool *pool;
+  MemFileBuffer **buffers;
+  uint buffers_len;
+  /** Number of buffers not compressed yet, decremented from the tasks. */
+  uint32_t buffers_pending;
+} MemFileCompressTask;
+
+typedef struct MemFileBufferStore {
+  /** Buffers by contents hash & size (on collision, only the first buffer is in the set). */
+  GSet *buffers;
+  /** Buffers queued for compression by the current operation. */
+  MemFileBuffer **compress_queue;
+  uint compress_queue_len;
+  uint compress_queue_alloc;
+  /** #MemFileCompressTask which weren't finished yet. */
+  ListBase compress_tasks;
+  /** Number of memfiles using this store. */
+  uint users;
+} MemFileBufferStore;
+
+static uint memfile_buffer_hash(const void *key)
+{
+  return ((const MemFileBuffer *)key)->hash;
+}
+
+static bool memfile_buffer_cmp(const void *a, const void *b)
+{
+  const MemFileBuffer *buffer_a = a;
+  const MemFileBuffer *buffer_b = b;
+  return (buffer_a->hash != buffer_b->hash) || (buffer_a->size != buffer_b->size);
+}
+
+/** Number of bytes used by the buffer (compressed or not). */
+static size_t memfile_buffer_mem_size(const MemFileBuffer *buffer)
+{
+  return buffer->data ? buffer->size : buffer->size_compressed;
+}
+
+static MemFileBufferStore *memfile_buffer_store_new(void)
+{
+  MemFileBufferStore *store = MEM_callocN(sizeof(*store), "MemFileBufferStore");
+  store->buffers = BLI_gset_new(memfile_buffer_hash, memfile_buffer_cmp, __func__);
+  return store;
+}
+
+static void memfile_buffer_compress_fn(TaskPool *__restrict pool, void *taskdata)
+{
+  MemFileCompressTask *task = BLI_task_pool_user_data(pool);
+  MemFileBuffer *buffer = taskdata;
+  uLongf size_compressed = compressBound(buffer->size);
+  char *data_compressed = MEM_mallocN(size_compressed, "Chunk buffer compressed");
+
+  if ((compress2((Bytef *)data_compressed,
+                 &size_compressed,
+                 (const Bytef *)buffer->data,
+                 buffer->size,
+                 Z_BEST_SPEED) != Z_OK) ||
+      (size_compressed >= buffer->size)) {
+    /* Not worth it, keep the buffer uncompressed. */
+    MEM_freeN(data_compressed);
+  }
+  else {
+    buffer->data_compressed = data_compressed;
+    buffer->size_compressed = (uint)size_compressed;
+  }
+
+  atomic_sub_and_fetch_uint32(&task->buffers_pending, 1);
+}
+
+/**
+ * Wait for \a task and swap in the compressed data from the main thread,
+ * so memory accounting isn't threaded.
+ */
+static void memfile_compress_task_finish(MemFileBufferStore *store, MemFileCompressTask *task)
+{
+  BLI_task_pool_work_and_wait(task->pool);
+  BLI_task_pool_free(task->pool);
+
+  for (uint i = 0; i < task->buffers_len; i++) {
+    MemFileBuffer *buffer = task->buffers[i];
+    buffer->compress_task = NULL;
+    if (buffer->data_compressed == NULL) {
+      continue;
+    }
+    if (buffer->users_hot != 0) {
+      /* Used by an uncompressed memfile again since it was queued. */
+      MEM_freeN(buffer->data_compressed);
+      buffer->data_compressed = NULL;
+      buffer->size_compressed = 0;
+      continue;
+    }
+    if (buffer->owner) {
+      buffer->owner->size -= buffer->size - buffer->size_compressed;
+    }
+    MEM_freeN((void *)buffer->data);
+    buffer->data = NULL;
+  }
+
+  BLI_remlink(&store->compress_tasks, task);
+  MEM_freeN(task->buffers);
+  MEM_freeN(task);
+}
+
+/** Swap in the results of the tasks that are done, without waiting for the others. */
+static void memfile_compress_tasks_update(MemFileBufferStore *store)
+{
+  LISTBASE_FOREACH_MUTABLE (MemFileCompressTask *, task, &store->compress_tasks) {
+    if (atomic_add_and_fetch_uint32(&task->buffers_pending, 0) == 0) {
+      memfile_compress_task_finish(store, task);
+    }
+  }
+}
+
+static void memfile_compress_tasks_start(MemFileBufferStore *store)
+{
+  if (store->compress_queue_len == 0) {
+    return;
+  }
+
+  MemFileCompressTask *task = MEM_callocN(sizeof(*task), "MemFileCompressTask");
+  task->buffers = MEM_malloc_arrayN(store->compress_queue_len, sizeof(*task->buffers), __func__);
+  task->buffers_len = store->compress_queue_len;
+  task->buffers_pending = store->compress_queue_len;
+  task->pool = BLI_task_pool_create_background(task, TASK_PRIORITY_LOW);
+  BLI_addtail(&store->compress_tasks, task);
+
+  for (uint i = 0; i < store->compress_queue_len; i++) {
+    MemFileBuffer *buffer = store->compress_queue[i];
+    buffer->is_compress_queued = false;
+    buffer->compress_task = task;
+    task->buffers[i] = buffer;
+  }
+  store->compress_queue_len = 0;
+
+  for (uint i = 0; i < task->buffers_len; i++) {
+    BLI_task_pool_push(task->pool, memfile_buffer_compress_fn, task->buffers[i], false, NULL);
+  }
+}
+
+static void memfile_buffer_compress_push(MemFileBufferStore *store, MemFileBuffer *buffer)
+{
+  BLI_assert(buffer->data != NULL);
+
+  if (buffer->compress_task != NULL) {
+    /* Still being compressed from an earlier queuing. */
+    return;
+  }
+
+  if (store->compress_queue_len == store->compress_queue_alloc) {
+    store->compress_queue_alloc = MAX2(store->compress_queue_alloc * 2, 64u);
+    store->compress_queue = MEM_reallocN(store->compress_queue,
+                                         sizeof(*store->compress_queue) *
+                                             store->compress_queue_alloc);
+  }
+  store->compress_queue[store->compress_queue_len++] = buffer;
+  buffer->is_compress_queued = true;
+}
+
+/** Ensure \a buffer isn't queued or being compressed, so it can be freed. */
+static void memfile_buffer_compress_sync(MemFileBufferStore *store, MemFileBuffer *buffer)
+{
+  if (buffer->is_compress_queued) {
+    for (uint i = 0; i < store->compress_queue_len; i++) {
+      if (store->compress_queue[i] == buffer) {
+        store->compress_queue[i] = store->compress_queue[--store->compress_queue_len];
+        break;
+      }
+    }
+    buffer->is_compress_queued = false;
+  }
+  if (buffer->compress_task != NULL) {
+    memfile_compress_task_finish(store, buffer->compress_task);
+  }
+}
+
+static void memfile_buffer_decompress(MemFileBuffer *buffer)
+{
+  if (buffer->data != NULL) {
+    /* Not compressed, or still being compressed (the result is discarded once the task is done
+     * since the buffer is used again). */
+    return;
+  }
+
+  char *data = MEM_mallocN(buffer->size, "Chunk buffer");
+  uLongf size = buffer->size;
+  if (uncompress((Bytef *)data, &size, buffer->data_compressed, buffer->size_compressed) !=
+      Z_OK) {
+    BLI_assert(0);
+  }
+
+  if (buffer->owner) {
+    buffer->owner->size += buffer->size - buffer->size_compressed;
+  }
+  MEM_freeN(buffer->data_compressed);
+  buffer->data_compressed = NULL;
+  buffer->size_compressed = 0;
+  buffer->data = data;
+}
+
+static MemFileBuffer *memfile_buffer_ensure(MemFile *memfile, const char *buf, uint size)
+{
+  MemFileBuffer buffer_key = {
+      .size = size,
+      .hash = BLI_hash_mm2((const uchar *)buf, size, 0),
+  };
+
+  void **buffer_p;
+  const bool is_stored = BLI_gset_ensure_p_ex(memfile->store->buffers, &buffer_key, &buffer_p);
+  if (is_stored) {
+    MemFileBuffer *buffer = *buffer_p;
+    memfile_buffer_decompress(buffer);
+    if (memcmp(buffer->data, buf, size) == 0) {
+      return buffer;
+    }
+  }
+
+  MemFileBuffer *buffer = MEM_callocN(sizeof(*buffer), "MemFileBuffer");
+  char *data = MEM_mallocN(size, "Chunk buffer");
+  memcpy(data, buf, size);
+  buffer->data = data;
+  buffer->size = size;
+  buffer->hash = buffer_key.hash;
+  buffer->owner = memfile;
+  memfile->size += size;
+
+  if (!is_stored) {
+    *buffer_p = buffer;
+    buffer->is_stored = true;
+  }
+  return buffer;
+}
+
+/** A user of \a buffer is now in a compressed memfile (or was removed). */
+static void memfile_buffer_users_hot_decrement(MemFileBufferStore *store, MemFileBuffer *buffer)
+{
+  BLI_assert(buffer->users_hot > 0);
+  buffer->users_hot--;
+  if ((buffer->users_hot == 0) && (buffer->users != 0) && (buffer->data != NULL)) {
+    memfile_buffer_compress_push(store, buffer);
+  }
+}
+
+/** A user of \a buffer is now in an uncompressed memfile. */
+static void memfile_buffer_users_hot_increment(MemFileBuffer *buffer)
+{
+  memfile_buffer_decompress(buffer);
+  buffer->users_hot++;
+}
+
+static void memfile_buffer_users_decrement(MemFile *memfile, MemFileBuffer *buffer)
+{
+  MemFileBufferStore *store = memfile->store;
+  BLI_assert(buffer->users > 0);
+  buffer->users--;
+
+  if (buffer->owner == memfile) {
+    buffer->owner = NULL;
+  }
+
+  if (buffer->users != 0) {
+    if (memfile->is_compressed == false) {
+      memfile_buffer_users_hot_decrement(store, buffer);
+    }
+    return;
+  }
+
+  /* The compression task may still be reading the data. */
+  memfile_buffer_compress_sync(store, buffer);
+
+  if (buffer->is_stored) {
+    BLI_gset_remove(store->buffers, buffer, NULL);
+  }
+  MEM_SAFE_FREE(buffer->data);
+  MEM_SAFE_FREE(buffer->data_compressed);
+  MEM_freeN(buffer);
+}
+
+static void memfile_store_users_decrement(MemFile *memfile)
+{
+  MemFileBufferStore *store = memfile->store;
+  memfile->store = NULL;
+
+  BLI_assert(store->users > 0);
+  if (--store->users != 0) {
+    return;
+  }
+
+  /* All buffers were freed, along with their compression task. */
+  BLI_assert(BLI_gset_len(store->buffers) == 0);
+  BLI_assert(BLI_listbase_is_empty(&store->compress_tasks));
+  BLI_gset_free(store->buffers, NULL);
+  MEM_SAFE_FREE(store->compress_queue);
+  MEM_freeN(store);
+}
+
+/** \} */
+
 /* not memfile itself */
 void BLO_memfile_free(MemFile *memfile)
 {
   MemFileChunk *chunk;
 
+  if (memfile->store == NULL) {
+    BLI_assert(BLI_listbase_is_empty(&memfile->chunks));
+    return;
+  }
+
+  MemFileBufferStore *store = memfile->store;
+  memfile_compress_tasks_update(store);
+
   while ((chunk = BLI_pophead(&memfile->chunks))) {
-    if (chunk->is_identical == false) {
-      MEM_freeN((void *)chunk->buf);
-    }
+    memfile_buffer_users_decrement(memfile, chunk->buffer);
     MEM_freeN(chunk);
   }
   memfile->size = 0;
+  memfile->is_compressed = false;
+
+  memfile_compress_tasks_start(store);
+  memfile_store_users_decrement(memfile);
 }
 
 /* to keep list of memfiles consistent, 'first' is always first in list */
 /* result is that 'first' is being freed */
 void BLO_memfile_merge(MemFile *first, MemFile *second)
 {
-  /* We use this mapping to store the memory buffers from second memfile chunks which are not owned
-   * by it (i.e. shared with some previous memory steps). */
-  GHash *buffer_to_second_memchunk = BLI_ghash_new(
-      BLI_ghashutil_ptrhash, BLI_ghashutil_ptrcmp, __func__);
-
-  /* First, detect all memchunks in second memfile that are not owned by it. */
+  /* Buffers are reference counted, only the memory accounting of buffers allocated by the first
+   * memfile and also used by the second one needs to be transferred. Buffers still being
+   * compressed are accounted to their owner when the compressed data is swapped in. */
   for (MemFileChunk *sc = second->chunks.first; sc != NULL; sc = sc->next) {
-    if (sc->is_identical) {
-      BLI_ghash_insert(buffer_to_second_memchunk, (void *)sc->buf, sc);
-    }
-  }
-
-  /* Now, check all chunks from first memfile (the one we are removing), and if a memchunk owned by
-   * it is also used by the second memfile, transfer the ownership. */
-  for (MemFileChunk *fc = first->chunks.first; fc != NULL; fc = fc->next) {
-    if (!fc->is_identical) {
-      MemFileChunk *sc = BLI_ghash_lookup(buffer_to_second_memchunk, fc->buf);
-      if (sc != NULL) {
-        BLI_assert(sc->is_identical);
-        sc->is_identical = false;
-        fc->is_identical = true;
-      }
-      /* Note that if the second memfile does not use that chunk, we assume that the first one
-       * fully owns it without sharing it with any other memfile, and hence it should be freed with
-       * it. */
+    MemFileBuffer *buffer = sc->buffer;
+    if (buffer->owner == first) {
+      buffer->owner = second;
+      second->size += memfile_buffer_mem_size(buffer);
     }
   }
 
-  BLI_ghash_free(buffer_to_second_memchunk, NULL, NULL);
-
   BLO_memfile_free(first);
 }
 
@@ -113,6 +426,86 @@ void BLO_memfile_clear_future(MemFile *memfile)
   }
 }
 
+/**
+ * Compress the buffers of \a memfile (in the background) when no uncompressed memfile uses them,
+ * used for undo steps which are unlikely to be needed soon.
+ */
+void BLO_memfile_compress(MemFile *memfile)
+{
+  if (memfile->is_compressed || memfile->store == NULL) {
+    return;
+  }
+
+  MemFileBufferStore *store = memfile->store;
+  memfile_compress_tasks_update(store);
+
+  memfile->is_compressed = true;
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    memfile_buffer_users_hot_decrement(store, chunk->buffer);
+  }
+
+  memfile_compress_tasks_start(store);
+}
+
+/**
+ * Ensure the contents of \a memfile can be accessed (#MemFileBuffer.data),
+ * must be called before reading a memfile that may have been compressed.
+ */
+void BLO_memfile_decompress(MemFile *memfile)
+{
+  if (memfile->is_compressed == false) {
+    return;
+  }
+
+  memfile_compress_tasks_update(memfile->store);
+
+  memfile->is_compressed = false;
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    memfile_buffer_users_hot_increment(chunk->buffer);
+  }
+}
+
+/**
+ * Wait for the background compression of the buffers of \a memfile,
+ * so the memory it uses is up to date (#MemFile.size).
+ */
+void BLO_memfile_compress_wait(MemFile *memfile)
+{
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    if (chunk->buffer->compress_task != NULL) {
+      memfile_compress_task_finish(memfile->store, chunk->buffer->compress_task);
+    }
+  }
+}
+
+/**
+ * Fill \a r_memfile with chunks sharing the (decompressed) buffers of \a memfile.
+ *
+ * The copy doesn't depend on \a memfile which can be freed in the meantime, and its contents
+ * aren't modified or compressed until the copy is freed, so it can be read from another thread
+ * (see #BLO_write_file_from_memfile). Must be freed with #BLO_memfile_free from the main thread.
+ */
+void BLO_memfile_copy_shared(MemFile *memfile, MemFile *r_memfile)
+{
+  BLI_assert(BLI_listbase_is_empty(&r_memfile->chunks));
+  r_memfile->size = 0;
+  r_memfile->is_compressed = false;
+  r_memfile->store = memfile->store;
+  if (r_memfile->store == NULL) {
+    return;
+  }
+  r_memfile->store->users++;
+
+  memfile_compress_tasks_update(memfile->store);
+
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    MemFileChunk *chunk_copy = MEM_dupallocN(chunk);
+    chunk_copy->buffer->users++;
+    memfile_buffer_users_hot_increment(chunk_copy->buffer);
+    BLI_addtail(&r_memfile->chunks, chunk_copy);
+  }
+}
+
 void BLO_memfile_write_init(MemFileWriteData *mem_data,
                             MemFile *written_memfile,
                             MemFile *reference_memfile)
@@ -121,12 +514,28 @@ void BLO_memfile_write_init(MemFileWriteData *mem_data,
   mem_data->reference_memfile = reference_memfile;
   mem_data->reference_current_chunk = reference_memfile ? reference_memfile->chunks.first : NULL;
 
+  /* Share the buffers (and their store) with the reference. */
+  if (written_memfile->store == NULL) {
+    if (reference_memfile != NULL && reference_memfile->store != NULL) {
+      written_memfile->store = reference_memfile->store;
+    }
+    else {
+      written_memfile->store = memfile_buffer_store_new();
+    }
+    written_memfile->store->users++;
+  }
+  BLI_assert(reference_memfile == NULL || reference_memfile->store == NULL ||
+             reference_memfile->store == written_memfile->store);
+
   /* If we have a reference memfile, we generate a mapping between the session_uuid's of the
    * IDs stored in that previous undo step, and its first matching memchunk. This will allow
    * us to easily find the existing undo memory storage of IDs even when some re-ordering in
    * current Main data-base broke the order matching with the memchunks from previous step.
    */
   if (reference_memfile != NULL) {
+    /* Chunks are compared with the reference ones. */
+    BLO_memfile_decompress(reference_memfile);
+
     mem_data->id_session_uuid_mapping = BLI_ghash_new(
         BLI_ghashutil_inthash_p_simple, BLI_ghashutil_intcmp, __func__);
     uint current_session_uuid = MAIN_ID_SESSION_UUID_UNSET;
@@ -159,9 +568,11 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, uint siz
   MemFile *memfile = mem_data->written_memfile;
   MemFileChunk **compchunk_step = &mem_data->reference_current_chunk;
 
+  BLI_assert(memfile->is_compressed == false);
+
   MemFileChunk *curchunk = MEM_mallocN(sizeof(MemFileChunk), "MemFileChunk");
   curchunk->size = size;
-  curchunk->buf = NULL;
+  curchunk->buffer = NULL;
   curchunk->is_identical = false;
   /* This is unsafe in the sense that an app handler or other code that does not
    * perform an undo push may make changes after the last undo push that
@@ -174,8 +585,8 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, uint siz
   if (*compchunk_step != NULL) {
     MemFileChunk *compchunk = *compchunk_step;
     if (compchunk->size == curchunk->size) {
-      if (memcmp(compchunk->buf, buf, size) == 0) {
-        curchunk->buf = compchunk->buf;
+      if (memcmp(compchunk->buffer->data, buf, size) == 0) {
+        curchunk->buffer = compchunk->buffer;
         curchunk->is_identical = true;
         compchunk->is_identical_future = true;
       }
@@ -183,13 +594,13 @@ void BLO_memfile_chunk_add(MemFileWriteData *mem_data, const char *buf, uint siz
     *compchunk_step = compchunk->next;
   }
 
-  /* not equal... */
-  if (curchunk->buf == NULL) {
-    char *buf_new = MEM_mallocN(size, "Chunk buffer");
-    memcpy(buf_new, buf, size);
-    curchunk->buf = buf_new;
-    memfile->size += size;
+  /* not equal to the reference chunk, look for the same contents in any other memfile... */
+  if (curchunk->buffer == NULL) {
+    curchunk->buffer = memfile_buffer_ensure(memfile, buf, size);
   }
+
+  curchunk->buffer->users++;
+  curchunk->buffer->users_hot++;
 }
 
 struct Main *BLO_memfile_main_get(struct MemFile *memfile,
@@ -251,8 +662,10 @@ bool BLO_memfile_write_file(struct MemFile *memfile, const char *filename)
     return false;
   }
 
+  BLO_memfile_decompress(memfile);
+
   for (chunk = memfile->chunks.first; chunk; chunk = chunk->next) {
-    if ((size_t)write(file, chunk->buf, chunk->size) != chunk->size) {
+    if ((size_t)write(file, chunk->buffer->data, chunk->size) != chunk->size) {
       break;
     }
   }
@@ -769,6 +769,10 @@ void BLO_version_defaults_userpref_blend(Main *bmain, UserDef *userdef)
     }
   }
 
+  if (!USER_VERSION_ATLEAST(291, 2)) {
+    userdef->compositor_cache_limit = 1024;
+  }
+
   /**
    * Versioning code until next subversion bump goes here.
    *
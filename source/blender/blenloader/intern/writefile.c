@@ -148,7 +148,9 @@
 
 #include "BLI_bitmap.h"
 #include "BLI_blenlib.h"
+#include "BLI_math_base.h"
 #include "BLI_mempool.h"
+#include "BLI_task.h"
 #include "MEM_guardedalloc.h"  // MEM_freeN
 
 #include "BKE_action.h"
@@ -227,7 +229,7 @@ struct WriteWrap {
   /* internal */
   union {
     int file_handle;
-    gzFile gz_handle;
+    struct ZlibWriteWrap *zlib_wrap;
   } _user_data;
 };
 
@@ -257,17 +259,203 @@ static size_t ww_write_none(WriteWrap *ww, const char *buf, size_t buf_len)
 }
 #undef FILE_HANDLE
 
-/* zlib */
-#define FILE_HANDLE(ww) (ww)->_user_data.gz_handle
+/* zlib (frames, see #BLO_ZLIB_FRAME_SIZE) */
+#define ZLIB_WRAP(ww) (ww)->_user_data.zlib_wrap
+
+typedef struct ZlibFrame {
+  struct ZlibFrame *next, *prev;
+
+  /** Uncompressed data, freed once compressed. */
+  uchar *data_in;
+  uint data_in_len;
+
+  /** A complete gzip member, NULL when compression failed. */
+  uchar *data_out;
+  uint data_out_len;
+} ZlibFrame;
+
+typedef struct ZlibWriteWrap {
+  int file_handle;
+
+  /** Frame being filled by #ww_write_zlib. */
+  uchar *frame_buf;
+  uint frame_buf_used;
+
+  /** Frames submitted for compression, in file order. */
+  ListBase frames_pending;
+  int frames_pending_num;
+  /** Limit memory use by writing out pending frames once this many are queued. */
+  int frames_pending_max;
+  TaskPool *task_pool;
+
+  /** Compressed size of every frame written so far (for the seek table). */
+  uint32_t *frame_sizes;
+  int frames_num;
+  int frames_alloc;
+
+  bool error;
+} ZlibWriteWrap;
+
+static void ww_zlib_frame_compress_fn(TaskPool *__restrict UNUSED(pool), void *taskdata)
+{
+  ZlibFrame *frame = taskdata;
+
+  z_stream strm = {NULL};
+  /* Match the previously used `gzopen(filepath, "wb1")`, '16' adds the gzip wrapper. */
+  if (deflateInit2(&strm, 1, Z_DEFLATED, 16 + MAX_WBITS, 8, Z_DEFAULT_STRATEGY) == Z_OK) {
+    const uint out_len_max = (uint)deflateBound(&strm, frame->data_in_len);
+    uchar *data_out = MEM_mallocN(out_len_max, __func__);
+
+    strm.next_in = frame->data_in;
+    strm.avail_in = frame->data_in_len;
+    strm.next_out = data_out;
+    strm.avail_out = out_len_max;
+
+    if (deflate(&strm, Z_FINISH) == Z_STREAM_END) {
+      frame->data_out = data_out;
+      frame->data_out_len = (uint)strm.total_out;
+    }
+    else {
+      MEM_freeN(data_out);
+    }
+    deflateEnd(&strm);
+  }
+
+  MEM_freeN(frame->data_in);
+  frame->data_in = NULL;
+}
+
+static bool ww_zlib_write_raw(ZlibWriteWrap *zww, const void *data, size_t data_len)
+{
+  return (size_t)write(zww->file_handle, data, data_len) == data_len;
+}
+
+/**
+ * Wait for all pending frames to be compressed and write them out in order.
+ */
+static void ww_zlib_frames_flush(ZlibWriteWrap *zww)
+{
+  if (zww->frames_pending_num == 0) {
+    return;
+  }
+
+  BLI_task_pool_work_and_wait(zww->task_pool);
+
+  LISTBASE_FOREACH_MUTABLE (ZlibFrame *, frame, &zww->frames_pending) {
+    if (frame->data_out == NULL) {
+      zww->error = true;
+    }
+    else {
+      if (!zww->error) {
+        if (zww->frames_num == zww->frames_alloc) {
+          zww->frames_alloc = zww->frames_alloc ? zww->frames_alloc * 2 : 64;
+          zww->frame_sizes = MEM_reallocN(zww->frame_sizes,
+                                          sizeof(*zww->frame_sizes) * zww->frames_alloc);
+        }
+        zww->frame_sizes[zww->frames_num++] = frame->data_out_len;
+
+        if (!ww_zlib_write_raw(zww, frame->data_out, frame->data_out_len)) {
+          zww->error = true;
+        }
+      }
+      MEM_freeN(frame->data_out);
+    }
+    MEM_freeN(frame);
+  }
+
+  BLI_listbase_clear(&zww->frames_pending);
+  zww->frames_pending_num = 0;
+}
+
+static void ww_zlib_frame_submit(ZlibWriteWrap *zww)
+{
+  if (zww->frame_buf_used == 0) {
+    return;
+  }
+
+  ZlibFrame *frame = MEM_callocN(sizeof(*frame), __func__);
+  frame->data_in = zww->frame_buf;
+  frame->data_in_len = zww->frame_buf_used;
+  BLI_addtail(&zww->frames_pending, frame);
+  zww->frames_pending_num++;
+
+  zww->frame_buf = MEM_mallocN(BLO_ZLIB_FRAME_SIZE, __func__);
+  zww->frame_buf_used = 0;
+
+  BLI_task_pool_push(zww->task_pool, ww_zlib_frame_compress_fn, frame, false, NULL);
+
+  if (zww->frames_pending_num >= zww->frames_pending_max) {
+    ww_zlib_frames_flush(zww);
+  }
+}
+
+static void ww_zlib_uint32_encode(uchar *buf, uint32_t value)
+{
+  buf[0] = (uchar)(value);
+  buf[1] = (uchar)(value >> 8);
+  buf[2] = (uchar)(value >> 16);
+  buf[3] = (uchar)(value >> 24);
+}
+
+/**
+ * Write the empty gzip member holding the seek table, see #BLO_ZLIB_FRAME_SIZE.
+ */
+static bool ww_zlib_seek_table_write(ZlibWriteWrap *zww)
+{
+  if (zww->frames_num > BLO_ZLIB_SEEK_TABLE_FRAMES_MAX) {
+    /* Still a valid compressed file, only without support for seeking. */
+    return true;
+  }
+
+  const uint subfield_len = (uint)(zww->frames_num * 4) + BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE;
+  const uint table_len = BLO_ZLIB_SEEK_TABLE_HEADER_SIZE + subfield_len +
+                         BLO_ZLIB_SEEK_TABLE_TRAILER_SIZE;
+  uchar *table = MEM_callocN(table_len, __func__);
+  uchar *p = table;
+
+  /* Gzip header: magic, deflate, #FEXTRA flag, no time-stamp, no extra flags, unknown OS. */
+  const uchar gzip_header[10] = {0x1f, 0x8b, 8, 4, 0, 0, 0, 0, 0, 0xff};
+  memcpy(p, gzip_header, sizeof(gzip_header));
+  p += sizeof(gzip_header);
+  /* XLEN, followed by the sub-field header. */
+  p[0] = (uchar)((subfield_len + 4) & 0xff);
+  p[1] = (uchar)((subfield_len + 4) >> 8);
+  p[2] = 'B';
+  p[3] = 'S';
+  p[4] = (uchar)(subfield_len & 0xff);
+  p[5] = (uchar)(subfield_len >> 8);
+  p += 6;
+
+  for (int i = 0; i < zww->frames_num; i++, p += 4) {
+    ww_zlib_uint32_encode(p, zww->frame_sizes[i]);
+  }
+  ww_zlib_uint32_encode(p, BLO_ZLIB_FRAME_SIZE);
+  ww_zlib_uint32_encode(p + 4, (uint32_t)zww->frames_num);
+  memcpy(p + 8, BLO_ZLIB_FRAMES_MAGIC, 4);
+  p += BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE;
+
+  /* Empty final deflate block, the CRC32 and size of no data are both zero. */
+  p[0] = 0x03;
+  p[1] = 0x00;
+
+  const bool success = ww_zlib_write_raw(zww, table, table_len);
+  MEM_freeN(table);
+  return success;
+}
 
 static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
 {
-  gzFile file;
+  int file;
 
-  file = BLI_gzopen(filepath, "wb1");
+  file = BLI_open(filepath, O_BINARY + O_WRONLY + O_CREAT + O_TRUNC, 0666);
 
-  if (file != Z_NULL) {
-    FILE_HANDLE(ww) = file;
+  if (file != -1) {
+    ZlibWriteWrap *zww = MEM_callocN(sizeof(*zww), __func__);
+    zww->file_handle = file;
+    zww->frame_buf = MEM_mallocN(BLO_ZLIB_FRAME_SIZE, __func__);
+    zww->frames_pending_max = max_ii(2, BLI_task_scheduler_num_threads() * 2);
+    zww->task_pool = BLI_task_pool_create(zww, TASK_PRIORITY_HIGH);
+    ZLIB_WRAP(ww) = zww;
     return true;
   }
 
@@ -275,13 +463,44 @@ static bool ww_open_zlib(WriteWrap *ww, const char *filepath)
 }
 static bool ww_close_zlib(WriteWrap *ww)
 {
-  return (gzclose(FILE_HANDLE(ww)) == Z_OK);
+  ZlibWriteWrap *zww = ZLIB_WRAP(ww);
+
+  ww_zlib_frame_submit(zww);
+  ww_zlib_frames_flush(zww);
+
+  bool success = !zww->error && ww_zlib_seek_table_write(zww);
+  if (close(zww->file_handle) == -1) {
+    success = false;
+  }
+
+  BLI_task_pool_free(zww->task_pool);
+  MEM_freeN(zww->frame_buf);
+  MEM_SAFE_FREE(zww->frame_sizes);
+  MEM_freeN(zww);
+  ZLIB_WRAP(ww) = NULL;
+
+  return success;
 }
 static size_t ww_write_zlib(WriteWrap *ww, const char *buf, size_t buf_len)
 {
-  return gzwrite(FILE_HANDLE(ww), buf, buf_len);
+  ZlibWriteWrap *zww = ZLIB_WRAP(ww);
+  const size_t buf_len_orig = buf_len;
+
+  while (buf_len > 0) {
+    const uint len = (uint)MIN2(buf_len, BLO_ZLIB_FRAME_SIZE - zww->frame_buf_used);
+    memcpy(zww->frame_buf + zww->frame_buf_used, buf, len);
+    zww->frame_buf_used += len;
+    buf += len;
+    buf_len -= len;
+
+    if (zww->frame_buf_used == BLO_ZLIB_FRAME_SIZE) {
+      ww_zlib_frame_submit(zww);
+    }
+  }
+
+  return zww->error ? 0 : buf_len_orig;
 }
-#undef FILE_HANDLE
+#undef ZLIB_WRAP
 
 /* --- end compression types --- */
 
@@ -4008,6 +4227,64 @@ bool BLO_write_file_mem(Main *mainvar, MemFile *compare, MemFile *current, int w
   return (err == 0);
 }
 
+/**
+ * Write \a memfile (an undo step, see #BLO_write_file_mem) to disk, compressing it when
+ * \a write_flags contains #G_FILE_COMPRESS.
+ *
+ * Only file-system access is done here, so this can run in a background thread
+ * (\a memfile must not be compressed, see #BLO_memfile_decompress).
+ * A temporary file is used, the file at \a filepath is only replaced once it's fully written.
+ *
+ * \param stop: Optional, cancel writing when set (the existing file is kept).
+ * \return Success.
+ */
+bool BLO_write_file_from_memfile(MemFile *memfile,
+                                 const char *filepath,
+                                 const int write_flags,
+                                 const short *stop)
+{
+  char tempname[FILE_MAX + 1];
+  WriteWrap ww;
+
+  BLI_snprintf(tempname, sizeof(tempname), "%s@", filepath);
+
+  ww_handle_init((write_flags & G_FILE_COMPRESS) ? WW_WRAP_ZLIB : WW_WRAP_NONE, &ww);
+
+  if (ww.open(&ww, tempname) == false) {
+    fprintf(stderr, "Cannot open file %s for writing: %s\n", tempname, strerror(errno));
+    return false;
+  }
+
+  bool success = true;
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    if (stop && *stop) {
+      success = false;
+      break;
+    }
+    if (ww.write(&ww, chunk->buffer->data, chunk->size) != chunk->size) {
+      fprintf(stderr, "Unable to save '%s': %s\n", filepath, strerror(errno));
+      success = false;
+      break;
+    }
+  }
+
+  if (ww.close(&ww) == false) {
+    success = false;
+  }
+
+  if (success == false) {
+    remove(tempname);
+    return false;
+  }
+
+  if (BLI_rename(tempname, filepath) != 0) {
+    fprintf(stderr, "Cannot change old file '%s' (file saved with @)\n", filepath);
+    return false;
+  }
+
+  return true;
+}
+
 void BLO_write_raw(BlendWriter *writer, int size_in_bytes, const void *data_ptr)
 {
   writedata(writer->wd, DATA, size_in_bytes, data_ptr);
@@ -0,0 +1,177 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "blendfile_loading_base_test.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "MEM_guardedalloc.h"
+
+#include "BKE_appdir.h"
+#include "BKE_customdata.h"
+#include "BKE_global.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+
+#include "BLI_fileops.h"
+#include "BLI_linklist.h"
+#include "BLI_path_util.h"
+
+#include "BLO_readfile.h"
+#include "BLO_writefile.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "../intern/readfile.h"
+
+/* Enough vertices to span several compressed frames. */
+static const int verts_num = 400000;
+
+class BlendfileCompressionTest : public BlendfileLoadingBaseTest {
+ protected:
+  char filepath[FILE_MAX];
+
+  void SetUp() override
+  {
+    BlendfileLoadingBaseTest::SetUp();
+    BKE_tempdir_init(nullptr);
+    BLI_path_join(
+        filepath, sizeof(filepath), BKE_tempdir_base(), "blendfile_compression_test.blend", NULL);
+  }
+
+  void TearDown() override
+  {
+    BLI_delete(filepath, false, false);
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  static float vert_coord(int index, int axis)
+  {
+    /* Not trivially compressible, so the compressed frames have different sizes. */
+    return (float)((index * 7919 + axis * 104729) % 65521) * 0.001f;
+  }
+
+  bool write_compressed_mesh_file()
+  {
+    Main *bmain = BKE_main_new();
+    Mesh *me = BKE_mesh_add(bmain, "CompressedMesh");
+    me->totvert = verts_num;
+    CustomData_add_layer(&me->vdata, CD_MVERT, CD_CALLOC, nullptr, verts_num);
+    BKE_mesh_update_customdata_pointers(me, false);
+    for (int i = 0; i < verts_num; i++) {
+      for (int axis = 0; axis < 3; axis++) {
+        me->mvert[i].co[axis] = vert_coord(i, axis);
+      }
+    }
+
+    BlendFileWriteParams params = {BLO_WRITE_PATH_REMAP_NONE};
+    const bool success = BLO_write_file(bmain, filepath, G_FILE_COMPRESS, &params, nullptr);
+    BKE_main_free(bmain);
+    return success;
+  }
+
+  void expect_mesh_file_contents()
+  {
+    bfile = BLO_read_from_file(filepath, BLO_READ_SKIP_NONE, nullptr);
+    ASSERT_NE(bfile, nullptr);
+
+    Mesh *me = static_cast<Mesh *>(bfile->main->meshes.first);
+    ASSERT_NE(me, nullptr);
+    ASSERT_EQ(me->totvert, verts_num);
+    ASSERT_NE(me->mvert, nullptr);
+    for (int i = 0; i < verts_num; i++) {
+      for (int axis = 0; axis < 3; axis++) {
+        ASSERT_EQ(me->mvert[i].co[axis], vert_coord(i, axis)) << "vertex " << i;
+      }
+    }
+  }
+
+  /* Read the `frame_size` and `frames_num` of the seek table footer. */
+  bool seek_table_footer_read(uchar footer[BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE])
+  {
+    FILE *file = BLI_fopen(filepath, "rb");
+    if (file == nullptr) {
+      return false;
+    }
+    const long offset = BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE + BLO_ZLIB_SEEK_TABLE_TRAILER_SIZE;
+    const bool success = fseek(file, -offset, SEEK_END) == 0 &&
+                         fread(footer, 1, BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE, file) ==
+                             BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE;
+    fclose(file);
+    return success;
+  }
+
+  bool seek_table_footer_write(const uchar footer[BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE])
+  {
+    FILE *file = BLI_fopen(filepath, "r+b");
+    if (file == nullptr) {
+      return false;
+    }
+    const long offset = BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE + BLO_ZLIB_SEEK_TABLE_TRAILER_SIZE;
+    const bool success = fseek(file, -offset, SEEK_END) == 0 &&
+                         fwrite(footer, 1, BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE, file) ==
+                             BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE;
+    fclose(file);
+    return success;
+  }
+};
+
+static uint32_t uint32_decode(const uchar *buf)
+{
+  return (uint32_t)buf[0] | ((uint32_t)buf[1] << 8) | ((uint32_t)buf[2] << 16) |
+         ((uint32_t)buf[3] << 24);
+}
+
+TEST_F(BlendfileCompressionTest, SeekTableRoundTrip)
+{
+  ASSERT_TRUE(write_compressed_mesh_file());
+
+  uchar footer[BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE];
+  ASSERT_TRUE(seek_table_footer_read(footer));
+  EXPECT_EQ(memcmp(footer + 8, BLO_ZLIB_FRAMES_MAGIC, 4), 0);
+  EXPECT_EQ(uint32_decode(footer), BLO_ZLIB_FRAME_SIZE);
+  EXPECT_GT(uint32_decode(footer + 4), 2u);
+
+  /* Listing names only reads block headers and seeks over their data. */
+  BlendHandle *bh = BLO_blendhandle_from_file(filepath, nullptr);
+  ASSERT_NE(bh, nullptr);
+  int names_num = 0;
+  LinkNode *names = BLO_blendhandle_get_datablock_names(bh, ID_ME, &names_num);
+  EXPECT_EQ(names_num, 1);
+  if (names != nullptr) {
+    EXPECT_STREQ(static_cast<const char *>(names->link), "CompressedMesh");
+  }
+  BLI_linklist_freeN(names);
+  BLO_blendhandle_close(bh);
+
+  /* Reading all data goes back to the blocks that were skipped. */
+  expect_mesh_file_contents();
+}
+
+TEST_F(BlendfileCompressionTest, SeekTableInvalidFrameSize)
+{
+  ASSERT_TRUE(write_compressed_mesh_file());
+
+  /* A frame size that is out of bounds must make reading ignore the seek table, the file is
+   * then read as a regular gzip stream. */
+  uchar footer[BLO_ZLIB_SEEK_TABLE_FOOTER_SIZE];
+  ASSERT_TRUE(seek_table_footer_read(footer));
+  footer[0] = footer[1] = footer[2] = footer[3] = 0xff;
+  ASSERT_TRUE(seek_table_footer_write(footer));
+
+  expect_mesh_file_contents();
+}
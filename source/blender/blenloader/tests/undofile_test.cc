@@ -0,0 +1,128 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "testing/testing.h"
+
+#include <cstring>
+#include <string>
+
+#include "BLI_listbase.h"
+#include "BLI_threads.h"
+
+#include "BLO_undofile.h"
+
+static void memfile_write(MemFile *memfile, MemFile *reference, const char **bufs, int bufs_len)
+{
+  MemFileWriteData mem_data = {nullptr};
+  BLO_memfile_write_init(&mem_data, memfile, reference);
+  for (int i = 0; i < bufs_len; i++) {
+    BLO_memfile_chunk_add(&mem_data, bufs[i], (uint)strlen(bufs[i]));
+  }
+  BLO_memfile_write_finalize(&mem_data);
+}
+
+static void memfile_expect_contents(MemFile *memfile, const char **bufs, int bufs_len)
+{
+  EXPECT_EQ(BLI_listbase_count(&memfile->chunks), bufs_len);
+  int i = 0;
+  LISTBASE_FOREACH (MemFileChunk *, chunk, &memfile->chunks) {
+    ASSERT_NE(chunk->buffer->data, nullptr);
+    EXPECT_EQ(std::string(chunk->buffer->data, chunk->size), std::string(bufs[i++]));
+  }
+}
+
+TEST(undofile, SharedBuffers)
+{
+  BLI_threadapi_init();
+
+  const char *bufs_a[] = {"first chunk", "second chunk", "third chunk"};
+  const char *bufs_b[] = {"third chunk", "second chunk", "changed chunk"};
+  MemFile memfile_a = {{nullptr}};
+  MemFile memfile_b = {{nullptr}};
+
+  memfile_write(&memfile_a, nullptr, bufs_a, 3);
+  memfile_write(&memfile_b, &memfile_a, bufs_b, 3);
+
+  MemFileChunk *chunk_b_0 = (MemFileChunk *)memfile_b.chunks.first;
+  MemFileChunk *chunk_b_1 = (MemFileChunk *)chunk_b_0->next;
+  MemFileChunk *chunk_a_1 = (MemFileChunk *)((MemFileChunk *)memfile_a.chunks.first)->next;
+  MemFileChunk *chunk_a_2 = (MemFileChunk *)chunk_a_1->next;
+
+  /* Shared with the matching chunk of the reference. */
+  EXPECT_TRUE(chunk_b_1->is_identical);
+  EXPECT_EQ(chunk_b_1->buffer, chunk_a_1->buffer);
+  /* Shared by contents, but not identical to the matching chunk of the reference. */
+  EXPECT_FALSE(chunk_b_0->is_identical);
+  EXPECT_EQ(chunk_b_0->buffer, chunk_a_2->buffer);
+  EXPECT_EQ(memfile_b.size, strlen("changed chunk"));
+
+  BLO_memfile_merge(&memfile_a, &memfile_b);
+  EXPECT_EQ(memfile_b.size,
+            strlen("second chunk") + strlen("third chunk") + strlen("changed chunk"));
+  memfile_expect_contents(&memfile_b, bufs_b, 3);
+
+  BLO_memfile_free(&memfile_b);
+
+  BLI_threadapi_exit();
+}
+
+TEST(undofile, Compress)
+{
+  BLI_threadapi_init();
+
+  std::string large(1 << 16, 'a');
+  const char *bufs_a[] = {large.c_str(), "small"};
+  const char *bufs_b[] = {large.c_str(), "other"};
+  MemFile memfile_a = {{nullptr}};
+  MemFile memfile_b = {{nullptr}};
+
+  memfile_write(&memfile_a, nullptr, bufs_a, 2);
+  memfile_write(&memfile_b, &memfile_a, bufs_b, 2);
+  EXPECT_EQ(memfile_a.store, memfile_b.store);
+
+  const size_t size_a = memfile_a.size;
+  MemFileChunk *chunk_a_0 = (MemFileChunk *)memfile_a.chunks.first;
+
+  /* The large buffer is still used by an uncompressed memfile, it isn't compressed. */
+  BLO_memfile_compress(&memfile_a);
+  BLO_memfile_compress_wait(&memfile_a);
+  EXPECT_NE(chunk_a_0->buffer->data, nullptr);
+  EXPECT_EQ(memfile_a.size, size_a);
+
+  /* Needed uncompressed again before the compression is done, its result is discarded. */
+  BLO_memfile_compress(&memfile_b);
+  BLO_memfile_decompress(&memfile_b);
+  BLO_memfile_compress_wait(&memfile_a);
+  EXPECT_NE(chunk_a_0->buffer->data, nullptr);
+  EXPECT_EQ(memfile_a.size, size_a);
+
+  /* Only used by compressed memfiles now. */
+  BLO_memfile_compress(&memfile_b);
+  BLO_memfile_compress_wait(&memfile_b);
+  EXPECT_EQ(chunk_a_0->buffer->data, nullptr);
+  EXPECT_LT(memfile_a.size, size_a);
+
+  BLO_memfile_decompress(&memfile_b);
+  EXPECT_EQ(memfile_a.size, size_a);
+  memfile_expect_contents(&memfile_b, bufs_b, 2);
+
+  /* Freeing a memfile while its buffers are being compressed. */
+  BLO_memfile_compress(&memfile_b);
+  BLO_memfile_free(&memfile_a);
+  BLO_memfile_free(&memfile_b);
+
+  BLI_threadapi_exit();
+}
@@ -592,6 +592,8 @@ void BM_mesh_bm_to_me(Main *bmain, BMesh *bm, Mesh *me, const struct BMeshToMesh
 #if 0
   oldverts = MEM_dupallocN(me->mvert);
 #else
+    /* The array is freed at the end, make sure it is not shared with an evaluated copy. */
+    me->mvert = CustomData_duplicate_referenced_layer(&me->vdata, CD_MVERT, me->totvert);
     oldverts = me->mvert;
     me->mvert = NULL;
     CustomData_update_typemap(&me->vdata);
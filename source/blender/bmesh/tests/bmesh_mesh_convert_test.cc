@@ -0,0 +1,83 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+#include "testing/testing.h"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_key_types.h"
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "BKE_customdata.h"
+#include "BKE_idtype.h"
+#include "BKE_key.h"
+#include "BKE_lib_id.h"
+#include "BKE_main.h"
+#include "BKE_mesh.h"
+
+#include "bmesh.h"
+
+static const int verts_num = 4;
+
+/* Leaving edit-mode with shape keys while an evaluated copy shares the vertices of the mesh. */
+TEST(bmesh_mesh_convert, ShapeKeysWithSharedVerts)
+{
+  BKE_idtype_init();
+  Main *bmain = BKE_main_new();
+  Mesh *me = BKE_mesh_add(bmain, "Mesh");
+  me->totvert = verts_num;
+  CustomData_add_layer(&me->vdata, CD_MVERT, CD_CALLOC, nullptr, verts_num);
+  BKE_mesh_update_customdata_pointers(me, false);
+  for (int i = 0; i < verts_num; i++) {
+    me->mvert[i].co[0] = (float)i;
+  }
+  me->key = BKE_key_add(bmain, &me->id);
+  KeyBlock *kb = BKE_keyblock_add(me->key, nullptr);
+  BKE_keyblock_convert_from_mesh(me, me->key, kb);
+
+  Mesh *me_eval = BKE_mesh_copy_for_eval(me, true);
+  EXPECT_EQ(me_eval->mvert, me->mvert);
+
+  BMeshCreateParams create_params = {0};
+  BMesh *bm = BM_mesh_create(&bm_mesh_allocsize_default, &create_params);
+  BMeshFromMeshParams from_params = {0};
+  from_params.use_shapekey = true;
+  from_params.active_shapekey = 1;
+  BM_mesh_bm_from_me(bm, me, &from_params);
+
+  BMVert *v;
+  BMIter iter;
+  BM_ITER_MESH (v, &iter, bm, BM_VERTS_OF_MESH) {
+    v->co[1] = 1.0f;
+  }
+  BMeshToMeshParams to_params = {0};
+  BM_mesh_bm_to_me(nullptr, bm, me, &to_params);
+  BM_mesh_free(bm);
+
+  /* The evaluated copy keeps the old vertices, until it is updated. */
+  ASSERT_EQ(me->totvert, verts_num);
+  EXPECT_NE(me_eval->mvert, me->mvert);
+  for (int i = 0; i < verts_num; i++) {
+    EXPECT_EQ(me->mvert[i].co[1], 1.0f);
+    EXPECT_EQ(me_eval->mvert[i].co[0], (float)i);
+    EXPECT_EQ(me_eval->mvert[i].co[1], 0.0f);
+  }
+  const float(*kb_co)[3] = (const float(*)[3])kb->data;
+  EXPECT_EQ(kb_co[verts_num - 1][1], 1.0f);
+
+  BKE_id_free(nullptr, me_eval);
+  BKE_main_free(bmain);
+}
@@ -93,7 +93,7 @@ extern "C" {
  *
  * \see ExecutionSystem.execute control of the Render priority
  * \see NodeOperation.getRenderPriority receive the render priority
- * \see ExecutionGroup.execute the main loop to execute a whole ExecutionGroup
+ * \see ExecutionSystem.executeGroups the main loop to execute the output ExecutionGroups
  *
  * \section order Chunk order
  *
@@ -120,7 +120,7 @@ extern "C" {
  *  - [@ref ChunkExecutionState.COM_ES_EXECUTED]:
  *    Chunk is finished.
  *
- * \see ExecutionGroup.execute
+ * \see ExecutionGroup.executeBegin
  * \see ViewerOperation.getChunkOrder
  * \see OrderOfChunks
  *
@@ -167,7 +167,7 @@ extern "C" {
  * +-------------------------+        | (B)            |                           | (A)            |
  *            O                       +----------------+                           +----------------+
  *            O                                |                                            |
- *            O       ExecutionGroup.execute   |                                            |
+ *            O  ExecutionGroup.executeBegin   |                                            |
  *            O------------------------------->O                                            |
  *            .                                O                                            |
  *            .                                O-------\                                    |
@@ -219,7 +219,7 @@ extern "C" {
  *
  * </pre>
  *
- * \see ExecutionGroup.execute Execute a complete ExecutionGroup.
+ * \see ExecutionSystem.executeGroups Execute the output ExecutionGroups.
  * Halts until finished or breaked by user
  * \see ExecutionGroup.scheduleChunkWhenPossible Tries to schedule a single chunk,
  * checks if all input data is available. Can trigger dependent chunks to be calculated
@@ -237,11 +237,15 @@ extern "C" {
  * \section workscheduler WorkScheduler
  * the WorkScheduler is implemented as a static class. the responsibility of the WorkScheduler
  * is to balance WorkPackages to the available and free devices.
- * the work-scheduler can work in 2 states.
+ * the work-scheduler can work in 3 states.
  * For witching these between the state you need to recompile blender
  *
  * \subsection multithread Multi threaded
- * Default the work-scheduler will place all work as WorkPackage in a queue.
+ * Default the work-scheduler will push all CPU work as WorkPackage in a task pool,
+ * executed by the task scheduler shared with the rest of Blender.
+ * Idle threads steal work from busy ones, and the thread waiting for the work helps executing it.
+ *
+ * With COM_TM_QUEUE all work is placed in a queue instead.
  * For every CPUcore a working thread is created.
  * These working threads will ask the WorkScheduler if there is work
  * for a specific Device.
@@ -294,6 +298,24 @@ extern "C" {
  *
  * \section executePixel executing a pixel
  * Finally the last step, the node functionality :)
+ *
+ * \section fullframe Full-frame execution
+ * When all operations of the ExecutionSystem implement NodeOperation.update_memory_buffer,
+ * the ExecutionGroup's and chunks are not used. Every operation is calculated once for its
+ * whole area, in an order where its inputs are already calculated. The area is split in
+ * rows that are calculated in parallel. An operation reads its inputs from their buffers
+ * instead of calling executePixel for every pixel of the inputs.
+ *
+ * The buffer of an operation is freed as soon as all operations reading it are calculated.
+ * \see ExecutionSystem.executeFullFrame
+ * \see NodeOperation.isFullFrame
+ *
+ * \subsection fullframecache Cache
+ * When editing, results of operations are kept in the CompositorCache between executions.
+ * They are identified by a hash of the operation parameters (NodeOperation.hashParams) and of
+ * its inputs, so after a change only the operations depending on the changed node are
+ * calculated again. The memory of the cache is limited by the compositor cache limit of the
+ * user preferences.
  */
 
 /**
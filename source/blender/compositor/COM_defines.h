@@ -68,10 +68,18 @@ typedef enum CompositorPriority {
 // workscheduler threading models
 /**
  * COM_TM_QUEUE is a multi-threaded model, which uses the BLI_thread_queue pattern.
- * This is the default option.
+ * Every CPUDevice has its own thread, waiting for work in a single queue.
  */
 #define COM_TM_QUEUE 1
 
+/**
+ * COM_TM_TASK is a multi-threaded model, which uses a BLI_task pool for the CPU work.
+ * The work is executed by the task scheduler shared with the rest of Blender (work stealing).
+ * OpenCL devices still have their own threads and queue.
+ * This is the default option (when building with TBB).
+ */
+#define COM_TM_TASK 2
+
 /**
  * COM_TM_NOTHREAD is a single threading model, everything is executed in the caller thread.
  * easy for debugging
@@ -79,9 +87,14 @@ typedef enum CompositorPriority {
 #define COM_TM_NOTHREAD 0
 
 /**
- * COM_CURRENT_THREADING_MODEL can be one of the above, COM_TM_QUEUE is currently default.
+ * COM_CURRENT_THREADING_MODEL can be one of the above, COM_TM_TASK is currently default.
+ * Without TBB task pools execute their tasks in the calling thread, COM_TM_QUEUE is used then.
  */
-#define COM_CURRENT_THREADING_MODEL COM_TM_QUEUE
+#ifdef WITH_TBB
+#  define COM_CURRENT_THREADING_MODEL COM_TM_TASK
+#else
+#  define COM_CURRENT_THREADING_MODEL COM_TM_QUEUE
+#endif
 // chunk order
 /**
  * \brief The order of chunks to be scheduled
@@ -0,0 +1,169 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#include <list>
+#include <map>
+#include <string.h>
+
+#include "DNA_userdef_types.h"
+
+#include "COM_CompositorCache.h"
+#include "COM_MemoryBuffer.h"
+
+/* -------------------------------------------------------------------- */
+/** \name Operation Hash
+ * \{ */
+
+#define COM_HASH_PRIME1 0x9E3779B185EBCA87ULL
+#define COM_HASH_PRIME2 0xC2B2AE3D27D4EB4FULL
+
+static inline uint64_t hash_rotl(uint64_t value, int bits)
+{
+  return (value << bits) | (value >> (64 - bits));
+}
+
+static inline uint64_t hash_round(uint64_t hash, uint64_t value)
+{
+  hash ^= hash_rotl(value * COM_HASH_PRIME2, 31) * COM_HASH_PRIME1;
+  return hash_rotl(hash, 27) * COM_HASH_PRIME1 + COM_HASH_PRIME2;
+}
+
+OperationHash::OperationHash()
+{
+  this->m_hash = COM_HASH_PRIME1;
+}
+
+void OperationHash::addData(const void *data, size_t size)
+{
+  /* Words are mixed at once instead of bytes. */
+  const unsigned char *bytes = (const unsigned char *)data;
+  uint64_t hash = hash_round(this->m_hash, size);
+  for (; size >= sizeof(uint64_t); size -= sizeof(uint64_t), bytes += sizeof(uint64_t)) {
+    uint64_t word;
+    memcpy(&word, bytes, sizeof(uint64_t));
+    hash = hash_round(hash, word);
+  }
+  if (size > 0) {
+    uint64_t word = 0;
+    memcpy(&word, bytes, size);
+    hash = hash_round(hash, word);
+  }
+  this->m_hash = hash;
+}
+
+/** \} */
+
+/* -------------------------------------------------------------------- */
+/** \name Compositor Cache
+ * \{ */
+
+typedef struct CacheEntry {
+  uint64_t hash;
+  MemoryBuffer *buffer;
+  size_t size;
+  /** Execution the entry was last used by, entries used by the current one can't be freed. */
+  unsigned int execution;
+} CacheEntry;
+
+typedef std::list<CacheEntry> CacheEntries;
+
+/** Most recently used entries first. */
+static CacheEntries g_entries;
+static std::map<uint64_t, CacheEntries::iterator> g_lookup;
+static size_t g_size = 0;
+static unsigned int g_execution = 0;
+
+static size_t cache_limit()
+{
+  if (U.compositor_cache_limit <= 0) {
+    return 0;
+  }
+  return (size_t)U.compositor_cache_limit * 1024 * 1024;
+}
+
+static size_t cache_buffer_size(MemoryBuffer *buffer)
+{
+  return (size_t)buffer->getWidth() * buffer->getHeight() * buffer->get_num_channels() *
+         sizeof(float);
+}
+
+/* Free least recently used entries until `size` fits in the limit, keeping the entries used by the
+ * current execution. */
+static bool cache_make_room(size_t size)
+{
+  const size_t limit = cache_limit();
+  CacheEntries::iterator it = g_entries.end();
+  while (g_size + size > limit && it != g_entries.begin()) {
+    --it;
+    if (it->execution == g_execution) {
+      continue;
+    }
+    delete it->buffer;
+    g_size -= it->size;
+    g_lookup.erase(it->hash);
+    it = g_entries.erase(it);
+  }
+  return g_size + size <= limit;
+}
+
+void CompositorCache::beginExecution()
+{
+  g_execution++;
+  cache_make_room(0);
+}
+
+MemoryBuffer *CompositorCache::get(uint64_t hash)
+{
+  std::map<uint64_t, CacheEntries::iterator>::iterator found = g_lookup.find(hash);
+  if (found == g_lookup.end()) {
+    return NULL;
+  }
+  CacheEntries::iterator it = found->second;
+  it->execution = g_execution;
+  g_entries.splice(g_entries.begin(), g_entries, it);
+  return it->buffer;
+}
+
+bool CompositorCache::put(uint64_t hash, MemoryBuffer *buffer)
+{
+  if (g_lookup.find(hash) != g_lookup.end()) {
+    return false;
+  }
+  const size_t size = cache_buffer_size(buffer);
+  if (!cache_make_room(size)) {
+    return false;
+  }
+
+  CacheEntry entry = {hash, buffer, size, g_execution};
+  g_entries.push_front(entry);
+  g_lookup[hash] = g_entries.begin();
+  g_size += size;
+  return true;
+}
+
+void CompositorCache::clear()
+{
+  for (CacheEntry &entry : g_entries) {
+    delete entry.buffer;
+  }
+  g_entries.clear();
+  g_lookup.clear();
+  g_size = 0;
+}
+
+/** \} */
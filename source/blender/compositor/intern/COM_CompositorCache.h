@@ -0,0 +1,97 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * Copyright 2020, Blender Foundation.
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+class MemoryBuffer;
+
+/**
+ * \brief hash identifying the result of a NodeOperation.
+ * Built from the type, resolution and parameters of the operation and the hashes of its inputs.
+ * \see NodeOperation.hashParams
+ * \ingroup Execution
+ */
+class OperationHash {
+ private:
+  uint64_t m_hash;
+
+ public:
+  OperationHash();
+
+  /**
+   * \brief add the contents of a block of memory to the hash
+   */
+  void addData(const void *data, size_t size);
+
+  /**
+   * \brief add a single value to the hash
+   */
+  template<typename T> void add(const T &value)
+  {
+    addData(&value, sizeof(T));
+  }
+
+  uint64_t get() const
+  {
+    return this->m_hash;
+  }
+};
+
+/**
+ * \brief cache keeping the results of operations between executions of the compositor.
+ *
+ * Results are identified by their OperationHash, so when a node tree is executed again only the
+ * operations that are changed, or that depend on changed operations, need to be calculated.
+ * The memory used by the cache is limited by the compositor cache limit of the user preferences,
+ * the least recently used results are freed first.
+ *
+ * Only used by the full-frame execution model, and not accessed from multiple threads at once:
+ * executions are serialized by COM_execute.
+ * \see ExecutionSystem.executeFullFrame
+ * \ingroup Execution
+ */
+class CompositorCache {
+ public:
+  /**
+   * \brief start a new execution
+   * Results used by the previous execution can be freed again, and the cache is trimmed to the
+   * memory limit when it was lowered.
+   */
+  static void beginExecution();
+
+  /**
+   * \brief find a cached result, NULL when not found
+   * The returned buffer is owned by the cache and stays valid during the current execution.
+   */
+  static MemoryBuffer *get(uint64_t hash);
+
+  /**
+   * \brief add a result to the cache
+   * \return true when the cache took ownership of the buffer. False when the buffer doesn't fit in
+   * the memory limit or the result was already cached, the caller keeps the ownership then.
+   */
+  static bool put(uint64_t hash, MemoryBuffer *buffer);
+
+  /**
+   * \brief free all cached results
+   */
+  static void clear();
+};
@@ -59,6 +59,8 @@ ExecutionGroup::ExecutionGroup()
   this->m_chunksFinished = 0;
   BLI_rcti_init(&this->m_viewerBorder, 0, 0, 0, 0);
   this->m_executionStartTime = 0;
+  this->m_chunkOrder = NULL;
+  this->m_chunkOrderStartIndex = 0;
 }
 
 CompositorPriority ExecutionGroup::getRenderPriotrity()
@@ -152,6 +154,7 @@ void ExecutionGroup::initExecution()
 
 void ExecutionGroup::deinitExecution()
 {
+  MEM_SAFE_FREE(this->m_chunkOrder);
   if (this->m_chunkExecutionStates != NULL) {
     MEM_freeN(this->m_chunkExecutionStates);
     this->m_chunkExecutionStates = NULL;
@@ -192,18 +195,18 @@ void ExecutionGroup::determineNumberOfChunks()
  * this method is called for the top execution groups. containing the compositor node or the
  * preview node or the viewer node)
  */
-void ExecutionGroup::execute(ExecutionSystem *graph)
+bool ExecutionGroup::executeBegin(ExecutionSystem *graph)
 {
   const CompositorContext &context = graph->getContext();
   const bNodeTree *bTree = context.getbNodeTree();
   if (this->m_width == 0 || this->m_height == 0) {
-    return;
+    return false;
   }  /// \note Break out... no pixels to calculate.
   if (bTree->test_break && bTree->test_break(bTree->tbh)) {
-    return;
+    return false;
   }  /// \note Early break out for blur and preview nodes.
   if (this->m_numberOfChunks == 0) {
-    return;
+    return false;
   }  /// \note Early break out.
   unsigned int chunkNumber;
 
@@ -322,53 +325,56 @@ void ExecutionGroup::execute(ExecutionSystem *graph)
   DebugInfo::execution_group_started(this);
   DebugInfo::graphviz(graph);
 
-  bool breaked = false;
-  bool finished = false;
-  unsigned int startIndex = 0;
-  const int maxNumberEvaluated = BLI_system_thread_count() * 2;
+  this->m_chunkOrder = chunkOrder;
+  this->m_chunkOrderStartIndex = 0;
 
-  while (!finished && !breaked) {
-    bool startEvaluated = false;
-    finished = true;
-    int numberEvaluated = 0;
-
-    for (index = startIndex;
-         index < this->m_numberOfChunks && numberEvaluated < maxNumberEvaluated;
-         index++) {
-      chunkNumber = chunkOrder[index];
-      int yChunk = chunkNumber / this->m_numberOfXChunks;
-      int xChunk = chunkNumber - (yChunk * this->m_numberOfXChunks);
-      const ChunkExecutionState state = this->m_chunkExecutionStates[chunkNumber];
-      if (state == COM_ES_NOT_SCHEDULED) {
-        scheduleChunkWhenPossible(graph, xChunk, yChunk);
-        finished = false;
-        startEvaluated = true;
-        numberEvaluated++;
-
-        if (bTree->update_draw) {
-          bTree->update_draw(bTree->udh);
-        }
-      }
-      else if (state == COM_ES_SCHEDULED) {
-        finished = false;
-        startEvaluated = true;
-        numberEvaluated++;
-      }
-      else if (state == COM_ES_EXECUTED && !startEvaluated) {
-        startIndex = index + 1;
+  return true;
+}
+
+bool ExecutionGroup::scheduleNextChunks(ExecutionSystem *graph)
+{
+  const bNodeTree *bTree = graph->getContext().getbNodeTree();
+  const int maxNumberEvaluated = BLI_system_thread_count() * 2;
+  bool startEvaluated = false;
+  bool finished = true;
+  int numberEvaluated = 0;
+
+  for (unsigned int index = this->m_chunkOrderStartIndex;
+       index < this->m_numberOfChunks && numberEvaluated < maxNumberEvaluated;
+       index++) {
+    unsigned int chunkNumber = this->m_chunkOrder[index];
+    int yChunk = chunkNumber / this->m_numberOfXChunks;
+    int xChunk = chunkNumber - (yChunk * this->m_numberOfXChunks);
+    const ChunkExecutionState state = this->m_chunkExecutionStates[chunkNumber];
+    if (state == COM_ES_NOT_SCHEDULED) {
+      scheduleChunkWhenPossible(graph, xChunk, yChunk);
+      finished = false;
+      startEvaluated = true;
+      numberEvaluated++;
+
+      if (bTree->update_draw) {
+        bTree->update_draw(bTree->udh);
       }
     }
-
-    WorkScheduler::finish();
-
-    if (bTree->test_break && bTree->test_break(bTree->tbh)) {
-      breaked = true;
+    else if (state == COM_ES_SCHEDULED) {
+      finished = false;
+      startEvaluated = true;
+      numberEvaluated++;
+    }
+    else if (state == COM_ES_EXECUTED && !startEvaluated) {
+      this->m_chunkOrderStartIndex = index + 1;
     }
   }
+
+  return finished;
+}
+
+void ExecutionGroup::executeEnd(ExecutionSystem *graph)
+{
   DebugInfo::execution_group_finished(this);
   DebugInfo::graphviz(graph);
 
-  MEM_freeN(chunkOrder);
+  MEM_SAFE_FREE(this->m_chunkOrder);
 }
 
 MemoryBuffer **ExecutionGroup::getInputBuffersOpenCL(int chunkNumber)
@@ -181,6 +181,17 @@ class ExecutionGroup {
    */
   double m_executionStartTime;
 
+  /**
+   * \brief order in which the chunks are scheduled, only set while executing.
+   * \see executeBegin
+   */
+  unsigned int *m_chunkOrder;
+
+  /**
+   * \brief index in m_chunkOrder before which all chunks are executed.
+   */
+  unsigned int m_chunkOrderStartIndex;
+
   // methods
   /**
    * \brief check whether parameter operation can be added to the execution group
@@ -382,22 +393,30 @@ class ExecutionGroup {
   void deinitExecution();
 
   /**
-   * \brief schedule an ExecutionGroup
-   * \note this method will return when all chunks have been calculated, or the execution has
-   * breaked (by user)
+   * \brief start the execution of an output ExecutionGroup, the chunk order is determined here.
+   * Chunks are then scheduled with scheduleNextChunks until all are executed, and executeEnd
+   * must be called afterwards. This allows to execute multiple groups at once,
+   * see ExecutionSystem.executeGroups.
    *
-   * first the order of the chunks will be determined. This is determined by finding the
-   * ViewerOperation and get the relevant information from it.
+   * The order of the chunks is determined by finding the ViewerOperation and get the relevant
+   * information from it.
    *   - ChunkOrdering
    *   - CenterX
    *   - CenterY
    *
-   * After determining the order of the chunks the chunks will be scheduled
-   *
    * \see ViewerOperation
-   * \param graph:
+   * \return false when there is nothing to execute (executeEnd must not be called).
    */
-  void execute(ExecutionSystem *graph);
+  bool executeBegin(ExecutionSystem *graph);
+
+  /**
+   * \brief schedule the next chunks in order (with the chunks they depend on),
+   * the caller waits for them using WorkScheduler.finish before calling this again.
+   * \return true when all chunks have been executed.
+   */
+  bool scheduleNextChunks(ExecutionSystem *graph);
+
+  void executeEnd(ExecutionSystem *graph);
 
   /**
    * \brief this method determines the MemoryProxy's where this execution group depends on.
@@ -439,6 +458,15 @@ class ExecutionGroup {
 
   void setRenderBorder(float xmin, float xmax, float ymin, float ymax);
 
+  /**
+   * \brief get the area of the output operation to calculate, limited by the viewer or render
+   * border.
+   */
+  const rcti *getRenderArea() const
+  {
+    return &this->m_viewerBorder;
+  }
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
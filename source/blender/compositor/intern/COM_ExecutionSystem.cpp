@@ -18,6 +18,13 @@
 
 #include "COM_ExecutionSystem.h"
 
+#include <map>
+#include <set>
+#include <typeinfo>
+
+#include "BLI_rect.h"
+#include "BLI_string.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 #include "PIL_time.h"
 
@@ -25,6 +32,9 @@
 
 #include "BLT_translation.h"
 
+#include "DNA_userdef_types.h"
+
+#include "COM_CompositorCache.h"
 #include "COM_Converter.h"
 #include "COM_Debug.h"
 #include "COM_ExecutionGroup.h"
@@ -37,6 +47,9 @@
 #  include "MEM_guardedalloc.h"
 #endif
 
+/** Number of rows of an area calculated by a single task in the full-frame execution model. */
+#define COM_FULL_FRAME_ROWS_PER_TASK 16
+
 ExecutionSystem::ExecutionSystem(RenderData *rd,
                                  Scene *scene,
                                  bNodeTree *editingtree,
@@ -125,6 +138,7 @@ void ExecutionSystem::set_operations(const Operations &operations, const Groups
 {
   m_operations = operations;
   m_groups = groups;
+  m_fullFrame = canExecuteFullFrame();
 }
 
 void ExecutionSystem::execute()
@@ -171,22 +185,28 @@ void ExecutionSystem::execute()
       operation->initExecution();
     }
   }
-  for (index = 0; index < this->m_groups.size(); index++) {
-    ExecutionGroup *executionGroup = this->m_groups[index];
-    executionGroup->setChunksize(this->m_context.getChunksize());
-    executionGroup->initExecution();
+
+  if (this->m_fullFrame) {
+    executeFullFrame();
   }
+  else {
+    for (index = 0; index < this->m_groups.size(); index++) {
+      ExecutionGroup *executionGroup = this->m_groups[index];
+      executionGroup->setChunksize(this->m_context.getChunksize());
+      executionGroup->initExecution();
+    }
 
-  WorkScheduler::start(this->m_context);
+    WorkScheduler::start(this->m_context);
 
-  executeGroups(COM_PRIORITY_HIGH);
-  if (!this->getContext().isFastCalculation()) {
-    executeGroups(COM_PRIORITY_MEDIUM);
-    executeGroups(COM_PRIORITY_LOW);
-  }
+    executeGroups(COM_PRIORITY_HIGH);
+    if (!this->getContext().isFastCalculation()) {
+      executeGroups(COM_PRIORITY_MEDIUM);
+      executeGroups(COM_PRIORITY_LOW);
+    }
 
-  WorkScheduler::finish();
-  WorkScheduler::stop();
+    WorkScheduler::finish();
+    WorkScheduler::stop();
+  }
 
   editingtree->stats_draw(editingtree->sdh, TIP_("Compositing | De-initializing execution"));
   for (index = 0; index < this->m_operations.size(); index++) {
@@ -201,13 +221,38 @@ void ExecutionSystem::execute()
 
 void ExecutionSystem::executeGroups(CompositorPriority priority)
 {
-  unsigned int index;
+  const bNodeTree *editingtree = this->m_context.getbNodeTree();
   vector<ExecutionGroup *> executionGroups;
   this->findOutputExecutionGroup(&executionGroups, priority);
 
-  for (index = 0; index < executionGroups.size(); index++) {
-    ExecutionGroup *group = executionGroups[index];
-    group->execute(this);
+  /* Output groups are executed together instead of one after the other, so chunks of
+   * independent groups (and the groups they depend on) can be computed at the same time.
+   * Scheduling is only done from this thread, the chunks being executed by the WorkScheduler. */
+  vector<ExecutionGroup *> runningGroups;
+  for (ExecutionGroup *group : executionGroups) {
+    if (group->executeBegin(this)) {
+      runningGroups.push_back(group);
+    }
+  }
+
+  bool finished = runningGroups.empty();
+  while (!finished) {
+    finished = true;
+    for (ExecutionGroup *group : runningGroups) {
+      if (!group->scheduleNextChunks(this)) {
+        finished = false;
+      }
+    }
+
+    WorkScheduler::finish();
+
+    if (editingtree->test_break && editingtree->test_break(editingtree->tbh)) {
+      break;
+    }
+  }
+
+  for (ExecutionGroup *group : runningGroups) {
+    group->executeEnd(this);
   }
 }
 
@@ -233,3 +278,257 @@ void ExecutionSystem::findOutputExecutionGroup(vector<ExecutionGroup *> *result)
     }
   }
 }
+
+/* -------------------------------------------------------------------- */
+/** \name Full-Frame Execution
+ * \{ */
+
+bool ExecutionSystem::canExecuteFullFrame() const
+{
+  if (this->m_operations.empty()) {
+    return false;
+  }
+  for (NodeOperation *operation : this->m_operations) {
+    /* Buffers are stored per operation, so only a single output is supported. */
+    if (!operation->isFullFrame() || operation->getNumberOfOutputSockets() > 1) {
+      return false;
+    }
+    for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+      if (!operation->getInputSocket(index)->isConnected()) {
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+typedef std::set<NodeOperation *> Tags;
+
+/* Depth-first sorting, the inputs of an operation are always before the operation itself. */
+static void full_frame_sort_operations_recursive(ExecutionSystem::Operations &sorted,
+                                                 Tags &visited,
+                                                 NodeOperation *operation)
+{
+  if (visited.find(operation) != visited.end()) {
+    return;
+  }
+  visited.insert(operation);
+
+  for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+    NodeOperationInput *input = operation->getInputSocket(index);
+    full_frame_sort_operations_recursive(sorted, visited, &input->getLink()->getOperation());
+  }
+
+  sorted.push_back(operation);
+}
+
+typedef struct FullFrameTaskData {
+  NodeOperation *operation;
+  MemoryBuffer *output;
+  const rcti *area;
+  blender::Span<MemoryBuffer *> inputs;
+} FullFrameTaskData;
+
+static void full_frame_update_task(void *__restrict userdata,
+                                   const int task_index,
+                                   const TaskParallelTLS *__restrict /*tls*/)
+{
+  const FullFrameTaskData *data = (const FullFrameTaskData *)userdata;
+  const int ymin = data->area->ymin + task_index * COM_FULL_FRAME_ROWS_PER_TASK;
+  rcti area;
+  BLI_rcti_init(&area,
+                data->area->xmin,
+                data->area->xmax,
+                ymin,
+                min_ii(ymin + COM_FULL_FRAME_ROWS_PER_TASK, data->area->ymax));
+  data->operation->update_memory_buffer(data->output, area, data->inputs);
+}
+
+static void full_frame_update_area(NodeOperation *operation,
+                                   MemoryBuffer *output,
+                                   const rcti *area,
+                                   blender::Span<MemoryBuffer *> inputs)
+{
+  if (BLI_rcti_is_empty(area)) {
+    return;
+  }
+
+  FullFrameTaskData data = {operation, output, area, inputs};
+  const int height = BLI_rcti_size_y(area);
+  const int num_tasks = (height + COM_FULL_FRAME_ROWS_PER_TASK - 1) /
+                        COM_FULL_FRAME_ROWS_PER_TASK;
+
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.use_threading = !operation->isSingleThreaded();
+  BLI_task_parallel_range(0, num_tasks, &data, full_frame_update_task, &settings);
+}
+
+/* Hash the results of the operations that can be cached, in the order of `sorted` so the hashes
+ * of the inputs are known. Operations without a hash can't be cached and neither can the
+ * operations depending on them. */
+static void full_frame_hash_operations(const ExecutionSystem::Operations &sorted,
+                                       std::map<NodeOperation *, uint64_t> &hashes)
+{
+  for (NodeOperation *operation : sorted) {
+    OperationHash hash;
+    if (!operation->hashParams(hash)) {
+      continue;
+    }
+    /* Type names are unique strings, hashing the pointer is enough. */
+    hash.add(typeid(*operation).name());
+    hash.add(operation->getWidth());
+    hash.add(operation->getHeight());
+    if (operation->getNumberOfOutputSockets() > 0) {
+      hash.add(operation->getOutputSocket()->getDataType());
+    }
+
+    bool valid = true;
+    for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+      NodeOperation *input = &operation->getInputSocket(index)->getLink()->getOperation();
+      std::map<NodeOperation *, uint64_t>::iterator input_hash = hashes.find(input);
+      if (input_hash == hashes.end()) {
+        valid = false;
+        break;
+      }
+      hash.add(input_hash->second);
+    }
+    if (valid) {
+      hashes[operation] = hash.get();
+    }
+  }
+}
+
+/* Results of input operations are cheap to recalculate (they copy existing buffers) and output
+ * operations don't have results, so only the operations in between are kept in the cache. */
+static bool full_frame_use_cache(NodeOperation *operation)
+{
+  return operation->getNumberOfInputSockets() > 0 && operation->getNumberOfOutputSockets() > 0;
+}
+
+void ExecutionSystem::executeFullFrame()
+{
+  const bNodeTree *editingtree = this->m_context.getbNodeTree();
+
+  vector<ExecutionGroup *> outputGroups;
+  findOutputExecutionGroup(&outputGroups, COM_PRIORITY_HIGH);
+  if (!this->getContext().isFastCalculation()) {
+    findOutputExecutionGroup(&outputGroups, COM_PRIORITY_MEDIUM);
+    findOutputExecutionGroup(&outputGroups, COM_PRIORITY_LOW);
+  }
+
+  /* Only operations needed by the outputs being executed, ordered by priority of the outputs. */
+  Operations sorted;
+  Tags visited;
+  std::map<NodeOperation *, const rcti *> outputAreas;
+  for (ExecutionGroup *group : outputGroups) {
+    NodeOperation *operation = group->getOutputOperation();
+    outputAreas[operation] = group->getRenderArea();
+    full_frame_sort_operations_recursive(sorted, visited, operation);
+  }
+
+  /* Results of operations that didn't change since a previous execution are taken from the
+   * cache, the operations they depend on don't need to be calculated then. */
+  std::map<NodeOperation *, MemoryBuffer *> buffers;
+  std::map<NodeOperation *, uint64_t> hashes;
+  Tags cached;
+  const bool use_cache = !this->m_context.isRendering() && U.compositor_cache_limit > 0;
+  if (use_cache) {
+    CompositorCache::beginExecution();
+    full_frame_hash_operations(sorted, hashes);
+
+    visited.clear();
+    for (NodeOperation *operation : sorted) {
+      std::map<NodeOperation *, uint64_t>::iterator hash = hashes.find(operation);
+      if (hash == hashes.end() || !full_frame_use_cache(operation)) {
+        continue;
+      }
+      MemoryBuffer *buffer = CompositorCache::get(hash->second);
+      if (buffer) {
+        buffers[operation] = buffer;
+        cached.insert(operation);
+        visited.insert(operation);
+      }
+    }
+
+    sorted.clear();
+    for (ExecutionGroup *group : outputGroups) {
+      full_frame_sort_operations_recursive(sorted, visited, group->getOutputOperation());
+    }
+  }
+
+  /* Count the readers of every buffer, so it can be freed as soon as it has been read. */
+  std::map<NodeOperation *, int> readers;
+  for (NodeOperation *operation : sorted) {
+    for (unsigned int index = 0; index < operation->getNumberOfInputSockets(); index++) {
+      readers[&operation->getInputSocket(index)->getLink()->getOperation()]++;
+    }
+  }
+
+  vector<MemoryBuffer *> inputs;
+  for (unsigned int index = 0; index < sorted.size(); index++) {
+    NodeOperation *operation = sorted[index];
+    if (editingtree->test_break && editingtree->test_break(editingtree->tbh)) {
+      break;
+    }
+
+    inputs.clear();
+    for (unsigned int i = 0; i < operation->getNumberOfInputSockets(); i++) {
+      inputs.push_back(buffers[&operation->getInputSocket(i)->getLink()->getOperation()]);
+    }
+
+    MemoryBuffer *output = NULL;
+    rcti area;
+    if (operation->getNumberOfOutputSockets() == 0) {
+      area = *outputAreas[operation];
+    }
+    else {
+      /* Operations without resolution (like a constant color read by a preview) still get a
+       * single pixel, for reading operations without COM_SC_NO_RESIZE inputs. */
+      BLI_rcti_init(
+          &area, 0, max_ii(operation->getWidth(), 1), 0, max_ii(operation->getHeight(), 1));
+      output = new MemoryBuffer(operation->getOutputSocket()->getDataType(), &area);
+      buffers[operation] = output;
+    }
+
+    full_frame_update_area(operation, output, &area, inputs);
+
+    if (use_cache && full_frame_use_cache(operation)) {
+      std::map<NodeOperation *, uint64_t>::iterator hash = hashes.find(operation);
+      if (hash != hashes.end() && CompositorCache::put(hash->second, output)) {
+        cached.insert(operation);
+      }
+    }
+
+    /* Free input buffers that are not read anymore, buffers of the cache are kept. */
+    for (unsigned int i = 0; i < operation->getNumberOfInputSockets(); i++) {
+      NodeOperation *inputOperation = &operation->getInputSocket(i)->getLink()->getOperation();
+      if (--readers[inputOperation] == 0) {
+        if (cached.find(inputOperation) == cached.end()) {
+          delete buffers[inputOperation];
+        }
+        buffers.erase(inputOperation);
+      }
+    }
+
+    editingtree->progress(editingtree->prh, (float)(index + 1) / sorted.size());
+    char buf[128];
+    BLI_snprintf(buf,
+                 sizeof(buf),
+                 TIP_("Compositing | Operation %u-%u"),
+                 index + 1,
+                 (unsigned int)sorted.size());
+    editingtree->stats_draw(editingtree->sdh, buf);
+  }
+
+  /* Buffers left when the execution was canceled. */
+  for (std::map<NodeOperation *, MemoryBuffer *>::iterator it = buffers.begin();
+       it != buffers.end();
+       ++it) {
+    if (cached.find(it->first) == cached.end()) {
+      delete it->second;
+    }
+  }
+}
+
+/** \} */
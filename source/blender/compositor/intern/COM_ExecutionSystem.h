@@ -133,6 +133,12 @@ class ExecutionSystem {
    */
   Groups m_groups;
 
+  /**
+   * \brief execute with the full-frame execution model
+   * \see ExecutionSystem.executeFullFrame
+   */
+  bool m_fullFrame;
+
  private:  // methods
   /**
    * find all execution group with output nodes
@@ -145,6 +151,12 @@ class ExecutionSystem {
    */
   void findOutputExecutionGroup(vector<ExecutionGroup *> *result) const;
 
+  /**
+   * \brief can all operations be executed by the full-frame execution model.
+   * \see NodeOperation.isFullFrame
+   */
+  bool canExecuteFullFrame() const;
+
  public:
   /**
    * \brief Create a new ExecutionSystem and initialize it with the
@@ -188,6 +200,15 @@ class ExecutionSystem {
  private:
   void executeGroups(CompositorPriority priority);
 
+  /**
+   * \brief execute with the full-frame execution model.
+   * Instead of pulling pixels of every chunk through the operations of an ExecutionGroup,
+   * operations are calculated one after the other for their whole area by
+   * NodeOperation.update_memory_buffer. Buffers of the operations are freed as soon as all
+   * operations reading them have been calculated.
+   */
+  void executeFullFrame();
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
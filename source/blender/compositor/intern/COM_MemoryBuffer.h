@@ -128,6 +128,32 @@ class MemoryBuffer {
     return this->m_num_channels;
   }
 
+  /**
+   * \brief whether the buffer holds a single element that is used for its whole area,
+   * e.g. the output of a constant or resolution-less operation.
+   */
+  bool is_a_single_elem() const
+  {
+    return this->m_width == 1 && this->m_height == 1;
+  }
+
+  /**
+   * \brief number of floats to advance to the next element of a row,
+   * 0 for single element buffers so they can be iterated as if they were full size.
+   */
+  int get_elem_stride() const
+  {
+    return is_a_single_elem() ? 0 : this->m_num_channels;
+  }
+
+  /**
+   * \brief number of floats to advance to the next row, 0 for single element buffers.
+   */
+  int get_row_stride() const
+  {
+    return is_a_single_elem() ? 0 : this->m_width * this->m_num_channels;
+  }
+
   /**
    * \brief get the data of this MemoryBuffer
    * \note buffer should already be available in memory
@@ -137,6 +163,24 @@ class MemoryBuffer {
     return this->m_buffer;
   }
 
+  /**
+   * \brief get the data of the pixel at x, y
+   * \note coordinates are absolute and should be inside the rect of this buffer,
+   * pixels of a row are stored next to each other, see #get_elem_stride.
+   * Single element buffers return their element for any coordinate.
+   */
+  inline float *getElem(int x, int y)
+  {
+    if (is_a_single_elem()) {
+      return this->m_buffer;
+    }
+    BLI_assert(x >= this->m_rect.xmin && x < this->m_rect.xmax);
+    BLI_assert(y >= this->m_rect.ymin && y < this->m_rect.ymax);
+    const int offset = (this->m_width * (y - this->m_rect.ymin) + (x - this->m_rect.xmin)) *
+                       this->m_num_channels;
+    return &this->m_buffer[offset];
+  }
+
   /**
    * \brief after execution the state will be set to available by calling this method
    */
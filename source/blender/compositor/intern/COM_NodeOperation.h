@@ -24,8 +24,10 @@
 
 #include "BLI_math_color.h"
 #include "BLI_math_vector.h"
+#include "BLI_span.hh"
 #include "BLI_threads.h"
 
+#include "COM_CompositorCache.h"
 #include "COM_MemoryBuffer.h"
 #include "COM_MemoryProxy.h"
 #include "COM_Node.h"
@@ -102,6 +104,12 @@ class NodeOperation : public SocketReader {
    */
   bool m_openCL;
 
+  /**
+   * \brief can this operation be executed by the full-frame execution model.
+   * \see NodeOperation.update_memory_buffer
+   */
+  bool m_fullFrame;
+
   /**
    * \brief mutex reference for very special node initializations
    * \note only use when you really know what you are doing.
@@ -183,6 +191,17 @@ class NodeOperation : public SocketReader {
     return false;
   }
 
+  /**
+   * \brief can this operation be executed by the full-frame execution model.
+   * When all operations of an ExecutionSystem support it, the system calculates every operation
+   * for its whole area at once, instead of pulling pixels through the operations for every chunk.
+   * \see ExecutionSystem.executeFullFrame
+   */
+  bool isFullFrame() const
+  {
+    return this->m_fullFrame;
+  }
+
   void setbNodeTree(const bNodeTree *tree)
   {
     this->m_btree = tree;
@@ -200,6 +219,35 @@ class NodeOperation : public SocketReader {
   {
   }
 
+  /**
+   * \brief calculate an area of this operation at once, used by the full-frame execution model.
+   * \ingroup execution
+   * \note can be called by multiple threads at the same time, for different areas.
+   * \param output: the buffer to write the result to (covering the whole operation),
+   * NULL for output operations.
+   * \param area: the area to calculate.
+   * \param inputs: the calculated buffers of the input sockets, covering the whole resolution of
+   * the operation. Inputs with COM_SC_NO_RESIZE keep the resolution of the input operation.
+   */
+  virtual void update_memory_buffer(MemoryBuffer * /*output*/,
+                                    const rcti & /*area*/,
+                                    blender::Span<MemoryBuffer *> /*inputs*/)
+  {
+  }
+
+  /**
+   * \brief add the parameters of this operation to the hash identifying its result.
+   * Type, resolution and inputs of the operation are added by the ExecutionSystem.
+   * \ingroup execution
+   * \note called after initExecution.
+   * \return false when the result can't be cached (the default).
+   * \see CompositorCache
+   */
+  virtual bool hashParams(OperationHash & /*hash*/)
+  {
+    return false;
+  }
+
   /**
    * \brief when a chunk is executed by an OpenCLDevice, this method is called
    * \ingroup execution
@@ -420,6 +468,14 @@ class NodeOperation : public SocketReader {
     this->m_openCL = openCL;
   }
 
+  /**
+   * \brief set if this NodeOperation implements update_memory_buffer
+   */
+  void setFullFrame(bool fullFrame)
+  {
+    this->m_fullFrame = fullFrame;
+  }
+
   /* allow the DebugInfo class to look at internals */
   friend class DebugInfo;
 
@@ -42,7 +42,9 @@ class WorkScheduler {
    * inside this loop new work is queried and being executed
    */
   static void *thread_execute_cpu(void *data);
+#endif
 
+#if COM_CURRENT_THREADING_MODEL != COM_TM_NOTHREAD
   /**
    * \brief main thread loop for gpudevices
    * inside this loop new work is queried and being executed
@@ -55,7 +57,7 @@ class WorkScheduler {
    * An execution group schedules a chunk in the WorkScheduler
    * when ExecutionGroup.isOpenCL is set the work will be handled by a OpenCLDevice
    * otherwise the work is scheduled for an CPUDevice
-   * \see ExecutionGroup.execute
+   * \see ExecutionGroup.scheduleNextChunks
    * \param group: the execution group
    * \param chunkNumber: the number of the chunk in the group to be executed
    */
@@ -39,6 +39,11 @@ class BrightnessOperation : public NodeOperation {
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            blender::Span<MemoryBuffer *> inputs);
+  bool hashParams(OperationHash &hash);
+
   /**
    * Initialize the execution
    */
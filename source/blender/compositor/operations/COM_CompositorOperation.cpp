@@ -20,6 +20,7 @@
 #include "BKE_global.h"
 #include "BKE_image.h"
 #include "BLI_listbase.h"
+#include "BLI_math_vector.h"
 #include "MEM_guardedalloc.h"
 
 #include "BLI_threads.h"
@@ -51,6 +52,8 @@ CompositorOperation::CompositorOperation() : NodeOperation()
   this->m_scene = NULL;
   this->m_sceneName[0] = '\0';
   this->m_viewName = NULL;
+
+  this->setFullFrame(true);
 }
 
 void CompositorOperation::initExecution()
@@ -217,6 +220,41 @@ void CompositorOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
   }
 }
 
+void CompositorOperation::update_memory_buffer(MemoryBuffer * /*output*/,
+                                               const rcti &area,
+                                               blender::Span<MemoryBuffer *> inputs)
+{
+  if (!this->m_outputBuffer) {
+    return;
+  }
+
+  /* Inputs may be single elements (constants), so each one is advanced by its own stride. */
+  const int color_stride = inputs[0]->get_elem_stride();
+  const int alpha_stride = inputs[1]->get_elem_stride();
+  const int depth_stride = inputs[2]->get_elem_stride();
+  for (int y = area.ymin; y < area.ymax; y++) {
+    const int offset = y * this->getWidth() + area.xmin;
+    float *buffer = this->m_outputBuffer + offset * COM_NUM_CHANNELS_COLOR;
+    float *zbuffer = this->m_depthBuffer + offset;
+    const float *color = inputs[0]->getElem(area.xmin, y);
+    const float *alpha = inputs[1]->getElem(area.xmin, y);
+    const float *depth = inputs[2]->getElem(area.xmin, y);
+
+    for (int x = area.xmin; x < area.xmax; x++) {
+      copy_v4_v4(buffer, color);
+      if (this->m_useAlphaInput) {
+        buffer[3] = *alpha;
+      }
+      *zbuffer = *depth;
+      buffer += COM_NUM_CHANNELS_COLOR;
+      zbuffer++;
+      color += color_stride;
+      alpha += alpha_stride;
+      depth += depth_stride;
+    }
+  }
+}
+
 void CompositorOperation::determineResolution(unsigned int resolution[2],
                                               unsigned int preferredResolution[2])
 {
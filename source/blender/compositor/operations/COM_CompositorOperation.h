@@ -87,6 +87,9 @@ class CompositorOperation : public NodeOperation {
     return this->m_active;
   }
   void executeRegion(rcti *rect, unsigned int tileNumber);
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            blender::Span<MemoryBuffer *> inputs);
   void setScene(const struct Scene *scene)
   {
     m_scene = scene;
@@ -122,4 +125,12 @@ class CompositorOperation : public NodeOperation {
   {
     this->m_active = active;
   }
+  const float *getOutputBuffer() const
+  {
+    return this->m_outputBuffer;
+  }
+  const float *getDepthBuffer() const
+  {
+    return this->m_depthBuffer;
+  }
 };
@@ -35,12 +35,19 @@ void ConvertBaseOperation::deinitExecution()
   this->m_inputOperation = NULL;
 }
 
+bool ConvertBaseOperation::hashParams(OperationHash & /*hash*/)
+{
+  /* Conversions with parameters add them to the hash. */
+  return true;
+}
+
 /* ******** Value to Color ******** */
 
 ConvertValueToColorOperation::ConvertValueToColorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_VALUE);
   this->addOutputSocket(COM_DT_COLOR);
+  this->setFullFrame(true);
 }
 
 void ConvertValueToColorOperation::executePixelSampled(float output[4],
@@ -54,12 +61,28 @@ void ConvertValueToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertValueToColorOperation::update_memory_buffer(MemoryBuffer *output,
+                                                        const rcti &area,
+                                                        blender::Span<MemoryBuffer *> inputs)
+{
+  const int in_stride = inputs[0]->get_elem_stride();
+  for (int y = area.ymin; y < area.ymax; y++) {
+    const float *in = inputs[0]->getElem(area.xmin, y);
+    float *out = output->getElem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++, in += in_stride, out += 4) {
+      out[0] = out[1] = out[2] = in[0];
+      out[3] = 1.0f;
+    }
+  }
+}
+
 /* ******** Color to Value ******** */
 
 ConvertColorToValueOperation::ConvertColorToValueOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_VALUE);
+  this->setFullFrame(true);
 }
 
 void ConvertColorToValueOperation::executePixelSampled(float output[4],
@@ -72,12 +95,27 @@ void ConvertColorToValueOperation::executePixelSampled(float output[4],
   output[0] = (inputColor[0] + inputColor[1] + inputColor[2]) / 3.0f;
 }
 
+void ConvertColorToValueOperation::update_memory_buffer(MemoryBuffer *output,
+                                                        const rcti &area,
+                                                        blender::Span<MemoryBuffer *> inputs)
+{
+  const int in_stride = inputs[0]->get_elem_stride();
+  for (int y = area.ymin; y < area.ymax; y++) {
+    const float *in = inputs[0]->getElem(area.xmin, y);
+    float *out = output->getElem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++, in += in_stride, out += 1) {
+      out[0] = (in[0] + in[1] + in[2]) / 3.0f;
+    }
+  }
+}
+
 /* ******** Color to BW ******** */
 
 ConvertColorToBWOperation::ConvertColorToBWOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_VALUE);
+  this->setFullFrame(true);
 }
 
 void ConvertColorToBWOperation::executePixelSampled(float output[4],
@@ -90,12 +128,27 @@ void ConvertColorToBWOperation::executePixelSampled(float output[4],
   output[0] = IMB_colormanagement_get_luminance(inputColor);
 }
 
+void ConvertColorToBWOperation::update_memory_buffer(MemoryBuffer *output,
+                                                     const rcti &area,
+                                                     blender::Span<MemoryBuffer *> inputs)
+{
+  const int in_stride = inputs[0]->get_elem_stride();
+  for (int y = area.ymin; y < area.ymax; y++) {
+    const float *in = inputs[0]->getElem(area.xmin, y);
+    float *out = output->getElem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++, in += in_stride, out += 1) {
+      out[0] = IMB_colormanagement_get_luminance(in);
+    }
+  }
+}
+
 /* ******** Color to Vector ******** */
 
 ConvertColorToVectorOperation::ConvertColorToVectorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_COLOR);
   this->addOutputSocket(COM_DT_VECTOR);
+  this->setFullFrame(true);
 }
 
 void ConvertColorToVectorOperation::executePixelSampled(float output[4],
@@ -108,12 +161,27 @@ void ConvertColorToVectorOperation::executePixelSampled(float output[4],
   copy_v3_v3(output, color);
 }
 
+void ConvertColorToVectorOperation::update_memory_buffer(MemoryBuffer *output,
+                                                         const rcti &area,
+                                                         blender::Span<MemoryBuffer *> inputs)
+{
+  const int in_stride = inputs[0]->get_elem_stride();
+  for (int y = area.ymin; y < area.ymax; y++) {
+    const float *in = inputs[0]->getElem(area.xmin, y);
+    float *out = output->getElem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++, in += in_stride, out += 3) {
+      copy_v3_v3(out, in);
+    }
+  }
+}
+
 /* ******** Value to Vector ******** */
 
 ConvertValueToVectorOperation::ConvertValueToVectorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_VALUE);
   this->addOutputSocket(COM_DT_VECTOR);
+  this->setFullFrame(true);
 }
 
 void ConvertValueToVectorOperation::executePixelSampled(float output[4],
@@ -126,12 +194,27 @@ void ConvertValueToVectorOperation::executePixelSampled(float output[4],
   output[0] = output[1] = output[2] = value;
 }
 
+void ConvertValueToVectorOperation::update_memory_buffer(MemoryBuffer *output,
+                                                         const rcti &area,
+                                                         blender::Span<MemoryBuffer *> inputs)
+{
+  const int in_stride = inputs[0]->get_elem_stride();
+  for (int y = area.ymin; y < area.ymax; y++) {
+    const float *in = inputs[0]->getElem(area.xmin, y);
+    float *out = output->getElem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++, in += in_stride, out += 3) {
+      out[0] = out[1] = out[2] = in[0];
+    }
+  }
+}
+
 /* ******** Vector to Color ******** */
 
 ConvertVectorToColorOperation::ConvertVectorToColorOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_VECTOR);
   this->addOutputSocket(COM_DT_COLOR);
+  this->setFullFrame(true);
 }
 
 void ConvertVectorToColorOperation::executePixelSampled(float output[4],
@@ -143,12 +226,28 @@ void ConvertVectorToColorOperation::executePixelSampled(float output[4],
   output[3] = 1.0f;
 }
 
+void ConvertVectorToColorOperation::update_memory_buffer(MemoryBuffer *output,
+                                                         const rcti &area,
+                                                         blender::Span<MemoryBuffer *> inputs)
+{
+  const int in_stride = inputs[0]->get_elem_stride();
+  for (int y = area.ymin; y < area.ymax; y++) {
+    const float *in = inputs[0]->getElem(area.xmin, y);
+    float *out = output->getElem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++, in += in_stride, out += 4) {
+      copy_v3_v3(out, in);
+      out[3] = 1.0f;
+    }
+  }
+}
+
 /* ******** Vector to Value ******** */
 
 ConvertVectorToValueOperation::ConvertVectorToValueOperation() : ConvertBaseOperation()
 {
   this->addInputSocket(COM_DT_VECTOR);
   this->addOutputSocket(COM_DT_VALUE);
+  this->setFullFrame(true);
 }
 
 void ConvertVectorToValueOperation::executePixelSampled(float output[4],
@@ -161,6 +260,20 @@ void ConvertVectorToValueOperation::executePixelSampled(float output[4],
   output[0] = (input[0] + input[1] + input[2]) / 3.0f;
 }
 
+void ConvertVectorToValueOperation::update_memory_buffer(MemoryBuffer *output,
+                                                         const rcti &area,
+                                                         blender::Span<MemoryBuffer *> inputs)
+{
+  const int in_stride = inputs[0]->get_elem_stride();
+  for (int y = area.ymin; y < area.ymax; y++) {
+    const float *in = inputs[0]->getElem(area.xmin, y);
+    float *out = output->getElem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++, in += in_stride, out += 1) {
+      out[0] = (in[0] + in[1] + in[2]) / 3.0f;
+    }
+  }
+}
+
 /* ******** RGB to YCC ******** */
 
 ConvertRGBToYCCOperation::ConvertRGBToYCCOperation() : ConvertBaseOperation()
@@ -185,6 +298,12 @@ void ConvertRGBToYCCOperation::setMode(int mode)
   }
 }
 
+bool ConvertRGBToYCCOperation::hashParams(OperationHash &hash)
+{
+  hash.add(this->m_mode);
+  return true;
+}
+
 void ConvertRGBToYCCOperation::executePixelSampled(float output[4],
                                                    float x,
                                                    float y,
@@ -227,6 +346,12 @@ void ConvertYCCToRGBOperation::setMode(int mode)
   }
 }
 
+bool ConvertYCCToRGBOperation::hashParams(OperationHash &hash)
+{
+  hash.add(this->m_mode);
+  return true;
+}
+
 void ConvertYCCToRGBOperation::executePixelSampled(float output[4],
                                                    float x,
                                                    float y,
@@ -26,6 +26,7 @@ GammaOperation::GammaOperation() : NodeOperation()
   this->addOutputSocket(COM_DT_COLOR);
   this->m_inputProgram = NULL;
   this->m_inputGammaProgram = NULL;
+  this->setFullFrame(true);
 }
 void GammaOperation::initExecution()
 {
@@ -49,6 +50,32 @@ void GammaOperation::executePixelSampled(float output[4], float x, float y, Pixe
   output[3] = inputValue[3];
 }
 
+void GammaOperation::update_memory_buffer(MemoryBuffer *output,
+                                          const rcti &area,
+                                          blender::Span<MemoryBuffer *> inputs)
+{
+  const int color_stride = inputs[0]->get_elem_stride();
+  const int gamma_stride = inputs[1]->get_elem_stride();
+  for (int y = area.ymin; y < area.ymax; y++) {
+    const float *color = inputs[0]->getElem(area.xmin, y);
+    const float *gamma = inputs[1]->getElem(area.xmin, y);
+    float *out = output->getElem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax;
+         x++, color += color_stride, gamma += gamma_stride, out += 4) {
+      /* check for negative to avoid nan's */
+      out[0] = color[0] > 0.0f ? powf(color[0], *gamma) : color[0];
+      out[1] = color[1] > 0.0f ? powf(color[1], *gamma) : color[1];
+      out[2] = color[2] > 0.0f ? powf(color[2], *gamma) : color[2];
+      out[3] = color[3];
+    }
+  }
+}
+
+bool GammaOperation::hashParams(OperationHash & /*hash*/)
+{
+  return true;
+}
+
 void GammaOperation::deinitExecution()
 {
   this->m_inputProgram = NULL;
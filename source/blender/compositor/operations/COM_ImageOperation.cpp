@@ -45,6 +45,7 @@ BaseImageOperation::BaseImageOperation() : NodeOperation()
   this->m_numberOfChannels = 0;
   this->m_rd = NULL;
   this->m_viewName = NULL;
+  this->setFullFrame(true);
 }
 ImageOperation::ImageOperation() : BaseImageOperation()
 {
@@ -102,6 +103,29 @@ void BaseImageOperation::deinitExecution()
   BKE_image_release_ibuf(this->m_image, this->m_buffer, NULL);
 }
 
+bool BaseImageOperation::hashParams(OperationHash &hash)
+{
+  /* Image buffers can be changed in place (painting, reloading), their change stamp is renewed
+   * then, so the buffer identity is hashed instead of the pixels. */
+  if (this->m_buffer == NULL) {
+    hash.add(0);
+    return true;
+  }
+  hash.add(this->m_buffer);
+  hash.add(this->m_buffer->change_stamp);
+  hash.add(this->m_imageFloatBuffer);
+  hash.add(this->m_imageByteBuffer);
+  hash.add(this->m_depthBuffer);
+  hash.add(this->m_buffer->x);
+  hash.add(this->m_buffer->y);
+  hash.add(this->m_numberOfChannels);
+  if (this->m_imageByteBuffer) {
+    const char *colorspace = IMB_colormanagement_get_rect_colorspace(this->m_buffer);
+    hash.addData(colorspace, strlen(colorspace));
+  }
+  return true;
+}
+
 void BaseImageOperation::determineResolution(unsigned int resolution[2],
                                              unsigned int /*preferredResolution*/[2])
 {
@@ -168,6 +192,35 @@ void ImageOperation::executePixelSampled(float output[4], float x, float y, Pixe
   }
 }
 
+void ImageOperation::update_memory_buffer(MemoryBuffer *output,
+                                          const rcti &area,
+                                          blender::Span<MemoryBuffer *> /*inputs*/)
+{
+  const bool has_buffer = this->m_imageFloatBuffer || this->m_imageByteBuffer;
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *out = output->getElem(area.xmin, y);
+    if (!has_buffer || y >= this->m_buffer->y) {
+      copy_vn_fl(out, BLI_rcti_size_x(&area) * 4, 0.0f);
+      continue;
+    }
+    if (this->m_imageFloatBuffer && this->m_buffer->channels == 4 &&
+        area.xmax <= this->m_buffer->x) {
+      memcpy(out,
+             &this->m_imageFloatBuffer[(y * this->m_buffer->x + area.xmin) * 4],
+             sizeof(float[4]) * BLI_rcti_size_x(&area));
+      continue;
+    }
+    for (int x = area.xmin; x < area.xmax; x++, out += 4) {
+      if (x >= this->m_buffer->x) {
+        zero_v4(out);
+      }
+      else {
+        sampleImageAtLocation(this->m_buffer, x, y, COM_PS_NEAREST, true, out);
+      }
+    }
+  }
+}
+
 void ImageAlphaOperation::executePixelSampled(float output[4],
                                               float x,
                                               float y,
@@ -185,6 +238,27 @@ void ImageAlphaOperation::executePixelSampled(float output[4],
   }
 }
 
+void ImageAlphaOperation::update_memory_buffer(MemoryBuffer *output,
+                                               const rcti &area,
+                                               blender::Span<MemoryBuffer *> /*inputs*/)
+{
+  const bool has_buffer = this->m_imageFloatBuffer || this->m_imageByteBuffer;
+  float tempcolor[4];
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *out = output->getElem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++, out++) {
+      if (!has_buffer) {
+        *out = 0.0f;
+      }
+      else {
+        tempcolor[3] = 1.0f;
+        sampleImageAtLocation(this->m_buffer, x, y, COM_PS_NEAREST, false, tempcolor);
+        *out = tempcolor[3];
+      }
+    }
+  }
+}
+
 void ImageDepthOperation::executePixelSampled(float output[4],
                                               float x,
                                               float y,
@@ -203,3 +277,20 @@ void ImageDepthOperation::executePixelSampled(float output[4],
     }
   }
 }
+
+void ImageDepthOperation::update_memory_buffer(MemoryBuffer *output,
+                                               const rcti &area,
+                                               blender::Span<MemoryBuffer *> /*inputs*/)
+{
+  const int width = BLI_rcti_size_x(&area);
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *out = output->getElem(area.xmin, y);
+    if (this->m_depthBuffer == NULL || y >= (int)this->getHeight() ||
+        area.xmax > (int)this->getWidth()) {
+      copy_vn_fl(out, width, 0.0f);
+    }
+    else {
+      memcpy(out, &this->m_depthBuffer[y * this->m_width + area.xmin], sizeof(float) * width);
+    }
+  }
+}
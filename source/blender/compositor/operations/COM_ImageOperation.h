@@ -57,6 +57,7 @@ class BaseImageOperation : public NodeOperation {
  public:
   void initExecution();
   void deinitExecution();
+  bool hashParams(OperationHash &hash);
   void setImage(Image *image)
   {
     this->m_image = image;
@@ -85,6 +86,9 @@ class ImageOperation : public BaseImageOperation {
    */
   ImageOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            blender::Span<MemoryBuffer *> inputs);
 };
 class ImageAlphaOperation : public BaseImageOperation {
  public:
@@ -93,6 +97,9 @@ class ImageAlphaOperation : public BaseImageOperation {
    */
   ImageAlphaOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            blender::Span<MemoryBuffer *> inputs);
 };
 class ImageDepthOperation : public BaseImageOperation {
  public:
@@ -101,4 +108,7 @@ class ImageDepthOperation : public BaseImageOperation {
    */
   ImageDepthOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            blender::Span<MemoryBuffer *> inputs);
 };
@@ -71,6 +71,35 @@ void MathBaseOperation::clampIfNeeded(float *color)
   }
 }
 
+void MathBaseOperation::update_memory_buffer(MemoryBuffer *output,
+                                             const rcti &area,
+                                             blender::Span<MemoryBuffer *> inputs)
+{
+  const int width = BLI_rcti_size_x(&area);
+  const int in_strides[3] = {
+      inputs[0]->get_elem_stride(), inputs[1]->get_elem_stride(), inputs[2]->get_elem_stride()};
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *out = output->getElem(area.xmin, y);
+    this->update_memory_buffer_row(out,
+                                   inputs[0]->getElem(area.xmin, y),
+                                   inputs[1]->getElem(area.xmin, y),
+                                   inputs[2]->getElem(area.xmin, y),
+                                   in_strides,
+                                   width);
+    if (this->m_useClamp) {
+      for (int i = 0; i < width; i++) {
+        CLAMP(out[i], 0.0f, 1.0f);
+      }
+    }
+  }
+}
+
+bool MathBaseOperation::hashParams(OperationHash &hash)
+{
+  hash.add(this->m_useClamp);
+  return true;
+}
+
 void MathAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
 {
   float inputValue1[4];
@@ -84,6 +113,18 @@ void MathAddOperation::executePixelSampled(float output[4], float x, float y, Pi
   clampIfNeeded(output);
 }
 
+void MathAddOperation::update_memory_buffer_row(float *out,
+                                                const float *value1,
+                                                const float *value2,
+                                                const float * /*value3*/,
+                                                const int in_strides[3],
+                                                int width)
+{
+  for (int i = 0; i < width; i++) {
+    out[i] = value1[i * in_strides[0]] + value2[i * in_strides[1]];
+  }
+}
+
 void MathSubtractOperation::executePixelSampled(float output[4],
                                                 float x,
                                                 float y,
@@ -100,6 +141,18 @@ void MathSubtractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathSubtractOperation::update_memory_buffer_row(float *out,
+                                                     const float *value1,
+                                                     const float *value2,
+                                                     const float * /*value3*/,
+                                                     const int in_strides[3],
+                                                     int width)
+{
+  for (int i = 0; i < width; i++) {
+    out[i] = value1[i * in_strides[0]] - value2[i * in_strides[1]];
+  }
+}
+
 void MathMultiplyOperation::executePixelSampled(float output[4],
                                                 float x,
                                                 float y,
@@ -116,6 +169,18 @@ void MathMultiplyOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMultiplyOperation::update_memory_buffer_row(float *out,
+                                                     const float *value1,
+                                                     const float *value2,
+                                                     const float * /*value3*/,
+                                                     const int in_strides[3],
+                                                     int width)
+{
+  for (int i = 0; i < width; i++) {
+    out[i] = value1[i * in_strides[0]] * value2[i * in_strides[1]];
+  }
+}
+
 void MathDivideOperation::executePixelSampled(float output[4],
                                               float x,
                                               float y,
@@ -137,6 +202,20 @@ void MathDivideOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathDivideOperation::update_memory_buffer_row(float *out,
+                                                   const float *value1,
+                                                   const float *value2,
+                                                   const float * /*value3*/,
+                                                   const int in_strides[3],
+                                                   int width)
+{
+  for (int i = 0; i < width; i++) {
+    const float divisor = value2[i * in_strides[1]];
+    /* We don't want to divide by zero. */
+    out[i] = (divisor == 0.0f) ? 0.0f : value1[i * in_strides[0]] / divisor;
+  }
+}
+
 void MathSineOperation::executePixelSampled(float output[4],
                                             float x,
                                             float y,
@@ -356,6 +435,18 @@ void MathMinimumOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMinimumOperation::update_memory_buffer_row(float *out,
+                                                    const float *value1,
+                                                    const float *value2,
+                                                    const float * /*value3*/,
+                                                    const int in_strides[3],
+                                                    int width)
+{
+  for (int i = 0; i < width; i++) {
+    out[i] = min_ff(value1[i * in_strides[0]], value2[i * in_strides[1]]);
+  }
+}
+
 void MathMaximumOperation::executePixelSampled(float output[4],
                                                float x,
                                                float y,
@@ -372,6 +463,18 @@ void MathMaximumOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MathMaximumOperation::update_memory_buffer_row(float *out,
+                                                    const float *value1,
+                                                    const float *value2,
+                                                    const float * /*value3*/,
+                                                    const int in_strides[3],
+                                                    int width)
+{
+  for (int i = 0; i < width; i++) {
+    out[i] = max_ff(value1[i * in_strides[0]], value2[i * in_strides[1]]);
+  }
+}
+
 void MathRoundOperation::executePixelSampled(float output[4],
                                              float x,
                                              float y,
@@ -43,12 +43,31 @@ class MathBaseOperation : public NodeOperation {
 
   void clampIfNeeded(float color[4]);
 
+  /**
+   * Calculate a row of values, called by update_memory_buffer before clamping.
+   * \param in_strides: the element stride of each input (0 for single element inputs).
+   * Operations implementing it should enable the full-frame execution model.
+   */
+  virtual void update_memory_buffer_row(float * /*out*/,
+                                        const float * /*value1*/,
+                                        const float * /*value2*/,
+                                        const float * /*value3*/,
+                                        const int /*in_strides*/[3],
+                                        int /*width*/)
+  {
+  }
+
  public:
   /**
    * the inner loop of this program
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler) = 0;
 
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            blender::Span<MemoryBuffer *> inputs);
+  bool hashParams(OperationHash &hash);
+
   /**
    * Initialize the execution
    */
@@ -74,29 +93,69 @@ class MathAddOperation : public MathBaseOperation {
  public:
   MathAddOperation() : MathBaseOperation()
   {
+    this->setFullFrame(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out,
+      const float *value1,
+      const float *value2,
+      const float *value3,
+      const int in_strides[3],
+      int width);
 };
 class MathSubtractOperation : public MathBaseOperation {
  public:
   MathSubtractOperation() : MathBaseOperation()
   {
+    this->setFullFrame(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out,
+      const float *value1,
+      const float *value2,
+      const float *value3,
+      const int in_strides[3],
+      int width);
 };
 class MathMultiplyOperation : public MathBaseOperation {
  public:
   MathMultiplyOperation() : MathBaseOperation()
   {
+    this->setFullFrame(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out,
+      const float *value1,
+      const float *value2,
+      const float *value3,
+      const int in_strides[3],
+      int width);
 };
 class MathDivideOperation : public MathBaseOperation {
  public:
   MathDivideOperation() : MathBaseOperation()
   {
+    this->setFullFrame(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out,
+      const float *value1,
+      const float *value2,
+      const float *value3,
+      const int in_strides[3],
+      int width);
 };
 class MathSineOperation : public MathBaseOperation {
  public:
@@ -181,15 +240,35 @@ class MathMinimumOperation : public MathBaseOperation {
  public:
   MathMinimumOperation() : MathBaseOperation()
   {
+    this->setFullFrame(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out,
+      const float *value1,
+      const float *value2,
+      const float *value3,
+      const int in_strides[3],
+      int width);
 };
 class MathMaximumOperation : public MathBaseOperation {
  public:
   MathMaximumOperation() : MathBaseOperation()
   {
+    this->setFullFrame(true);
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out,
+      const float *value1,
+      const float *value2,
+      const float *value3,
+      const int in_strides[3],
+      int width);
 };
 class MathRoundOperation : public MathBaseOperation {
  public:
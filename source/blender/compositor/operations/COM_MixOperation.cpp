@@ -63,6 +63,49 @@ void MixBaseOperation::executePixelSampled(float output[4], float x, float y, Pi
   output[3] = inputColor1[3];
 }
 
+void MixBaseOperation::update_memory_buffer(MemoryBuffer *output,
+                                            const rcti &area,
+                                            blender::Span<MemoryBuffer *> inputs)
+{
+  const int width = BLI_rcti_size_x(&area);
+  const int in_strides[3] = {
+      inputs[0]->get_elem_stride(), inputs[1]->get_elem_stride(), inputs[2]->get_elem_stride()};
+  for (int y = area.ymin; y < area.ymax; y++) {
+    this->update_memory_buffer_row(output->getElem(area.xmin, y),
+                                   inputs[0]->getElem(area.xmin, y),
+                                   inputs[1]->getElem(area.xmin, y),
+                                   inputs[2]->getElem(area.xmin, y),
+                                   in_strides,
+                                   width);
+  }
+}
+
+bool MixBaseOperation::hashParams(OperationHash &hash)
+{
+  hash.add(this->m_valueAlphaMultiply);
+  hash.add(this->m_useClamp);
+  return true;
+}
+
+void MixBaseOperation::update_memory_buffer_row(
+    float *out,
+    const float *value,
+    const float *color1,
+    const float *color2,
+    const int in_strides[3],
+    int width)
+{
+  for (int i = 0; i < width;
+       i++, out += 4, value += in_strides[0], color1 += in_strides[1], color2 += in_strides[2]) {
+    const float fac = this->m_valueAlphaMultiply ? *value * color2[3] : *value;
+    const float facm = 1.0f - fac;
+    out[0] = facm * color1[0] + fac * color2[0];
+    out[1] = facm * color1[1] + fac * color2[1];
+    out[2] = facm * color1[2] + fac * color2[2];
+    out[3] = color1[3];
+  }
+}
+
 void MixBaseOperation::determineResolution(unsigned int resolution[2],
                                            unsigned int preferredResolution[2])
 {
@@ -99,7 +142,7 @@ void MixBaseOperation::deinitExecution()
 
 MixAddOperation::MixAddOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixAddOperation::executePixelSampled(float output[4], float x, float y, PixelSampler sampler)
@@ -124,11 +167,30 @@ void MixAddOperation::executePixelSampled(float output[4], float x, float y, Pix
   clampIfNeeded(output);
 }
 
+void MixAddOperation::update_memory_buffer_row(
+    float *out,
+    const float *value,
+    const float *color1,
+    const float *color2,
+    const int in_strides[3],
+    int width)
+{
+  for (int i = 0; i < width;
+       i++, out += 4, value += in_strides[0], color1 += in_strides[1], color2 += in_strides[2]) {
+    const float fac = this->m_valueAlphaMultiply ? *value * color2[3] : *value;
+    out[0] = color1[0] + fac * color2[0];
+    out[1] = color1[1] + fac * color2[1];
+    out[2] = color1[2] + fac * color2[2];
+    out[3] = color1[3];
+    clampIfNeeded(out);
+  }
+}
+
 /* ******** Mix Blend Operation ******** */
 
 MixBlendOperation::MixBlendOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixBlendOperation::executePixelSampled(float output[4],
@@ -158,6 +220,26 @@ void MixBlendOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixBlendOperation::update_memory_buffer_row(
+    float *out,
+    const float *value,
+    const float *color1,
+    const float *color2,
+    const int in_strides[3],
+    int width)
+{
+  for (int i = 0; i < width;
+       i++, out += 4, value += in_strides[0], color1 += in_strides[1], color2 += in_strides[2]) {
+    const float fac = this->m_valueAlphaMultiply ? *value * color2[3] : *value;
+    const float facm = 1.0f - fac;
+    out[0] = facm * color1[0] + fac * color2[0];
+    out[1] = facm * color1[1] + fac * color2[1];
+    out[2] = facm * color1[2] + fac * color2[2];
+    out[3] = color1[3];
+    clampIfNeeded(out);
+  }
+}
+
 /* ******** Mix Burn Operation ******** */
 
 MixColorBurnOperation::MixColorBurnOperation() : MixBaseOperation()
@@ -290,7 +372,7 @@ void MixColorOperation::executePixelSampled(float output[4],
 
 MixDarkenOperation::MixDarkenOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixDarkenOperation::executePixelSampled(float output[4],
@@ -319,11 +401,31 @@ void MixDarkenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixDarkenOperation::update_memory_buffer_row(
+    float *out,
+    const float *value,
+    const float *color1,
+    const float *color2,
+    const int in_strides[3],
+    int width)
+{
+  for (int i = 0; i < width;
+       i++, out += 4, value += in_strides[0], color1 += in_strides[1], color2 += in_strides[2]) {
+    const float fac = this->m_valueAlphaMultiply ? *value * color2[3] : *value;
+    const float facm = 1.0f - fac;
+    out[0] = min_ff(color1[0], color2[0]) * fac + color1[0] * facm;
+    out[1] = min_ff(color1[1], color2[1]) * fac + color1[1] * facm;
+    out[2] = min_ff(color1[2], color2[2]) * fac + color1[2] * facm;
+    out[3] = color1[3];
+    clampIfNeeded(out);
+  }
+}
+
 /* ******** Mix Difference Operation ******** */
 
 MixDifferenceOperation::MixDifferenceOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixDifferenceOperation::executePixelSampled(float output[4],
@@ -352,6 +454,26 @@ void MixDifferenceOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixDifferenceOperation::update_memory_buffer_row(
+    float *out,
+    const float *value,
+    const float *color1,
+    const float *color2,
+    const int in_strides[3],
+    int width)
+{
+  for (int i = 0; i < width;
+       i++, out += 4, value += in_strides[0], color1 += in_strides[1], color2 += in_strides[2]) {
+    const float fac = this->m_valueAlphaMultiply ? *value * color2[3] : *value;
+    const float facm = 1.0f - fac;
+    out[0] = facm * color1[0] + fac * fabsf(color1[0] - color2[0]);
+    out[1] = facm * color1[1] + fac * fabsf(color1[1] - color2[1]);
+    out[2] = facm * color1[2] + fac * fabsf(color1[2] - color2[2]);
+    out[3] = color1[3];
+    clampIfNeeded(out);
+  }
+}
+
 /* ******** Mix Difference Operation ******** */
 
 MixDivideOperation::MixDivideOperation() : MixBaseOperation()
@@ -577,7 +699,7 @@ void MixHueOperation::executePixelSampled(float output[4], float x, float y, Pix
 
 MixLightenOperation::MixLightenOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixLightenOperation::executePixelSampled(float output[4],
@@ -624,6 +746,25 @@ void MixLightenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixLightenOperation::update_memory_buffer_row(
+    float *out,
+    const float *value,
+    const float *color1,
+    const float *color2,
+    const int in_strides[3],
+    int width)
+{
+  for (int i = 0; i < width;
+       i++, out += 4, value += in_strides[0], color1 += in_strides[1], color2 += in_strides[2]) {
+    const float fac = this->m_valueAlphaMultiply ? *value * color2[3] : *value;
+    out[0] = max_ff(fac * color2[0], color1[0]);
+    out[1] = max_ff(fac * color2[1], color1[1]);
+    out[2] = max_ff(fac * color2[2], color1[2]);
+    out[3] = color1[3];
+    clampIfNeeded(out);
+  }
+}
+
 /* ******** Mix Linear Light Operation ******** */
 
 MixLinearLightOperation::MixLinearLightOperation() : MixBaseOperation()
@@ -676,7 +817,7 @@ void MixLinearLightOperation::executePixelSampled(float output[4],
 
 MixMultiplyOperation::MixMultiplyOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixMultiplyOperation::executePixelSampled(float output[4],
@@ -705,6 +846,26 @@ void MixMultiplyOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixMultiplyOperation::update_memory_buffer_row(
+    float *out,
+    const float *value,
+    const float *color1,
+    const float *color2,
+    const int in_strides[3],
+    int width)
+{
+  for (int i = 0; i < width;
+       i++, out += 4, value += in_strides[0], color1 += in_strides[1], color2 += in_strides[2]) {
+    const float fac = this->m_valueAlphaMultiply ? *value * color2[3] : *value;
+    const float facm = 1.0f - fac;
+    out[0] = color1[0] * (facm + fac * color2[0]);
+    out[1] = color1[1] * (facm + fac * color2[1]);
+    out[2] = color1[2] * (facm + fac * color2[2]);
+    out[3] = color1[3];
+    clampIfNeeded(out);
+  }
+}
+
 /* ******** Mix Ovelray Operation ******** */
 
 MixOverlayOperation::MixOverlayOperation() : MixBaseOperation()
@@ -801,7 +962,7 @@ void MixSaturationOperation::executePixelSampled(float output[4],
 
 MixScreenOperation::MixScreenOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixScreenOperation::executePixelSampled(float output[4],
@@ -831,6 +992,26 @@ void MixScreenOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixScreenOperation::update_memory_buffer_row(
+    float *out,
+    const float *value,
+    const float *color1,
+    const float *color2,
+    const int in_strides[3],
+    int width)
+{
+  for (int i = 0; i < width;
+       i++, out += 4, value += in_strides[0], color1 += in_strides[1], color2 += in_strides[2]) {
+    const float fac = this->m_valueAlphaMultiply ? *value * color2[3] : *value;
+    const float facm = 1.0f - fac;
+    out[0] = 1.0f - (facm + fac * (1.0f - color2[0])) * (1.0f - color1[0]);
+    out[1] = 1.0f - (facm + fac * (1.0f - color2[1])) * (1.0f - color1[1]);
+    out[2] = 1.0f - (facm + fac * (1.0f - color2[2])) * (1.0f - color1[2]);
+    out[3] = color1[3];
+    clampIfNeeded(out);
+  }
+}
+
 /* ******** Mix Soft Light Operation ******** */
 
 MixSoftLightOperation::MixSoftLightOperation() : MixBaseOperation()
@@ -881,7 +1062,7 @@ void MixSoftLightOperation::executePixelSampled(float output[4],
 
 MixSubtractOperation::MixSubtractOperation() : MixBaseOperation()
 {
-  /* pass */
+  this->setFullFrame(true);
 }
 
 void MixSubtractOperation::executePixelSampled(float output[4],
@@ -909,6 +1090,25 @@ void MixSubtractOperation::executePixelSampled(float output[4],
   clampIfNeeded(output);
 }
 
+void MixSubtractOperation::update_memory_buffer_row(
+    float *out,
+    const float *value,
+    const float *color1,
+    const float *color2,
+    const int in_strides[3],
+    int width)
+{
+  for (int i = 0; i < width;
+       i++, out += 4, value += in_strides[0], color1 += in_strides[1], color2 += in_strides[2]) {
+    const float fac = this->m_valueAlphaMultiply ? *value * color2[3] : *value;
+    out[0] = color1[0] - fac * color2[0];
+    out[1] = color1[1] - fac * color2[1];
+    out[2] = color1[2] - fac * color2[2];
+    out[3] = color1[3];
+    clampIfNeeded(out);
+  }
+}
+
 /* ******** Mix Value Operation ******** */
 
 MixValueOperation::MixValueOperation() : MixBaseOperation()
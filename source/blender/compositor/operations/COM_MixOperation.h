@@ -43,6 +43,19 @@ class MixBaseOperation : public NodeOperation {
     }
   }
 
+  /**
+   * Mix a row of pixels, called by update_memory_buffer.
+   * \param in_strides: the element stride of each input (0 for single element inputs).
+   * Operations implementing it should enable the full-frame execution model.
+   */
+  virtual void update_memory_buffer_row(
+      float *out,
+      const float *value,
+      const float *color1,
+      const float *color2,
+      const int in_strides[3],
+      int width);
+
  public:
   /**
    * Default constructor
@@ -54,6 +67,11 @@ class MixBaseOperation : public NodeOperation {
    */
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
 
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            blender::Span<MemoryBuffer *> inputs);
+  bool hashParams(OperationHash &hash);
+
   /**
    * Initialize the execution
    */
@@ -84,12 +102,30 @@ class MixAddOperation : public MixBaseOperation {
  public:
   MixAddOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out,
+      const float *value,
+      const float *color1,
+      const float *color2,
+      const int in_strides[3],
+      int width);
 };
 
 class MixBlendOperation : public MixBaseOperation {
  public:
   MixBlendOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out,
+      const float *value,
+      const float *color1,
+      const float *color2,
+      const int in_strides[3],
+      int width);
 };
 
 class MixColorBurnOperation : public MixBaseOperation {
@@ -108,12 +144,30 @@ class MixDarkenOperation : public MixBaseOperation {
  public:
   MixDarkenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out,
+      const float *value,
+      const float *color1,
+      const float *color2,
+      const int in_strides[3],
+      int width);
 };
 
 class MixDifferenceOperation : public MixBaseOperation {
  public:
   MixDifferenceOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out,
+      const float *value,
+      const float *color1,
+      const float *color2,
+      const int in_strides[3],
+      int width);
 };
 
 class MixDivideOperation : public MixBaseOperation {
@@ -144,6 +198,15 @@ class MixLightenOperation : public MixBaseOperation {
  public:
   MixLightenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out,
+      const float *value,
+      const float *color1,
+      const float *color2,
+      const int in_strides[3],
+      int width);
 };
 
 class MixLinearLightOperation : public MixBaseOperation {
@@ -156,6 +219,15 @@ class MixMultiplyOperation : public MixBaseOperation {
  public:
   MixMultiplyOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out,
+      const float *value,
+      const float *color1,
+      const float *color2,
+      const int in_strides[3],
+      int width);
 };
 
 class MixOverlayOperation : public MixBaseOperation {
@@ -174,6 +246,15 @@ class MixScreenOperation : public MixBaseOperation {
  public:
   MixScreenOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out,
+      const float *value,
+      const float *color1,
+      const float *color2,
+      const int in_strides[3],
+      int width);
 };
 
 class MixSoftLightOperation : public MixBaseOperation {
@@ -186,6 +267,15 @@ class MixSubtractOperation : public MixBaseOperation {
  public:
   MixSubtractOperation();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+
+ protected:
+  void update_memory_buffer_row(
+      float *out,
+      const float *value,
+      const float *color1,
+      const float *color2,
+      const int in_strides[3],
+      int width);
 };
 
 class MixValueOperation : public MixBaseOperation {
@@ -44,6 +44,7 @@ PreviewOperation::PreviewOperation(const ColorManagedViewSettings *viewSettings,
   this->m_divider = 1.0f;
   this->m_viewSettings = viewSettings;
   this->m_displaySettings = displaySettings;
+  this->setFullFrame(true);
 }
 
 void PreviewOperation::verifyPreview(bNodeInstanceHash *previews, bNodeInstanceKey key)
@@ -109,6 +110,34 @@ void PreviewOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
 
   IMB_colormanagement_processor_free(cm_processor);
 }
+
+void PreviewOperation::update_memory_buffer(MemoryBuffer * /*output*/,
+                                            const rcti &area,
+                                            blender::Span<MemoryBuffer *> inputs)
+{
+  MemoryBuffer *input = inputs[0];
+  float color[4];
+  struct ColormanageProcessor *cm_processor;
+
+  cm_processor = IMB_colormanagement_display_processor_new(this->m_viewSettings,
+                                                           this->m_displaySettings);
+
+  for (int y = area.ymin; y < area.ymax; y++) {
+    unsigned char *out = this->m_outputBuffer + (y * getWidth() + area.xmin) * 4;
+    for (int x = area.xmin; x < area.xmax; x++, out += 4) {
+      if (input->is_a_single_elem()) {
+        copy_v4_v4(color, input->getBuffer());
+      }
+      else {
+        input->read(color, floor(x / this->m_divider), floor(y / this->m_divider));
+      }
+      IMB_colormanagement_processor_apply_v4(cm_processor, color);
+      rgba_float_to_uchar(out, color);
+    }
+  }
+
+  IMB_colormanagement_processor_free(cm_processor);
+}
 bool PreviewOperation::determineDependingAreaOfInterest(rcti *input,
                                                         ReadBufferOperation *readOperation,
                                                         rcti *output)
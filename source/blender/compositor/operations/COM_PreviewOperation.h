@@ -52,6 +52,9 @@ class PreviewOperation : public NodeOperation {
   CompositorPriority getRenderPriority() const;
 
   void executeRegion(rcti *rect, unsigned int tileNumber);
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            blender::Span<MemoryBuffer *> inputs);
   void determineResolution(unsigned int resolution[2], unsigned int preferredResolution[2]);
   bool determineDependingAreaOfInterest(rcti *input,
                                         ReadBufferOperation *readOperation,
@@ -53,6 +53,11 @@ class RenderLayersProg : public NodeOperation {
    */
   float *m_inputBuffer;
 
+  /**
+   * #RenderResult.change_stamp of the result m_inputBuffer belongs to.
+   */
+  unsigned int m_renderResultChangeStamp;
+
   /**
    * Render-pass where this operation needs to get its data from.
    */
@@ -121,6 +126,10 @@ class RenderLayersProg : public NodeOperation {
   void initExecution();
   void deinitExecution();
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            blender::Span<MemoryBuffer *> inputs);
+  bool hashParams(OperationHash &hash);
 };
 
 class RenderLayersAOOperation : public RenderLayersProg {
@@ -130,6 +139,9 @@ class RenderLayersAOOperation : public RenderLayersProg {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            blender::Span<MemoryBuffer *> inputs);
 };
 
 class RenderLayersAlphaProg : public RenderLayersProg {
@@ -139,6 +151,9 @@ class RenderLayersAlphaProg : public RenderLayersProg {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            blender::Span<MemoryBuffer *> inputs);
 };
 
 class RenderLayersDepthProg : public RenderLayersProg {
@@ -148,4 +163,7 @@ class RenderLayersDepthProg : public RenderLayersProg {
   {
   }
   void executePixelSampled(float output[4], float x, float y, PixelSampler sampler);
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            blender::Span<MemoryBuffer *> inputs);
 };
@@ -21,6 +21,7 @@
 SetValueOperation::SetValueOperation() : NodeOperation()
 {
   this->addOutputSocket(COM_DT_VALUE);
+  this->setFullFrame(true);
 }
 
 void SetValueOperation::executePixelSampled(float output[4],
@@ -31,6 +32,21 @@ void SetValueOperation::executePixelSampled(float output[4],
   output[0] = this->m_value;
 }
 
+void SetValueOperation::update_memory_buffer(MemoryBuffer *output,
+                                             const rcti &area,
+                                             blender::Span<MemoryBuffer *> /*inputs*/)
+{
+  for (int y = area.ymin; y < area.ymax; y++) {
+    copy_vn_fl(output->getElem(area.xmin, y), BLI_rcti_size_x(&area), this->m_value);
+  }
+}
+
+bool SetValueOperation::hashParams(OperationHash &hash)
+{
+  hash.add(this->m_value);
+  return true;
+}
+
 void SetValueOperation::determineResolution(unsigned int resolution[2],
                                             unsigned int preferredResolution[2])
 {
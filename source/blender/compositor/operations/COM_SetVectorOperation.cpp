@@ -22,6 +22,7 @@
 SetVectorOperation::SetVectorOperation() : NodeOperation()
 {
   this->addOutputSocket(COM_DT_VECTOR);
+  this->setFullFrame(true);
 }
 
 void SetVectorOperation::executePixelSampled(float output[4],
@@ -34,6 +35,28 @@ void SetVectorOperation::executePixelSampled(float output[4],
   output[2] = this->m_z;
 }
 
+void SetVectorOperation::update_memory_buffer(MemoryBuffer *output,
+                                              const rcti &area,
+                                              blender::Span<MemoryBuffer *> /*inputs*/)
+{
+  const float vector[3] = {this->m_x, this->m_y, this->m_z};
+  for (int y = area.ymin; y < area.ymax; y++) {
+    float *out = output->getElem(area.xmin, y);
+    for (int x = area.xmin; x < area.xmax; x++, out += 3) {
+      copy_v3_v3(out, vector);
+    }
+  }
+}
+
+bool SetVectorOperation::hashParams(OperationHash &hash)
+{
+  hash.add(this->m_x);
+  hash.add(this->m_y);
+  hash.add(this->m_z);
+  hash.add(this->m_w);
+  return true;
+}
+
 void SetVectorOperation::determineResolution(unsigned int resolution[2],
                                              unsigned int preferredResolution[2])
 {
@@ -53,6 +53,8 @@ ViewerOperation::ViewerOperation() : NodeOperation()
   this->m_depthInput = NULL;
   this->m_rd = NULL;
   this->m_viewName = NULL;
+
+  this->setFullFrame(true);
 }
 
 void ViewerOperation::initExecution()
@@ -118,6 +120,45 @@ void ViewerOperation::executeRegion(rcti *rect, unsigned int /*tileNumber*/)
   updateImage(rect);
 }
 
+void ViewerOperation::update_memory_buffer(MemoryBuffer * /*output*/,
+                                           const rcti &area,
+                                           blender::Span<MemoryBuffer *> inputs)
+{
+  if (!this->m_outputBuffer) {
+    return;
+  }
+
+  /* Inputs may be single elements (constants), so each one is advanced by its own stride. */
+  const int color_stride = inputs[0]->get_elem_stride();
+  const int alpha_stride = inputs[1]->get_elem_stride();
+  const int depth_stride = inputs[2]->get_elem_stride();
+  for (int y = area.ymin; y < area.ymax; y++) {
+    const int offset = y * this->getWidth() + area.xmin;
+    float *buffer = this->m_outputBuffer + offset * 4;
+    const float *color = inputs[0]->getElem(area.xmin, y);
+    const float *alpha = inputs[1]->getElem(area.xmin, y);
+
+    for (int x = area.xmin; x < area.xmax; x++, buffer += 4) {
+      copy_v4_v4(buffer, color);
+      if (this->m_useAlphaInput) {
+        buffer[3] = *alpha;
+      }
+      color += color_stride;
+      alpha += alpha_stride;
+    }
+    if (this->m_depthBuffer) {
+      float *zbuffer = this->m_depthBuffer + offset;
+      const float *depth = inputs[2]->getElem(area.xmin, y);
+      for (int x = area.xmin; x < area.xmax; x++, zbuffer++, depth += depth_stride) {
+        *zbuffer = *depth;
+      }
+    }
+  }
+
+  rcti rect = area;
+  updateImage(&rect);
+}
+
 void ViewerOperation::initImage()
 {
   Image *ima = this->m_image;
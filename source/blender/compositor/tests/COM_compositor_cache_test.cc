@@ -0,0 +1,177 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "testing/testing.h"
+
+#include <atomic>
+
+#include "DNA_node_types.h"
+#include "DNA_scene_types.h"
+#include "DNA_userdef_types.h"
+
+#include "COM_CompositorCache.h"
+#include "COM_ExecutionGroup.h"
+#include "COM_ExecutionSystem.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_SetValueOperation.h"
+
+static const int area_width = 16;
+static const int area_height = 8;
+
+/* Doubles its input and counts how often it was calculated. */
+class CountingOperation : public NodeOperation {
+ public:
+  std::atomic<int> executions;
+
+  CountingOperation() : executions(0)
+  {
+    this->addInputSocket(COM_DT_VALUE);
+    this->addOutputSocket(COM_DT_VALUE);
+    this->setFullFrame(true);
+  }
+
+  void update_memory_buffer(MemoryBuffer *output,
+                            const rcti &area,
+                            blender::Span<MemoryBuffer *> inputs) override
+  {
+    this->executions++;
+    for (int y = area.ymin; y < area.ymax; y++) {
+      for (int x = area.xmin; x < area.xmax; x++) {
+        *output->getElem(x, y) = *inputs[0]->getElem(x, y) * 2.0f;
+      }
+    }
+  }
+
+  bool hashParams(OperationHash & /*hash*/) override
+  {
+    return true;
+  }
+};
+
+/* Output that keeps the last pixel of its input. */
+class ResultOperation : public NodeOperation {
+ public:
+  float result;
+
+  ResultOperation() : result(0.0f)
+  {
+    this->addInputSocket(COM_DT_VALUE);
+    this->setFullFrame(true);
+  }
+
+  bool isOutputOperation(bool /*rendering*/) const override
+  {
+    return true;
+  }
+
+  void update_memory_buffer(MemoryBuffer * /*output*/,
+                            const rcti &area,
+                            blender::Span<MemoryBuffer *> inputs) override
+  {
+    if (area.ymax == area_height) {
+      this->result = *inputs[0]->getElem(area_width - 1, area_height - 1);
+    }
+  }
+};
+
+static void stats_draw_nop(void * /*data*/, const char * /*str*/)
+{
+}
+
+static void progress_nop(void * /*data*/, float /*progress*/)
+{
+}
+
+class CompositorCacheTest : public testing::Test {
+ protected:
+  bNodeTree ntree;
+  RenderData rd;
+  int cache_limit_prev;
+
+  SetValueOperation *value;
+  CountingOperation *counting;
+  ResultOperation *result;
+  ExecutionSystem *system;
+
+  void SetUp() override
+  {
+    cache_limit_prev = U.compositor_cache_limit;
+    U.compositor_cache_limit = 16;
+    CompositorCache::clear();
+
+    memset(&ntree, 0, sizeof(ntree));
+    memset(&rd, 0, sizeof(rd));
+    ntree.stats_draw = stats_draw_nop;
+    ntree.progress = progress_nop;
+    system = new ExecutionSystem(&rd, nullptr, &ntree, false, false, nullptr, nullptr, "");
+
+    /* value -> counting -> result, the counting operation is the only one that is cached. */
+    value = new SetValueOperation();
+    counting = new CountingOperation();
+    result = new ResultOperation();
+    counting->getInputSocket(0)->setLink(value->getOutputSocket());
+    result->getInputSocket(0)->setLink(counting->getOutputSocket());
+    unsigned int resolution[2] = {area_width, area_height};
+    value->setResolution(resolution);
+    counting->setResolution(resolution);
+    result->setResolution(resolution);
+
+    ExecutionGroup *group = new ExecutionGroup();
+    group->addOperation(result);
+    group->setOutputExecutionGroup(true);
+    group->determineResolution(resolution);
+    system->set_operations({value, counting, result}, {group});
+  }
+
+  void TearDown() override
+  {
+    delete system;
+    CompositorCache::clear();
+    U.compositor_cache_limit = cache_limit_prev;
+  }
+};
+
+TEST_F(CompositorCacheTest, hit_skips_execution)
+{
+  value->setValue(1.5f);
+  system->execute();
+  EXPECT_GT(counting->executions, 0);
+  EXPECT_FLOAT_EQ(result->result, 3.0f);
+
+  /* Nothing changed, the result of the counting operation comes from the cache. */
+  const int executions = counting->executions;
+  result->result = 0.0f;
+  system->execute();
+  EXPECT_EQ(counting->executions, executions);
+  EXPECT_FLOAT_EQ(result->result, 3.0f);
+
+  /* A changed input changes the hash, so the operation is calculated again. */
+  value->setValue(2.0f);
+  system->execute();
+  EXPECT_GT(counting->executions, executions);
+  EXPECT_FLOAT_EQ(result->result, 4.0f);
+}
+
+TEST_F(CompositorCacheTest, disabled)
+{
+  U.compositor_cache_limit = 0;
+  value->setValue(1.5f);
+  system->execute();
+  const int executions = counting->executions;
+  EXPECT_GT(executions, 0);
+  system->execute();
+  EXPECT_EQ(counting->executions, 2 * executions);
+}
@@ -0,0 +1,240 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ */
+
+#include "testing/testing.h"
+
+#include "BLI_rect.h"
+
+#include "DNA_node_types.h"
+
+#include "COM_CompositorOperation.h"
+#include "COM_ConvertOperation.h"
+#include "COM_MathBaseOperation.h"
+#include "COM_MemoryBuffer.h"
+#include "COM_MixOperation.h"
+#include "COM_SetColorOperation.h"
+#include "COM_SetValueOperation.h"
+
+/* Area that is larger than a single element, so reading past constant inputs is detected. */
+static const int area_width = 7;
+static const int area_height = 3;
+
+static MemoryBuffer *single_elem_buffer_create(DataType datatype, const float *value)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, 1, 0, 1);
+  MemoryBuffer *buffer = new MemoryBuffer(datatype, &rect);
+  memcpy(buffer->getBuffer(), value, sizeof(float) * buffer->get_num_channels());
+  return buffer;
+}
+
+static MemoryBuffer *full_buffer_create(DataType datatype, const float *value)
+{
+  rcti rect;
+  BLI_rcti_init(&rect, 0, area_width, 0, area_height);
+  MemoryBuffer *buffer = new MemoryBuffer(datatype, &rect);
+  const int num_channels = buffer->get_num_channels();
+  for (int y = 0; y < area_height; y++) {
+    for (int x = 0; x < area_width; x++) {
+      memcpy(buffer->getElem(x, y), value, sizeof(float) * num_channels);
+    }
+  }
+  return buffer;
+}
+
+static rcti full_area()
+{
+  rcti area;
+  BLI_rcti_init(&area, 0, area_width, 0, area_height);
+  return area;
+}
+
+static void expect_buffers_equal(MemoryBuffer *a, MemoryBuffer *b)
+{
+  const int num_channels = a->get_num_channels();
+  ASSERT_EQ(num_channels, (int)b->get_num_channels());
+  for (int y = 0; y < area_height; y++) {
+    for (int x = 0; x < area_width; x++) {
+      for (int c = 0; c < num_channels; c++) {
+        EXPECT_FLOAT_EQ(a->getElem(x, y)[c], b->getElem(x, y)[c]) << x << ", " << y;
+      }
+    }
+  }
+}
+
+static int test_break_always(void * /*data*/)
+{
+  return true;
+}
+
+TEST(full_frame, single_elem_buffer)
+{
+  const float color[4] = {0.1f, 0.2f, 0.3f, 0.4f};
+  MemoryBuffer *single = single_elem_buffer_create(COM_DT_COLOR, color);
+  EXPECT_TRUE(single->is_a_single_elem());
+  EXPECT_EQ(single->get_elem_stride(), 0);
+  EXPECT_EQ(single->get_row_stride(), 0);
+  EXPECT_EQ(single->getElem(area_width - 1, area_height - 1), single->getBuffer());
+
+  MemoryBuffer *full = full_buffer_create(COM_DT_COLOR, color);
+  EXPECT_FALSE(full->is_a_single_elem());
+  EXPECT_EQ(full->get_elem_stride(), 4);
+  EXPECT_EQ(full->get_row_stride(), area_width * 4);
+
+  delete single;
+  delete full;
+}
+
+TEST(full_frame, mix_constant_inputs)
+{
+  const float fac = 0.25f;
+  const float color1[4] = {0.1f, 0.2f, 0.3f, 1.0f};
+  const float color2[4] = {0.5f, 0.6f, 0.7f, 0.5f};
+  MemoryBuffer *single_inputs[3] = {single_elem_buffer_create(COM_DT_VALUE, &fac),
+                                    single_elem_buffer_create(COM_DT_COLOR, color1),
+                                    single_elem_buffer_create(COM_DT_COLOR, color2)};
+  MemoryBuffer *full_inputs[3] = {full_buffer_create(COM_DT_VALUE, &fac),
+                                  full_buffer_create(COM_DT_COLOR, color1),
+                                  full_buffer_create(COM_DT_COLOR, color2)};
+  /* Mixed constant and full inputs. */
+  MemoryBuffer *mixed_inputs[3] = {single_inputs[0], full_inputs[1], single_inputs[2]};
+
+  const float zero[4] = {0.0f};
+  MemoryBuffer *single_output = full_buffer_create(COM_DT_COLOR, zero);
+  MemoryBuffer *mixed_output = full_buffer_create(COM_DT_COLOR, zero);
+  MemoryBuffer *full_output = full_buffer_create(COM_DT_COLOR, zero);
+
+  MixAddOperation add;
+  add.setUseValueAlphaMultiply(true);
+  const rcti area = full_area();
+  add.update_memory_buffer(single_output, area, {single_inputs, 3});
+  add.update_memory_buffer(mixed_output, area, {mixed_inputs, 3});
+  add.update_memory_buffer(full_output, area, {full_inputs, 3});
+  expect_buffers_equal(single_output, full_output);
+  expect_buffers_equal(mixed_output, full_output);
+
+  const float *result = full_output->getElem(area_width - 1, area_height - 1);
+  EXPECT_FLOAT_EQ(result[0], color1[0] + fac * color2[3] * color2[0]);
+  EXPECT_FLOAT_EQ(result[3], color1[3]);
+
+  for (int i = 0; i < 3; i++) {
+    delete single_inputs[i];
+    delete full_inputs[i];
+  }
+  delete single_output;
+  delete mixed_output;
+  delete full_output;
+}
+
+TEST(full_frame, math_constant_inputs)
+{
+  const float value1 = 3.0f;
+  const float value2 = 0.5f;
+  MemoryBuffer *single_inputs[3] = {single_elem_buffer_create(COM_DT_VALUE, &value1),
+                                    single_elem_buffer_create(COM_DT_VALUE, &value2),
+                                    single_elem_buffer_create(COM_DT_VALUE, &value2)};
+  MemoryBuffer *full_inputs[3] = {full_buffer_create(COM_DT_VALUE, &value1),
+                                  full_buffer_create(COM_DT_VALUE, &value2),
+                                  full_buffer_create(COM_DT_VALUE, &value2)};
+
+  const float zero = 0.0f;
+  MemoryBuffer *single_output = full_buffer_create(COM_DT_VALUE, &zero);
+  MemoryBuffer *full_output = full_buffer_create(COM_DT_VALUE, &zero);
+
+  MathMultiplyOperation multiply;
+  multiply.setUseClamp(true);
+  const rcti area = full_area();
+  multiply.update_memory_buffer(single_output, area, {single_inputs, 3});
+  multiply.update_memory_buffer(full_output, area, {full_inputs, 3});
+  expect_buffers_equal(single_output, full_output);
+  EXPECT_FLOAT_EQ(*full_output->getElem(area_width - 1, area_height - 1), 1.0f);
+
+  for (int i = 0; i < 3; i++) {
+    delete single_inputs[i];
+    delete full_inputs[i];
+  }
+  delete single_output;
+  delete full_output;
+}
+
+TEST(full_frame, convert_constant_input)
+{
+  const float vector[3] = {1.0f, 2.0f, 6.0f};
+  MemoryBuffer *single_input = single_elem_buffer_create(COM_DT_VECTOR, vector);
+  MemoryBuffer *full_input = full_buffer_create(COM_DT_VECTOR, vector);
+
+  const float zero[4] = {0.0f};
+  MemoryBuffer *single_output = full_buffer_create(COM_DT_COLOR, zero);
+  MemoryBuffer *full_output = full_buffer_create(COM_DT_COLOR, zero);
+
+  ConvertVectorToColorOperation convert;
+  const rcti area = full_area();
+  convert.update_memory_buffer(single_output, area, {single_input});
+  convert.update_memory_buffer(full_output, area, {full_input});
+  expect_buffers_equal(single_output, full_output);
+
+  delete single_input;
+  delete full_input;
+  delete single_output;
+  delete full_output;
+}
+
+TEST(full_frame, compositor_constant_inputs)
+{
+  SetColorOperation color_operation;
+  SetValueOperation alpha_operation;
+  SetValueOperation depth_operation;
+
+  CompositorOperation compositor;
+  compositor.getInputSocket(0)->setLink(color_operation.getOutputSocket());
+  compositor.getInputSocket(1)->setLink(alpha_operation.getOutputSocket());
+  compositor.getInputSocket(2)->setLink(depth_operation.getOutputSocket());
+  compositor.setActive(true);
+  compositor.setUseAlphaInput(true);
+  unsigned int resolution[2] = {area_width, area_height};
+  compositor.setResolution(resolution);
+  compositor.initExecution();
+  ASSERT_NE(compositor.getOutputBuffer(), nullptr);
+  ASSERT_NE(compositor.getDepthBuffer(), nullptr);
+
+  /* Constant inputs of the full-frame execution model are single element buffers. */
+  const float color[4] = {0.1f, 0.2f, 0.3f, 1.0f};
+  const float alpha = 0.5f;
+  const float depth = 2.0f;
+  MemoryBuffer *inputs[3] = {single_elem_buffer_create(COM_DT_COLOR, color),
+                             single_elem_buffer_create(COM_DT_VALUE, &alpha),
+                             single_elem_buffer_create(COM_DT_VALUE, &depth)};
+  compositor.update_memory_buffer(nullptr, full_area(), {inputs, 3});
+
+  for (int i = 0; i < area_width * area_height; i++) {
+    const float *result = &compositor.getOutputBuffer()[i * 4];
+    EXPECT_FLOAT_EQ(result[0], color[0]);
+    EXPECT_FLOAT_EQ(result[1], color[1]);
+    EXPECT_FLOAT_EQ(result[2], color[2]);
+    EXPECT_FLOAT_EQ(result[3], alpha);
+    EXPECT_FLOAT_EQ(compositor.getDepthBuffer()[i], depth);
+  }
+
+  /* A break frees the buffers without writing them to the render result. */
+  bNodeTree ntree = {{nullptr}};
+  ntree.test_break = test_break_always;
+  compositor.setbNodeTree(&ntree);
+  compositor.deinitExecution();
+
+  for (int i = 0; i < 3; i++) {
+    delete inputs[i];
+  }
+}
@@ -23,6 +23,8 @@
 
 #pragma once
 
+#include <mutex>
+
 #include "MEM_guardedalloc.h"
 
 #include "intern/depsgraph_type.h"
@@ -98,6 +100,8 @@ class DepsgraphBuilderCache {
    * the better name? */
   template<typename... Args> bool isPropertyAnimated(ID *id, Args... args)
   {
+    /* Relations of view layer objects are built from multiple threads. */
+    std::lock_guard<std::mutex> lock(mutex_);
     AnimatedPropertyStorage *animated_property_storage = ensureInitializedAnimatedPropertyStorage(
         id);
     return animated_property_storage->isPropertyAnimated(args...);
@@ -105,6 +109,8 @@ class DepsgraphBuilderCache {
 
   Map<ID *, AnimatedPropertyStorage *> animated_property_storage_map_;
 
+  std::mutex mutex_;
+
   MEM_CXX_CLASS_ALLOC_FUNCS("DepsgraphBuilderCache");
 };
 
@@ -0,0 +1,143 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/builder/deg_builder_fuse.h"
+
+#include "intern/node/deg_node.h"
+#include "intern/node/deg_node_operation.h"
+
+#include "intern/debug/deg_debug.h"
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/depsgraph_type.h"
+
+namespace blender {
+namespace deg {
+
+/* Operations which are faster than this (in seconds) do not do enough work to make up for the
+ * overhead of scheduling them in a task of their own. */
+#define FUSE_MAX_OPERATION_EVAL_TIME 5e-6
+/* Maximum summed evaluation time of the cheap operations which are fused with the same parent,
+ * so wide parts of the graph are still evaluated in parallel. */
+#define FUSE_MAX_GROUP_EVAL_TIME 20e-6
+
+static inline bool is_operation_relation(const Relation *rel)
+{
+  return rel->from->type == NodeType::OPERATION && rel->to->type == NodeType::OPERATION &&
+         (rel->flag & RELATION_FLAG_CYCLIC) == 0;
+}
+
+/* Get the operation which the given one depends on, nullptr when there are none or multiple. */
+static OperationNode *get_single_parent(const OperationNode *node)
+{
+  OperationNode *parent = nullptr;
+  for (const Relation *rel : node->inlinks) {
+    if (!is_operation_relation(rel)) {
+      continue;
+    }
+    if (parent != nullptr) {
+      return nullptr;
+    }
+    parent = (OperationNode *)rel->from;
+  }
+  return parent;
+}
+
+static int count_children(const OperationNode *node)
+{
+  int num_children = 0;
+  for (const Relation *rel : node->outlinks) {
+    if (is_operation_relation(rel)) {
+      num_children++;
+    }
+  }
+  return num_children;
+}
+
+/* Operations which were never evaluated have an unknown cost, they are not considered cheap. */
+static bool is_cheap_operation(const OperationNode *node, double *r_eval_time)
+{
+  if (node->eval_time.get_num_samples() == 0) {
+    return false;
+  }
+  *r_eval_time = node->eval_time.get_averaged();
+  return *r_eval_time <= FUSE_MAX_OPERATION_EVAL_TIME;
+}
+
+void deg_graph_fuse_operations(Depsgraph *graph)
+{
+  int num_chain_operations = 0, num_group_operations = 0;
+  bool has_unprofiled_operations = false;
+
+  for (OperationNode *node : graph->operations) {
+    node->flag &= ~DEPSOP_FLAG_FUSED;
+  }
+
+  for (OperationNode *node : graph->operations) {
+    /* No-op nodes are not evaluated in a task, their children are scheduled right away. */
+    if (node->is_noop()) {
+      continue;
+    }
+    /* The only child of an operation can not be evaluated in parallel to it anyway. */
+    const bool is_chain = count_children(node) == 1;
+    double group_eval_time = 0.0;
+    for (Relation *rel : node->outlinks) {
+      if (!is_operation_relation(rel)) {
+        continue;
+      }
+      OperationNode *child = (OperationNode *)rel->to;
+      if (child->is_noop() || get_single_parent(child) != node) {
+        continue;
+      }
+      if (is_chain) {
+        child->flag |= DEPSOP_FLAG_FUSED;
+        num_chain_operations++;
+        continue;
+      }
+      double eval_time;
+      if (!is_cheap_operation(child, &eval_time)) {
+        has_unprofiled_operations |= child->eval_time.get_num_samples() == 0;
+        continue;
+      }
+      if (group_eval_time + eval_time > FUSE_MAX_GROUP_EVAL_TIME) {
+        continue;
+      }
+      group_eval_time += eval_time;
+      child->flag |= DEPSOP_FLAG_FUSED;
+      num_group_operations++;
+    }
+  }
+
+  /* Evaluation times are kept when relations are rebuilt, but new operations are only profiled
+   * once evaluated. Fuse them as well after the first evaluation. */
+  graph->need_update_fused_operations = has_unprofiled_operations;
+
+  DEG_DEBUG_PRINTF((::Depsgraph *)graph,
+                   BUILD,
+                   "Fused %d operations of chains and %d cheap operations\n",
+                   num_chain_operations,
+                   num_group_operations);
+}
+
+}  // namespace deg
+}  // namespace blender
@@ -0,0 +1,204 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/builder/deg_builder_fuse.h"
+
+#include "testing/testing.h"
+
+#include "BLI_string.h"
+
+#include "BKE_scene.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/depsgraph_testing.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender {
+namespace deg {
+namespace tests {
+
+class FuseOperationsTest : public DepsgraphTest {
+ protected:
+  Depsgraph *graph = nullptr;
+  ComponentNode *component = nullptr;
+  int operations_num = 0;
+
+  void SetUp() override
+  {
+    DepsgraphTest::SetUp();
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    graph = reinterpret_cast<Depsgraph *>(depsgraph);
+    component = graph->add_id_node(&add_object("Object")->id)
+                    ->add_component(NodeType::PARAMETERS);
+  }
+
+  /* Add an operation which was evaluated in the given time, none when negative. */
+  OperationNode *add_operation(const double eval_time = -1.0, const bool is_noop = false)
+  {
+    DepsEvalOperationCb evaluate;
+    if (!is_noop) {
+      evaluate = [](::Depsgraph * /*depsgraph*/) {};
+    }
+    OperationNode *node = component->add_operation(
+        evaluate, OperationCode::PARAMETERS_EVAL, "Operation", operations_num++);
+    if (eval_time >= 0.0) {
+      node->eval_time.add_sample(eval_time);
+    }
+    graph->operations.append(node);
+    return node;
+  }
+
+  void add_relation(OperationNode *from, OperationNode *to, const int flags = 0)
+  {
+    graph->add_new_relation(from, to, "Test", flags);
+  }
+
+  static bool is_fused(const OperationNode *node)
+  {
+    return (node->flag & DEPSOP_FLAG_FUSED) != 0;
+  }
+};
+
+TEST_F(FuseOperationsTest, chain)
+{
+  /* The only child of an operation is fused, whatever its evaluation time. */
+  OperationNode *a = add_operation(1.0);
+  OperationNode *b = add_operation();
+  OperationNode *c = add_operation(1.0);
+  add_relation(a, b);
+  add_relation(b, c);
+  deg_graph_fuse_operations(graph);
+
+  EXPECT_FALSE(is_fused(a));
+  EXPECT_TRUE(is_fused(b));
+  EXPECT_TRUE(is_fused(c));
+  EXPECT_FALSE(graph->need_update_fused_operations);
+}
+
+TEST_F(FuseOperationsTest, not_fused)
+{
+  /* A child with several parents and a no-op child. Cyclic relations are not waited for during
+   * evaluation, so they don't count as a parent. */
+  OperationNode *a = add_operation(1.0);
+  OperationNode *b = add_operation(1.0);
+  OperationNode *shared = add_operation(1e-7);
+  OperationNode *noop = add_operation(-1.0, true);
+  OperationNode *cyclic = add_operation(1e-7);
+  add_relation(a, shared);
+  add_relation(b, shared);
+  add_relation(a, noop);
+  add_relation(b, cyclic, RELATION_FLAG_CYCLIC);
+  add_relation(a, cyclic);
+  deg_graph_fuse_operations(graph);
+
+  EXPECT_FALSE(is_fused(shared));
+  EXPECT_FALSE(is_fused(noop));
+  EXPECT_TRUE(is_fused(cyclic));
+}
+
+TEST_F(FuseOperationsTest, cheap_operations)
+{
+  /* Cheap children of an operation are fused until their summed time gets too large, expensive
+   * and never evaluated children keep tasks of their own. */
+  OperationNode *parent = add_operation(1.0);
+  OperationNode *expensive = add_operation(1e-3);
+  OperationNode *unprofiled = add_operation();
+  add_relation(parent, expensive);
+  add_relation(parent, unprofiled);
+  OperationNode *cheap[8];
+  for (int i = 0; i < 8; i++) {
+    cheap[i] = add_operation(3e-6);
+    add_relation(parent, cheap[i]);
+  }
+  deg_graph_fuse_operations(graph);
+
+  EXPECT_FALSE(is_fused(expensive));
+  EXPECT_FALSE(is_fused(unprofiled));
+  int fused_num = 0;
+  for (int i = 0; i < 8; i++) {
+    fused_num += is_fused(cheap[i]);
+  }
+  EXPECT_EQ(fused_num, 6);
+  /* Fused again once the new operation was evaluated. */
+  EXPECT_TRUE(graph->need_update_fused_operations);
+
+  /* Flags of a previous pass are cleared. */
+  unprofiled->eval_time.add_sample(1e-3);
+  expensive->eval_time.add_sample(1e-3);
+  for (int i = 0; i < 8; i++) {
+    cheap[i]->eval_time.add_sample(1e-3);
+  }
+  deg_graph_fuse_operations(graph);
+  for (int i = 0; i < 8; i++) {
+    EXPECT_FALSE(is_fused(cheap[i]));
+  }
+  EXPECT_FALSE(graph->need_update_fused_operations);
+}
+
+/* Objects parented in a chain are evaluated the same with fused operations. */
+TEST_F(DepsgraphTest, fused_operations_evaluate)
+{
+  const int objects_num = 8;
+  Object *objects[objects_num];
+  for (int i = 0; i < objects_num; i++) {
+    char name[MAX_NAME];
+    BLI_snprintf(name, sizeof(name), "Object %d", i);
+    objects[i] = add_object(name);
+    objects[i]->loc[0] = 1.0f;
+    if (i > 0) {
+      objects[i]->parent = objects[i - 1];
+    }
+  }
+  depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+  DEG_graph_build_from_view_layer(depsgraph);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+
+  /* Operations are fused once they were evaluated. */
+  const Depsgraph *graph = reinterpret_cast<Depsgraph *>(depsgraph);
+  int fused_num = 0;
+  for (const OperationNode *node : graph->operations) {
+    fused_num += (node->flag & DEPSOP_FLAG_FUSED) != 0;
+  }
+  EXPECT_GT(fused_num, 0);
+
+  for (const float x : {11.0f, 21.0f}) {
+    objects[0]->loc[0] = x;
+    DEG_id_tag_update_ex(bmain, &objects[0]->id, ID_RECALC_TRANSFORM);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+    for (int i = 0; i < objects_num; i++) {
+      const Object *object_eval = DEG_get_evaluated_object(depsgraph, objects[i]);
+      EXPECT_FLOAT_EQ(object_eval->obmat[3][0], x + i) << i;
+    }
+  }
+}
+
+}  // namespace tests
+}  // namespace deg
+}  // namespace blender
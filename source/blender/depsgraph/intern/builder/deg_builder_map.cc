@@ -54,6 +54,13 @@ bool BuilderMap::checkIsBuiltAndTag(ID *id, int tag)
   return result;
 }
 
+void BuilderMap::merge(const BuilderMap &other)
+{
+  for (const Map<ID *, int>::Item item : other.id_tags_.items()) {
+    tagBuild(item.key, item.value);
+  }
+}
+
 int BuilderMap::getIDTag(ID *id) const
 {
   return id_tags_.lookup_default(id, 0);
@@ -60,6 +60,9 @@ class BuilderMap {
    * handled otherwise and return false. */
   bool checkIsBuiltAndTag(ID *id, int tag = TAG_COMPLETE);
 
+  /* Tag everything which is tagged in the other map. */
+  void merge(const BuilderMap &other);
+
   template<typename T> bool checkIsBuilt(T *datablock, int tag = TAG_COMPLETE) const
   {
     return checkIsBuilt(&datablock->id, tag);
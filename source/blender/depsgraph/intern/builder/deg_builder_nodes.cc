@@ -112,6 +112,7 @@
 
 #include "intern/builder/deg_builder.h"
 #include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
 #include "intern/depsgraph_type.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
 #include "intern/node/deg_node.h"
@@ -154,22 +155,20 @@ IDNode *DepsgraphNodeBuilder::add_id_node(ID *id)
 {
   IDNode *id_node = nullptr;
   ID *id_cow = nullptr;
-  IDComponentsMask previously_visible_components_mask = 0;
-  uint32_t previous_eval_flags = 0;
-  DEGCustomDataMeshMasks previous_customdata_masks;
   IDInfo *id_info = id_info_hash_.lookup_default(id, nullptr);
   if (id_info != nullptr) {
     id_cow = id_info->id_cow;
-    previously_visible_components_mask = id_info->previously_visible_components_mask;
-    previous_eval_flags = id_info->previous_eval_flags;
-    previous_customdata_masks = id_info->previous_customdata_masks;
     /* Tag ID info to not free the CoW ID pointer. */
     id_info->id_cow = nullptr;
   }
   id_node = graph_->add_id_node(id, id_cow);
-  id_node->previously_visible_components_mask = previously_visible_components_mask;
-  id_node->previous_eval_flags = previous_eval_flags;
-  id_node->previous_customdata_masks = previous_customdata_masks;
+  /* NOTE: Nodes which are kept by an incremental build have their previous state stored
+   * already, new nodes are initialized with an empty one. */
+  if (id_info != nullptr) {
+    id_node->previously_visible_components_mask = id_info->previously_visible_components_mask;
+    id_node->previous_eval_flags = id_info->previous_eval_flags;
+    id_node->previous_customdata_masks = id_info->previous_customdata_masks;
+  }
   /* Currently all ID nodes are supposed to have copy-on-write logic.
    *
    * NOTE: Zero number of components indicates that ID node was just created. */
@@ -339,16 +338,11 @@ void DepsgraphNodeBuilder::begin_build()
   }
 
   for (OperationNode *op_node : graph_->entry_tags) {
-    ComponentNode *comp_node = op_node->owner;
-    IDNode *id_node = comp_node->owner;
+    save_entry_tag(op_node);
+  }
 
-    SavedEntryTag entry_tag;
-    entry_tag.id_orig = id_node->id_orig;
-    entry_tag.component_type = comp_node->type;
-    entry_tag.opcode = op_node->opcode;
-    entry_tag.name = op_node->name;
-    entry_tag.name_tag = op_node->name_tag;
-    saved_entry_tags_.append(entry_tag);
+  for (OperationNode *op_node : graph_->operations) {
+    save_eval_time(op_node);
   }
 
   /* Make sure graph has no nodes left from previous state. */
@@ -357,8 +351,117 @@ void DepsgraphNodeBuilder::begin_build()
   graph_->entry_tags.clear();
 }
 
+void DepsgraphNodeBuilder::begin_build_incremental(Span<IDNode *> id_nodes)
+{
+  Set<const IDNode *> rebuild_id_nodes;
+  for (IDNode *id_node : id_nodes) {
+    rebuild_id_nodes.add(id_node);
+  }
+
+  for (IDNode *id_node : graph_->id_nodes) {
+    /* Nodes of all IDs can be extended by the build. */
+    id_node->reopen_build();
+    /* Flags are accumulated again for the rebuilt IDs and their dependencies, compare them
+     * against the current state to see which IDs need to be re-evaluated. */
+    id_node->previously_visible_components_mask = id_node->visible_components_mask;
+    id_node->previous_eval_flags = id_node->eval_flags;
+    id_node->previous_customdata_masks = id_node->customdata_masks;
+    if (!rebuild_id_nodes.contains(id_node)) {
+      built_map_.tagBuild(id_node->id_orig);
+    }
+  }
+
+  /* Remove operations and relations of the rebuilt IDs. The ID nodes themselves are kept, so the
+   * copy-on-write datablocks and the order of the IDs in the graph stay the same. */
+  for (IDNode *id_node : id_nodes) {
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations_map->values()) {
+        if (graph_->entry_tags.remove(op_node)) {
+          save_entry_tag(op_node);
+        }
+        save_eval_time(op_node);
+        if (op_node->opcode == OperationCode::ID_PROPERTY) {
+          for (Relation *rel : op_node->outlinks) {
+            if (rel->to->type == NodeType::OPERATION &&
+                ((OperationNode *)rel->to)->owner->owner != id_node) {
+              saved_id_properties_.append({id_node->id_orig, op_node->name});
+              break;
+            }
+          }
+        }
+        while (!op_node->inlinks.is_empty()) {
+          Relation *rel = op_node->inlinks[0];
+          rel->unlink();
+          delete rel;
+        }
+        while (!op_node->outlinks.is_empty()) {
+          Relation *rel = op_node->outlinks[0];
+          rel->unlink();
+          delete rel;
+        }
+      }
+    }
+    id_node->eval_flags = 0;
+    id_node->customdata_masks = DEGCustomDataMeshMasks();
+  }
+  int64_t num_operations = 0;
+  for (OperationNode *op_node : graph_->operations) {
+    if (!rebuild_id_nodes.contains(op_node->owner->owner)) {
+      graph_->operations[num_operations++] = op_node;
+    }
+  }
+  graph_->operations.resize(num_operations);
+  for (IDNode *id_node : id_nodes) {
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      delete comp_node;
+    }
+    id_node->components.clear();
+  }
+}
+
+void DepsgraphNodeBuilder::save_entry_tag(OperationNode *op_node)
+{
+  ComponentNode *comp_node = op_node->owner;
+  IDNode *id_node = comp_node->owner;
+
+  SavedEntryTag entry_tag;
+  entry_tag.id_orig = id_node->id_orig;
+  entry_tag.component_type = comp_node->type;
+  entry_tag.opcode = op_node->opcode;
+  entry_tag.name = op_node->name;
+  entry_tag.name_tag = op_node->name_tag;
+  saved_entry_tags_.append(entry_tag);
+}
+
+void DepsgraphNodeBuilder::save_eval_time(OperationNode *op_node)
+{
+  if (op_node->eval_time.get_num_samples() == 0) {
+    return;
+  }
+  ComponentNode *comp_node = op_node->owner;
+  IDNode *id_node = comp_node->owner;
+
+  SavedEvalTime eval_time;
+  eval_time.id_orig = id_node->id_orig;
+  eval_time.component_type = comp_node->type;
+  eval_time.component_name = comp_node->name;
+  eval_time.opcode = op_node->opcode;
+  eval_time.name = op_node->name;
+  eval_time.name_tag = op_node->name_tag;
+  eval_time.eval_time = op_node->eval_time;
+  saved_eval_times_.append(eval_time);
+}
+
 void DepsgraphNodeBuilder::end_build()
 {
+  for (const SavedIDProperty &id_property : saved_id_properties_) {
+    ensure_operation_node(id_property.id_orig,
+                          NodeType::PARAMETERS,
+                          OperationCode::ID_PROPERTY,
+                          nullptr,
+                          id_property.name.c_str());
+  }
+
   for (const SavedEntryTag &entry_tag : saved_entry_tags_) {
     IDNode *id_node = find_id_node(entry_tag.id_orig);
     if (id_node == nullptr) {
@@ -377,6 +480,24 @@ void DepsgraphNodeBuilder::end_build()
      * that originally node was explicitly tagged for user update. */
     op_node->tag_update(graph_, DEG_UPDATE_SOURCE_USER_EDIT);
   }
+
+  for (const SavedEvalTime &eval_time : saved_eval_times_) {
+    IDNode *id_node = find_id_node(eval_time.id_orig);
+    if (id_node == nullptr) {
+      continue;
+    }
+    ComponentNode *comp_node = id_node->find_component(eval_time.component_type,
+                                                       eval_time.component_name.c_str());
+    if (comp_node == nullptr) {
+      continue;
+    }
+    OperationNode *op_node = comp_node->find_operation(
+        eval_time.opcode, eval_time.name.c_str(), eval_time.name_tag);
+    if (op_node == nullptr) {
+      continue;
+    }
+    op_node->eval_time = eval_time.eval_time;
+  }
 }
 
 void DepsgraphNodeBuilder::build_id(ID *id)
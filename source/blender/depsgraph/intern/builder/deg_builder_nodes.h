@@ -99,6 +99,9 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   }
 
   virtual void begin_build();
+  /* Begin incremental update of the given ID nodes: their components and relations are removed
+   * from the graph, and all the other IDs of the graph are considered built. */
+  virtual void begin_build_incremental(Span<IDNode *> id_nodes);
   virtual void end_build();
 
   IDNode *add_id_node(ID *id);
@@ -162,6 +165,9 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
   virtual void build_view_layer(Scene *scene,
                                 ViewLayer *view_layer,
                                 eDepsNode_LinkedState_Type linked_state);
+  virtual void build_view_layer_objects(Scene *scene,
+                                        ViewLayer *view_layer,
+                                        const Set<ID *> &objects);
   virtual void build_collection(LayerCollection *from_layer_collection, Collection *collection);
   virtual void build_object(int base_index,
                             Object *object,
@@ -258,6 +264,29 @@ class DepsgraphNodeBuilder : public DepsgraphBuilder {
     int name_tag;
   };
   Vector<SavedEntryTag> saved_entry_tags_;
+  void save_entry_tag(OperationNode *op_node);
+
+  /* Evaluation time of an operation, restored on the new operation node so the scheduling
+   * priorities don't need to be measured again after relations are updated. */
+  struct SavedEvalTime {
+    ID *id_orig;
+    NodeType component_type;
+    string component_name;
+    OperationCode opcode;
+    string name;
+    int name_tag;
+    AveragedTimeSampler<OperationNode::MAX_EVAL_TIME_SAMPLES> eval_time;
+  };
+  Vector<SavedEvalTime> saved_eval_times_;
+  void save_eval_time(OperationNode *op_node);
+
+  /* ID property operation which was added to an incrementally rebuilt ID by the drivers of other
+   * IDs. Those IDs are not built again, so the operation is re-created by end_build(). */
+  struct SavedIDProperty {
+    ID *id_orig;
+    string name;
+  };
+  Vector<SavedIDProperty> saved_id_properties_;
 
   struct BuilderWalkUserData {
     DepsgraphNodeBuilder *builder;
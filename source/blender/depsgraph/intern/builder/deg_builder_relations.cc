@@ -31,7 +31,9 @@
 
 #include "MEM_guardedalloc.h"
 
+#include "BLI_array.hh"
 #include "BLI_blenlib.h"
+#include "BLI_task.h"
 #include "BLI_utildefines.h"
 
 #include "DNA_action_types.h"
@@ -76,6 +78,7 @@
 #include "BKE_curve.h"
 #include "BKE_effect.h"
 #include "BKE_fcurve_driver.h"
+#include "BKE_global.h"
 #include "BKE_gpencil_modifier.h"
 #include "BKE_idprop.h"
 #include "BKE_image.h"
@@ -244,10 +247,19 @@ bool object_have_geometry_component(const Object *object)
 DepsgraphRelationBuilder::DepsgraphRelationBuilder(Main *bmain,
                                                    Depsgraph *graph,
                                                    DepsgraphBuilderCache *cache)
-    : DepsgraphBuilder(bmain, graph, cache), scene_(nullptr), rna_node_query_(graph, this)
+    : DepsgraphBuilder(bmain, graph, cache),
+      scene_(nullptr),
+      rna_node_query_(graph, this),
+      relation_buffer_(nullptr)
 {
 }
 
+void DepsgraphRelationBuilder::set_task_builder_constructor(
+    const TaskBuilderConstructor &constructor)
+{
+  task_builder_constructor_ = constructor;
+}
+
 TimeSourceNode *DepsgraphRelationBuilder::get_node(const TimeSourceKey &key) const
 {
   if (key.id) {
@@ -327,6 +339,9 @@ void DepsgraphRelationBuilder::add_customdata_mask(Object *object,
     if (id_node == nullptr) {
       BLI_assert(!"ID should always be valid");
     }
+    else if (relation_buffer_ != nullptr) {
+      relation_buffer_->customdata_masks.append(make_pair(id_node, customdata_masks));
+    }
     else {
       id_node->customdata_masks |= customdata_masks;
     }
@@ -339,18 +354,33 @@ void DepsgraphRelationBuilder::add_special_eval_flag(ID *id, uint32_t flag)
   if (id_node == nullptr) {
     BLI_assert(!"ID should always be valid");
   }
+  else if (relation_buffer_ != nullptr) {
+    relation_buffer_->eval_flags.append(make_pair(id_node, flag));
+  }
   else {
     id_node->eval_flags |= flag;
   }
 }
 
+Relation *DepsgraphRelationBuilder::add_new_relation(Node *node_from,
+                                                     Node *node_to,
+                                                     const char *description,
+                                                     int flags)
+{
+  if (relation_buffer_ != nullptr) {
+    relation_buffer_->relations.append({node_from, node_to, description, flags});
+    return nullptr;
+  }
+  return graph_->add_new_relation(node_from, node_to, description, flags);
+}
+
 Relation *DepsgraphRelationBuilder::add_time_relation(TimeSourceNode *timesrc,
                                                       Node *node_to,
                                                       const char *description,
                                                       int flags)
 {
   if (timesrc && node_to) {
-    return graph_->add_new_relation(timesrc, node_to, description, flags);
+    return add_new_relation(timesrc, node_to, description, flags);
   }
 
   DEG_DEBUG_PRINTF((::Depsgraph *)graph_,
@@ -371,7 +401,7 @@ Relation *DepsgraphRelationBuilder::add_operation_relation(OperationNode *node_f
                                                            int flags)
 {
   if (node_from && node_to) {
-    return graph_->add_new_relation(node_from, node_to, description, flags);
+    return add_new_relation(node_from, node_to, description, flags);
   }
 
   DEG_DEBUG_PRINTF((::Depsgraph *)graph_,
@@ -478,6 +508,19 @@ void DepsgraphRelationBuilder::begin_build()
 {
 }
 
+void DepsgraphRelationBuilder::begin_build_incremental(Span<IDNode *> id_nodes)
+{
+  Set<const IDNode *> rebuild_id_nodes;
+  for (IDNode *id_node : id_nodes) {
+    rebuild_id_nodes.add(id_node);
+  }
+  for (IDNode *id_node : graph_->id_nodes) {
+    if (!rebuild_id_nodes.contains(id_node)) {
+      built_map_.tagBuild(id_node->id_orig);
+    }
+  }
+}
+
 void DepsgraphRelationBuilder::build_id(ID *id)
 {
   if (id == nullptr) {
@@ -622,6 +665,119 @@ void DepsgraphRelationBuilder::build_collection(LayerCollection *from_layer_coll
   }
 }
 
+namespace {
+
+/* Identifies relations which were built by more than one parallel task. */
+struct BufferedRelationKey {
+  const Node *from;
+  const Node *to;
+  StringRefNull description;
+  int flags;
+
+  uint64_t hash() const
+  {
+    const DefaultHash<const Node *> node_hash;
+    return node_hash(from) ^ (node_hash(to) * 33) ^ (hash_string(description) * 37) ^
+           uint64_t(flags);
+  }
+
+  friend bool operator==(const BufferedRelationKey &a, const BufferedRelationKey &b)
+  {
+    return a.from == b.from && a.to == b.to && a.flags == b.flags &&
+           a.description == b.description;
+  }
+};
+
+struct BuildObjectsTaskData {
+  Span<Object *> objects;
+  Span<unique_ptr<DepsgraphRelationBuilder>> task_builders;
+};
+
+void build_objects_task(void *__restrict userdata,
+                        const int task,
+                        const TaskParallelTLS *__restrict /*tls*/)
+{
+  const BuildObjectsTaskData *data = static_cast<const BuildObjectsTaskData *>(userdata);
+  const int64_t num_tasks = data->task_builders.size();
+  const int64_t start = data->objects.size() * task / num_tasks;
+  const int64_t end = data->objects.size() * (task + 1) / num_tasks;
+  DepsgraphRelationBuilder *builder = data->task_builders[task].get();
+  for (Object *object : data->objects.slice(start, end - start)) {
+    builder->build_object(object);
+  }
+}
+
+}  // namespace
+
+/* Objects per parallel task, below this building the relations is not worth the overhead of the
+ * buffering and merging. */
+static const int64_t RELATIONS_OBJECTS_PER_TASK = 256;
+
+/* Build relations of the objects, in parallel for large amounts of objects.
+ *
+ * Every task builds a contiguous range of the objects with its own builder, which buffers the
+ * relations instead of adding them to the graph. Data-blocks which are used by objects of several
+ * ranges are built by the task of each range. Applying the buffers in order and skipping the
+ * relations which were already added by an earlier range results in the same relations, in the
+ * same order, as building the objects one after the other. The single threaded depsgraph debug
+ * option builds them one after the other. */
+void DepsgraphRelationBuilder::build_objects(Span<Object *> objects)
+{
+  const int64_t num_tasks = std::min<int64_t>(objects.size() / RELATIONS_OBJECTS_PER_TASK,
+                                              BLI_task_scheduler_num_threads());
+  if (!task_builder_constructor_ || relation_buffer_ != nullptr || num_tasks < 2 ||
+      (G.debug & G_DEBUG_DEPSGRAPH_NO_THREADS)) {
+    for (Object *object : objects) {
+      build_object(object);
+    }
+    return;
+  }
+
+  Array<unique_ptr<DepsgraphRelationBuilder>> task_builders(num_tasks);
+  Array<RelationBuffer> buffers(num_tasks);
+  for (int64_t i : task_builders.index_range()) {
+    task_builders[i] = task_builder_constructor_();
+    task_builders[i]->scene_ = scene_;
+    task_builders[i]->built_map_ = built_map_;
+    task_builders[i]->relation_buffer_ = &buffers[i];
+  }
+
+  BuildObjectsTaskData data = {objects, task_builders};
+  TaskParallelSettings settings;
+  BLI_parallel_range_settings_defaults(&settings);
+  settings.min_iter_per_thread = 1;
+  BLI_task_parallel_range(0, num_tasks, &data, build_objects_task, &settings);
+
+  apply_relation_buffers(buffers);
+  for (const unique_ptr<DepsgraphRelationBuilder> &task_builder : task_builders) {
+    built_map_.merge(task_builder->built_map_);
+  }
+}
+
+void DepsgraphRelationBuilder::apply_relation_buffers(Span<RelationBuffer> buffers)
+{
+  /* Index of the first buffer which contains the relation. */
+  Map<BufferedRelationKey, int64_t> relation_buffer_index;
+  for (const int64_t i : buffers.index_range()) {
+    const RelationBuffer &buffer = buffers[i];
+    for (const RelationBuffer::BufferedRelation &relation : buffer.relations) {
+      const BufferedRelationKey key = {
+          relation.from, relation.to, relation.description, relation.flags};
+      if (relation_buffer_index.lookup_or_add(key, i) != i) {
+        /* Built for a data-block which is shared with objects of an earlier range. */
+        continue;
+      }
+      graph_->add_new_relation(relation.from, relation.to, relation.description, relation.flags);
+    }
+    for (const pair<IDNode *, DEGCustomDataMeshMasks> &mask : buffer.customdata_masks) {
+      mask.first->customdata_masks |= mask.second;
+    }
+    for (const pair<IDNode *, uint32_t> &flag : buffer.eval_flags) {
+      flag.first->eval_flags |= flag.second;
+    }
+  }
+}
+
 void DepsgraphRelationBuilder::build_object(Object *object)
 {
   if (built_map_.checkIsBuiltAndTag(object)) {
@@ -1325,7 +1481,7 @@ void DepsgraphRelationBuilder::build_animdata_curves_targets(ID *id,
       add_relation(adt_key, pose_init_key, "Animation -> Prop", RELATION_CHECK_BEFORE_ADD);
       continue;
     }
-    graph_->add_new_relation(
+    add_operation_relation(
         operation_from, operation_to, "Animation -> Prop", RELATION_CHECK_BEFORE_ADD);
     /* It is possible that animation is writing to a nested ID data-block,
      * need to make sure animation is evaluated after target ID is copied. */
@@ -1975,8 +2131,7 @@ void DepsgraphRelationBuilder::build_object_data_geometry(Object *object)
    * data mask to be used. We add relation here to ensure object is never
    * evaluated prior to Scene's CoW is ready. */
   OperationKey scene_key(&scene_->id, NodeType::PARAMETERS, OperationCode::SCENE_EVAL);
-  Relation *rel = add_relation(scene_key, obdata_ubereval_key, "CoW Relation");
-  rel->flag |= RELATION_FLAG_NO_FLUSH;
+  add_relation(scene_key, obdata_ubereval_key, "CoW Relation", RELATION_FLAG_NO_FLUSH);
   /* Modifiers */
   if (object->modifiers.first != nullptr) {
     ModifierUpdateDepsgraphContext ctx = {};
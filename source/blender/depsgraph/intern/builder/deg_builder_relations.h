@@ -159,11 +159,36 @@ struct RNAPathKey {
   RNAPointerSource source;
 };
 
+/* Changes to the graph made by a relation builder which builds part of the relations in a
+ * parallel task. They are applied to the graph once all the tasks are done. */
+struct RelationBuffer {
+  struct BufferedRelation {
+    Node *from;
+    Node *to;
+    const char *description;
+    int flags;
+  };
+
+  Vector<BufferedRelation> relations;
+  Vector<pair<IDNode *, DEGCustomDataMeshMasks>> customdata_masks;
+  Vector<pair<IDNode *, uint32_t>> eval_flags;
+};
+
 class DepsgraphRelationBuilder : public DepsgraphBuilder {
  public:
+  /* Constructs builders for the tasks which build relations in parallel, of the same type as the
+   * builder which spawns the tasks. */
+  using TaskBuilderConstructor = function<unique_ptr<DepsgraphRelationBuilder>()>;
+
   DepsgraphRelationBuilder(Main *bmain, Depsgraph *graph, DepsgraphBuilderCache *cache);
 
+  /* Allow building relations of view layer objects in parallel. */
+  void set_task_builder_constructor(const TaskBuilderConstructor &constructor);
+
   void begin_build();
+  /* Begin incremental update of relations of the given ID nodes: the relations of all the other
+   * IDs of the graph are considered built. */
+  void begin_build_incremental(Span<IDNode *> id_nodes);
 
   template<typename KeyFrom, typename KeyTo>
   Relation *add_relation(const KeyFrom &key_from,
@@ -209,9 +234,11 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   virtual void build_view_layer(Scene *scene,
                                 ViewLayer *view_layer,
                                 eDepsNode_LinkedState_Type linked_state);
+  virtual void build_view_layer_ids(Scene *scene, Span<ID *> ids);
   virtual void build_collection(LayerCollection *from_layer_collection,
                                 Object *object,
                                 Collection *collection);
+  virtual void build_objects(Span<Object *> objects);
   virtual void build_object(Object *object);
   virtual void build_object_proxy_from(Object *object);
   virtual void build_object_proxy_group(Object *object);
@@ -328,6 +355,7 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
   OperationNode *find_node(const OperationKey &key) const;
   bool has_node(const OperationKey &key) const;
 
+  /* NOTE: Returns nullptr when the relation is buffered by a parallel task. */
   Relation *add_time_relation(TimeSourceNode *timesrc,
                               Node *node_to,
                               const char *description,
@@ -372,6 +400,16 @@ class DepsgraphRelationBuilder : public DepsgraphBuilder {
 
   BuilderMap built_map_;
   RNANodeQuery rna_node_query_;
+
+  TaskBuilderConstructor task_builder_constructor_;
+  /* Set for the builders of parallel tasks. */
+  RelationBuffer *relation_buffer_;
+
+  Relation *add_new_relation(Node *node_from,
+                             Node *node_to,
+                             const char *description,
+                             int flags);
+  void apply_relation_buffers(Span<RelationBuffer> buffers);
 };
 
 struct DepsNodeHandle {
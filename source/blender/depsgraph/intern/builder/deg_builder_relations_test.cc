@@ -0,0 +1,151 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "testing/testing.h"
+
+#include "BLI_string.h"
+#include "BLI_task.h"
+#include "BLI_threads.h"
+
+#include "BKE_constraint.h"
+#include "BKE_global.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "DNA_constraint_types.h"
+#include "DNA_mesh_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "intern/debug/deg_debug.h"
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_testing.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender {
+namespace deg {
+namespace tests {
+
+/* Enough objects to build their relations in several parallel tasks. */
+static const int objects_num = 1200;
+
+class RelationBuilderParallelTest : public DepsgraphTest {
+ protected:
+  static int threads_override_prev;
+
+  static void SetUpTestCase()
+  {
+    DepsgraphTest::SetUpTestCase();
+    /* Relations are only built in parallel when there are multiple threads. */
+    threads_override_prev = BLI_system_num_threads_override_get();
+    BLI_system_num_threads_override_set(4);
+    BLI_task_scheduler_init();
+  }
+
+  static void TearDownTestCase()
+  {
+    BLI_task_scheduler_exit();
+    BLI_system_num_threads_override_set(threads_override_prev);
+    DepsgraphTest::TearDownTestCase();
+  }
+
+  /* Objects which share their mesh, with parents and constraint targets earlier in the object
+   * list, so data-blocks are used by the objects of several parallel tasks. */
+  void scene_create()
+  {
+    Mesh *mesh = BKE_mesh_add(bmain, "Mesh");
+    Object *objects[objects_num];
+    for (int i = 0; i < objects_num; i++) {
+      char name[MAX_NAME];
+      BLI_snprintf(name, sizeof(name), "Object %d", i);
+      const bool is_mesh = (i % 4) == 0;
+      objects[i] = add_object(name, is_mesh ? OB_MESH : OB_EMPTY);
+      if (is_mesh) {
+        objects[i]->data = mesh;
+        id_us_plus(&mesh->id);
+      }
+    }
+    for (int i = 0; i < objects_num; i++) {
+      if ((i % 3) == 1) {
+        objects[i]->parent = objects[i / 2];
+      }
+      if ((i % 5) == 2) {
+        bConstraint *con = BKE_constraint_add_for_object(
+            objects[i], "Copy Location", CONSTRAINT_TYPE_LOCLIKE);
+        ((bLocateLikeConstraint *)con->data)->tar = objects[i / 3];
+      }
+    }
+  }
+
+  ::Depsgraph *depsgraph_build_new(bool use_threads)
+  {
+    const int debug_prev = G.debug;
+    if (!use_threads) {
+      G.debug |= G_DEBUG_DEPSGRAPH_NO_THREADS;
+    }
+    ::Depsgraph *graph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(graph);
+    G.debug = debug_prev;
+    return graph;
+  }
+};
+
+int RelationBuilderParallelTest::threads_override_prev = 0;
+
+static int64_t relations_num(const Depsgraph *graph)
+{
+  int64_t num = 0;
+  for (const OperationNode *op_node : graph->operations) {
+    num += op_node->inlinks.size();
+  }
+  return num;
+}
+
+TEST_F(RelationBuilderParallelTest, matches_serial)
+{
+  scene_create();
+  depsgraph = depsgraph_build_new(false);
+  ::Depsgraph *parallel_graph = depsgraph_build_new(true);
+  const Depsgraph *serial = reinterpret_cast<Depsgraph *>(depsgraph);
+  const Depsgraph *parallel = reinterpret_cast<Depsgraph *>(parallel_graph);
+
+  EXPECT_TRUE(deg_debug_compare(serial, parallel, false));
+  /* Relations shared between parallel tasks are only added once. */
+  EXPECT_EQ(relations_num(parallel), relations_num(serial));
+
+  for (const IDNode *id_node : serial->id_nodes) {
+    const IDNode *parallel_id_node = parallel->find_id_node(id_node->id_orig);
+    ASSERT_NE(parallel_id_node, nullptr) << id_node->id_orig->name;
+    EXPECT_EQ(parallel_id_node->eval_flags, id_node->eval_flags) << id_node->id_orig->name;
+    EXPECT_TRUE(parallel_id_node->customdata_masks == id_node->customdata_masks)
+        << id_node->id_orig->name;
+  }
+
+  DEG_graph_free(parallel_graph);
+}
+
+}  // namespace tests
+}  // namespace deg
+}  // namespace blender
@@ -95,11 +95,13 @@ void DepsgraphRelationBuilder::build_view_layer(Scene *scene,
   /* NOTE: Nodes builder requires us to pass CoW base because it's being
    * passed to the evaluation functions. During relations builder we only
    * do nullptr-pointer check of the base, so it's fine to pass original one. */
+  Vector<Object *> objects;
   LISTBASE_FOREACH (Base *, base, &view_layer->object_bases) {
     if (need_pull_base_into_graph(base)) {
-      build_object(base->object);
+      objects.append(base->object);
     }
   }
+  build_objects(objects);
 
   build_layer_collections(&view_layer->layer_collections);
 
@@ -154,5 +156,15 @@ void DepsgraphRelationBuilder::build_view_layer(Scene *scene,
   }
 }
 
+/* Build relations of the given IDs of the view layer, relations of the rest of the view layer
+ * are expected to be in the graph already. */
+void DepsgraphRelationBuilder::build_view_layer_ids(Scene *scene, Span<ID *> ids)
+{
+  scene_ = scene;
+  for (ID *id : ids) {
+    build_id(id);
+  }
+}
+
 }  // namespace deg
 }  // namespace blender
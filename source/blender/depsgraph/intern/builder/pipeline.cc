@@ -84,6 +84,8 @@ void AbstractBuilderPipeline::build_step_relations()
   /* Hook up relationships between operations - to determine evaluation order. */
   unique_ptr<DepsgraphRelationBuilder> relation_builder = construct_relation_builder();
   relation_builder->begin_build();
+  relation_builder->set_task_builder_constructor(
+      [this]() { return construct_relation_builder(); });
   build_relations(*relation_builder);
   relation_builder->build_copy_on_write_relations();
   relation_builder->build_driver_relations();
@@ -113,6 +115,7 @@ void AbstractBuilderPipeline::build_step_finalize()
 #endif
   /* Relations are up to date. */
   deg_graph_->need_update = false;
+  deg_graph_->need_update_relations_ids.clear();
 }
 
 unique_ptr<DepsgraphNodeBuilder> AbstractBuilderPipeline::construct_node_builder()
@@ -0,0 +1,271 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+#include "pipeline_incremental.h"
+
+#include "PIL_time.h"
+
+#include "BKE_global.h"
+#include "BKE_layer.h"
+
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+
+#include "intern/builder/deg_builder_nodes.h"
+#include "intern/builder/deg_builder_relations.h"
+#include "intern/debug/deg_debug.h"
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_relation.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+#include "intern/node/deg_node_operation.h"
+
+namespace blender {
+namespace deg {
+
+namespace {
+
+/* ID types for which DepsgraphRelationBuilder::build_id() builds all relations the ID has to
+ * other IDs. */
+bool is_related_id_type_supported(const ID_Type id_type)
+{
+  switch (id_type) {
+    case ID_OB:
+    case ID_ME:
+    case ID_CU:
+    case ID_MB:
+    case ID_LT:
+    case ID_HA:
+    case ID_PT:
+    case ID_VO:
+    case ID_GR:
+    case ID_SCE:
+    case ID_MA:
+    case ID_TE:
+    case ID_IM:
+    case ID_NT:
+    case ID_AC:
+    case ID_AR:
+    case ID_CA:
+    case ID_LA:
+    case ID_LP:
+    case ID_KE:
+    case ID_WO:
+      return true;
+    default:
+      return false;
+  }
+}
+
+/* Relations of the IDs which are built again are added a second time, keep only one of them.
+ * Relations with different flags are not duplicates, since they are flushed differently. */
+void remove_duplicate_relations(Span<IDNode *> id_nodes)
+{
+  Vector<Relation *> duplicates;
+  for (IDNode *id_node : id_nodes) {
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations_map->values()) {
+        Set<pair<Node *, int>> inlinks, outlinks;
+        for (Relation *rel : op_node->inlinks) {
+          if (!inlinks.add(make_pair(rel->from, rel->flag))) {
+            duplicates.append(rel);
+          }
+        }
+        for (Relation *rel : op_node->outlinks) {
+          if (!outlinks.add(make_pair(rel->to, rel->flag))) {
+            duplicates.append(rel);
+          }
+        }
+        for (Relation *rel : duplicates) {
+          rel->unlink();
+          delete rel;
+        }
+        duplicates.clear();
+      }
+    }
+  }
+}
+
+}  // namespace
+
+IncrementalBuilderPipeline::IncrementalBuilderPipeline(::Depsgraph *graph)
+    : ViewLayerBuilderPipeline(graph)
+{
+}
+
+void IncrementalBuilderPipeline::update()
+{
+  double start_time = 0.0;
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    start_time = PIL_check_seconds_timer();
+  }
+
+  build_step_sanity_check();
+  unique_ptr<DepsgraphNodeBuilder> node_builder = construct_node_builder();
+  if (!update_step_collect(*node_builder)) {
+    DEG_DEBUG_PRINTF(reinterpret_cast<::Depsgraph *>(deg_graph_),
+                     BUILD,
+                     "Relations can not be updated incrementally, building the whole graph\n");
+    build();
+    return;
+  }
+  update_step_nodes(*node_builder);
+  update_step_relations();
+  build_step_finalize();
+
+  if (G.debug & (G_DEBUG_DEPSGRAPH_BUILD | G_DEBUG_DEPSGRAPH_TIME)) {
+    printf("Depsgraph relations of %d IDs updated in %f seconds.\n",
+           (int)rebuild_id_nodes_.size(),
+           PIL_check_seconds_timer() - start_time);
+  }
+
+  if (G.debug & G_DEBUG_DEPSGRAPH_VERIFY) {
+    update_step_verify();
+  }
+}
+
+/* Find nodes which are to be rebuilt, returns false when it can't be done incrementally. */
+bool IncrementalBuilderPipeline::update_step_collect(DepsgraphNodeBuilder &node_builder)
+{
+  /* Physics relations are cached for the whole graph, and only invalidated by a full build. */
+  for (int i = 0; i < DEG_PHYSICS_RELATIONS_NUM; i++) {
+    if (deg_graph_->physics_relations[i] != nullptr) {
+      return false;
+    }
+  }
+
+  for (ID *id : deg_graph_->need_update_relations_ids) {
+    if (GS(id->name) != ID_OB) {
+      return false;
+    }
+    IDNode *id_node = deg_graph_->find_id_node(id);
+    if (id_node == nullptr || id_node->linked_state != DEG_ID_LINKED_DIRECTLY) {
+      return false;
+    }
+    Object *object = (Object *)id;
+    Base *base = BKE_view_layer_base_find(view_layer_, object);
+    if (base == nullptr || !node_builder.need_pull_base_into_graph(base)) {
+      return false;
+    }
+    /* Parts of the relations of these are built from the scene or from other objects. */
+    if (object->proxy != nullptr || object->proxy_from != nullptr ||
+        object->proxy_group != nullptr || object->rigidbody_object != nullptr ||
+        object->rigidbody_constraint != nullptr || object->type == OB_SPEAKER) {
+      return false;
+    }
+    rebuild_id_nodes_.add(id_node);
+  }
+
+  for (IDNode *id_node : rebuild_id_nodes_) {
+    for (ComponentNode *comp_node : id_node->components.values()) {
+      for (OperationNode *op_node : comp_node->operations) {
+        for (Relation *rel : op_node->inlinks) {
+          if (rel->from->type != NodeType::OPERATION) {
+            continue;
+          }
+          IDNode *related_id_node = ((OperationNode *)rel->from)->owner->owner;
+          if (rebuild_id_nodes_.contains(related_id_node)) {
+            continue;
+          }
+          if (!is_related_id_type_supported(related_id_node->id_type)) {
+            return false;
+          }
+          related_id_nodes_.add(related_id_node);
+        }
+        for (Relation *rel : op_node->outlinks) {
+          if (rel->to->type != NodeType::OPERATION) {
+            continue;
+          }
+          IDNode *related_id_node = ((OperationNode *)rel->to)->owner->owner;
+          if (rebuild_id_nodes_.contains(related_id_node)) {
+            continue;
+          }
+          if (!is_related_id_type_supported(related_id_node->id_type)) {
+            return false;
+          }
+          related_id_nodes_.add(related_id_node);
+        }
+      }
+    }
+  }
+  return true;
+}
+
+void IncrementalBuilderPipeline::update_step_nodes(DepsgraphNodeBuilder &node_builder)
+{
+  const int64_t num_id_nodes = deg_graph_->id_nodes.size();
+  node_builder.begin_build_incremental(rebuild_id_nodes_.as_span());
+  node_builder.build_view_layer_objects(
+      scene_, view_layer_, deg_graph_->need_update_relations_ids);
+  node_builder.end_build();
+  for (int64_t i = num_id_nodes; i < deg_graph_->id_nodes.size(); i++) {
+    new_id_nodes_.append(deg_graph_->id_nodes[i]);
+  }
+}
+
+void IncrementalBuilderPipeline::update_step_relations()
+{
+  /* Cycles are detected again for the whole graph. */
+  for (OperationNode *op_node : deg_graph_->operations) {
+    for (Relation *rel : op_node->inlinks) {
+      rel->flag &= ~RELATION_FLAG_CYCLIC;
+    }
+  }
+
+  Vector<IDNode *> id_nodes;
+  Vector<ID *> ids;
+  for (IDNode *id_node : rebuild_id_nodes_) {
+    id_nodes.append(id_node);
+    ids.append(id_node->id_orig);
+  }
+  for (IDNode *id_node : related_id_nodes_) {
+    id_nodes.append(id_node);
+    ids.append(id_node->id_orig);
+  }
+  /* New IDs are reached from the rebuilt ones. */
+  id_nodes.extend(new_id_nodes_);
+
+  unique_ptr<DepsgraphRelationBuilder> relation_builder = construct_relation_builder();
+  relation_builder->begin_build_incremental(id_nodes);
+  relation_builder->build_view_layer_ids(scene_, ids);
+  for (IDNode *id_node : id_nodes) {
+    relation_builder->build_copy_on_write_relations(id_node);
+    relation_builder->build_driver_relations(id_node);
+  }
+  remove_duplicate_relations(id_nodes);
+}
+
+/* Compare against a full build of the graph. IDs which are not used anymore are not removed by
+ * the incremental update, so extra operations are allowed. */
+void IncrementalBuilderPipeline::update_step_verify()
+{
+  ::Depsgraph *reference = DEG_graph_new(bmain_, scene_, view_layer_, deg_graph_->mode);
+  DEG_graph_build_from_view_layer(reference);
+  if (!deg_debug_compare(reinterpret_cast<Depsgraph *>(reference), deg_graph_, true)) {
+    DEG_ERROR_PRINTF("ERROR! Incremental update of relations differs from a full build!\n");
+    BLI_assert(!"This should not happen!");
+  }
+  DEG_graph_free(reference);
+}
+
+}  // namespace deg
+}  // namespace blender
@@ -0,0 +1,62 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#pragma once
+
+#include "pipeline_view_layer.h"
+
+namespace blender {
+namespace deg {
+
+struct IDNode;
+
+/* Update of the relations of the IDs tagged with DEG_id_tag_relations_update(), without building
+ * the whole graph of the view layer again.
+ *
+ * Nodes of the tagged objects are removed from the graph and built again, after which relations
+ * of the IDs which were connected to them are built again as well. Cases which can not be handled
+ * this way, like IDs which are not objects of the view layer or relations which are built from
+ * the scene (rigid bodies, physics), fall back to a full build of the graph. */
+class IncrementalBuilderPipeline : public ViewLayerBuilderPipeline {
+ public:
+  IncrementalBuilderPipeline(::Depsgraph *graph);
+
+  void update();
+
+ protected:
+  /* Nodes of the tagged objects, which are built again. */
+  VectorSet<IDNode *> rebuild_id_nodes_;
+  /* Nodes of IDs which had relations to or from the tagged objects, their relations are built
+   * again. */
+  VectorSet<IDNode *> related_id_nodes_;
+  /* Nodes of IDs which were added to the graph by the update. */
+  Vector<IDNode *> new_id_nodes_;
+
+  bool update_step_collect(DepsgraphNodeBuilder &node_builder);
+  void update_step_nodes(DepsgraphNodeBuilder &node_builder);
+  void update_step_relations();
+  void update_step_verify();
+};
+
+}  // namespace deg
+}  // namespace blender
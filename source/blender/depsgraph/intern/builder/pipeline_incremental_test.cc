@@ -0,0 +1,122 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "intern/builder/pipeline_incremental.h"
+
+#include "testing/testing.h"
+
+#include "BKE_constraint.h"
+
+#include "DNA_constraint_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_debug.h"
+#include "DEG_depsgraph_query.h"
+
+#include "intern/depsgraph.h"
+#include "intern/depsgraph_testing.h"
+#include "intern/node/deg_node_component.h"
+#include "intern/node/deg_node_id.h"
+
+namespace blender {
+namespace deg {
+namespace tests {
+
+class IncrementalBuilderPipelineTest : public DepsgraphTest {
+ protected:
+  void depsgraph_build()
+  {
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph);
+  }
+
+  ComponentNode *find_transform_component(Object *object)
+  {
+    IDNode *id_node = reinterpret_cast<Depsgraph *>(depsgraph)->find_id_node(&object->id);
+    return id_node->find_component(NodeType::TRANSFORM);
+  }
+
+  void update_relations(ID *id)
+  {
+    DEG_id_tag_relations_update(bmain, id);
+    EXPECT_FALSE(DEG_is_fully_evaluated(depsgraph));
+    DEG_graph_relations_update(depsgraph);
+    EXPECT_TRUE(DEG_debug_graph_relations_validate(depsgraph, bmain, scene, view_layer));
+  }
+};
+
+TEST_F(IncrementalBuilderPipelineTest, parent)
+{
+  Object *parent = add_object("Parent");
+  Object *child = add_object("Child");
+  Object *unrelated = add_object("Unrelated");
+  depsgraph_build();
+  ComponentNode *unrelated_transform = find_transform_component(unrelated);
+
+  child->parent = parent;
+  update_relations(&child->id);
+  /* Nodes of unrelated objects are kept as-is. */
+  EXPECT_EQ(find_transform_component(unrelated), unrelated_transform);
+
+  child->parent = nullptr;
+  update_relations(&child->id);
+  EXPECT_EQ(find_transform_component(unrelated), unrelated_transform);
+}
+
+TEST_F(IncrementalBuilderPipelineTest, constraint)
+{
+  Object *target = add_object("Target");
+  Object *owner = add_object("Owner");
+  Object *unrelated = add_object("Unrelated");
+  depsgraph_build();
+  ComponentNode *unrelated_transform = find_transform_component(unrelated);
+
+  bConstraint *con = BKE_constraint_add_for_object(
+      owner, "Copy Location", CONSTRAINT_TYPE_LOCLIKE);
+  ((bLocateLikeConstraint *)con->data)->tar = target;
+  update_relations(&owner->id);
+  EXPECT_EQ(find_transform_component(unrelated), unrelated_transform);
+
+  /* Target depending on the owner is handled by rebuilding relations of the related IDs. */
+  target->parent = unrelated;
+  update_relations(&target->id);
+}
+
+TEST_F(IncrementalBuilderPipelineTest, full_build_fallback)
+{
+  Object *object = add_object("Object");
+  depsgraph_build();
+
+  /* Only relations of objects are updated incrementally. */
+  update_relations(&scene->id);
+
+  /* Objects which are not in the graph yet are pulled in from the view layer. */
+  Object *new_object = add_object("New Object");
+  new_object->parent = object;
+  update_relations(&new_object->id);
+}
+
+}  // namespace tests
+}  // namespace deg
+}  // namespace blender
@@ -86,6 +86,15 @@ class DepsgraphDebug {
     fflush(stderr); \
   } while (0)
 
+struct Depsgraph;
+
+/* Compare operations and relations of the graph against the reference one, printing the
+ * differences. When allow_extra_operations is true operations which are not in the reference
+ * graph are ignored, together with their relations. */
+bool deg_debug_compare(const Depsgraph *reference,
+                       const Depsgraph *graph,
+                       bool allow_extra_operations);
+
 bool terminal_do_color(void);
 string color_for_pointer(const void *pointer);
 string color_end(void);
@@ -52,6 +52,9 @@ template<int MaxSamples> class AveragedTimeSampler {
 
   double get_averaged() const
   {
+    if (num_samples_ == 0) {
+      return 0.0;
+    }
     double sum = 0.0;
     for (int i = 0; i < num_samples_; ++i) {
       sum += samples_[i];
@@ -59,6 +62,11 @@ template<int MaxSamples> class AveragedTimeSampler {
     return sum / num_samples_;
   }
 
+  int get_num_samples() const
+  {
+    return num_samples_;
+  }
+
  protected:
   double samples_[MaxSamples];
 
@@ -63,6 +63,7 @@ namespace deg {
 Depsgraph::Depsgraph(Main *bmain, Scene *scene, ViewLayer *view_layer, eEvaluationMode mode)
     : time_source(nullptr),
       need_update(true),
+      need_update_fused_operations(false),
       bmain(bmain),
       scene(scene),
       view_layer(view_layer),
@@ -29,6 +29,7 @@
 
 #pragma once
 
+#include <mutex>
 #include <stdlib.h>
 
 #include "MEM_guardedalloc.h"
@@ -111,6 +112,14 @@ struct Depsgraph {
   /* Indicates whether relations needs to be updated. */
   bool need_update;
 
+  /* IDs whose relations are to be updated, while relations of the rest of the graph are up to
+   * date. Only used when need_update is false, see DEG_id_tag_relations_update(). */
+  Set<ID *> need_update_relations_ids;
+
+  /* Indicates whether fused operations are to be updated after the next evaluation, once the
+   * operations which were not evaluated before are profiled. */
+  bool need_update_fused_operations;
+
   /* Indicates which ID types were updated. */
   char id_type_updated[MAX_LIBARRAY];
 
@@ -167,6 +176,8 @@ struct Depsgraph {
   /* Cached list of colliders/effectors for collections and the scene
    * created along with relations, for fast lookup during evaluation. */
   Map<const ID *, ListBase *> *physics_relations[DEG_PHYSICS_RELATIONS_NUM];
+  /* Relations of view layer objects are built from multiple threads. */
+  std::mutex physics_relations_lock;
 
   MEM_CXX_CLASS_ALLOC_FUNCS("Depsgraph");
 };
@@ -47,6 +47,7 @@
 #include "builder/pipeline_all_objects.h"
 #include "builder/pipeline_compositor.h"
 #include "builder/pipeline_from_ids.h"
+#include "builder/pipeline_incremental.h"
 #include "builder/pipeline_render.h"
 #include "builder/pipeline_view_layer.h"
 
@@ -263,7 +264,12 @@ void DEG_graph_relations_update(Depsgraph *graph)
 {
   deg::Depsgraph *deg_graph = (deg::Depsgraph *)graph;
   if (!deg_graph->need_update) {
-    /* Graph is up to date, nothing to do. */
+    if (!deg_graph->need_update_relations_ids.is_empty()) {
+      /* Only relations of some IDs changed, rebuild them in-place. */
+      deg::IncrementalBuilderPipeline builder(graph);
+      builder.update();
+    }
+    /* Otherwise graph is up to date, nothing to do. */
     return;
   }
   DEG_graph_build_from_view_layer(graph);
@@ -277,3 +283,23 @@ void DEG_relations_tag_update(Main *bmain)
     DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
   }
 }
+
+/* Tag relations of the given ID for update. */
+void DEG_id_tag_relations_update(Main *bmain, ID *id)
+{
+  DEG_GLOBAL_DEBUG_PRINTF(TAG, "%s: Tagging relations of %s for update.\n", __func__, id->name);
+  for (deg::Depsgraph *depsgraph : deg::get_all_registered_graphs(bmain)) {
+    if (depsgraph->need_update) {
+      /* Whole graph is rebuilt anyway. */
+      continue;
+    }
+    deg::IDNode *id_node = depsgraph->find_id_node(id);
+    if (id_node == nullptr) {
+      /* New ID needs to be pulled into the graph from the view layer. */
+      DEG_graph_tag_relations_update(reinterpret_cast<Depsgraph *>(depsgraph));
+      continue;
+    }
+    depsgraph->need_update_relations_ids.add(id);
+    id_node->tag_update(depsgraph, deg::DEG_UPDATE_SOURCE_RELATIONS);
+  }
+}
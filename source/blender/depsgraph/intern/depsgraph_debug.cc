@@ -44,6 +44,81 @@
 
 namespace deg = blender::deg;
 
+namespace blender {
+namespace deg {
+
+static string debug_node_key(const Node *node)
+{
+  if (node->type != NodeType::OPERATION) {
+    return node->identifier();
+  }
+  const OperationNode *op_node = (const OperationNode *)node;
+  const ComponentNode *comp_node = op_node->owner;
+  return comp_node->owner->name + "/" + nodeTypeAsString(comp_node->type) + "/" +
+         comp_node->name + "/" + op_node->identifier() + "[" + to_string(op_node->name_tag) + "]";
+}
+
+static string debug_relation_key(const Relation *rel)
+{
+  return debug_node_key(rel->from) + " -> " + debug_node_key(rel->to);
+}
+
+bool deg_debug_compare(const Depsgraph *reference,
+                       const Depsgraph *graph,
+                       bool allow_extra_operations)
+{
+  Set<string> reference_operations, reference_relations;
+  for (OperationNode *op_node : reference->operations) {
+    reference_operations.add(debug_node_key(op_node));
+    for (Relation *rel : op_node->inlinks) {
+      reference_relations.add(debug_relation_key(rel));
+    }
+  }
+
+  bool is_equal = true;
+  Set<string> operations, relations;
+  for (OperationNode *op_node : graph->operations) {
+    const string op_key = debug_node_key(op_node);
+    operations.add(op_key);
+    const bool is_extra_operation = !reference_operations.contains(op_key);
+    if (is_extra_operation && !allow_extra_operations) {
+      DEG_ERROR_PRINTF("Unexpected operation %s\n", op_key.c_str());
+      is_equal = false;
+    }
+    for (Relation *rel : op_node->inlinks) {
+      const string rel_key = debug_relation_key(rel);
+      relations.add(rel_key);
+      if (reference_relations.contains(rel_key)) {
+        continue;
+      }
+      if (allow_extra_operations &&
+          (is_extra_operation || (rel->from->type == NodeType::OPERATION &&
+                                  !reference_operations.contains(debug_node_key(rel->from))))) {
+        continue;
+      }
+      DEG_ERROR_PRINTF("Unexpected relation %s\n", rel_key.c_str());
+      is_equal = false;
+    }
+  }
+
+  for (const string &op_key : reference_operations) {
+    if (!operations.contains(op_key)) {
+      DEG_ERROR_PRINTF("Missing operation %s\n", op_key.c_str());
+      is_equal = false;
+    }
+  }
+  for (const string &rel_key : reference_relations) {
+    if (!relations.contains(rel_key)) {
+      DEG_ERROR_PRINTF("Missing relation %s\n", rel_key.c_str());
+      is_equal = false;
+    }
+  }
+  return is_equal;
+}
+
+}  // namespace deg
+}  // namespace blender
+
 void DEG_debug_flags_set(Depsgraph *depsgraph, int flags)
 {
   deg::Depsgraph *deg_graph = reinterpret_cast<deg::Depsgraph *>(depsgraph);
@@ -77,13 +152,9 @@ bool DEG_debug_compare(const struct Depsgraph *graph1, const struct Depsgraph *g
   if (deg_graph1->operations.size() != deg_graph2->operations.size()) {
     return false;
   }
-  /* TODO(sergey): Currently we only do real stupid check,
-   * which is fast but which isn't 100% reliable.
-   *
-   * Would be cool to make it more robust, but it's good enough
-   * for now. Also, proper graph check is actually NP-complex
-   * problem. */
-  return true;
+  /* NOTE: Operations are matched by their identifiers, which is not a graph isomorphism check
+   * but is enough to compare graphs built from the same data. */
+  return deg::deg_debug_compare(deg_graph1, deg_graph2, false);
 }
 
 bool DEG_debug_graph_relations_validate(Depsgraph *graph,
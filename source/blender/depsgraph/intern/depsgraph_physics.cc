@@ -165,6 +165,7 @@ namespace deg {
 
 ListBase *build_effector_relations(Depsgraph *graph, Collection *collection)
 {
+  std::lock_guard<std::mutex> lock(graph->physics_relations_lock);
   Map<const ID *, ListBase *> *hash = graph->physics_relations[DEG_PHYSICS_EFFECTOR];
   if (hash == nullptr) {
     graph->physics_relations[DEG_PHYSICS_EFFECTOR] = new Map<const ID *, ListBase *>();
@@ -181,6 +182,7 @@ ListBase *build_collision_relations(Depsgraph *graph,
                                     unsigned int modifier_type)
 {
   const ePhysicsRelationType type = modifier_to_relation_type(modifier_type);
+  std::lock_guard<std::mutex> lock(graph->physics_relations_lock);
   Map<const ID *, ListBase *> *hash = graph->physics_relations[type];
   if (hash == nullptr) {
     graph->physics_relations[type] = new Map<const ID *, ListBase *>();
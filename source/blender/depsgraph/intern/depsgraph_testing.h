@@ -0,0 +1,79 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ *
+ * Fixture of the depsgraph tests, which build their scene in code instead of loading a blend
+ * file.
+ */
+
+#pragma once
+
+#include "testing/testing.h"
+
+#include "tests/blendfile_loading_base_test.h"
+
+#include "BKE_collection.h"
+#include "BKE_layer.h"
+#include "BKE_main.h"
+#include "BKE_object.h"
+#include "BKE_scene.h"
+
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+namespace blender {
+namespace deg {
+namespace tests {
+
+/* Creates an empty scene in a new main database for every test. The depsgraph of the base class
+ * is freed after every test, before the main database. */
+class DepsgraphTest : public BlendfileLoadingBaseTest {
+ protected:
+  Main *bmain = nullptr;
+  Scene *scene = nullptr;
+  ViewLayer *view_layer = nullptr;
+
+  void SetUp() override
+  {
+    bmain = BKE_main_new();
+    scene = BKE_scene_add(bmain, "Scene");
+    view_layer = BKE_view_layer_default_view(scene);
+  }
+
+  void TearDown() override
+  {
+    depsgraph_free();
+    BKE_main_free(bmain);
+    BlendfileLoadingBaseTest::TearDown();
+  }
+
+  /* Add an object to the master collection of the scene. */
+  Object *add_object(const char *name, const int type = OB_EMPTY)
+  {
+    Object *object = BKE_object_add_only_object(bmain, type, name);
+    BKE_collection_object_add(bmain, scene->master_collection, object);
+    return object;
+  }
+};
+
+}  // namespace tests
+}  // namespace deg
+}  // namespace blender
@@ -29,8 +29,12 @@
 
 #include "BLI_compiler_attrs.h"
 #include "BLI_gsqueue.h"
+#include "BLI_heap.h"
+#include "BLI_math_base.h"
 #include "BLI_task.h"
+#include "BLI_threads.h"
 #include "BLI_utildefines.h"
+#include "BLI_vector.hh"
 
 #include "BKE_global.h"
 
@@ -43,6 +47,7 @@
 
 #include "atomic_ops.h"
 
+#include "intern/builder/deg_builder_fuse.h"
 #include "intern/depsgraph.h"
 #include "intern/depsgraph_relation.h"
 #include "intern/eval/deg_eval_copy_on_write.h"
@@ -69,10 +74,10 @@ void schedule_children(DepsgraphEvalState *state,
                        ScheduleFunction *schedule_function,
                        ScheduleFunctionArgs... schedule_function_args);
 
-void schedule_node_to_pool(OperationNode *node, const int UNUSED(thread_id), TaskPool *pool)
-{
-  BLI_task_pool_push(pool, deg_task_run_func, node, false, NULL);
-}
+void schedule_node_to_pool(OperationNode *node,
+                           const int UNUSED(thread_id),
+                           TaskPool *pool,
+                           Vector<OperationNode *> *fused_operations);
 
 /* Denotes which part of dependency graph is being evaluated. */
 enum class EvaluationStage {
@@ -96,36 +101,73 @@ struct DepsgraphEvalState {
   bool do_stats;
   EvaluationStage stage;
   bool need_single_thread_pass;
+  /* Operations which are ready to be evaluated, ordered by their priority. Every task of the pool
+   * evaluates the operation with the highest priority at the time the task is started. */
+  Heap *ready_operations;
+  SpinLock ready_operations_lock;
 };
 
+/* Operations which were not evaluated yet still count, so the number of operations in a chain is
+ * taken into account. */
+#define MIN_OPERATION_EVAL_TIME 1e-6
+
 void evaluate_node(const DepsgraphEvalState *state, OperationNode *operation_node)
 {
   ::Depsgraph *depsgraph = reinterpret_cast<::Depsgraph *>(state->graph);
 
   /* Sanity checks. */
   BLI_assert(!operation_node->is_noop() && "NOOP nodes should not actually be scheduled");
-  /* Perform operation. */
+  /* Perform operation. Time is always measured, it is used for the scheduling priorities. */
+  const double start_time = PIL_check_seconds_timer();
+  operation_node->evaluate(depsgraph);
+  const double eval_time = PIL_check_seconds_timer() - start_time;
+  operation_node->eval_time.add_sample(eval_time);
   if (state->do_stats) {
-    const double start_time = PIL_check_seconds_timer();
-    operation_node->evaluate(depsgraph);
-    operation_node->stats.current_time += PIL_check_seconds_timer() - start_time;
+    operation_node->stats.current_time += eval_time;
   }
-  else {
-    operation_node->evaluate(depsgraph);
+}
+
+/* Fused operations are appended to the operations of the current task when given, instead of
+ * becoming a task of their own. */
+void schedule_node_to_pool(OperationNode *node,
+                           const int UNUSED(thread_id),
+                           TaskPool *pool,
+                           Vector<OperationNode *> *fused_operations)
+{
+  if (fused_operations != nullptr && (node->flag & DEPSOP_FLAG_FUSED)) {
+    fused_operations->append(node);
+    return;
   }
+  DepsgraphEvalState *state = (DepsgraphEvalState *)BLI_task_pool_user_data(pool);
+  BLI_spin_lock(&state->ready_operations_lock);
+  BLI_heap_insert(state->ready_operations, -(float)node->eval_priority, node);
+  BLI_spin_unlock(&state->ready_operations_lock);
+  BLI_task_pool_push(pool, deg_task_run_func, NULL, false, NULL);
 }
 
-void deg_task_run_func(TaskPool *pool, void *taskdata)
+void deg_task_run_func(TaskPool *pool, void *UNUSED(taskdata))
 {
   void *userdata_v = BLI_task_pool_user_data(pool);
   DepsgraphEvalState *state = (DepsgraphEvalState *)userdata_v;
 
-  /* Evaluate node. */
-  OperationNode *operation_node = reinterpret_cast<OperationNode *>(taskdata);
-  evaluate_node(state, operation_node);
+  /* Take the ready operation with the highest priority, there is one for every task. */
+  BLI_spin_lock(&state->ready_operations_lock);
+  OperationNode *operation_node = (OperationNode *)BLI_heap_pop_min(state->ready_operations);
+  BLI_spin_unlock(&state->ready_operations_lock);
+
+  /* Evaluate node, and the fused operations which become ready once it is evaluated. This avoids
+   * the overhead of a task for chains of operations and for cheap operations. */
+  Vector<OperationNode *> fused_operations;
+  fused_operations.append(operation_node);
+  while (!fused_operations.is_empty()) {
+    operation_node = fused_operations.pop_last();
+
+    /* Evaluate node. */
+    evaluate_node(state, operation_node);
 
-  /* Schedule children. */
-  schedule_children(state, operation_node, schedule_node_to_pool, pool);
+    /* Schedule children. */
+    schedule_children(state, operation_node, schedule_node_to_pool, pool, &fused_operations);
+  }
 }
 
 bool check_operation_node_visible(OperationNode *op_node)
@@ -178,10 +220,72 @@ void calculate_pending_parents(Depsgraph *graph)
   }
 }
 
+bool need_evaluate_operation(OperationNode *node)
+{
+  return check_operation_node_visible(node) && (node->flag & DEPSOP_FLAG_NEEDS_UPDATE);
+}
+
+/* Relation from an operation which needs evaluation to a child which waits for it. These are the
+ * relations counted by calculate_pending_parents_for_node(). */
+bool is_pending_relation(const Relation *rel)
+{
+  return (rel->flag & RELATION_FLAG_CYCLIC) == 0 &&
+         need_evaluate_operation((OperationNode *)rel->to);
+}
+
+/* Priority of an operation is its own evaluation time, plus the priority of the most expensive
+ * operation depending on it. So the operations on the longest chain of the graph (the critical
+ * path) are scheduled first, instead of being left for last while other threads are idle.
+ *
+ * Priorities are calculated in reverse topological order, so children are done before their
+ * parents without recursing along chains of operations, which can be very long. */
+void calculate_priorities(Depsgraph *graph)
+{
+  /* Topological order of the operations to evaluate, found by consuming the pending parents
+   * counters. They are counted back up when going over the same relations in reverse order. */
+  Vector<OperationNode *> order;
+  for (OperationNode *node : graph->operations) {
+    node->eval_priority = 0.0;
+    if (need_evaluate_operation(node) && node->num_links_pending == 0) {
+      order.append(node);
+    }
+  }
+  for (int64_t i = 0; i < order.size(); i++) {
+    for (Relation *rel : order[i]->outlinks) {
+      if (!is_pending_relation(rel)) {
+        continue;
+      }
+      OperationNode *child = (OperationNode *)rel->to;
+      if (--child->num_links_pending == 0) {
+        order.append(child);
+      }
+    }
+  }
+
+  for (int64_t i = order.size() - 1; i >= 0; i--) {
+    OperationNode *node = order[i];
+    double children_priority = 0.0;
+    for (Relation *rel : node->outlinks) {
+      if (!is_pending_relation(rel)) {
+        continue;
+      }
+      OperationNode *child = (OperationNode *)rel->to;
+      children_priority = max_dd(children_priority, child->eval_priority);
+      child->num_links_pending++;
+    }
+    const double eval_time = node->is_noop() ?
+                                 0.0 :
+                                 max_dd(node->eval_time.get_averaged(), MIN_OPERATION_EVAL_TIME);
+    node->eval_priority = eval_time + children_priority;
+  }
+}
+
 void initialize_execution(DepsgraphEvalState *state, Depsgraph *graph)
 {
   const bool do_stats = state->do_stats;
   calculate_pending_parents(graph);
+  /* Uses the pending parents counters, leaving them unchanged. */
+  calculate_priorities(graph);
   /* Clear tags and other things which needs to be clear. */
   for (OperationNode *node : graph->operations) {
     if (do_stats) {
@@ -380,6 +484,8 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   state.graph = graph;
   state.do_stats = graph->debug.do_time_debug();
   state.need_single_thread_pass = false;
+  state.ready_operations = BLI_heap_new();
+  BLI_spin_init(&state.ready_operations_lock);
   /* Prepare all nodes for evaluation. */
   initialize_execution(&state, graph);
 
@@ -387,14 +493,14 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   /* First, process all Copy-On-Write nodes. */
   state.stage = EvaluationStage::COPY_ON_WRITE;
   TaskPool *task_pool = deg_evaluate_task_pool_create(&state);
-  schedule_graph(&state, schedule_node_to_pool, task_pool);
+  schedule_graph(&state, schedule_node_to_pool, task_pool, nullptr);
   BLI_task_pool_work_and_wait(task_pool);
   BLI_task_pool_free(task_pool);
 
   /* After that, process all other nodes. */
   state.stage = EvaluationStage::THREADED_EVALUATION;
   task_pool = deg_evaluate_task_pool_create(&state);
-  schedule_graph(&state, schedule_node_to_pool, task_pool);
+  schedule_graph(&state, schedule_node_to_pool, task_pool, nullptr);
   BLI_task_pool_work_and_wait(task_pool);
   BLI_task_pool_free(task_pool);
 
@@ -403,6 +509,9 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
     evaluate_graph_single_threaded(&state);
   }
 
+  BLI_heap_free(state.ready_operations, NULL);
+  BLI_spin_end(&state.ready_operations_lock);
+
   /* Finalize statistics gathering. This is because we only gather single
    * operation timing here, without aggregating anything to avoid any extra
    * synchronization. */
@@ -411,6 +520,12 @@ void deg_evaluate_on_refresh(Depsgraph *graph)
   }
   /* Clear any uncleared tags - just in case. */
   deg_graph_clear_tags(graph);
+  /* Operations are only fused once more, so operations which are never evaluated do not cause
+   * this on every evaluation. */
+  if (graph->need_update_fused_operations) {
+    deg_graph_fuse_operations(graph);
+    graph->need_update_fused_operations = false;
+  }
   graph->is_evaluating = false;
 
   graph->debug.end_graph_evaluation();
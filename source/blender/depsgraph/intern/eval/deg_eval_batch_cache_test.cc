@@ -0,0 +1,159 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "testing/testing.h"
+
+#include "BLI_listbase.h"
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_modifier.h"
+#include "BKE_scene.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_modifier_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#include "intern/depsgraph_testing.h"
+
+namespace blender {
+namespace deg {
+namespace tests {
+
+/* Stands in for the draw cache of the evaluated mesh, the draw manager is not used here. */
+static int batch_cache;
+static int batch_cache_dirty_mode = -1;
+static int batch_cache_free_num = 0;
+
+static void batch_cache_dirty_tag(Mesh * /*me*/, int mode)
+{
+  batch_cache_dirty_mode = mode;
+}
+
+static void batch_cache_free(Mesh *me)
+{
+  me->runtime.batch_cache = nullptr;
+  batch_cache_free_num++;
+}
+
+class MeshBatchCacheReuseTest : public DepsgraphTest {
+ protected:
+  Mesh *mesh = nullptr;
+  Object *object = nullptr;
+  Object *hook = nullptr;
+
+  void (*dirty_tag_cb_prev)(Mesh *me, int mode);
+  void (*free_cb_prev)(Mesh *me);
+
+  void SetUp() override
+  {
+    dirty_tag_cb_prev = BKE_mesh_batch_cache_dirty_tag_cb;
+    free_cb_prev = BKE_mesh_batch_cache_free_cb;
+    BKE_mesh_batch_cache_dirty_tag_cb = batch_cache_dirty_tag;
+    BKE_mesh_batch_cache_free_cb = batch_cache_free;
+    batch_cache_dirty_mode = -1;
+    batch_cache_free_num = 0;
+
+    DepsgraphTest::SetUp();
+    mesh = BKE_mesh_add(bmain, "Mesh");
+    mesh->totvert = 4;
+    CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+    BKE_mesh_update_customdata_pointers(mesh, false);
+
+    /* The hook modifier only deforms the mesh, moving the hook object updates the geometry of
+     * the mesh object without changing the object or its mesh. */
+    object = add_object("Object", OB_MESH);
+    object->data = mesh;
+    id_us_plus(&mesh->id);
+    hook = add_object("Hook");
+    HookModifierData *hmd = (HookModifierData *)BKE_modifier_new(eModifierType_Hook);
+    hmd->object = hook;
+    BLI_addtail(&object->modifiers, hmd);
+
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph);
+    DEG_make_active(depsgraph);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+
+  void TearDown() override
+  {
+    DepsgraphTest::TearDown();
+    BKE_mesh_batch_cache_dirty_tag_cb = dirty_tag_cb_prev;
+    BKE_mesh_batch_cache_free_cb = free_cb_prev;
+  }
+
+  Mesh *mesh_eval_get()
+  {
+    Object *object_eval = DEG_get_evaluated_object(depsgraph, object);
+    return (Mesh *)object_eval->runtime.data_eval;
+  }
+};
+
+TEST_F(MeshBatchCacheReuseTest, deformed)
+{
+  Mesh *mesh_eval = mesh_eval_get();
+  ASSERT_NE(mesh_eval, nullptr);
+  mesh_eval->runtime.batch_cache = &batch_cache;
+
+  /* The geometry update is flushed from the hook, the cache moves to the new evaluated mesh. */
+  DEG_id_tag_update_ex(bmain, &hook->id, ID_RECALC_TRANSFORM);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+  mesh_eval = mesh_eval_get();
+  ASSERT_NE(mesh_eval, nullptr);
+  EXPECT_EQ(mesh_eval->runtime.batch_cache, &batch_cache);
+  EXPECT_EQ(batch_cache_dirty_mode, BKE_MESH_BATCH_DIRTY_DEFORM);
+  EXPECT_EQ(batch_cache_free_num, 0);
+
+  /* Changes to the original mesh could change its topology. */
+  DEG_id_tag_update_ex(bmain, &mesh->id, ID_RECALC_GEOMETRY);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+  mesh_eval = mesh_eval_get();
+  ASSERT_NE(mesh_eval, nullptr);
+  EXPECT_EQ(mesh_eval->runtime.batch_cache, nullptr);
+  EXPECT_EQ(batch_cache_free_num, 1);
+}
+
+TEST_F(MeshBatchCacheReuseTest, object_changed)
+{
+  Mesh *mesh_eval = mesh_eval_get();
+  ASSERT_NE(mesh_eval, nullptr);
+  mesh_eval->runtime.batch_cache = &batch_cache;
+
+  /* Changes to the modifiers of the object could change the topology. */
+  DEG_id_tag_update_ex(bmain, &object->id, ID_RECALC_GEOMETRY);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+  mesh_eval = mesh_eval_get();
+  ASSERT_NE(mesh_eval, nullptr);
+  EXPECT_EQ(mesh_eval->runtime.batch_cache, nullptr);
+  EXPECT_EQ(batch_cache_free_num, 1);
+}
+
+}  // namespace tests
+}  // namespace deg
+}  // namespace blender
@@ -0,0 +1,135 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "testing/testing.h"
+
+#include <climits>
+
+#include "BKE_customdata.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+#include "BKE_scene.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#include "intern/depsgraph_testing.h"
+
+namespace blender {
+namespace deg {
+namespace tests {
+
+class CopyOnWriteMeshTest : public DepsgraphTest {
+ protected:
+  Mesh *mesh = nullptr;
+
+  void SetUp() override
+  {
+    DepsgraphTest::SetUp();
+
+    /* A single triangle in the XY plane, with normals that don't match it. */
+    mesh = BKE_mesh_add(bmain, "Mesh");
+    mesh->totvert = 3;
+    mesh->totedge = 3;
+    mesh->totpoly = 1;
+    mesh->totloop = 3;
+    CustomData_add_layer(&mesh->vdata, CD_MVERT, CD_CALLOC, nullptr, mesh->totvert);
+    CustomData_add_layer(&mesh->edata, CD_MEDGE, CD_CALLOC, nullptr, mesh->totedge);
+    CustomData_add_layer(&mesh->pdata, CD_MPOLY, CD_CALLOC, nullptr, mesh->totpoly);
+    CustomData_add_layer(&mesh->ldata, CD_MLOOP, CD_CALLOC, nullptr, mesh->totloop);
+    BKE_mesh_update_customdata_pointers(mesh, false);
+    for (int i = 0; i < 3; i++) {
+      mesh->mvert[i].co[0] = (i == 1) ? 1.0f : 0.0f;
+      mesh->mvert[i].co[1] = (i == 2) ? 1.0f : 0.0f;
+      mesh->mvert[i].no[0] = SHRT_MAX;
+      mesh->medge[i].v1 = i;
+      mesh->medge[i].v2 = (i + 1) % 3;
+      mesh->mloop[i].v = i;
+      mesh->mloop[i].e = i;
+    }
+    mesh->mpoly[0].totloop = 3;
+
+    Object *object = add_object("Object", OB_MESH);
+    object->data = mesh;
+    id_us_plus(&mesh->id);
+
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_VIEWPORT);
+    DEG_graph_build_from_view_layer(depsgraph);
+    BKE_scene_graph_update_tagged(depsgraph, bmain);
+  }
+
+  void expect_original_unchanged()
+  {
+    EXPECT_FALSE(CustomData_has_referenced(&mesh->vdata));
+    EXPECT_FALSE(CustomData_has_layer(&mesh->pdata, CD_NORMAL));
+    for (int i = 0; i < 3; i++) {
+      EXPECT_EQ(mesh->mvert[i].co[0], (i == 1) ? 1.0f : 0.0f);
+      EXPECT_EQ(mesh->mvert[i].no[0], SHRT_MAX);
+      EXPECT_EQ(mesh->mvert[i].no[2], 0);
+    }
+  }
+};
+
+/* The copy-on-write mesh shares the data of the original, writing to it must not change the
+ * original. */
+TEST_F(CopyOnWriteMeshTest, write_does_not_change_original)
+{
+  Mesh *mesh_cow = (Mesh *)DEG_get_evaluated_id(depsgraph, &mesh->id);
+  ASSERT_NE(mesh_cow, mesh);
+  EXPECT_EQ(mesh_cow->mvert, mesh->mvert);
+  EXPECT_TRUE(CustomData_has_referenced(&mesh_cow->vdata));
+  expect_original_unchanged();
+
+  BKE_mesh_normals_tag_dirty(mesh_cow);
+  BKE_mesh_ensure_normals_for_display(mesh_cow);
+  EXPECT_NE(mesh_cow->mvert, mesh->mvert);
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(mesh_cow->mvert[i].no[0], 0);
+    EXPECT_EQ(mesh_cow->mvert[i].no[2], SHRT_MAX);
+  }
+  expect_original_unchanged();
+
+  /* Copied again on the next evaluation. */
+  DEG_id_tag_update_ex(bmain, &mesh->id, ID_RECALC_GEOMETRY);
+  BKE_scene_graph_update_tagged(depsgraph, bmain);
+  mesh_cow = (Mesh *)DEG_get_evaluated_id(depsgraph, &mesh->id);
+  EXPECT_EQ(mesh_cow->mvert, mesh->mvert);
+
+  MVert *mvert = (MVert *)CustomData_duplicate_referenced_layer(
+      &mesh_cow->vdata, CD_MVERT, mesh_cow->totvert);
+  BKE_mesh_update_customdata_pointers(mesh_cow, false);
+  EXPECT_EQ(mesh_cow->mvert, mvert);
+  mvert[1].co[0] = 2.0f;
+  BKE_mesh_normals_tag_dirty(mesh_cow);
+  BKE_mesh_ensure_normals_for_display(mesh_cow);
+  EXPECT_TRUE(CustomData_has_layer(&mesh_cow->pdata, CD_NORMAL));
+  expect_original_unchanged();
+}
+
+}  // namespace tests
+}  // namespace deg
+}  // namespace blender
@@ -0,0 +1,166 @@
+/*
+ * This program is free software; you can redistribute it and/or
+ * modify it under the terms of the GNU General Public License
+ * as published by the Free Software Foundation; either version 2
+ * of the License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston, MA 02110-1301, USA.
+ *
+ * The Original Code is Copyright (C) 2020 Blender Foundation.
+ * All rights reserved.
+ */
+
+/** \file
+ * \ingroup depsgraph
+ */
+
+#include "testing/testing.h"
+
+#include <vector>
+
+#include "MEM_guardedalloc.h"
+
+#include "BLI_listbase.h"
+#include "BLI_string.h"
+
+#include "BKE_action.h"
+#include "BKE_anim_data.h"
+#include "BKE_fcurve.h"
+#include "BKE_scene.h"
+
+#include "DNA_anim_types.h"
+#include "DNA_windowmanager_types.h"
+
+#include "DEG_depsgraph.h"
+#include "DEG_depsgraph_build.h"
+#include "DEG_depsgraph_query.h"
+
+#include "intern/depsgraph_testing.h"
+
+namespace blender {
+namespace deg {
+namespace tests {
+
+static const int objects_num = 6;
+
+struct FramesResult {
+  Object *objects[objects_num];
+  std::vector<double> frames;
+  std::vector<float> locations;
+  int frames_max;
+};
+
+static void frames_graph_build(Depsgraph *depsgraph, void * /*user_data*/)
+{
+  DEG_graph_build_from_view_layer(depsgraph);
+}
+
+static bool frames_result_add(Depsgraph *depsgraph, double frame, void *user_data)
+{
+  FramesResult *result = static_cast<FramesResult *>(user_data);
+  result->frames.push_back(frame);
+  for (Object *object : result->objects) {
+    const Object *object_eval = DEG_get_evaluated_object(depsgraph, object);
+    for (int axis = 0; axis < 3; axis++) {
+      result->locations.push_back(object_eval->obmat[3][axis]);
+    }
+  }
+  return (int)result->frames.size() < result->frames_max;
+}
+
+class SceneEvaluateFramesTest : public DepsgraphTest {
+ protected:
+  Object *objects[objects_num];
+
+  void SetUp() override
+  {
+    DepsgraphTest::SetUp();
+    /* Frame changes update the image editors of the window manager. */
+    bmain->wm.first = MEM_callocN(sizeof(wmWindowManager), __func__);
+
+    /* A chain of objects, each one moving along one axis with the frame. */
+    for (int i = 0; i < objects_num; i++) {
+      char name[MAX_NAME];
+      BLI_snprintf(name, sizeof(name), "Object %d", i);
+      objects[i] = add_object(name);
+      if (i > 0) {
+        objects[i]->parent = objects[i - 1];
+      }
+      location_animate(objects[i], i % 3);
+    }
+  }
+
+  void TearDown() override
+  {
+    depsgraph_free();
+    MEM_freeN(bmain->wm.first);
+    BLI_listbase_clear(&bmain->wm);
+    DepsgraphTest::TearDown();
+  }
+
+  void location_animate(Object *object, int axis)
+  {
+    AnimData *adt = BKE_animdata_add_id(&object->id);
+    adt->action = BKE_action_add(bmain, "Action");
+    FCurve *fcu = BKE_fcurve_create();
+    fcu->rna_path = BLI_strdup("location");
+    fcu->array_index = axis;
+    /* The default generator is the frame itself. */
+    add_fmodifier(&fcu->modifiers, FMODIFIER_TYPE_GENERATOR, fcu);
+    BLI_addtail(&adt->action->curves, fcu);
+  }
+
+  FramesResult evaluate_frames(const std::vector<double> &frames, int graphs_num, int frames_max)
+  {
+    depsgraph_free();
+    depsgraph = DEG_graph_new(bmain, scene, view_layer, DAG_EVAL_RENDER);
+    frames_graph_build(depsgraph, nullptr);
+
+    FramesResult result;
+    memcpy(result.objects, objects, sizeof(objects));
+    result.frames_max = frames_max;
+    BKE_scene_graph_evaluate_frames(depsgraph,
+                                    frames.data(),
+                                    (int)frames.size(),
+                                    graphs_num,
+                                    frames_graph_build,
+                                    frames_result_add,
+                                    &result);
+    return result;
+  }
+};
+
+TEST_F(SceneEvaluateFramesTest, concurrent_matches_sequential)
+{
+  const std::vector<double> frames = {1.0, 2.0, 2.5, 3.0, 7.0, 8.0, 9.0, 10.0, 11.0};
+  const FramesResult sequential = evaluate_frames(frames, 1, (int)frames.size());
+  ASSERT_EQ(sequential.frames, frames);
+  EXPECT_FLOAT_EQ(sequential.locations[0], 1.0f);
+  EXPECT_FLOAT_EQ(sequential.locations.back(), 2.0f * 11.0f);
+
+  for (int graphs_num : {0, 2, 4}) {
+    const FramesResult concurrent = evaluate_frames(frames, graphs_num, (int)frames.size());
+    EXPECT_EQ(concurrent.frames, frames) << graphs_num << " graphs";
+    EXPECT_EQ(concurrent.locations, sequential.locations) << graphs_num << " graphs";
+  }
+}
+
+TEST_F(SceneEvaluateFramesTest, stop)
+{
+  const std::vector<double> frames = {1.0, 2.0, 3.0, 4.0, 5.0, 6.0, 7.0};
+  for (int graphs_num : {1, 4}) {
+    const FramesResult result = evaluate_frames(frames, graphs_num, 3);
+    EXPECT_EQ(result.frames, std::vector<double>(frames.begin(), frames.begin() + 3));
+  }
+}
+
+}  // namespace tests
+}  // namespace deg
+}  // namespace blender
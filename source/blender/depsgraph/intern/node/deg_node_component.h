@@ -106,6 +106,9 @@ struct ComponentNode : public Node {
   virtual OperationNode *get_exit_operation() override;
 
   void finalize_build(Depsgraph *graph);
+  /* Revert finalize_build(), so operations can be added to the component again by an
+   * incremental build. */
+  void reopen_build();
 
   IDNode *owner;
 
@@ -71,6 +71,7 @@ struct IDNode : public Node {
   virtual void tag_update(Depsgraph *graph, eUpdateSource source) override;
 
   void finalize_build(Depsgraph *graph);
+  void reopen_build();
 
   IDComponentsMask get_visible_components_mask() const;
 
@@ -210,7 +210,7 @@ const char *operationCodeAsString(OperationCode opcode)
   return "UNKNOWN";
 }
 
-OperationNode::OperationNode() : name_tag(-1), flag(0)
+OperationNode::OperationNode() : name_tag(-1), flag(0), eval_priority(0.0)
 {
 }
 
@@ -23,6 +23,7 @@
 
 #pragma once
 
+#include "intern/debug/deg_time_average.h"
 #include "intern/node/deg_node.h"
 
 #include "intern/depsgraph_type.h"
@@ -223,6 +224,9 @@ enum OperationFlag {
    * outgoing relations. This is for NO-OP nodes that are purely used to indicate a
    * relation between components/IDs, and not for connecting to an operation. */
   DEPSOP_FLAG_PINNED = (1 << 3),
+  /* Node is evaluated in the task of its only parent operation, right after it, instead of being
+   * scheduled as a task of its own. Set by deg_graph_fuse_operations(). */
+  DEPSOP_FLAG_FUSED = (1 << 4),
 
   /* Set of flags which gets flushed along the relations. */
   DEPSOP_FLAG_FLUSH = (DEPSOP_FLAG_USER_MODIFIED),
@@ -273,6 +277,15 @@ struct OperationNode : public Node {
   /* (OperationFlag) extra settings affecting evaluation. */
   int flag;
 
+  /* Time spent evaluating this operation in the last evaluations. Kept when relations are
+   * updated, see DepsgraphNodeBuilder::end_build(). */
+  static const constexpr int MAX_EVAL_TIME_SAMPLES = 4;
+  AveragedTimeSampler<MAX_EVAL_TIME_SAMPLES> eval_time;
+
+  /* Evaluation time of this operation and of the longest chain of operations depending on it,
+   * operations with the highest priority are scheduled first. Only valid during evaluation. */
+  double eval_priority;
+
   DEG_DEPSNODE_DECLARE;
 };
 
@@ -233,6 +233,8 @@ typedef struct MeshBatchCache {
   int vert_len;
   int mat_len;
   bool is_dirty; /* Instantly invalidates cache, skipping mesh check */
+  /* Only vertex positions changed, buffers depending on them are updated in place. */
+  bool is_deform_dirty;
   bool is_editmode;
   bool is_uvsyncsel;
 
@@ -77,6 +77,10 @@
 #  include "PIL_time_utildefines.h"
 #endif
 
+/* Maximum and minimum number of elements extracted by a single range task. */
+#define MESH_EXTRACT_CHUNK_SIZE 8192
+#define MESH_EXTRACT_CHUNK_SIZE_MIN 256
+
 /* ---------------------------------------------------------------------- */
 /** \name Mesh/BMesh Interface (indirect, partially cached access to complex data).
  * \{ */
@@ -129,7 +133,8 @@ typedef struct MeshRenderData {
   /* Data created on-demand (usually not for #BMesh based data). */
   MLoopTri *mlooptri;
   float (*loop_normals)[3];
-  float (*poly_normals)[3];
+  /** Owned by the mesh, see #BKE_mesh_poly_normals_ensure. */
+  const float (*poly_normals)[3];
   int *lverts, *ledges;
 } MeshRenderData;
 
@@ -246,16 +251,7 @@ static void mesh_render_data_update_normals(MeshRenderData *mr,
   if (mr->extract_type != MR_EXTRACT_BMESH) {
     /* Mesh */
     if (data_flag & (MR_DATA_POLY_NOR | MR_DATA_LOOP_NOR | MR_DATA_TAN_LOOP_NOR)) {
-      mr->poly_normals = MEM_mallocN(sizeof(*mr->poly_normals) * mr->poly_len, __func__);
-      BKE_mesh_calc_normals_poly((MVert *)mr->mvert,
-                                 NULL,
-                                 mr->vert_len,
-                                 mr->mloop,
-                                 mr->mpoly,
-                                 mr->loop_len,
-                                 mr->poly_len,
-                                 mr->poly_normals,
-                                 true);
+      mr->poly_normals = BKE_mesh_poly_normals_ensure(me);
     }
     if (((data_flag & MR_DATA_LOOP_NOR) && is_auto_smooth) || (data_flag & MR_DATA_TAN_LOOP_NOR)) {
       mr->loop_normals = MEM_mallocN(sizeof(*mr->loop_normals) * mr->loop_len, __func__);
@@ -442,7 +438,6 @@ static MeshRenderData *mesh_render_data_create(Mesh *me,
 static void mesh_render_data_free(MeshRenderData *mr)
 {
   MEM_SAFE_FREE(mr->mlooptri);
-  MEM_SAFE_FREE(mr->poly_normals);
   MEM_SAFE_FREE(mr->loop_normals);
 
   MEM_SAFE_FREE(mr->lverts);
@@ -1964,6 +1959,7 @@ static void extract_pos_nor_iter_poly_mesh(const MeshRenderData *mr,
                                            void *_data)
 {
   MeshExtract_PosNor_Data *data = _data;
+  const int *v_origindex = (mr->extract_type == MR_EXTRACT_MAPPED) ? mr->v_origindex : NULL;
   EXTRACT_POLY_AND_LOOP_FOREACH_MESH_BEGIN(mp, mp_index, ml, ml_index, params, mr)
   {
     PosNorLoop *vert = &data->vbo_data[ml_index];
@@ -1972,8 +1968,7 @@ static void extract_pos_nor_iter_poly_mesh(const MeshRenderData *mr,
     vert->nor = data->packed_nor[ml->v];
     /* Flag for paint mode overlay. */
     if (mp->flag & ME_HIDE || mv->flag & ME_HIDE ||
-        ((mr->extract_type == MR_EXTRACT_MAPPED) && (mr->v_origindex) &&
-         (mr->v_origindex[ml->v] == ORIGINDEX_NONE))) {
+        (v_origindex && (v_origindex[ml->v] == ORIGINDEX_NONE))) {
       vert->nor.w = -1;
     }
     else if (mv->flag & SELECT) {
@@ -2128,11 +2123,15 @@ static void extract_lnor_hq_iter_poly_mesh(const MeshRenderData *mr,
                                            const ExtractPolyMesh_Params *params,
                                            void *data)
 {
+  const float(*loop_normals)[3] = mr->loop_normals;
+  const int *v_origindex = (mr->edit_bmesh && mr->extract_type == MR_EXTRACT_MAPPED) ?
+                               mr->v_origindex :
+                               NULL;
   EXTRACT_POLY_AND_LOOP_FOREACH_MESH_BEGIN(mp, mp_index, ml, ml_index, params, mr)
   {
     gpuHQNor *lnor_data = &((gpuHQNor *)data)[ml_index];
-    if (mr->loop_normals) {
-      normal_float_to_short_v3(&lnor_data->x, mr->loop_normals[ml_index]);
+    if (loop_normals) {
+      normal_float_to_short_v3(&lnor_data->x, loop_normals[ml_index]);
     }
     else if (mp->flag & ME_SMOOTH) {
       copy_v3_v3_short(&lnor_data->x, mr->mvert[ml->v].no);
@@ -2144,8 +2143,7 @@ static void extract_lnor_hq_iter_poly_mesh(const MeshRenderData *mr,
     /* Flag for paint mode overlay.
      * Only use #MR_EXTRACT_MAPPED in edit mode where it is used to display the edge-normals.
      * In paint mode it will use the un-mapped data to draw the wire-frame. */
-    if (mp->flag & ME_HIDE || (mr->edit_bmesh && mr->extract_type == MR_EXTRACT_MAPPED &&
-                               (mr->v_origindex) && mr->v_origindex[ml->v] == ORIGINDEX_NONE)) {
+    if (mp->flag & ME_HIDE || (v_origindex && v_origindex[ml->v] == ORIGINDEX_NONE)) {
       lnor_data->w = -1;
     }
     else if (mp->flag & ME_FACE_SEL) {
@@ -2220,11 +2218,15 @@ static void extract_lnor_iter_poly_mesh(const MeshRenderData *mr,
                                         const ExtractPolyMesh_Params *params,
                                         void *data)
 {
+  const float(*loop_normals)[3] = mr->loop_normals;
+  const int *v_origindex = (mr->edit_bmesh && mr->extract_type == MR_EXTRACT_MAPPED) ?
+                               mr->v_origindex :
+                               NULL;
   EXTRACT_POLY_AND_LOOP_FOREACH_MESH_BEGIN(mp, mp_index, ml, ml_index, params, mr)
   {
     GPUPackedNormal *lnor_data = &((GPUPackedNormal *)data)[ml_index];
-    if (mr->loop_normals) {
-      *lnor_data = GPU_normal_convert_i10_v3(mr->loop_normals[ml_index]);
+    if (loop_normals) {
+      *lnor_data = GPU_normal_convert_i10_v3(loop_normals[ml_index]);
     }
     else if (mp->flag & ME_SMOOTH) {
       *lnor_data = GPU_normal_convert_i10_s3(mr->mvert[ml->v].no);
@@ -2236,8 +2238,7 @@ static void extract_lnor_iter_poly_mesh(const MeshRenderData *mr,
     /* Flag for paint mode overlay.
      * Only use MR_EXTRACT_MAPPED in edit mode where it is used to display the edge-normals.
      * In paint mode it will use the un-mapped data to draw the wire-frame. */
-    if (mp->flag & ME_HIDE || (mr->edit_bmesh && mr->extract_type == MR_EXTRACT_MAPPED &&
-                               (mr->v_origindex) && mr->v_origindex[ml->v] == ORIGINDEX_NONE)) {
+    if (mp->flag & ME_HIDE || (v_origindex && v_origindex[ml->v] == ORIGINDEX_NONE)) {
       lnor_data->w = -1;
     }
     else if (mp->flag & ME_FACE_SEL) {
@@ -4296,7 +4297,7 @@ static void statvis_calc_distort(const MeshRenderData *mr, float *r_distort)
       float fac = -1.0f;
 
       if (mp->totloop > 3) {
-        float *f_no = mr->poly_normals[mp_index];
+        const float *f_no = mr->poly_normals[mp_index];
         fac = 0.0f;
 
         for (int i = 1; i <= mp->totloop; i++) {
@@ -4391,7 +4392,7 @@ static void statvis_calc_sharp(const MeshRenderData *mr, float *r_sharp)
         void **pval;
         bool value_is_init = BLI_edgehash_ensure_p(eh, l_curr->v, l_next->v, &pval);
         if (!value_is_init) {
-          *pval = mr->poly_normals[mp_index];
+          *pval = (void *)mr->poly_normals[mp_index];
           /* non-manifold edge, yet... */
           continue;
         }
@@ -5284,6 +5285,15 @@ static void extract_init(ExtractTaskData *data)
   }
 }
 
+static void extract_task_done(ExtractTaskData *data)
+{
+  /* If this is the last task, we do the finish function. */
+  int remainin_tasks = atomic_sub_and_fetch_int32(data->task_counter, 1);
+  if (remainin_tasks == 0 && data->extract->finish != NULL) {
+    data->extract->finish(data->mr, data->cache, data->buf, data->user_data->user_data);
+  }
+}
+
 static void extract_run(void *__restrict taskdata)
 {
   ExtractTaskData *data = (ExtractTaskData *)taskdata;
@@ -5294,12 +5304,7 @@ static void extract_run(void *__restrict taskdata)
                       data->end,
                       data->extract,
                       data->user_data->user_data);
-
-    /* If this is the last task, we do the finish function. */
-    int remainin_tasks = atomic_sub_and_fetch_int32(data->task_counter, 1);
-    if (remainin_tasks == 0 && data->extract->finish != NULL) {
-      data->extract->finish(data->mr, data->cache, data->buf, data->user_data->user_data);
-    }
+    extract_task_done(data);
   }
   else if (data->tasktype == EXTRACT_LINES_LOOSE) {
     extract_lines_loose_subbuffer(data->mr, data->cache);
@@ -5445,26 +5450,110 @@ static struct TaskNode *user_data_init_task_node_create(struct TaskGraph *task_g
 /** \name Extract Loop
  * \{ */
 
+/**
+ * A range task runs all threaded extractions over the same range of elements, one after the
+ * other. The mesh data of the range is only loaded once and stays in the cache for the
+ * extractions that follow.
+ */
+typedef struct ExtractRangeTaskData {
+  /** Threaded #ExtractTaskData, owned by the #UserDataInitTaskData. */
+  const ListBase *task_datas;
+  eMRIterType iter_type;
+  int start, end;
+} ExtractRangeTaskData;
+
+static void extract_range_run(void *__restrict taskdata)
+{
+  ExtractRangeTaskData *data = (ExtractRangeTaskData *)taskdata;
+  LISTBASE_FOREACH (ExtractTaskData *, td, data->task_datas) {
+    if (td->iter_type & data->iter_type) {
+      mesh_extract_iter(
+          td->mr, data->iter_type, data->start, data->end, td->extract, td->user_data->user_data);
+      extract_task_done(td);
+    }
+  }
+}
+
 static void extract_range_task_create(struct TaskGraph *task_graph,
                                       struct TaskNode *task_node_user_data_init,
-                                      ExtractTaskData *taskdata,
+                                      const ListBase *task_datas,
                                       const eMRIterType type,
                                       int start,
                                       int length)
 {
-  taskdata = MEM_dupallocN(taskdata);
-  atomic_add_and_fetch_int32(taskdata->task_counter, 1);
+  ExtractRangeTaskData *taskdata = MEM_mallocN(sizeof(*taskdata), __func__);
+  taskdata->task_datas = task_datas;
   taskdata->iter_type = type;
   taskdata->start = start;
   taskdata->end = start + length;
+  LISTBASE_FOREACH (ExtractTaskData *, td, task_datas) {
+    if (td->iter_type & type) {
+      (*td->task_counter)++;
+    }
+  }
   struct TaskNode *task_node = BLI_task_graph_node_create(
-      task_graph, extract_run, taskdata, MEM_freeN);
+      task_graph, extract_range_run, taskdata, MEM_freeN);
   BLI_task_graph_edge_create(task_node_user_data_init, task_node);
 }
 
+/**
+ * Split the elements in at least one range per thread, the extractions in a range run one after
+ * the other, so meshes with fewer elements than the maximum chunk size still use all threads.
+ */
+static int extract_range_chunk_size(const int len)
+{
+  const int num_threads = BLI_task_scheduler_num_threads();
+  const int chunk_size = (len + num_threads - 1) / num_threads;
+  return clamp_i(chunk_size, MESH_EXTRACT_CHUNK_SIZE_MIN, MESH_EXTRACT_CHUNK_SIZE);
+}
+
+static void extract_range_tasks_create_for_type(struct TaskGraph *task_graph,
+                                                struct TaskNode *task_node_user_data_init,
+                                                const ListBase *task_datas,
+                                                const eMRIterType type,
+                                                const int len)
+{
+  const int chunk_size = extract_range_chunk_size(len);
+  for (int i = 0; i < len; i += chunk_size) {
+    extract_range_task_create(
+        task_graph, task_node_user_data_init, task_datas, type, i, min_ii(chunk_size, len - i));
+  }
+}
+
+/**
+ * Create the range tasks of all threaded extractions, needs to be called after all extractions
+ * are added to `task_datas`.
+ */
+static void extract_range_tasks_create(struct TaskGraph *task_graph,
+                                       struct TaskNode *task_node_user_data_init,
+                                       const MeshRenderData *mr,
+                                       const ListBase *task_datas)
+{
+  eMRIterType iter_type = 0;
+  LISTBASE_FOREACH (ExtractTaskData *, td, task_datas) {
+    iter_type |= td->iter_type;
+  }
+
+  if (iter_type & MR_ITER_LOOPTRI) {
+    extract_range_tasks_create_for_type(
+        task_graph, task_node_user_data_init, task_datas, MR_ITER_LOOPTRI, mr->tri_len);
+  }
+  if (iter_type & MR_ITER_POLY) {
+    extract_range_tasks_create_for_type(
+        task_graph, task_node_user_data_init, task_datas, MR_ITER_POLY, mr->poly_len);
+  }
+  if (iter_type & MR_ITER_LEDGE) {
+    extract_range_tasks_create_for_type(
+        task_graph, task_node_user_data_init, task_datas, MR_ITER_LEDGE, mr->edge_loose_len);
+  }
+  if (iter_type & MR_ITER_LVERT) {
+    extract_range_tasks_create_for_type(
+        task_graph, task_node_user_data_init, task_datas, MR_ITER_LVERT, mr->vert_loose_len);
+  }
+}
+
 static void extract_task_create(struct TaskGraph *task_graph,
                                 struct TaskNode *task_node_mesh_render_data,
-                                struct TaskNode *task_node_user_data_init,
                                 ListBase *single_threaded_task_datas,
                                 ListBase *user_data_init_task_datas,
                                 const Scene *scene,
@@ -5488,35 +5577,10 @@ static void extract_task_create(struct TaskGraph *task_graph,
       mr, cache, extract, buf, task_counter);
 
   /* Simple heuristic. */
-  const int chunk_size = 8192;
-  const bool use_thread = (mr->loop_len + mr->loop_loose_len) > chunk_size;
+  const bool use_thread = (mr->loop_len + mr->loop_loose_len) > MESH_EXTRACT_CHUNK_SIZE;
   if (use_thread && extract->use_threading) {
-
-    /* Divide task into sensible chunks. */
-    if (taskdata->iter_type & MR_ITER_LOOPTRI) {
-      for (int i = 0; i < mr->tri_len; i += chunk_size) {
-        extract_range_task_create(
-            task_graph, task_node_user_data_init, taskdata, MR_ITER_LOOPTRI, i, chunk_size);
-      }
-    }
-    if (taskdata->iter_type & MR_ITER_POLY) {
-      for (int i = 0; i < mr->poly_len; i += chunk_size) {
-        extract_range_task_create(
-            task_graph, task_node_user_data_init, taskdata, MR_ITER_POLY, i, chunk_size);
-      }
-    }
-    if (taskdata->iter_type & MR_ITER_LEDGE) {
-      for (int i = 0; i < mr->edge_loose_len; i += chunk_size) {
-        extract_range_task_create(
-            task_graph, task_node_user_data_init, taskdata, MR_ITER_LEDGE, i, chunk_size);
-      }
-    }
-    if (taskdata->iter_type & MR_ITER_LVERT) {
-      for (int i = 0; i < mr->vert_loose_len; i += chunk_size) {
-        extract_range_task_create(
-            task_graph, task_node_user_data_init, taskdata, MR_ITER_LVERT, i, chunk_size);
-      }
-    }
+    /* The range tasks are shared with the other threaded extractions, they are created when all
+     * extractions are known. See #extract_range_tasks_create. */
     BLI_addtail(user_data_init_task_datas, taskdata);
   }
   else if (use_thread) {
@@ -5557,27 +5621,29 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
    * Small extractions and extractions that can't be multi-threaded are grouped in a single
    * `extract_single_threaded_task_node`.
    *
-   * Other extractions will create a node for each loop exceeding 8192 items. these nodes are
-   * linked to the `user_data_init_task_node`. the `user_data_init_task_node` prepares the
-   * user_data needed for the extraction based on the data extracted from the mesh.
-   * counters are used to check if the finalize of a task has to be called.
+   * Other extractions share a node for each range of at most 8192 items, with at least one range
+   * per thread. A range node runs all these extractions over its range, so the mesh data of the
+   * range is only fetched once. These nodes are linked to the `user_data_init_task_node`. the
+   * `user_data_init_task_node` prepares the user_data needed for the extraction based on the data
+   * extracted from the mesh. counters are used to check if the finalize of a task has to be
+   * called.
    *
    *                           Mesh extraction sub graph
    *
    *                                                       +----------------------+
-   *                                               +-----> | extract_task1_loop_1 |
+   *                                               +-----> | extract_range_poly_1 |
    *                                               |       +----------------------+
    * +------------------+     +----------------------+     +----------------------+
-   * | mesh_render_data | --> |                      | --> | extract_task1_loop_2 |
+   * | mesh_render_data | --> |                      | --> | extract_range_poly_2 |
    * +------------------+     |                      |     +----------------------+
    *   |                      |                      |     +----------------------+
-   *   |                      |    user_data_init    | --> | extract_task2_loop_1 |
+   *   |                      |    user_data_init    | --> | extract_range_poly_3 |
    *   v                      |                      |     +----------------------+
    * +------------------+     |                      |     +----------------------+
-   * | single_threaded  |     |                      | --> | extract_task2_loop_2 |
+   * | single_threaded  |     |                      | --> | extract_range_edge_1 |
    * +------------------+     +----------------------+     +----------------------+
    *                                               |       +----------------------+
-   *                                               +-----> | extract_task2_loop_3 |
+   *                                               +-----> | extract_range_vert_1 |
    *                                                       +----------------------+
    */
   eMRIterType iter_flag = 0;
@@ -5674,7 +5740,6 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
   if (mbc.buf.name) { \
     extract_task_create(task_graph, \
                         task_node_mesh_render_data, \
-                        task_node_user_data_init, \
                         &single_threaded_task_data->task_datas, \
                         &user_data_init_task_data->task_datas, \
                         scene, \
@@ -5718,7 +5783,6 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
                                              &extract_lines;
     extract_task_create(task_graph,
                         task_node_mesh_render_data,
-                        task_node_user_data_init,
                         &single_threaded_task_data->task_datas,
                         &user_data_init_task_data->task_datas,
                         scene,
@@ -5747,6 +5811,8 @@ void mesh_buffer_cache_create_requested(struct TaskGraph *task_graph,
    * The task is still part of the graph so the task_data will be freed when the graph is freed.
    */
   if (!BLI_listbase_is_empty(&user_data_init_task_data->task_datas)) {
+    extract_range_tasks_create(
+        task_graph, task_node_user_data_init, mr, &user_data_init_task_data->task_datas);
     BLI_task_graph_edge_create(task_node_mesh_render_data, task_node_user_data_init);
   }
 
@@ -671,6 +671,15 @@ void DRW_mesh_batch_cache_dirty_tag(Mesh *me, int mode)
     case BKE_MESH_BATCH_DIRTY_ALL:
       cache->is_dirty = true;
       break;
+    case BKE_MESH_BATCH_DIRTY_DEFORM:
+      /* Edit-mode buffers are spread over the cage caches, rebuild everything. */
+      if (cache->is_editmode) {
+        cache->is_dirty = true;
+      }
+      else {
+        cache->is_deform_dirty = true;
+      }
+      break;
     case BKE_MESH_BATCH_DIRTY_SHADING:
       mesh_batch_cache_discard_shaded_tri(cache);
       mesh_batch_cache_discard_uvedit(cache);
@@ -1122,6 +1131,73 @@ void DRW_mesh_batch_cache_free_old(Mesh *me, int ctime)
   mesh_cd_layers_type_clear(&cache->cd_used_over_time);
 }
 
+/* Re-extract the vertex buffers depending on vertex positions and replace their data. The buffers
+ * themselves are kept so batches using them stay valid, index buffers and other attributes are not
+ * touched at all. */
+static void mesh_batch_cache_update_deformed(struct TaskGraph *task_graph,
+                                             MeshBatchCache *cache,
+                                             Object *ob,
+                                             Mesh *me,
+                                             const Scene *scene,
+                                             const ToolSettings *ts,
+                                             const bool is_paint_mode,
+                                             const bool use_hide)
+{
+  MeshBufferCache *mbufcache = &cache->final;
+  MeshBufferCache mbc_deformed = {{NULL}};
+  bool do_update = false;
+
+  /* Buffers which are requested but not extracted yet will be extracted completely later on. */
+#define DEFORMED_VBO_REQUEST(name) \
+  if (mbufcache->vbo.name != NULL && !DRW_vbo_requested(mbufcache->vbo.name)) { \
+    mbc_deformed.vbo.name = GPU_vertbuf_create(GPU_USAGE_STATIC); \
+    do_update = true; \
+  } \
+  ((void)0)
+
+  DEFORMED_VBO_REQUEST(pos_nor);
+  DEFORMED_VBO_REQUEST(lnor);
+  DEFORMED_VBO_REQUEST(edge_fac);
+  DEFORMED_VBO_REQUEST(tan);
+
+#undef DEFORMED_VBO_REQUEST
+
+  if (!do_update) {
+    return;
+  }
+
+  mesh_buffer_cache_create_requested(task_graph,
+                                     cache,
+                                     mbc_deformed,
+                                     me,
+                                     false,
+                                     is_paint_mode,
+                                     false,
+                                     ob->obmat,
+                                     true,
+                                     false,
+                                     false,
+                                     &cache->cd_used,
+                                     scene,
+                                     ts,
+                                     use_hide);
+  BLI_task_graph_work_and_wait(task_graph);
+
+#define DEFORMED_VBO_UPDATE(name) \
+  if (mbc_deformed.vbo.name != NULL) { \
+    GPU_vertbuf_data_move(mbufcache->vbo.name, mbc_deformed.vbo.name); \
+    GPU_vertbuf_discard(mbc_deformed.vbo.name); \
+  } \
+  ((void)0)
+
+  DEFORMED_VBO_UPDATE(pos_nor);
+  DEFORMED_VBO_UPDATE(lnor);
+  DEFORMED_VBO_UPDATE(edge_fac);
+  DEFORMED_VBO_UPDATE(tan);
+
+#undef DEFORMED_VBO_UPDATE
+}
+
 #ifdef DEBUG
 /* Sanity check function to test if all requested batches are available. */
 static void drw_mesh_batch_cache_check_available(struct TaskGraph *task_graph, Mesh *me)
@@ -1300,6 +1376,13 @@ void DRW_mesh_batch_cache_create_requested(struct TaskGraph *task_graph,
     }
   }
 
+  if (cache->is_deform_dirty) {
+    BLI_assert(!is_editmode);
+    mesh_batch_cache_update_deformed(
+        task_graph, cache, ob, me, scene, ts, is_paint_mode, use_hide);
+    cache->is_deform_dirty = false;
+  }
+
   /* Second chance to early out */
   if ((batch_requested & ~cache->batch_ready) == 0) {
 #ifdef DEBUG
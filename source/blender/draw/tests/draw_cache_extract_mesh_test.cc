@@ -0,0 +1,195 @@
+/* Apache License, Version 2.0 */
+
+#include "testing/testing.h"
+
+#include "draw_testing.hh"
+
+#include "MEM_guardedalloc.h"
+
+#include "DNA_mesh_types.h"
+#include "DNA_meshdata_types.h"
+#include "DNA_object_types.h"
+#include "DNA_scene_types.h"
+
+#include "BLI_math.h"
+#include "BLI_task.h"
+#include "BLI_timeit.hh"
+
+#include "BKE_idtype.h"
+#include "BKE_lib_id.h"
+#include "BKE_mesh.h"
+
+#include "GPU_batch.h"
+
+#include "tests/mesh_testing.hh"
+
+extern "C" {
+#include "intern/draw_cache_extract.h"
+#include "intern/draw_cache_impl.h"
+}
+
+/* Grid of quads with normals. */
+static Mesh *mesh_grid_create(const int size)
+{
+  Mesh *mesh = blender::bke::tests::mesh_grid_create(size);
+  BKE_mesh_calc_normals(mesh);
+  return mesh;
+}
+
+static void mesh_batch_cache_request(Mesh *mesh)
+{
+  DRW_mesh_batch_cache_validate(mesh);
+  DRW_mesh_batch_cache_get_surface(mesh);
+  DRW_mesh_batch_cache_get_all_edges(mesh);
+  DRW_mesh_batch_cache_get_wireframes_face(mesh);
+}
+
+static void mesh_batch_cache_create(Object *object, Mesh *mesh, const Scene *scene)
+{
+  TaskGraph *task_graph = BLI_task_graph_create();
+  DRW_mesh_batch_cache_create_requested(task_graph, object, mesh, scene, false, false);
+  BLI_task_graph_work_and_wait(task_graph);
+  BLI_task_graph_free(task_graph);
+}
+
+class DrawCacheMeshTest : public DrawTest {
+ protected:
+  Scene *scene;
+  Object *object;
+  Mesh *mesh;
+
+  void SetUp() override
+  {
+    DrawTest::SetUp();
+    BKE_idtype_init();
+    scene = (Scene *)MEM_callocN(sizeof(Scene), __func__);
+    object = (Object *)MEM_callocN(sizeof(Object), __func__);
+    object->type = OB_MESH;
+    unit_m4(object->obmat);
+    mesh = nullptr;
+  }
+
+  void TearDown() override
+  {
+    if (mesh) {
+      DRW_mesh_batch_cache_free(mesh);
+      BKE_id_free(nullptr, mesh);
+    }
+    MEM_freeN(object);
+    MEM_freeN(scene);
+    DrawTest::TearDown();
+  }
+
+  void mesh_set(Mesh *new_mesh)
+  {
+    mesh = new_mesh;
+    object->data = mesh;
+  }
+};
+
+TEST_F(DrawCacheMeshTest, deform_update)
+{
+  mesh_set(mesh_grid_create(16));
+
+  mesh_batch_cache_request(mesh);
+  mesh_batch_cache_create(object, mesh, scene);
+
+  MeshBatchCache *cache = (MeshBatchCache *)mesh->runtime.batch_cache;
+  GPUVertBuf *pos_nor = cache->final.vbo.pos_nor;
+  GPUVertBuf *edge_fac = cache->final.vbo.edge_fac;
+  GPUIndexBuf *tris = cache->final.ibo.tris;
+  GPUIndexBuf *lines = cache->final.ibo.lines;
+  GPUBatch *surface = cache->batch.surface;
+  ASSERT_NE(pos_nor, nullptr);
+  ASSERT_NE(edge_fac, nullptr);
+  ASSERT_NE(tris, nullptr);
+  ASSERT_NE(lines, nullptr);
+  /* The first loop uses the first vertex, positions are the first attribute. */
+  EXPECT_EQ(((const float *)pos_nor->data)[2], 0.0f);
+
+  mesh->mvert[0].co[2] = 1.0f;
+  BKE_mesh_calc_normals(mesh);
+  DRW_mesh_batch_cache_dirty_tag(mesh, BKE_MESH_BATCH_DIRTY_DEFORM);
+
+  mesh_batch_cache_request(mesh);
+  mesh_batch_cache_create(object, mesh, scene);
+
+  /* Buffers and batches are kept, only the data depending on positions is replaced. */
+  EXPECT_EQ(mesh->runtime.batch_cache, cache);
+  EXPECT_EQ(cache->batch.surface, surface);
+  EXPECT_EQ(cache->final.vbo.pos_nor, pos_nor);
+  EXPECT_EQ(cache->final.vbo.edge_fac, edge_fac);
+  EXPECT_EQ(cache->final.ibo.tris, tris);
+  EXPECT_EQ(cache->final.ibo.lines, lines);
+  EXPECT_EQ(((const float *)pos_nor->data)[2], 1.0f);
+  EXPECT_EQ(cache->is_deform_dirty, false);
+}
+
+/* Extract a grid large enough to split the extraction in ranges that are shared by the
+ * extractions and check the extracted positions and normals. */
+static void extract_threaded_test(Object *object, Mesh *mesh, const Scene *scene)
+{
+  mesh->mvert[mesh->totvert - 1].co[2] = 1.0f;
+  BKE_mesh_calc_normals(mesh);
+
+  mesh_batch_cache_request(mesh);
+  mesh_batch_cache_create(object, mesh, scene);
+
+  MeshBatchCache *cache = (MeshBatchCache *)mesh->runtime.batch_cache;
+  GPUVertBuf *pos_nor = cache->final.vbo.pos_nor;
+  GPUVertBuf *edge_fac = cache->final.vbo.edge_fac;
+  ASSERT_NE(pos_nor, nullptr);
+  ASSERT_NE(edge_fac, nullptr);
+  ASSERT_EQ(pos_nor->vertex_len, mesh->totloop);
+  ASSERT_EQ(edge_fac->vertex_len, mesh->totloop);
+
+  /* Interleaved position and packed normal of each loop. */
+  const int stride = pos_nor->format.stride;
+  for (int i = 0; i < mesh->totloop; i++) {
+    const MVert *mv = &mesh->mvert[mesh->mloop[i].v];
+    const char *elem = (const char *)pos_nor->data + i * stride;
+    const float *pos = (const float *)elem;
+    const GPUPackedNormal *nor = (const GPUPackedNormal *)(elem + sizeof(float[3]));
+    EXPECT_V3_NEAR(pos, mv->co, 1e-6f);
+    EXPECT_EQ(nor->z, mv->no[2] >> 6);
+  }
+}
+
+TEST_F(DrawCacheMeshTest, extract_threaded)
+{
+  mesh_set(mesh_grid_create(100));
+  extract_threaded_test(object, mesh, scene);
+}
+
+TEST_F(DrawCacheMeshTest, extract_threaded_few_polys)
+{
+  /* Fewer polygons than the maximum size of a range, but enough loops to use threads. */
+  mesh_set(mesh_grid_create(60));
+  extract_threaded_test(object, mesh, scene);
+}
+
+/**
+ * Set this to 1 to activate the benchmark. It is disabled by default, because it prints a lot.
+ * Compares a full extraction of a large mesh with the update after a deformation.
+ */
+#if 0
+TEST_F(DrawCacheMeshTest, deform_update_benchmark)
+{
+  mesh_set(mesh_grid_create(1000));
+
+  for (int i = 0; i < 5; i++) {
+    {
+      SCOPED_TIMER("Full extraction  ");
+      DRW_mesh_batch_cache_dirty_tag(mesh, BKE_MESH_BATCH_DIRTY_ALL);
+      mesh_batch_cache_request(mesh);
+      mesh_batch_cache_create(object, mesh, scene);
+    }
+    {
+      SCOPED_TIMER("Deformed update  ");
+      DRW_mesh_batch_cache_dirty_tag(mesh, BKE_MESH_BATCH_DIRTY_DEFORM);
+      mesh_batch_cache_request(mesh);
+      mesh_batch_cache_create(object, mesh, scene);
+    }
+  }
+}
+#endif
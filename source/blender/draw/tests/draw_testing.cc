@@ -0,0 +1,26 @@
+/* Apache License, Version 2.0 */
+
+#include "draw_testing.hh"
+
+#include "GPU_context.h"
+#include "GPU_init_exit.h"
+
+#include "intern/draw_manager_testing.h"
+
+void DrawTest::SetUp()
+{
+  GHOST_GLSettings glSettings = {0};
+  ghost_system = GHOST_CreateSystem();
+  ghost_context = GHOST_CreateOpenGLContext(ghost_system, glSettings);
+  context = GPU_context_create(0);
+  GPU_init();
+  DRW_draw_state_init_gtests(GPU_SHADER_CFG_DEFAULT);
+}
+
+void DrawTest::TearDown()
+{
+  GPU_exit();
+  GPU_context_discard(context);
+  GHOST_DisposeOpenGLContext(ghost_system, ghost_context);
+  GHOST_DisposeSystem(ghost_system);
+}
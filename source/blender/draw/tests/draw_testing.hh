@@ -0,0 +1,21 @@
+/* Apache License, Version 2.0 */
+
+#pragma once
+
+#include "testing/testing.h"
+
+#include "GHOST_C-api.h"
+
+struct GPUContext;
+
+/* Base class for draw test cases. It will setup and tear down the GPU part around each test. */
+class DrawTest : public ::testing::Test {
+ private:
+  GHOST_SystemHandle ghost_system;
+  GHOST_ContextHandle ghost_context;
+  GPUContext *context;
+
+ protected:
+  void SetUp() override;
+  void TearDown() override;
+};
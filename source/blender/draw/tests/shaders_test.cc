@@ -2,45 +2,16 @@
 
 #include "testing/testing.h"
 
+#include "draw_testing.hh"
 #include "intern/draw_manager_testing.h"
 
-#include "GPU_context.h"
-#include "GPU_init_exit.h"
 #include "GPU_shader.h"
 
-#include "GHOST_C-api.h"
-
 #include "engines/eevee/eevee_private.h"
 #include "engines/gpencil/gpencil_engine.h"
 #include "engines/overlay/overlay_private.h"
 #include "engines/workbench/workbench_private.h"
 
-/* Base class for draw test cases. It will setup and tear down the GPU part around each test. */
-class DrawTest : public ::testing::Test {
- private:
-  GHOST_SystemHandle ghost_system;
-  GHOST_ContextHandle ghost_context;
-  GPUContext *context;
-
-  void SetUp() override
-  {
-    GHOST_GLSettings glSettings = {0};
-    ghost_system = GHOST_CreateSystem();
-    ghost_context = GHOST_CreateOpenGLContext(ghost_system, glSettings);
-    context = GPU_context_create(0);
-    GPU_init();
-    DRW_draw_state_init_gtests(GPU_SHADER_CFG_DEFAULT);
-  }
-
-  void TearDown() override
-  {
-    GPU_exit();
-    GPU_context_discard(context);
-    GHOST_DisposeOpenGLContext(ghost_system, ghost_context);
-    GHOST_DisposeSystem(ghost_system);
-  }
-};
-
 TEST_F(DrawTest, workbench_glsl_shaders)
 {
   workbench_shader_library_ensure();
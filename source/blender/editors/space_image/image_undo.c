@@ -302,6 +302,7 @@ static void ptile_restore_runtime_list(ListBase *paint_tiles)
       ibuf->userflags |= IB_MIPMAP_INVALID; /* force mip-map recreation. */
     }
     ibuf->userflags |= IB_DISPLAY_BUFFER_INVALID;
+    IMB_mark_changed(ibuf);
 
     BKE_image_release_ibuf(image, ibuf, NULL);
   }
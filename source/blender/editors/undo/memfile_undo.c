@@ -61,6 +61,42 @@ typedef struct MemFileUndoStep {
   MemFileUndoData *data;
 } MemFileUndoStep;
 
+/**
+ * Number of memfile steps around the active one kept uncompressed,
+ * older (or newer) steps are compressed in the background, see #BLO_memfile_compress.
+ */
+#define MEMFILE_UNDO_STEPS_UNCOMPRESSED 4
+
+static void memfile_undosys_step_compress_update(MemFileUndoStep *us, const int distance)
+{
+  MemFile *memfile = &us->data->memfile;
+  if (distance < MEMFILE_UNDO_STEPS_UNCOMPRESSED) {
+    BLO_memfile_decompress(memfile);
+  }
+  else {
+    BLO_memfile_compress(memfile);
+  }
+  /* Memory used by the step changes when compressing & freeing steps, see #MemFile.size. */
+  us->data->undo_size = memfile->size;
+  us->step.data_size = memfile->size;
+}
+
+/**
+ * Compress the memfile steps far from \a us_p, which are unlikely to be needed soon.
+ */
+static void memfile_undosys_steps_compress_update(UndoStep *us_p)
+{
+  int distance = 0;
+  for (UndoStep *us_iter = us_p; us_iter; us_iter = BKE_undosys_step_same_type_prev(us_iter)) {
+    memfile_undosys_step_compress_update((MemFileUndoStep *)us_iter, distance++);
+  }
+  distance = 1;
+  for (UndoStep *us_iter = BKE_undosys_step_same_type_next(us_p); us_iter;
+       us_iter = BKE_undosys_step_same_type_next(us_iter)) {
+    memfile_undosys_step_compress_update((MemFileUndoStep *)us_iter, distance++);
+  }
+}
+
 static bool memfile_undosys_poll(bContext *C)
 {
   /* other poll functions must run first, this is a catch-all. */
@@ -96,6 +132,10 @@ static bool memfile_undosys_step_encode(struct bContext *UNUSED(C),
   us->data = BKE_memfile_undo_encode(bmain, us_prev ? us_prev->data : NULL);
   us->step.data_size = us->data->undo_size;
 
+  if (us_prev != NULL) {
+    memfile_undosys_steps_compress_update(&us_prev->step);
+  }
+
   /* Store the fact that we should not re-use old data with that undo step, and reset the Main
    * flag. */
   us->step.use_old_bmain_data = !bmain->use_memfile_full_barrier;
@@ -187,6 +227,7 @@ static void memfile_undosys_step_decode(struct bContext *C,
   ED_editors_exit(bmain, false);
 
   MemFileUndoStep *us = (MemFileUndoStep *)us_p;
+  memfile_undosys_steps_compress_update(us_p);
   BKE_memfile_undo_decode(us->data, undo_direction, use_old_bmain_data, C);
 
   for (UndoStep *us_iter = us_p->next; us_iter; us_iter = us_iter->next) {
@@ -262,6 +303,8 @@ static void memfile_undosys_step_free(UndoStep *us_p)
     if (us_next_p != NULL) {
       MemFileUndoStep *us_next = (MemFileUndoStep *)us_next_p;
       BLO_memfile_merge(&us->data->memfile, &us_next->data->memfile);
+      us_next->data->undo_size = us_next->data->memfile.size;
+      us_next->step.data_size = us_next->data->memfile.size;
     }
   }
 
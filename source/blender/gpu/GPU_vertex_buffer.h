@@ -91,6 +91,7 @@ uint GPU_vertbuf_size_get(const GPUVertBuf *);
 void GPU_vertbuf_data_alloc(GPUVertBuf *, uint v_len);
 void GPU_vertbuf_data_resize(GPUVertBuf *, uint v_len);
 void GPU_vertbuf_data_len_set(GPUVertBuf *, uint v_len);
+void GPU_vertbuf_data_move(GPUVertBuf *verts_dst, GPUVertBuf *verts_src);
 
 /* The most important #set_attr variant is the untyped one. Get it right first.
  * It takes a void* so the app developer is responsible for matching their app data types
@@ -220,6 +220,33 @@ void GPU_vertbuf_data_len_set(GPUVertBuf *verts, uint v_len)
   verts->vertex_len = v_len;
 }
 
+/* Replace the data of verts_dst by the data of verts_src, which must have the same format.
+ * The buffer on the GPU is kept, so batches using verts_dst stay valid and only need the new
+ * data to be uploaded. verts_src is left without data. */
+void GPU_vertbuf_data_move(GPUVertBuf *verts_dst, GPUVertBuf *verts_src)
+{
+#if TRUST_NO_ONE
+  assert(verts_src->data != NULL);
+  assert(verts_dst->format.stride == verts_src->format.stride);
+  assert(verts_dst->format.attr_len == verts_src->format.attr_len);
+#endif
+
+#if VRAM_USAGE
+  /* The size of the source data has been added on allocation already. */
+  vbo_memory_usage -= GPU_vertbuf_size_get(verts_dst);
+#endif
+  if (verts_dst->data) {
+    MEM_freeN(verts_dst->data);
+  }
+  verts_dst->dirty = true;
+  verts_dst->vertex_len = verts_src->vertex_len;
+  verts_dst->vertex_alloc = verts_src->vertex_alloc;
+  verts_dst->data = verts_src->data;
+
+  verts_src->vertex_len = verts_src->vertex_alloc = 0;
+  verts_src->data = NULL;
+}
+
 void GPU_vertbuf_attr_set(GPUVertBuf *verts, uint a_idx, uint v_idx, const void *data)
 {
   const GPUVertFormat *format = &verts->format;
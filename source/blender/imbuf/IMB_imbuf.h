@@ -175,6 +175,13 @@ struct ImBuf *IMB_makeSingleUser(struct ImBuf *ibuf);
  */
 struct ImBuf *IMB_dupImBuf(const struct ImBuf *ibuf1);
 
+/**
+ * Give the buffer a new #ImBuf.change_stamp, call after changing its pixels in place.
+ *
+ * \attention Defined in allocimbuf.c
+ */
+void IMB_mark_changed(struct ImBuf *ibuf);
+
 /**
  *
  * \attention Defined in allocimbuf.c
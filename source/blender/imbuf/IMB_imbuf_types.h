@@ -256,6 +256,11 @@ typedef struct ImBuf {
   struct MEM_CacheLimiterHandle_s *c_handle;
   /** reference counter for multiple users */
   int refcounter;
+  /**
+   * Unique for every allocation and pixel change (see #IMB_mark_changed), so caches can detect
+   * changed pixels without comparing them.
+   */
+  unsigned int change_stamp;
 
   /* some parameters to pass along for packing images */
   /** Compressed image only used with png and exr currently */
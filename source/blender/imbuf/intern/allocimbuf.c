@@ -41,7 +41,10 @@
 #include "BLI_threads.h"
 #include "BLI_utildefines.h"
 
+#include "atomic_ops.h"
+
 static SpinLock refcounter_spin;
+static uint32_t change_stamp_counter = 0;
 
 void imb_refcounter_lock_init(void)
 {
@@ -269,6 +272,11 @@ ImBuf *IMB_makeSingleUser(ImBuf *ibuf)
   return rval;
 }
 
+void IMB_mark_changed(ImBuf *ibuf)
+{
+  ibuf->change_stamp = atomic_add_and_fetch_uint32(&change_stamp_counter, 1);
+}
+
 bool addzbufImBuf(ImBuf *ibuf)
 {
   if (ibuf == NULL) {
@@ -495,6 +503,7 @@ bool IMB_initImBuf(
     struct ImBuf *ibuf, unsigned int x, unsigned int y, unsigned char planes, unsigned int flags)
 {
   memset(ibuf, 0, sizeof(ImBuf));
+  IMB_mark_changed(ibuf);
 
   ibuf->x = x;
   ibuf->y = y;
@@ -614,6 +623,7 @@ ImBuf *IMB_dupImBuf(const ImBuf *ibuf1)
   tbuf.mall = ibuf2->mall;
   tbuf.c_handle = NULL;
   tbuf.refcounter = 0;
+  tbuf.change_stamp = ibuf2->change_stamp;
 
   /* for now don't duplicate metadata */
   tbuf.metadata = NULL;
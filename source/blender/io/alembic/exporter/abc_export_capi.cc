@@ -49,6 +49,7 @@ static CLG_LogRef LOG = {"io.alembic"};
 
 #include <algorithm>
 #include <memory>
+#include <vector>
 
 struct ExportJobData {
   Main *bmain;
@@ -77,6 +78,41 @@ static void build_depsgraph(Depsgraph *depsgraph, const bool visible_objects_onl
   }
 }
 
+struct ExportFramesData {
+  ExportJobData *job_data;
+  ABCArchive *abc_archive;
+  ABCHierarchyIterator *iter;
+  short *stop;
+  short *do_update;
+  float *progress;
+  float progress_per_frame;
+};
+
+static void build_depsgraph_for_frames(Depsgraph *depsgraph, void *user_data)
+{
+  const ExportFramesData *data = static_cast<const ExportFramesData *>(user_data);
+  build_depsgraph(depsgraph, data->job_data->params.visible_objects_only);
+}
+
+static bool export_frame(Depsgraph *depsgraph, double frame, void *user_data)
+{
+  ExportFramesData *data = static_cast<ExportFramesData *>(user_data);
+
+  if (G.is_break || (data->stop != nullptr && *data->stop)) {
+    return false;
+  }
+
+  CLOG_INFO(&LOG, 2, "Exporting frame %.2f", frame);
+  ExportSubset export_subset = data->abc_archive->export_subset_for_frame(frame);
+  data->iter->set_depsgraph(depsgraph);
+  data->iter->set_export_subset(export_subset);
+  data->iter->iterate_and_write();
+
+  *data->progress += data->progress_per_frame;
+  *data->do_update = true;
+  return true;
+}
+
 static void export_startjob(void *customdata,
                             /* Cannot be const, this function implements wm_jobs_start_callback.
                              * NOLINTNEXTLINE: readability-non-const-parameter. */
@@ -139,30 +175,27 @@ static void export_startjob(void *customdata,
     CLOG_INFO(&LOG, 2, "Exporting animation");
 
     // Writing the animated frames is not 100% of the work, but it's our best guess.
-    const float progress_per_frame = 1.0f / std::max(size_t(1), abc_archive->total_frame_count());
-    ABCArchive::Frames::const_iterator frame_it = abc_archive->frames_begin();
-    const ABCArchive::Frames::const_iterator frames_end = abc_archive->frames_end();
-
-    for (; frame_it != frames_end; frame_it++) {
-      double frame = *frame_it;
-
-      if (G.is_break || (stop != nullptr && *stop)) {
-        break;
-      }
-
-      // Update the scene for the next frame to render.
-      scene->r.cfra = static_cast<int>(frame);
-      scene->r.subframe = frame - scene->r.cfra;
-      BKE_scene_graph_update_for_newframe(data->depsgraph);
-
-      CLOG_INFO(&LOG, 2, "Exporting frame %.2f", frame);
-      ExportSubset export_subset = abc_archive->export_subset_for_frame(frame);
-      iter.set_export_subset(export_subset);
-      iter.iterate_and_write();
-
-      *progress += progress_per_frame;
-      *do_update = true;
-    }
+    ExportFramesData frames_data;
+    frames_data.job_data = data;
+    frames_data.abc_archive = abc_archive.get();
+    frames_data.iter = &iter;
+    frames_data.stop = stop;
+    frames_data.do_update = do_update;
+    frames_data.progress = progress;
+    frames_data.progress_per_frame = 1.0f /
+                                     std::max(size_t(1), abc_archive->total_frame_count());
+
+    // Frames without simulations are evaluated concurrently by multiple depsgraphs, and written
+    // in order.
+    const std::vector<double> frames(abc_archive->frames_begin(), abc_archive->frames_end());
+    BKE_scene_graph_evaluate_frames(data->depsgraph,
+                                    frames.data(),
+                                    static_cast<int>(frames.size()),
+                                    0,
+                                    build_depsgraph_for_frames,
+                                    export_frame,
+                                    &frames_data);
+    iter.set_depsgraph(data->depsgraph);
   }
   else {
     // If we're not animating, a single iteration over all objects is enough.
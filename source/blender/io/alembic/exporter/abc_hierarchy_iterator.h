@@ -39,7 +39,6 @@ namespace alembic {
 class ABCHierarchyIterator;
 
 struct ABCWriterConstructorArgs {
-  Depsgraph *depsgraph;
   ABCArchive *abc_archive;
   Alembic::Abc::OObject abc_parent;
   std::string abc_name;
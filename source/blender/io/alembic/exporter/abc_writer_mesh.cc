@@ -111,7 +111,7 @@ void ABCGenericMeshWriter::create_alembic_objects(const HierarchyContext *contex
     type.set(subsurf_modifier_ == nullptr);
   }
 
-  Scene *scene_eval = DEG_get_evaluated_scene(args_.depsgraph);
+  Scene *scene_eval = DEG_get_evaluated_scene(args_.hierarchy_iterator->depsgraph());
   liquid_sim_modifier_ = get_liquid_sim_modifier(scene_eval, context->object);
 }
 
@@ -170,6 +170,12 @@ void ABCGenericMeshWriter::do_write(HierarchyContext &context)
   Object *object = context.object;
   bool needsfree = false;
 
+  if (liquid_sim_modifier_ != nullptr) {
+    /* Frames can be evaluated by different depsgraphs, use the modifier of this frame. */
+    Scene *scene_eval = DEG_get_evaluated_scene(args_.hierarchy_iterator->depsgraph());
+    liquid_sim_modifier_ = get_liquid_sim_modifier(scene_eval, object);
+  }
+
   Mesh *mesh = get_export_mesh(object, needsfree);
 
   if (mesh == nullptr) {
@@ -242,6 +242,15 @@ class AbstractHierarchyIterator {
   /* Release all writers. Call after all frames have been exported. */
   void release_writers();
 
+  /* Export the objects of another depsgraph in the next iterations, for frames which are evaluated
+   * by a different depsgraph than the previous ones. It must have been built for the same scene,
+   * view layer and evaluation mode. The writers are kept, as they are found by export path. */
+  void set_depsgraph(Depsgraph *depsgraph);
+
+  /* The depsgraph which is being exported. Writers should use this instead of storing the one
+   * they were created with, as it can change between frames. */
+  Depsgraph *depsgraph() const;
+
   /* Determine which subset of writers is used for exporting.
    * Set this before calling iterate_and_write().
    *
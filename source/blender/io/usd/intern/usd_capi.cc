@@ -25,6 +25,8 @@
 #include <pxr/usd/usd/stage.h>
 #include <pxr/usd/usdGeom/tokens.h>
 
+#include <vector>
+
 #include "MEM_guardedalloc.h"
 
 #include "DEG_depsgraph.h"
@@ -76,6 +78,49 @@ static void ensure_usd_plugin_path_registered(void)
   pxr::PlugRegistry::GetInstance().RegisterPlugins(blender_usd_datafiles + "/");
 }
 
+// Construct the depsgraph for exporting.
+static void build_depsgraph(Depsgraph *depsgraph, const bool visible_objects_only)
+{
+  if (visible_objects_only) {
+    DEG_graph_build_from_view_layer(depsgraph);
+  }
+  else {
+    DEG_graph_build_for_all_objects(depsgraph);
+  }
+}
+
+struct ExportFramesData {
+  ExportJobData *job_data;
+  USDHierarchyIterator *iter;
+  short *stop;
+  short *do_update;
+  float *progress;
+  float progress_per_frame;
+};
+
+static void build_depsgraph_for_frames(Depsgraph *depsgraph, void *user_data)
+{
+  const ExportFramesData *data = static_cast<const ExportFramesData *>(user_data);
+  build_depsgraph(depsgraph, data->job_data->params.visible_objects_only);
+}
+
+static bool export_frame(Depsgraph *depsgraph, double frame, void *user_data)
+{
+  ExportFramesData *data = static_cast<ExportFramesData *>(user_data);
+
+  if (G.is_break || (data->stop != nullptr && *data->stop)) {
+    return false;
+  }
+
+  data->iter->set_depsgraph(depsgraph);
+  data->iter->set_export_frame(frame);
+  data->iter->iterate_and_write();
+
+  *data->progress += data->progress_per_frame;
+  *data->do_update = true;
+  return true;
+}
+
 static void export_startjob(void *customdata,
                             /* Cannot be const, this function implements wm_jobs_start_callback.
                              * NOLINTNEXTLINE: readability-non-const-parameter. */
@@ -90,14 +135,8 @@ static void export_startjob(void *customdata,
   WM_set_locked_interface(data->wm, true);
   G.is_break = false;
 
-  // Construct the depsgraph for exporting.
   Scene *scene = DEG_get_input_scene(data->depsgraph);
-  if (data->params.visible_objects_only) {
-    DEG_graph_build_from_view_layer(data->depsgraph);
-  }
-  else {
-    DEG_graph_build_for_all_objects(data->depsgraph);
-  }
+  build_depsgraph(data->depsgraph, data->params.visible_objects_only);
   BKE_scene_graph_update_tagged(data->depsgraph, data->bmain);
 
   *progress = 0.0f;
@@ -133,24 +172,28 @@ static void export_startjob(void *customdata,
 
   if (data->params.export_animation) {
     // Writing the animated frames is not 100% of the work, but it's our best guess.
-    float progress_per_frame = 1.0f / std::max(1, (scene->r.efra - scene->r.sfra + 1));
-
-    for (float frame = scene->r.sfra; frame <= scene->r.efra; frame++) {
-      if (G.is_break || (stop != nullptr && *stop)) {
-        break;
-      }
-
-      // Update the scene for the next frame to render.
-      scene->r.cfra = static_cast<int>(frame);
-      scene->r.subframe = frame - scene->r.cfra;
-      BKE_scene_graph_update_for_newframe(data->depsgraph);
-
-      iter.set_export_frame(frame);
-      iter.iterate_and_write();
-
-      *progress += progress_per_frame;
-      *do_update = true;
+    ExportFramesData frames_data;
+    frames_data.job_data = data;
+    frames_data.iter = &iter;
+    frames_data.stop = stop;
+    frames_data.do_update = do_update;
+    frames_data.progress = progress;
+    frames_data.progress_per_frame = 1.0f / std::max(1, (scene->r.efra - scene->r.sfra + 1));
+
+    // Frames without simulations are evaluated concurrently by multiple depsgraphs, and written
+    // in order.
+    std::vector<double> frames;
+    for (int frame = scene->r.sfra; frame <= scene->r.efra; frame++) {
+      frames.push_back(frame);
     }
+    BKE_scene_graph_evaluate_frames(data->depsgraph,
+                                    frames.data(),
+                                    static_cast<int>(frames.size()),
+                                    0,
+                                    build_depsgraph_for_frames,
+                                    export_frame,
+                                    &frames_data);
+    iter.set_depsgraph(data->depsgraph);
   }
   else {
     // If we're not animating, a single iteration over all objects is enough.
@@ -33,7 +33,6 @@ namespace usd {
 class USDHierarchyIterator;
 
 struct USDExporterContext {
-  Depsgraph *depsgraph;
   const pxr::UsdStageRefPtr stage;
   const pxr::SdfPath usd_path;
   const USDHierarchyIterator *hierarchy_iterator;
@@ -435,9 +435,10 @@ void USDGenericMeshWriter::write_surface_velocity(Object *object,
   }
 
   /* Check that the fluid sim modifier is enabled and has useful data. */
-  const bool use_render = (DEG_get_mode(usd_export_context_.depsgraph) == DAG_EVAL_RENDER);
+  Depsgraph *depsgraph = usd_export_context_.hierarchy_iterator->depsgraph();
+  const bool use_render = (DEG_get_mode(depsgraph) == DAG_EVAL_RENDER);
   const ModifierMode required_mode = use_render ? eModifierMode_Render : eModifierMode_Realtime;
-  const Scene *scene = DEG_get_evaluated_scene(usd_export_context_.depsgraph);
+  const Scene *scene = DEG_get_evaluated_scene(depsgraph);
   if (!BKE_modifier_is_enabled(scene, md, required_mode)) {
     return;
   }
@@ -53,6 +53,11 @@ typedef struct CustomDataLayer {
   char name[64];
   /** Layer data. */
   void *data;
+  /**
+   * Run-time reference count of the layer data when it is shared with layers of other
+   * CustomData, NULL when the data is not shared. See #CD_REFERENCE.
+   */
+  struct CustomDataSharing *sharing;
 } CustomDataLayer;
 
 #define MAX_CUSTOMDATA_LAYER_NAME 64
@@ -240,6 +245,8 @@ enum {
   CD_FLAG_EXTERNAL = (1 << 3),
   /* Indicates external data is read into memory */
   CD_FLAG_IN_MEMORY = (1 << 4),
+  /* Indicates the layer data is shared from another layer, which still owns it (run-time only) */
+  CD_FLAG_SHARED = (1 << 5),
 };
 
 /* Limits */
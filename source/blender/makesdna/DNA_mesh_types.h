@@ -48,6 +48,7 @@ struct MVert;
 struct MPropCol;
 struct Material;
 struct Mesh;
+struct MeshElemMap;
 struct Multires;
 struct SubdivCCG;
 
@@ -106,6 +107,23 @@ typedef struct Mesh_Runtime {
   /** Non-manifold boundary data for Shrinkwrap Target Project. */
   struct ShrinkwrapBoundaryData *shrinkwrap_data;
 
+  /**
+   * Cached normals, see #BKE_mesh_vertex_normals_ensure and #BKE_mesh_poly_normals_ensure.
+   * Only valid when the matching dirty flag is cleared.
+   */
+  float (*vert_normals)[3];
+  float (*poly_normals)[3];
+  /** Loops using each vertex, to sum the cached vertex normals in parallel. */
+  struct MeshElemMap *vert_loop_map;
+  int *vert_loop_map_mem;
+  /**
+   * Hashes of the topology and the vertex coordinates the cached normals were calculated from,
+   * so changes that weren't tagged with #BKE_mesh_normals_tag_dirty are detected.
+   */
+  uint64_t normals_topology_hash;
+  uint64_t vert_normals_hash;
+  uint64_t poly_normals_hash;
+
   /** Set by modifier stack if only deformed from original. */
   char deformed_only;
   /**
@@ -125,7 +143,17 @@ typedef struct Mesh_Runtime {
    */
   char wrapper_type_finalize;
 
-  char _pad[4];
+  /**
+   * The draw cache was taken over from the previous evaluated mesh of the object,
+   * which only differed in vertex positions (see #BKE_MESH_BATCH_DIRTY_DEFORM).
+   */
+  char is_batch_cache_deformed;
+
+  /** Set by #BKE_mesh_normals_tag_dirty when the cached normals need to be recalculated. */
+  char vert_normals_dirty;
+  char poly_normals_dirty;
+
+  char _pad[1];
 
   /** Needed in case we need to lazily initialize the mesh. */
   CustomData_MeshMasks cd_mask_extra;
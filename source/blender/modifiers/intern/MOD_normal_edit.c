@@ -449,7 +449,7 @@ static void normalEditModifier_do_directional(NormalEditModifierData *enmd,
 
   if (do_polynors_fix &&
       polygons_check_flip(mloop, nos, &mesh->ldata, mpoly, polynors, num_polys)) {
-    mesh->runtime.cd_dirty_vert |= CD_MASK_NORMAL;
+    BKE_mesh_normals_tag_dirty(mesh);
   }
 
   BKE_mesh_normals_loop_custom_set(mvert,
@@ -541,20 +541,17 @@ static Mesh *normalEditModifier_do(NormalEditModifierData *enmd,
 
   /* Compute poly (always needed) and vert normals. */
   CustomData *pdata = &result->pdata;
-  polynors = CustomData_get_layer(pdata, CD_NORMAL);
+  polynors = CustomData_duplicate_referenced_layer(pdata, CD_NORMAL, num_polys);
   if (!polynors) {
     polynors = CustomData_add_layer(pdata, CD_NORMAL, CD_CALLOC, NULL, num_polys);
     CustomData_set_layer_flag(pdata, CD_NORMAL, CD_FLAG_TEMPORARY);
   }
-  BKE_mesh_calc_normals_poly(mvert,
-                             NULL,
-                             num_verts,
-                             mloop,
-                             mpoly,
-                             num_loops,
-                             num_polys,
-                             polynors,
-                             (result->runtime.cd_dirty_vert & CD_MASK_NORMAL) ? false : true);
+  if (result->runtime.cd_dirty_vert & CD_MASK_NORMAL) {
+    BKE_mesh_vertex_normals_ensure(result);
+    /* The vertices are copied when they were shared with the input mesh. */
+    mvert = result->mvert;
+  }
+  memcpy(polynors, BKE_mesh_poly_normals_ensure(result), sizeof(*polynors) * (size_t)num_polys);
 
   result->runtime.cd_dirty_vert &= ~CD_MASK_NORMAL;
 
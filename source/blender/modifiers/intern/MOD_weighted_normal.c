@@ -608,13 +608,15 @@ static Mesh *modifyMesh(ModifierData *md, const ModifierEvalContext *ctx, Mesh *
   }
 
   CustomData *pdata = &result->pdata;
-  float(*polynors)[3] = CustomData_get_layer(pdata, CD_NORMAL);
+  float(*polynors)[3] = CustomData_duplicate_referenced_layer(pdata, CD_NORMAL, numPolys);
   if (!polynors) {
     polynors = CustomData_add_layer(pdata, CD_NORMAL, CD_CALLOC, NULL, numPolys);
     CustomData_set_layer_flag(pdata, CD_NORMAL, CD_FLAG_TEMPORARY);
   }
-  BKE_mesh_calc_normals_poly(
-      mvert, NULL, numVerts, mloop, mpoly, numLoops, numPolys, polynors, false);
+  BKE_mesh_vertex_normals_ensure(result);
+  memcpy(polynors, BKE_mesh_poly_normals_ensure(result), sizeof(*polynors) * (size_t)numPolys);
+  /* The vertices are copied when they were shared with the input mesh. */
+  mvert = result->mvert;
 
   const float split_angle = mesh->smoothresh;
   short(*clnors)[2];
@@ -40,6 +40,7 @@ void bpy_app_generic_callback(struct Main *main,
                               struct PointerRNA **pointers,
                               const int num_pointers,
                               void *arg);
+bool bpy_app_generic_callback_poll(void *arg);
 
 static PyTypeObject BlenderAppCbType;
 
@@ -245,6 +246,7 @@ PyObject *BPY_app_handlers_struct(void)
       funcstore->func = bpy_app_generic_callback;
       funcstore->alloc = 0;
       funcstore->arg = POINTER_FROM_INT(pos);
+      funcstore->poll = bpy_app_generic_callback_poll;
       BKE_callback_add(funcstore, pos);
     }
   }
@@ -310,6 +312,13 @@ static PyObject *choose_arguments(PyObject *func, PyObject *args_all, PyObject *
   return args_all;
 }
 
+/* Only call the generic callback when there are handlers registered for the event. */
+bool bpy_app_generic_callback_poll(void *arg)
+{
+  PyObject *cb_list = py_cb_array[POINTER_AS_INT(arg)];
+  return PyList_GET_SIZE(cb_list) > 0;
+}
+
 /* the actual callback - not necessarily called from py */
 void bpy_app_generic_callback(struct Main *UNUSED(main),
                               struct PointerRNA **pointers,
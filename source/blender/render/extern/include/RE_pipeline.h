@@ -150,6 +150,10 @@ typedef struct RenderResult {
   /* for acquire image, to indicate if it there is a combined layer */
   int have_combined;
 
+  /* Unique for every result and pass pixel change, so caches can detect changed passes
+   * without comparing pixels. */
+  unsigned int change_stamp;
+
   /* render info text */
   char *text;
   char *error;
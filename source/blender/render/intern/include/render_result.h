@@ -66,6 +66,10 @@ void render_result_views_new(struct RenderResult *rr, const struct RenderData *r
 
 void render_result_merge(struct RenderResult *rr, struct RenderResult *rrpart);
 
+/* Change Detection */
+
+void render_result_mark_changed(struct RenderResult *rr);
+
 /* Add Passes */
 
 void render_result_clone_passes(struct Render *re, struct RenderResult *rr, const char *viewname);
@@ -56,6 +56,8 @@
 #include "render_result.h"
 #include "render_types.h"
 
+#include "atomic_ops.h"
+
 /********************************** Free *************************************/
 
 static void render_result_views_free(RenderResult *rr)
@@ -305,6 +307,7 @@ RenderResult *render_result_new(Render *re,
   }
 
   rr = MEM_callocN(sizeof(RenderResult), "new render result");
+  render_result_mark_changed(rr);
   rr->rectx = rectx;
   rr->recty = recty;
   rr->renrect.xmin = 0;
@@ -755,6 +758,7 @@ RenderResult *render_result_new_from_exr(
   const char *to_colorspace = IMB_colormanagement_role_colorspace_name_get(
       COLOR_ROLE_SCENE_LINEAR);
 
+  render_result_mark_changed(rr);
   rr->rectx = rectx;
   rr->recty = recty;
 
@@ -888,6 +892,15 @@ void render_result_merge(RenderResult *rr, RenderResult *rrpart)
       }
     }
   }
+
+  render_result_mark_changed(rr);
+}
+
+/* Give the result a new change stamp, call after writing to its passes. */
+void render_result_mark_changed(RenderResult *rr)
+{
+  static uint32_t change_stamp_counter = 0;
+  rr->change_stamp = atomic_add_and_fetch_uint32(&change_stamp_counter, 1);
 }
 
 /* Called from the UI and render pipeline, to save multilayer and multiview
@@ -1381,6 +1394,8 @@ int render_result_exr_file_read_path(RenderResult *rr,
   IMB_exr_read_channels(exrhandle);
   IMB_exr_close(exrhandle);
 
+  render_result_mark_changed(rr);
+
   return 1;
 }
 
@@ -1698,5 +1713,6 @@ RenderResult *RE_DuplicateRenderResult(RenderResult *rr)
     new_rr->rectz = MEM_dupallocN(new_rr->rectz);
   }
   new_rr->stamp_data = BKE_stamp_data_copy(new_rr->stamp_data);
+  render_result_mark_changed(new_rr);
   return new_rr;
 }
@@ -410,9 +410,7 @@ void wm_close_and_free(bContext *C, wmWindowManager *wm)
   wmOperator *op;
   wmKeyConfig *keyconf;
 
-  if (wm->autosavetimer) {
-    wm_autosave_timer_ended(wm);
-  }
+  wm_autosave_timer_ended(wm);
 
 #ifdef WITH_XR_OPENXR
   /* May send notifier, so do before freeing notifier queue. */
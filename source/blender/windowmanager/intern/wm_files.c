@@ -1550,8 +1550,49 @@ static bool wm_file_write(bContext *C,
 
 /* -------------------------------------------------------------------- */
 /** \name Auto-Save API
+ *
+ * With global undo, the active undo step already holds the file contents in a #MemFile.
+ * Auto-save shares its buffers (without copying or serializing anything on the main thread)
+ * and writes them to disk from a job, while editing continues.
  * \{ */
 
+typedef struct AutoSaveJob {
+  /** Shares the buffers of the undo step, see #BLO_memfile_copy_shared. */
+  MemFile memfile;
+  char filepath[FILE_MAX];
+  int fileflags;
+} AutoSaveJob;
+
+static void wm_autosave_job_startjob(void *customdata,
+                                     short *stop,
+                                     short *UNUSED(do_update),
+                                     float *UNUSED(progress))
+{
+  AutoSaveJob *job = customdata;
+  BLO_write_file_from_memfile(&job->memfile, job->filepath, job->fileflags, stop);
+}
+
+static void wm_autosave_job_free(void *customdata)
+{
+  AutoSaveJob *job = customdata;
+  BLO_memfile_free(&job->memfile);
+  MEM_freeN(job);
+}
+
+static void wm_autosave_job_start(wmWindowManager *wm, MemFile *memfile, const char *filepath)
+{
+  AutoSaveJob *job = MEM_callocN(sizeof(*job), __func__);
+  BLO_memfile_copy_shared(memfile, &job->memfile);
+  BLI_strncpy(job->filepath, filepath, sizeof(job->filepath));
+  job->fileflags = G.fileflags;
+
+  wmJob *wm_job = WM_jobs_get(wm, NULL, wm, "Auto-Saving...", 0, WM_JOB_TYPE_AUTOSAVE);
+  WM_jobs_customdata_set(wm_job, job, wm_autosave_job_free);
+  WM_jobs_timer(wm_job, 0.1, 0, 0);
+  WM_jobs_callbacks(wm_job, wm_autosave_job_startjob, NULL, NULL, NULL);
+  WM_jobs_start(wm, wm_job);
+}
+
 void wm_autosave_location(char *filepath)
 {
   const int pid = abs(getpid());
@@ -1617,14 +1658,20 @@ void wm_autosave_timer(Main *bmain, wmWindowManager *wm, wmTimer *UNUSED(wt))
     }
   }
 
+  /* The previous auto-save is still being written (slow disk), skip this one. */
+  if (WM_jobs_test(wm, wm, WM_JOB_TYPE_AUTOSAVE)) {
+    wm->autosavetimer = WM_event_add_timer(wm, NULL, TIMERAUTOSAVE, U.savetime * 60.0);
+    return;
+  }
+
   wm_autosave_location(filepath);
 
-  if (U.uiflag & USER_GLOBALUNDO) {
-    /* fast save of last undobuffer, now with UI */
-    struct MemFile *memfile = ED_undosys_stack_memfile_get_active(wm->undo_stack);
-    if (memfile) {
-      BLO_memfile_write_file(memfile, filepath);
-    }
+  struct MemFile *memfile = (U.uiflag & USER_GLOBALUNDO) ?
+                                ED_undosys_stack_memfile_get_active(wm->undo_stack) :
+                                NULL;
+  if (memfile) {
+    /* Write the last undo step in the background, error reporting into console. */
+    wm_autosave_job_start(wm, memfile, filepath);
   }
   else {
     /* Save as regular blend file. */